@@ -0,0 +1,296 @@
+/**
+ * @file analyzer.c
+ * @ingroup analyzer
+ *
+ * @author Piotr Janaszek <janas03@yahoo.pl>
+ * @date Created on: Oct 18, 2026
+ *
+ * @brief File containing the offline analyzer estimating chances to win in recorded games.
+ *
+ * The analyzer reads recorded games, one per line in the form
+ * size#K#mode#x;y#x;y#... with coordinates counted from 1, replays them by
+ * the rules of the server and estimates every position with a Monte Carlo
+ * tree search of a fixed number of playouts. The positions are searched on a
+ * compute pool with a worker per core. For every position it prints the game
+ * number, the number of moves played and the chance of 'x' to win, and at
+ * the end reports the number of playouts per second.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "arena.h"
+#include "board_handler.h"
+#include "common.h"
+#include "compute_pool.h"
+#include "config.h"
+#include "mcts.h"
+#include "structs.h"
+
+/**
+ * Prints out parameters required to start the application
+ * @param[in] name Name of the analyzer application file.
+ */
+void
+usage(char *name) {
+	fprintf(stderr, "Usage: %s [-n playouts] [-t threads] [-s step] file\n",
+			name);
+	fprintf(stderr, "playouts - playouts per position, default %d\n",
+			ANALYZER_PLAYOUTS);
+	fprintf(stderr, "threads  - number of worker threads, default one per core\n");
+	fprintf(stderr, "step     - analyze every step-th position, default 1\n");
+	fprintf(stderr, "file     - recorded games, one per line: size#K#mode#x;y#...\n");
+}
+
+/**
+ * Estimates a position on a compute pool worker.
+ * @param[in] job Pointer to the job embedded in an analysis job.
+ * \sa analysis_job_s
+ */
+void
+run_analysis(compute_job_s *job) {
+	int i, cells;
+	long visits = 0;
+	double wins = 0;
+	analysis_job_s *analysis = (analysis_job_s*) job;
+	mcts_stats_s *stats = calloc(1, sizeof(mcts_stats_s));
+	analysis->value = -1;
+	if (stats == NULL) {
+		return;
+	}
+	if (run_mcts(&analysis->search, analysis->game * 1000003ULL
+			+ analysis->ply, stats) == 0) {
+		cells = analysis->search.size * analysis->search.size;
+		for (i = 0; i < cells; i++) {
+			visits += stats->visits[i];
+			wins += stats->wins[i];
+		}
+		/* wins at the root are those of the player to move */
+		analysis->value = visits > 0 ? wins / visits : 0.5;
+		if (analysis->search.side == 2) {
+			analysis->value = 1 - analysis->value;
+		}
+		analysis->playouts = stats->playouts;
+	}
+	free(stats);
+}
+
+/**
+ * Creates a job estimating the current position of a replayed game.
+ * @param[in] board    Pointer to the board of the game.
+ * @param[in] heights  Number of pawns in every column of a gravity game.
+ * @param[in] mode     The game mode.
+ * @param[in] side     The player to move, 1 or 2.
+ * @param[in] game     Number of the game.
+ * @param[in] ply      Number of moves played.
+ * @param[in] playouts Number of playouts to run.
+ * @return Pointer to the job or NULL when memory cannot be allocated.
+ * \sa analysis_job_s
+ */
+analysis_job_s*
+create_analysis_job(board_s *board, const int *heights, game_mode_e mode,
+		int side, int game, int ply, long playouts) {
+	int x, y;
+	char field;
+	analysis_job_s *analysis = calloc(1, sizeof(analysis_job_s));
+	if (analysis == NULL) {
+		return NULL;
+	}
+	analysis->job.run = run_analysis;
+	analysis->game = game;
+	analysis->ply = ply;
+	analysis->search.size = board->size;
+	analysis->search.win_length = board->win_length;
+	analysis->search.mode = mode;
+	analysis->search.side = side;
+	analysis->search.hash = board->hash;
+	for (x = 0; x < board->size; x++) {
+		for (y = 0; y < board->size; y++) {
+			field = get_field(board, x, y);
+			analysis->search.cells[x * board->size + y] =
+					field == 'x' ? 1 : field == 'o' ? 2 : 0;
+			analysis->search.no_empty += field == '1';
+		}
+		analysis->search.heights[x] = heights[x];
+	}
+	analysis->search.deadline = (long long) 1 << 62;
+	analysis->search.max_playouts = playouts;
+	analysis->search.cancelled = NULL;
+	return analysis;
+}
+
+/**
+ * Replays a recorded game and creates a job for every step-th position
+ * before the game ends.
+ * @param[in]  line     The recorded game.
+ * @param[in]  game     Number of the game.
+ * @param[in]  step     Distance between analyzed positions, in moves.
+ * @param[in]  playouts Number of playouts per position.
+ * @param[out] jobs     Array the jobs are appended to.
+ * @param[out] no_jobs  Pointer to the number of jobs in the array.
+ * @param[in]  capacity Size of the array.
+ * @return Number of jobs created or -1 when the record is not valid.
+ */
+int
+replay_game(char *line, int game, int step, long playouts,
+		analysis_job_s **jobs, int *no_jobs, int capacity) {
+	int size, win_length, mode, empty, result = 0, ply = 0, created = 0;
+	int heights[MAX_BOARD_SIZE] = { 0 };
+	char *token, *saveptr = NULL, *inner;
+	arena_s *arena;
+	board_s *board;
+	move_s move;
+	if ((token = strtok_r(line, PAYLOAD_DELIM, &saveptr)) == NULL) {
+		return -1;
+	}
+	size = atoi(token);
+	win_length = (token = strtok_r(NULL, PAYLOAD_DELIM, &saveptr)) != NULL ?
+			atoi(token) : 0;
+	mode = (token = strtok_r(NULL, PAYLOAD_DELIM, &saveptr)) != NULL ?
+			atoi(token) : -1;
+	if (size < MIN_BOARD_SIZE || size > MAX_BOARD_SIZE
+			|| win_length < MIN_WIN_LENGTH || win_length > MAX_WIN_LENGTH
+			|| win_length > size || mode < GAME_MODE_FREE
+			|| mode >= GAME_MODES_NO) {
+		return -1;
+	}
+	if ((arena = create_arena(get_board_arena_size(size, win_length))) == NULL
+			|| (board = create_new_board(arena, size, win_length)) == NULL) {
+		destroy_arena(arena);
+		return -1;
+	}
+	empty = size * size;
+	for (;;) {
+		if (ply % step == 0 && *no_jobs < capacity) {
+			if ((jobs[*no_jobs] = create_analysis_job(board, heights, mode,
+					ply % 2 + 1, game, ply, playouts)) != NULL) {
+				(*no_jobs)++;
+				created++;
+			}
+		}
+		if ((token = strtok_r(NULL, PAYLOAD_DELIM, &saveptr)) == NULL
+				|| (inner = strchr(token, INNER_DELIM[0])) == NULL) {
+			break;
+		}
+		move.x = atoi(token) - 1;
+		move.y = atoi(inner + 1) - 1;
+		move.pawn = ply % 2 == 0 ? 'x' : 'o';
+		if (mode == GAME_MODE_GRAVITY
+				&& get_drop_row(heights, size, move.y) != move.x) {
+			result = -1;
+			break;
+		}
+		if ((result = make_move(board, &move, &empty)) == -1) {
+			break;
+		}
+		if (mode == GAME_MODE_GRAVITY) {
+			heights[move.y]++;
+		}
+		ply++;
+		if (result != 0) {
+			break;
+		}
+	}
+	destroy_arena(arena);
+	return result == -1 ? -1 : created;
+}
+
+/**
+ * The main procedure.
+ * @param argc The command line.
+ * @param argv The number of options in the command line.
+ * @retval EXIT_SUCCESS Upon successful termination.
+ * @retval EXIT_FAILURE When an error occurs.
+ */
+int
+main(int argc, char **argv) {
+	int i, c, game = 0, no_jobs = 0, capacity = 1024, step = 1;
+	int threads = sysconf(_SC_NPROCESSORS_ONLN);
+	long playouts = ANALYZER_PLAYOUTS, total = 0;
+	long long elapsed;
+	char *line = NULL;
+	size_t length = 0;
+	FILE *file;
+	analysis_job_s **jobs, **bigger;
+	compute_pool_s *pool;
+	while ((c = getopt(argc, argv, "n:t:s:")) != -1) {
+		switch (c) {
+		case 'n':
+			playouts = atol(optarg);
+			break;
+		case 't':
+			threads = atoi(optarg);
+			break;
+		case 's':
+			step = atoi(optarg);
+			break;
+		default:
+			usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+	if (optind != argc - 1 || playouts <= 0 || threads <= 0 || step <= 0) {
+		usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+	if ((file = fopen(argv[optind], "r")) == NULL) {
+		perror("Open games:");
+		return EXIT_FAILURE;
+	}
+	if ((jobs = malloc(capacity * sizeof(analysis_job_s*))) == NULL) {
+		fprintf(stderr, "Cannot allocate memory for positions\n");
+		return EXIT_FAILURE;
+	}
+	while (getline(&line, &length, file) != -1) {
+		line[strcspn(line, "\r\n")] = '\0';
+		if (line[0] == '\0') {
+			continue;
+		}
+		game++;
+		if (no_jobs + MAX_BOARD_SIZE * MAX_BOARD_SIZE + 1 > capacity) {
+			if ((bigger = realloc(jobs, 2 * capacity
+					* sizeof(analysis_job_s*))) == NULL) {
+				fprintf(stderr, "Cannot allocate memory for positions\n");
+				break;
+			}
+			jobs = bigger;
+			capacity *= 2;
+		}
+		if (replay_game(line, game, step, playouts, jobs, &no_jobs, capacity)
+				== -1) {
+			fprintf(stderr, "Game %d is not valid, analyzed up to the error\n",
+					game);
+		}
+	}
+	free(line);
+	fclose(file);
+	elapsed = get_monotonic_ms();
+	if ((pool = create_compute_pool(threads, no_jobs)) == NULL) {
+		fprintf(stderr, "Error! Compute pool is not initialized\n");
+		return EXIT_FAILURE;
+	}
+	for (i = 0; i < no_jobs; i++) {
+		submit_compute_job(pool, &jobs[i]->job);
+	}
+	/* the pool runs every queued job before it stops */
+	destroy_compute_pool(pool);
+	elapsed = get_monotonic_ms() - elapsed;
+	for (i = 0; i < no_jobs; i++) {
+		if (jobs[i]->value >= 0) {
+			printf("%d %d %.4f\n", jobs[i]->game, jobs[i]->ply,
+					jobs[i]->value);
+			total += jobs[i]->playouts;
+		}
+		free(jobs[i]);
+	}
+	free(jobs);
+	fprintf(stderr,
+			"%d positions, %ld playouts in %lld ms, %lld playouts/s on %d threads\n",
+			no_jobs, total, elapsed,
+			total * 1000LL / (elapsed > 0 ? elapsed : 1), threads);
+	return EXIT_SUCCESS;
+}
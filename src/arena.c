@@ -0,0 +1,114 @@
+/**
+ * @file arena.c
+ * @ingroup arena
+ *
+ * @author Piotr Janaszek <janas03@yahoo.pl>
+ * @date Created on: Oct 18, 2026
+ *
+ * @brief File containing methods for managing contiguous memory arenas.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "config.h"
+#include "structs.h"
+
+/**
+ * Rounds a size up to the arena alignment.
+ * @param[in] size Number of bytes to be aligned.
+ * @return The smallest multiple of ARENA_ALIGNMENT not less than size.
+ * \sa ARENA_ALIGNMENT
+ */
+size_t
+arena_aligned_size(size_t size) {
+	return (size + ARENA_ALIGNMENT - 1) & ~((size_t) ARENA_ALIGNMENT - 1);
+}
+
+/**
+ * Creates an arena able to hold a given number of bytes. The arena header and
+ * its memory are allocated as a single block, so the whole arena is released by
+ * one call to destroy_arena.
+ * @param[in] size Number of bytes available for allocations.
+ * @return Pointer to the created arena or NULL upon error.
+ * \sa arena_s
+ */
+arena_s*
+create_arena(size_t size) {
+	arena_s *arena = NULL;
+	size_t header = arena_aligned_size(sizeof(arena_s));
+	arena = malloc(header + size);
+	if (arena == NULL) {
+		fprintf(stderr, "Cannot allocate memory for arena\n");
+		return NULL;
+	}
+	arena->base = (char*) arena + header;
+	arena->size = size;
+	arena->used = 0;
+	memset(arena->base, 0, size);
+	return arena;
+}
+
+/**
+ * Carves a block of memory out of an arena. Blocks cannot be freed separately.
+ * @param[in] arena Pointer to the arena to allocate from.
+ * @param[in] size  Number of bytes to allocate.
+ * @return Pointer to zeroed memory or NULL when the arena is exhausted.
+ * \sa arena_s
+ */
+void*
+arena_alloc(arena_s *arena, size_t size) {
+	void *ptr;
+	size = arena_aligned_size(size);
+	if (arena == NULL || size > arena->size - arena->used) {
+		return NULL;
+	}
+	ptr = arena->base + arena->used;
+	arena->used += size;
+	return ptr;
+}
+
+/**
+ * Carves a block starting at a given alignment out of an arena. Up to
+ * alignment - ARENA_ALIGNMENT bytes before the block are skipped, so the
+ * arena has to be created with that much slack.
+ * @param[in] arena     Pointer to the arena.
+ * @param[in] size      Number of bytes to be allocated.
+ * @param[in] alignment Required alignment, a power of two not less than ARENA_ALIGNMENT.
+ * @return Pointer to the allocated memory or NULL when the arena is exhausted.
+ */
+void*
+arena_alloc_aligned(arena_s *arena, size_t size, size_t alignment) {
+	size_t pad;
+	if (arena == NULL) {
+		return NULL;
+	}
+	pad = -(uintptr_t) (arena->base + arena->used) & (alignment - 1);
+	if (pad > arena->size - arena->used) {
+		return NULL;
+	}
+	arena->used += pad;
+	return arena_alloc(arena, size);
+}
+
+/**
+ * Releases everything allocated from an arena at once, so the arena can be
+ * reused. Blocks carved out later are not zeroed again.
+ * @param[in] arena Pointer to the arena.
+ */
+void
+reset_arena(arena_s *arena) {
+	arena->used = 0;
+}
+
+/**
+ * Destroys an arena together with everything that was allocated from it.
+ * @param[in] arena Pointer to the arena to be destroyed.
+ */
+void
+destroy_arena(arena_s *arena) {
+	free(arena);
+}
@@ -0,0 +1,25 @@
+/**
+ * @file arena.h
+ * @ingroup arena
+ *
+ * @author Piotr Janaszek <janas03@yahoo.pl>
+ * @date Created on: Oct 18, 2026
+ *
+ * @brief File containing methods for managing contiguous memory arenas.
+ */
+
+#ifndef ARENA_H_
+#define ARENA_H_
+
+#include <stddef.h>
+
+#include "structs.h"
+
+size_t arena_aligned_size(size_t size);
+arena_s* create_arena(size_t size);
+void* arena_alloc(arena_s *arena, size_t size);
+void* arena_alloc_aligned(arena_s *arena, size_t size, size_t alignment);
+void reset_arena(arena_s *arena);
+void destroy_arena(arena_s *arena);
+
+#endif /* ARENA_H_ */
@@ -6,6 +6,26 @@
  * @date Created on: Aug 13, 2012
  *
  * @brief File containing methods for board manipulating and move checking.
+ *
+ * A board is kept as one bitset per player plus an occupancy bitset. Rows are
+ * laid out one after another with a single guard bit between them, so a line
+ * of pawns in any direction is a run of bits spaced by a constant distance:
+ * 1 horizontally, stride vertically, stride + 1 and stride - 1 on the skews.
+ * Looking for a line on the whole board is then a few shifts and ands of the
+ * player's bitset. After a move only the lines through the new pawn are
+ * checked, since any new line has to pass through it, by a kernel specialized
+ * for the size and the win length of the board.
+ * The text form of a board is only produced when it is sent to a client.
+ *
+ * Every line of win_length fields on the board, a window, has a counter of
+ * pawns per player. A window with no pawns of the opponent is live for a
+ * player, who may still win through it. A move kills the opponent's live
+ * windows going through the moved pawn, so the live counts are kept up to date
+ * in O(win_length) and a game that neither player can win is called a draw
+ * as soon as both counts drop to zero.
+ *
+ * Each board also carries the Zobrist hash of its position, updated with one
+ * xor per move.
  */
 
 #define _GNU_SOURCE
@@ -13,96 +33,189 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "arena.h"
+#include "board_scanner.h"
 #include "config.h"
+#include "move_kernels.h"
 #include "structs.h"
+#include "zobrist.h"
 
 /**
- * Initializes a board by setting all fields to '0'.
- * @param[in] board Pointer to the board to be initialized.
+ * Computes the number of words in each bitset of a board of a given size.
+ * @param[in] size The size of the board.
+ * @return Number of 64-bit words.
  */
-void
-initialize_board(char **board) {
-	int i, j;
-	for (i = 0; i < NROWS; i++)
-		for (j = 0; j < NCOLS; j++)
-			board[i][j] = '0';
+int
+get_board_words(int size) {
+	return (size * (size + 1) + 63) / 64;
 }
 
 /**
- * Prepares a board by setting fields to '1' on a given size.
- * @param[in] board Pointer to the board to be prepared.
- * @param[in] size  Size of the board to be prepared.
+ * Computes the number of windows, i.e. lines of win_length fields, on a board.
+ * @param[in] size       The size of the board.
+ * @param[in] win_length Number of consecutive pawns needed to win.
+ * @return Number of windows in all four directions.
  */
-void
-prepare_board(char **board, int size) {
-	int i, j;
-	for (i = 0; i < size; i++)
-		for (j = 0; j < size; j++)
-			board[i][j] = '1';
+int
+get_board_windows(int size, int win_length) {
+	int starts = size - win_length + 1;
+	if (starts <= 0) {
+		return 0;
+	}
+	return 2 * size * starts + 2 * starts * starts;
 }
 
 /**
- * Creates new board of a given size.
- * @param[in] size The size of the board to be created.
- * @return Pointer to the created board.
+ * Computes the number of bytes of a board together with its bitsets and
+ * window counters.
+ * @param[in] size       The size of the board.
+ * @param[in] win_length Number of consecutive pawns needed to win.
+ * @return Number of bytes of the board block.
  */
-char**
-create_new_board(int size) {
-	int i;
-	char **board = (char**) malloc(NROWS * sizeof(char*));
-	if (board == NULL) {
+size_t
+get_board_bytes(int size, int win_length) {
+	return sizeof(board_s)
+			+ BOARD_BITS_NO * get_board_words(size) * sizeof(uint64_t)
+			+ 2 * get_board_windows(size, win_length) * sizeof(unsigned char);
+}
+
+/**
+ * Computes the number of arena bytes needed by a board of a given size,
+ * including the slack needed to align the board to a cache line.
+ * @param[in] size       The size of the board to be created.
+ * @param[in] win_length Number of consecutive pawns needed to win.
+ * @return Number of bytes to reserve in the arena for the board.
+ * \sa create_new_board
+ */
+size_t
+get_board_arena_size(int size, int win_length) {
+	return CACHE_LINE_SIZE - ARENA_ALIGNMENT
+			+ arena_aligned_size(get_board_bytes(size, win_length));
+}
+
+/**
+ * Creates new empty board of a given size in the arena, so the board is
+ * released together with the arena. The board and its bitsets are one
+ * cache-line-aligned block sized to the board.
+ * @param[in] arena      Pointer to the arena the board is allocated from.
+ * @param[in] size       The size of the board to be created.
+ * @param[in] win_length Number of consecutive pawns needed to win.
+ * @return Pointer to the created board or NULL upon error.
+ * \sa get_board_arena_size board_s
+ */
+board_s*
+create_new_board(arena_s *arena, int size, int win_length) {
+	board_s *board;
+	size_t bytes;
+	move_kernel_f kernel;
+	if ((kernel = get_move_kernel(size, win_length)) == NULL) {
 		return NULL;
 	}
-	for (i = 0; i < NROWS; i++) {
-		board[i] = (char*) malloc(NCOLS * sizeof(char));
-		if (board[i] == NULL) {
-			return NULL;
-		}
+	init_zobrist_keys();
+	bytes = get_board_bytes(size, win_length);
+	board = (board_s*) arena_alloc_aligned(arena, bytes, CACHE_LINE_SIZE);
+	if (board == NULL) {
+		return NULL;
 	}
-	initialize_board(board);
-	prepare_board(board, size);
+	memset(board, 0, bytes);
+	board->size = size;
+	board->stride = size + 1;
+	board->win_length = win_length;
+	board->words = get_board_words(size);
+	board->windows = get_board_windows(size, win_length);
+	board->live[0] = board->live[1] = board->windows;
+	board->check_move = kernel;
 	return board;
 }
 
 /**
- * Destroys a board by freeing all the pointers.
- * @param[in] board Pointer to the board to be destroyed.
+ * Gets one of the bitsets of a board.
+ * @param[in] board Pointer to the board.
+ * @param[in] which The bitset to be returned.
+ * @return Pointer to the first word of the bitset.
+ * \sa board_bits_e
  */
-void
-destroy_board(char **board) {
-	int i;
-	for (i = 0; i < NROWS; i++)
-		free(board[i]);
-	free(board);
+uint64_t*
+get_board_bits(board_s *board, board_bits_e which) {
+	return board->bits + which * board->words;
 }
 
 /**
- * Checks the size of a given board.
- * @param[in] board Pointer to the board which size needs to be checked.
- * @return The size of the board i.e. the value for which the board was prepared.
- * \sa prepare_board
+ * Gets the index of a player owning a given pawn.
+ * @param[in] pawn Pawn of a player.
+ * @return BOARD_BITS_X for 'x', BOARD_BITS_O for 'o' and -1 for any other character.
  */
 int
-get_board_size(char **board) {
-	int i, j, rows, cols;
-	rows = cols = 0;
-	if (board == NULL) {
-		return -1;
+get_pawn_index(char pawn) {
+	if (pawn == 'x') {
+		return BOARD_BITS_X;
+	}
+	if (pawn == 'o') {
+		return BOARD_BITS_O;
 	}
-	for (i = 0; i < NROWS; i++) {
-		if (board[i][0] == '1' || board[i][0] == 'x' || board[i][0] == 'o') {
-			rows++;
+	return -1;
+}
+
+/**
+ * Checks whether a given bit is set in a bitset.
+ * @param[in] bits Pointer to the bitset.
+ * @param[in] bit  Index of the bit.
+ * @return Non-zero value when the bit is set.
+ */
+int
+test_bit(const uint64_t *bits, int bit) {
+	return (bits[bit / 64] >> (bit % 64)) & 1;
+}
+
+/**
+ * Shifts a bitset towards lower bit indices, filling vacated bits with zeros.
+ * @param[out] dst   Pointer to the shifted bitset.
+ * @param[in]  src   Pointer to the bitset to be shifted.
+ * @param[in]  shift Number of bits to shift by.
+ * @param[in]  words Number of words in both bitsets.
+ */
+void
+shift_bits_down(uint64_t *dst, const uint64_t *src, int shift, int words) {
+	int i, q = shift / 64, r = shift % 64;
+	for (i = 0; i < words; i++) {
+		dst[i] = 0;
+		if (i + q < words) {
+			dst[i] = src[i + q] >> r;
+		}
+		if (r != 0 && i + q + 1 < words) {
+			dst[i] |= src[i + q + 1] << (64 - r);
 		}
 	}
-	for (j = 0; j < NCOLS; j++) {
-		if (board[0][j] == '1' || board[0][j] == 'x' || board[0][j] == 'o') {
-			cols++;
+}
+
+/**
+ * Checks whether a bitset holds a number of set bits spaced by a given distance.
+ * Every step ands the bitset with a shifted copy of itself, doubling the length
+ * of the runs it keeps track of, so only a logarithmic number of steps is done.
+ * @param[in] bits       Pointer to the bitset of a player.
+ * @param[in] distance   Distance in bits between consecutive fields of a line.
+ * @param[in] words      Number of words in the bitset.
+ * @param[in] win_length Number of set bits in a line.
+ * @retval  0 When a line is found.
+ * @retval -1 When a line is not found.
+ */
+int
+check_line(const uint64_t *bits, int distance, int words, int win_length) {
+	int i, length = 1, step, found = 0;
+	uint64_t runs[BOARD_WORDS], shifted[BOARD_WORDS];
+	memcpy(runs, bits, words * sizeof(uint64_t));
+	while (length < win_length) {
+		step = length * 2 <= win_length ? length : win_length - length;
+		shift_bits_down(shifted, runs, step * distance, words);
+		for (i = 0; i < words; i++) {
+			runs[i] &= shifted[i];
 		}
+		length += step;
 	}
-	if (rows == cols) {
-		return rows;
+	for (i = 0; i < words; i++) {
+		found |= runs[i] != 0;
 	}
-	return -1;
+	return found ? 0 : -1;
 }
 
 /**
@@ -114,192 +227,219 @@ get_board_size(char **board) {
  * \sa move_s
  */
 int
-validate_move(char **board, move_s *move) {
-	if (board[move->x][move->y] == 'x') {
+validate_move(board_s *board, move_s *move) {
+	if (move->x < 0 || move->y < 0 || move->x >= board->size
+			|| move->y >= board->size) {
 		return -1;
 	}
-	if (board[move->x][move->y] == 'o') {
+	if (get_pawn_index(move->pawn) == -1) {
 		return -1;
 	}
-	if (board[move->x][move->y] == '1') {
-		return 0;
-	}
-	if (board[move->x][move->y] == '0') {
+	if (test_bit(get_board_bits(board, BOARD_BITS_OCCUPIED),
+			move->x * board->stride + move->y)) {
 		return -1;
 	}
-	return -1;
+	return 0;
 }
 
 /**
- * Checks whether a four consecutive pawns can be found in any horizontal row.
- * Then the game wins the player that makes current move.
- * @param[in] board Pointer to the board that a will be check against four consecutive pawns in a row.
- * @param[in] size  Size of the board to be checked.
+ * Checks whether a player has a winning line of pawns in any row, column
+ * or skew row of a board.
+ * @param[in] board Pointer to the board to be checked.
  * @param[in] pawn  Pawn of a player that currently makes a move.
- * @retval  0 When a four consecutive pawns are find in a row.
- * @retval -1 When a four consecutive pawns are not found.
+ * @retval  0 When a line of pawns is found.
+ * @retval -1 When a line of pawns is not found.
  */
 int
-check_board_horizontally(char **board, int size, char pawn) {
-	int row, col, count = 0;
-	for (row = 0; row < size; row++) {
-		for (col = 0; col < size; col++) {
-			if (board[row][col] == pawn) {
-				count++;
-				if (count == 4) {
-					return 0;
-				}
-			} else {
-				count = 0;
-			}
-		}
-		count = 0;
+check_board(board_s *board, char pawn) {
+	int words = board->words, length = board->win_length;
+	const uint64_t *bits = get_board_bits(board, get_pawn_index(pawn));
+	if (check_line(bits, 1, words, length) == 0) {
+		return 0;
+	}
+	if (check_line(bits, board->stride, words, length) == 0) {
+		return 0;
+	}
+	if (check_line(bits, board->stride + 1, words, length) == 0) {
+		return 0;
+	}
+	if (check_line(bits, board->stride - 1, words, length) == 0) {
+		return 0;
 	}
 	return -1;
 }
 
 /**
- * Checks whether a four consecutive pawns can be found in any vertical row.
- * Then the game wins the player that makes current move.
- * @param[in] board Pointer to the board that a will be check against four consecutive pawns in a row.
- * @param[in] size  Size of the board to be checked.
- * @param[in] pawn  Pawn of a player that currently makes a move.
- * @retval  0 When a four consecutive pawns are find in a row.
- * @retval -1 When a four consecutive pawns are not found.
+ * Gets the index of a window starting at a given field.
+ * @param[in] board     Pointer to the board.
+ * @param[in] direction Direction of the window: 0 horizontal, 1 vertical,
+ *                      2 skew right and 3 skew left.
+ * @param[in] x         The x coordinate of the first field of the window.
+ * @param[in] y         The y coordinate of the first field of the window.
+ * @return Index of the window or -1 when the window does not fit the board.
  */
 int
-check_board_vertically(char **board, int size, char pawn) {
-	int row, col, count = 0;
-	for (col = 0; col < size; col++) {
-		for (row = 0; row < size; row++) {
-			if (board[row][col] == pawn) {
-				count++;
-				if (count == 4) {
-					return 0;
-				}
-			} else {
-				count = 0;
+get_window_index(board_s *board, int direction, int x, int y) {
+	const int dx[4] = { 0, 1, 1, 1 };
+	const int dy[4] = { 1, 0, 1, -1 };
+	int n = board->size, starts = board->size - board->win_length + 1;
+	int ex = x + (board->win_length - 1) * dx[direction];
+	int ey = y + (board->win_length - 1) * dy[direction];
+	if (x < 0 || y < 0 || x >= n || y >= n || ex < 0 || ey < 0 || ex >= n
+			|| ey >= n) {
+		return -1;
+	}
+	switch (direction) {
+	case 0:
+		return x * starts + y;
+	case 1:
+		return n * starts + x * n + y;
+	case 2:
+		return 2 * n * starts + x * starts + y;
+	default:
+		return 2 * n * starts + starts * starts + x * starts
+				+ (y - board->win_length + 1);
+	}
+}
+
+/**
+ * Counts a move in every window going through it and updates the numbers of
+ * windows still live for both players.
+ * @param[in] board Pointer to the board the move was performed on.
+ * @param[in] move  Structure containing coordinates of a move and a player's pawn.
+ * \sa board_s
+ */
+void
+update_live_windows(board_s *board, move_s *move) {
+	int i, d, w, player = get_pawn_index(move->pawn);
+	const int dx[4] = { 0, 1, 1, 1 };
+	const int dy[4] = { 1, 0, 1, -1 };
+	unsigned char *pawns = (unsigned char*) get_board_bits(board,
+			BOARD_BITS_NO) + player * board->windows;
+	for (d = 0; d < 4; d++) {
+		for (i = 0; i < board->win_length; i++) {
+			w = get_window_index(board, d, move->x - i * dx[d],
+					move->y - i * dy[d]);
+			if (w == -1) {
+				continue;
+			}
+			if (pawns[w]++ == 0) {
+				board->live[1 - player]--;
 			}
 		}
-		count = 0;
 	}
-	return -1;
 }
 
 /**
- * Checks whether a four consecutive pawns can be found in any skew right row in the lower part of a board.
- * Then the game wins the player that makes current move.
- * @param[in] board Pointer to the board that a will be check against four consecutive pawns in a row.
- * @param[in] size  Size of the board to be checked.
- * @param[in] pawn  Pawn of a player that currently makes a move.
- * @retval  0 When a four consecutive pawns are find in a row.
- * @retval -1 When a four consecutive pawns are not found.
+ * Gets the character representing a field of a board.
+ * @param[in] board Pointer to the board.
+ * @param[in] x     The x coordinate of the field.
+ * @param[in] y     The y coordinate of the field.
+ * @return The pawn taking the field or '1' when the field is empty.
  */
-int
-check_board_skew_right_down(char **board, int size, char pawn) {
-	int row, col, tmp_row, count = 0;
-	for (row = 0; row < size; row++) {
-		tmp_row = row;
-		for (col = 0; col < size && tmp_row < size; col++, tmp_row++) {
-			if (board[tmp_row][col] == pawn) {
-				count++;
-				if (count == 4) {
-					return 0;
-				}
-			} else {
-				count = 0;
-			}
+char
+get_field(board_s *board, int x, int y) {
+	int bit = x * board->stride + y;
+	if (test_bit(get_board_bits(board, BOARD_BITS_X), bit)) {
+		return 'x';
+	}
+	if (test_bit(get_board_bits(board, BOARD_BITS_O), bit)) {
+		return 'o';
+	}
+	return '1';
+}
+
+/**
+ * Encodes a board as text understood by clients: NROWS x NCOLS characters,
+ * '0' for fields outside the board, '1' for empty fields and players' pawns.
+ * @param[in]  board  Pointer to the board to be encoded.
+ * @param[out] buffer Buffer of at least NROWS * NCOLS + 1 characters.
+ * @return Pointer to the null-terminated text held in the buffer.
+ * \sa board_from_string
+ */
+char*
+board_to_string(board_s *board, char *buffer) {
+	int i, j;
+	memset(buffer, '0', NROWS * NCOLS);
+	buffer[NROWS * NCOLS] = '\0';
+	for (i = 0; i < board->size; i++) {
+		for (j = 0; j < board->size; j++) {
+			buffer[i * NCOLS + j] = get_field(board, i, j);
 		}
-		count = 0;
 	}
-	return -1;
+	return buffer;
 }
 
 /**
- * Checks whether a four consecutive pawns can be found in any skew right row in the upper part of a board.
- * Then the game wins the player that makes current move.
- * @param[in] board Pointer to the board that a will be check against four consecutive pawns in a row.
- * @param[in] size  Size of the board to be checked.
- * @param[in] pawn  Pawn of a player that currently makes a move.
- * @retval  0 When a four consecutive pawns are find in a row.
- * @retval -1 When a four consecutive pawns are not found.
+ * Computes the Zobrist hash of a board from scratch.
+ * @param[in] board Pointer to the board.
+ * @return The xor of the keys of all the pawns on the board.
+ * \sa get_zobrist_key
  */
-int
-check_board_skew_right_up(char **board, int size, char pawn) {
-	int row, col, tmp_col, count = 0;
-	for (col = 0; col < size; col++) {
-		tmp_col = col;
-		for (row = 0; row < size && tmp_col < size; row++, tmp_col++) {
-			if (board[row][tmp_col] == pawn) {
-				count++;
-				if (count == 4) {
-					return 0;
-				}
-			} else {
-				count = 0;
+uint64_t
+hash_board(board_s *board) {
+	int i, j;
+	char field;
+	uint64_t hash = 0;
+	for (i = 0; i < board->size; i++) {
+		for (j = 0; j < board->size; j++) {
+			if ((field = get_field(board, i, j)) != '1') {
+				hash ^= get_zobrist_key(board->size, i, j, field);
 			}
 		}
-		count = 0;
 	}
-	return -1;
+	return hash;
 }
 
 /**
- * Checks whether a four consecutive pawns can be found in any skew left row in the lower part of a board.
- * Then the game wins the player that makes current move.
- * @param[in] board Pointer to the board that a will be check against four consecutive pawns in a row.
- * @param[in] size  Size of the board to be checked.
- * @param[in] pawn  Pawn of a player that currently makes a move.
- * @retval  0 When a four consecutive pawns are find in a row.
- * @retval -1 When a four consecutive pawns are not found.
+ * Creates a board from its text encoding.
+ * @param[in] arena Pointer to the arena the board is allocated from.
+ * @param[in] size  The size of the board.
+ * @param[in] text  Text of NROWS x NCOLS characters.
+ * @return Pointer to the created board or NULL upon error.
+ * \sa board_to_string
  */
-int
-check_board_skew_left_down(char **board, int size, char pawn) {
-	int row, col, tmp_col, count = 0;
-	for (col = 0; col < size; col++) {
-		tmp_col = col;
-		for (row = size - 1; row >= 0 && tmp_col < size; row--, tmp_col++) {
-			if (board[row][tmp_col] == pawn) {
-				count++;
-				if (count == 4) {
-					return 0;
-				}
-			} else {
-				count = 0;
+board_s*
+board_from_string(arena_s *arena, int size, const char *text) {
+	int i, j, bit, pawn;
+	board_s *board;
+	if (text == NULL || strlen(text) < NROWS * NCOLS) {
+		return NULL;
+	}
+	if ((board = create_new_board(arena, size, WIN_LENGTH)) == NULL) {
+		return NULL;
+	}
+	for (i = 0; i < size; i++) {
+		for (j = 0; j < size; j++) {
+			if ((pawn = get_pawn_index(text[i * NCOLS + j])) == -1) {
+				continue;
 			}
+			bit = i * board->stride + j;
+			get_board_bits(board, pawn)[bit / 64] |= (uint64_t) 1 << (bit % 64);
+			get_board_bits(board, BOARD_BITS_OCCUPIED)[bit / 64] |=
+					(uint64_t) 1 << (bit % 64);
 		}
-		count = 0;
 	}
-	return -1;
+	board->hash = hash_board(board);
+	return board;
 }
 
 /**
- * Checks whether a four consecutive pawns can be found in any skew left row in the upper part of a board.
- * Then the game wins the player that makes current move.
- * @param[in] board Pointer to the board that a will be check against four consecutive pawns in a row.
- * @param[in] size  Size of the board to be checked.
- * @param[in] pawn  Pawn of a player that currently makes a move.
- * @retval  0 When a four consecutive pawns are find in a row.
- * @retval -1 When a four consecutive pawns are not found.
+ * Finds the field a pawn dropped into a column of a gravity game falls to.
+ * Columns fill up from the last row, so the field follows from the number of
+ * pawns already in the column without looking at the board.
+ * @param[in] heights Number of pawns in every column.
+ * @param[in] size    Size of the board.
+ * @param[in] column  The column the pawn is dropped into.
+ * @return The x coordinate of the field or -1 when the column does not exist
+ * or is full.
  */
 int
-check_board_skew_left_up(char **board, int size, char pawn) {
-	int row, col, tmp_row, count = 0;
-	for (row = size - 1; row >= 0; row--) {
-		tmp_row = row;
-		for (col = 0; col < size && tmp_row >= 0; col++, tmp_row--) {
-			if (board[tmp_row][col] == pawn) {
-				count++;
-				if (count == 4) {
-					return 0;
-				}
-			} else {
-				count = 0;
-			}
-		}
-		count = 0;
+get_drop_row(const int *heights, int size, int column) {
+	if (column < 0 || column >= size || heights[column] >= size) {
+		return -1;
 	}
-	return -1;
+	return size - 1 - heights[column];
 }
 
 /**
@@ -309,43 +449,43 @@ check_board_skew_left_up(char **board, int size, char pawn) {
  * @param[in] free  Pointer showing how many free places left on the board.
  * @retval  0 When a move is performed and a game is not finished.
  * @retval  1 When a move is performed and current player wins the game.
+ * @retval  2 When a move is performed and neither player can win any more.
  * @retval -1 When current move cannot be performed i.e. is out of range.
  * \sa move_s
  */
 int
-make_move(char **board, move_s *move, int *free) {
-	int size, result = 0;
-	if ((size = get_board_size(board)) == -1) {
+make_move(board_s *board, move_s *move, int *free) {
+	int bit, result;
+	uint64_t mask;
+	if (board == NULL || validate_move(board, move) != 0) {
 		return -1;
 	}
-	if (move->x > size || move->y > size || move->x < 0 || move->y < 0) {
-		return -1;
-	}
-	if (validate_move(board, move) != 0) {
-		return -1;
-	}
-	board[move->x][move->y] = move->pawn;
+	bit = move->x * board->stride + move->y;
+	mask = (uint64_t) 1 << (bit % 64);
+	get_board_bits(board, get_pawn_index(move->pawn))[bit / 64] |= mask;
+	get_board_bits(board, BOARD_BITS_OCCUPIED)[bit / 64] |= mask;
+	board->hash ^= get_zobrist_key(board->size, move->x, move->y, move->pawn);
 	(*free)--;
-	if (*free <= 0) {
-		return 2;
-	}
-	if ((result = check_board_horizontally(board, size, move->pawn)) == 0) {
-		return 1;
+	result = board->check_move(board, move);
+#ifdef DEBUG
+	if (result != check_board(board, move->pawn)
+			|| result != scan_board(board, move->pawn)) {
+		fprintf(stderr, "Win check mismatch after move %d %d on board %d\n",
+				move->x, move->y, board->size);
+		abort();
 	}
-	if ((result = check_board_vertically(board, size, move->pawn)) == 0) {
-		return 1;
-	}
-	if ((result = check_board_skew_right_down(board, size, move->pawn)) == 0) {
-		return 1;
+	if (board->hash != hash_board(board)) {
+		fprintf(stderr, "Hash mismatch after move %d %d on board %d\n",
+				move->x, move->y, board->size);
+		abort();
 	}
-	if ((result = check_board_skew_right_up(board, size, move->pawn)) == 0) {
+#endif
+	if (result == 0) {
 		return 1;
 	}
-	if ((result = check_board_skew_left_down(board, size, move->pawn)) == 0) {
-		return 1;
-	}
-	if ((result = check_board_skew_left_up(board, size, move->pawn)) == 0) {
-		return 1;
+	update_live_windows(board, move);
+	if (*free <= 0 || (board->live[0] == 0 && board->live[1] == 0)) {
+		return 2;
 	}
 	return 0;
 }
@@ -11,11 +11,18 @@
 #ifndef BOARD_HANDLER_H_
 #define BOARD_HANDLER_H_
 
+#include <stddef.h>
+
 #include "structs.h"
 
-char** create_new_board(int size);
-void destroy_board(char **board);
-int get_board_size(char **board);
-int make_move(char **board, move_s *move, int *free);
+size_t get_board_arena_size(int size, int win_length);
+board_s* create_new_board(arena_s *arena, int size, int win_length);
+uint64_t* get_board_bits(board_s *board, board_bits_e which);
+char get_field(board_s *board, int x, int y);
+uint64_t hash_board(board_s *board);
+char* board_to_string(board_s *board, char *buffer);
+board_s* board_from_string(arena_s *arena, int size, const char *text);
+int get_drop_row(const int *heights, int size, int column);
+int make_move(board_s *board, move_s *move, int *free);
 
 #endif /* BOARD_HANDLER_H_ */
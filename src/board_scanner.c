@@ -0,0 +1,249 @@
+/**
+ * @file board_scanner.c
+ * @ingroup board_scanner
+ *
+ * @author Piotr Janaszek <janas03@yahoo.pl>
+ * @date Created on: Oct 18, 2026
+ *
+ * @brief File containing vectorized methods for checking a whole board against lines of pawns.
+ *
+ * A scanner grid holds one byte per field, non-zero where a player has a pawn,
+ * in GRID_ROWS rows of GRID_STRIDE bytes. The board occupies the top left
+ * corner and everything else is zero padding. A line of K pawns starting at
+ * byte p is found by anding the bytes p + base + k * step for k from 0 to
+ * K - 1, where step is 1 horizontally, GRID_STRIDE vertically and
+ * GRID_STRIDE +/- 1 on the skews, and base is K - 1 for the skew going left. The padding keeps every read
+ * inside the grid and makes lines leaving the board come out as zero, so the
+ * kernels below only differ in how many bytes they and at once: 16 with SSE2,
+ * 32 with AVX2 and 64 with AVX-512. The widest kernel supported by the CPU
+ * is chosen once at runtime and the scalar one is used elsewhere.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SCANNER_X86
+#endif
+
+#include "board_handler.h"
+#include "config.h"
+#include "structs.h"
+
+/**
+ * Number of bytes of a scanner grid at which a line may start.
+ */
+#define SCAN_BYTES (MAX_BOARD_SIZE * GRID_STRIDE)
+
+/**
+ * Distance in bytes between consecutive fields of a line, one entry per direction.
+ */
+static const int line_step[4] = { 1, GRID_STRIDE, GRID_STRIDE + 1,
+		GRID_STRIDE - 1 };
+
+/**
+ * Kernel chosen for the running CPU.
+ */
+static int (*scan_kernel)(const unsigned char *grid, int win_length);
+
+/**
+ * Guards the choice of the kernel.
+ */
+static pthread_once_t scan_kernel_once = PTHREAD_ONCE_INIT;
+
+/**
+ * Fills a scanner grid with pawns of a player.
+ * @param[in]  board Pointer to the board.
+ * @param[in]  pawn  Pawn of the player.
+ * @param[out] grid  Buffer of GRID_ROWS * GRID_STRIDE bytes.
+ */
+void
+board_to_grid(board_s *board, char pawn, unsigned char *grid) {
+	int i, j, bit;
+	const uint64_t *bits = get_board_bits(board,
+			pawn == 'x' ? BOARD_BITS_X : BOARD_BITS_O);
+	memset(grid, 0, GRID_ROWS * GRID_STRIDE);
+	for (i = 0; i < board->size; i++) {
+		for (j = 0; j < board->size; j++) {
+			bit = i * board->stride + j;
+			grid[i * GRID_STRIDE + j] = (bits[bit / 64] >> (bit % 64)) & 1;
+		}
+	}
+}
+
+/**
+ * Checks a scanner grid one byte at a time.
+ * @param[in] grid       Pointer to the scanner grid.
+ * @param[in] win_length Number of consecutive pawns in a line.
+ * @retval  0 When a line of pawns is found.
+ * @retval -1 When a line of pawns is not found.
+ */
+int
+scan_grid_scalar(const unsigned char *grid, int win_length) {
+	int d, k, p, base;
+	unsigned char run;
+	for (d = 0; d < 4; d++) {
+		base = d == 3 ? win_length - 1 : 0;
+		for (p = 0; p < SCAN_BYTES; p++) {
+			run = 1;
+			for (k = 0; k < win_length && run; k++) {
+				run &= grid[p + base + k * line_step[d]];
+			}
+			if (run) {
+				return 0;
+			}
+		}
+	}
+	return -1;
+}
+
+#ifdef SCANNER_X86
+
+/**
+ * Checks a scanner grid 16 bytes at a time.
+ * @param[in] grid       Pointer to the scanner grid.
+ * @param[in] win_length Number of consecutive pawns in a line.
+ * @retval  0 When a line of pawns is found.
+ * @retval -1 When a line of pawns is not found.
+ */
+__attribute__((target("sse2")))
+int
+scan_grid_sse2(const unsigned char *grid, int win_length) {
+	int d, k, p, base;
+	__m128i run;
+	for (d = 0; d < 4; d++) {
+		base = d == 3 ? win_length - 1 : 0;
+		for (p = 0; p < SCAN_BYTES; p += 16) {
+			run = _mm_loadu_si128((const __m128i*) (grid + p + base));
+			for (k = 1; k < win_length; k++) {
+				run = _mm_and_si128(run,
+						_mm_loadu_si128((const __m128i*) (grid + p
+								+ base + k * line_step[d])));
+			}
+			if (_mm_movemask_epi8(_mm_cmpeq_epi8(run, _mm_setzero_si128()))
+					!= 0xFFFF) {
+				return 0;
+			}
+		}
+	}
+	return -1;
+}
+
+/**
+ * Checks a scanner grid 32 bytes, i.e. one row, at a time.
+ * @param[in] grid       Pointer to the scanner grid.
+ * @param[in] win_length Number of consecutive pawns in a line.
+ * @retval  0 When a line of pawns is found.
+ * @retval -1 When a line of pawns is not found.
+ */
+__attribute__((target("avx2")))
+int
+scan_grid_avx2(const unsigned char *grid, int win_length) {
+	int d, k, p, base;
+	__m256i run;
+	for (d = 0; d < 4; d++) {
+		base = d == 3 ? win_length - 1 : 0;
+		for (p = 0; p < SCAN_BYTES; p += 32) {
+			run = _mm256_loadu_si256((const __m256i*) (grid + p + base));
+			for (k = 1; k < win_length; k++) {
+				run = _mm256_and_si256(run,
+						_mm256_loadu_si256((const __m256i*) (grid + p
+								+ base + k * line_step[d])));
+			}
+			if (!_mm256_testz_si256(run, run)) {
+				return 0;
+			}
+		}
+	}
+	return -1;
+}
+
+/**
+ * Checks a scanner grid 64 bytes, i.e. two rows, at a time.
+ * @param[in] grid       Pointer to the scanner grid.
+ * @param[in] win_length Number of consecutive pawns in a line.
+ * @retval  0 When a line of pawns is found.
+ * @retval -1 When a line of pawns is not found.
+ */
+__attribute__((target("avx512f")))
+int
+scan_grid_avx512(const unsigned char *grid, int win_length) {
+	int d, k, p, base;
+	__m512i run;
+	for (d = 0; d < 4; d++) {
+		base = d == 3 ? win_length - 1 : 0;
+		for (p = 0; p < SCAN_BYTES; p += 64) {
+			run = _mm512_loadu_si512((const void*) (grid + p + base));
+			for (k = 1; k < win_length; k++) {
+				run = _mm512_and_si512(run,
+						_mm512_loadu_si512((const void*) (grid + p
+								+ base + k * line_step[d])));
+			}
+			if (_mm512_test_epi64_mask(run, run) != 0) {
+				return 0;
+			}
+		}
+	}
+	return -1;
+}
+
+#endif
+
+/**
+ * Chooses the widest kernel supported by the running CPU.
+ */
+void
+choose_scan_kernel(void) {
+	scan_kernel = scan_grid_scalar;
+#ifdef SCANNER_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx512f")) {
+		scan_kernel = scan_grid_avx512;
+	} else if (__builtin_cpu_supports("avx2")) {
+		scan_kernel = scan_grid_avx2;
+	} else if (__builtin_cpu_supports("sse2")) {
+		scan_kernel = scan_grid_sse2;
+	}
+#endif
+}
+
+/**
+ * Checks whether a scanner grid holds a line of pawns.
+ * @param[in] grid       Pointer to the scanner grid.
+ * @param[in] win_length Number of consecutive pawns in a line.
+ * @retval  0 When a line of pawns is found.
+ * @retval -1 When a line of pawns is not found.
+ * \sa board_to_grid
+ */
+int
+scan_grid(const unsigned char *grid, int win_length) {
+	pthread_once(&scan_kernel_once, choose_scan_kernel);
+	return scan_kernel(grid, win_length);
+}
+
+/**
+ * Checks whether a player has a winning line of pawns anywhere on a board.
+ * @param[in] board Pointer to the board to be checked.
+ * @param[in] pawn  Pawn of the player.
+ * @retval  0 When a line of pawns is found.
+ * @retval -1 When a line of pawns is not found.
+ */
+int
+scan_board(board_s *board, char pawn) {
+	unsigned char grid[GRID_ROWS * GRID_STRIDE] __attribute__((aligned(64)));
+	int result;
+	board_to_grid(board, pawn, grid);
+	result = scan_grid(grid, board->win_length);
+#ifdef DEBUG
+	if (result != scan_grid_scalar(grid, board->win_length)) {
+		fprintf(stderr, "Vector and scalar scanners disagree on board %d\n",
+				board->size);
+		abort();
+	}
+#endif
+	return result;
+}
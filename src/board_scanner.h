@@ -0,0 +1,21 @@
+/**
+ * @file board_scanner.h
+ * @ingroup board_scanner
+ *
+ * @author Piotr Janaszek <janas03@yahoo.pl>
+ * @date Created on: Oct 18, 2026
+ *
+ * @brief File containing vectorized methods for checking a whole board against lines of pawns.
+ */
+
+#ifndef BOARD_SCANNER_H_
+#define BOARD_SCANNER_H_
+
+#include "structs.h"
+
+void board_to_grid(board_s *board, char pawn, unsigned char *grid);
+int scan_grid(const unsigned char *grid, int win_length);
+int scan_grid_scalar(const unsigned char *grid, int win_length);
+int scan_board(board_s *board, char pawn);
+
+#endif /* BOARD_SCANNER_H_ */
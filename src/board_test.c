@@ -0,0 +1,371 @@
+/**
+ * @file board_test.c
+ * @ingroup board_test
+ *
+ * @author Piotr Janaszek <janas03@yahoo.pl>
+ * @date Created on: Oct 18, 2026
+ *
+ * @brief File containing a differential test of the win checks of the board.
+ *
+ * Every case is a position held in a plain grid of characters and a move
+ * played on it. The position is copied into a board and the move is played
+ * with make_move, so the specialized kernel of the size and win length
+ * checks it. The result is compared with a reference scanner walking the
+ * grid one field at a time, and so are the whole board checks: scan_board
+ * with the kernel chosen for the CPU and scan_grid_scalar. Boards whose
+ * fields fit EXHAUSTIVE_FIELDS are checked for every placement of pawns,
+ * with the remaining fields either empty or taken by the opponent. Larger
+ * boards are checked with lines one field shorter, equal and one field
+ * longer than the win length in every direction and at every offset, with
+ * the move on each of their fields, and with RANDOM_CASES random positions
+ * of random density. Mismatches are printed and make the test fail.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "arena.h"
+#include "board_handler.h"
+#include "board_scanner.h"
+#include "config.h"
+#include "structs.h"
+
+/**
+ * Largest number of fields of a board checked for every placement of pawns.
+ */
+#define EXHAUSTIVE_FIELDS 16
+
+/**
+ * Number of random positions checked for every board size and win length.
+ */
+#define RANDOM_CASES 2000
+
+/**
+ * Number of mismatches printed before the rest are only counted.
+ */
+#define MAX_REPORTED 10
+
+/**
+ * Number of cases checked.
+ */
+static long cases;
+
+/**
+ * Number of cases with a mismatch.
+ */
+static long failures;
+
+/**
+ * State of the pseudo random generator, fixed so that runs are repeatable.
+ */
+static uint64_t random_state = 0x9E3779B97F4A7C15ULL;
+
+/**
+ * Gets the next pseudo random number.
+ * @param[in] range Number of possible values.
+ * @return Number from 0 to range - 1.
+ */
+int
+next_random(int range) {
+	random_state ^= random_state << 13;
+	random_state ^= random_state >> 7;
+	random_state ^= random_state << 17;
+	return (int) ((random_state >> 11) % range);
+}
+
+/**
+ * Counts pawns of a player in a line going through a field in both directions.
+ * @param[in] grid Fields of the board, row by row, '1' for an empty field.
+ * @param[in] size Size of the board.
+ * @param[in] x    The x coordinate of the field.
+ * @param[in] y    The y coordinate of the field.
+ * @param[in] dx   Step of the line along x.
+ * @param[in] dy   Step of the line along y.
+ * @return Length of the line of pawns or 0 when the field has no pawn.
+ */
+int
+count_line(const char *grid, int size, int x, int y, int dx, int dy) {
+	int i, j, length = 0;
+	char pawn = grid[x * size + y];
+	if (pawn == '1') {
+		return 0;
+	}
+	for (i = x, j = y; i >= 0 && j >= 0 && i < size && j < size
+			&& grid[i * size + j] == pawn; i -= dx, j -= dy) {
+		length++;
+	}
+	for (i = x + dx, j = y + dy; i >= 0 && j >= 0 && i < size && j < size
+			&& grid[i * size + j] == pawn; i += dx, j += dy) {
+		length++;
+	}
+	return length;
+}
+
+/**
+ * Checks with the reference scanner whether a field is part of a winning line.
+ * @param[in] grid       Fields of the board, row by row.
+ * @param[in] size       Size of the board.
+ * @param[in] win_length Number of consecutive pawns needed to win.
+ * @param[in] x          The x coordinate of the field.
+ * @param[in] y          The y coordinate of the field.
+ * @retval  0 When a line of pawns is found.
+ * @retval -1 When a line of pawns is not found.
+ */
+int
+reference_check_move(const char *grid, int size, int win_length, int x, int y) {
+	if (count_line(grid, size, x, y, 0, 1) >= win_length
+			|| count_line(grid, size, x, y, 1, 0) >= win_length
+			|| count_line(grid, size, x, y, 1, 1) >= win_length
+			|| count_line(grid, size, x, y, 1, -1) >= win_length) {
+		return 0;
+	}
+	return -1;
+}
+
+/**
+ * Checks with the reference scanner whether a player has a winning line anywhere.
+ * @param[in] grid       Fields of the board, row by row.
+ * @param[in] size       Size of the board.
+ * @param[in] win_length Number of consecutive pawns needed to win.
+ * @param[in] pawn       Pawn of the player.
+ * @retval  0 When a line of pawns is found.
+ * @retval -1 When a line of pawns is not found.
+ */
+int
+reference_check_board(const char *grid, int size, int win_length, char pawn) {
+	int x, y;
+	for (x = 0; x < size; x++) {
+		for (y = 0; y < size; y++) {
+			if (grid[x * size + y] == pawn
+					&& reference_check_move(grid, size, win_length, x, y) == 0) {
+				return 0;
+			}
+		}
+	}
+	return -1;
+}
+
+/**
+ * Prints a case that the board and the reference scanner disagree on.
+ * @param[in] grid       Fields of the board after the move, row by row.
+ * @param[in] size       Size of the board.
+ * @param[in] win_length Number of consecutive pawns needed to win.
+ * @param[in] move       The move played.
+ * @param[in] check      What was checked.
+ * @param[in] got        Result of the board.
+ * @param[in] expected   Result of the reference scanner.
+ */
+void
+report_mismatch(const char *grid, int size, int win_length, move_s *move,
+		const char *check, int got, int expected) {
+	int x;
+	if (++failures > MAX_REPORTED) {
+		return;
+	}
+	fprintf(stderr, "Mismatch of %s on board %d with K %d after move %c %d %d: "
+			"got %d, expected %d\n", check, size, win_length, move->pawn,
+			move->x, move->y, got, expected);
+	for (x = 0; x < size; x++) {
+		fprintf(stderr, "  %.*s\n", size, grid + x * size);
+	}
+}
+
+/**
+ * Checks a move played on a position against the reference scanner.
+ * @param[in] arena      Pointer to the arena the board is allocated from.
+ * @param[in] grid       Fields of the board before the move, row by row. The
+ *                       field of the move is taken by its pawn on return.
+ * @param[in] size       Size of the board.
+ * @param[in] win_length Number of consecutive pawns needed to win.
+ * @param[in] move       The move, on an empty field.
+ */
+void
+check_case(arena_s *arena, char *grid, int size, int win_length, move_s *move) {
+	int x, y, bit, pawn, result, expected, empty = size * size;
+	char other = move->pawn == 'x' ? 'o' : 'x';
+	unsigned char cells[GRID_ROWS * GRID_STRIDE];
+	board_s *board;
+	reset_arena(arena);
+	if ((board = create_new_board(arena, size, win_length)) == NULL) {
+		fprintf(stderr, "Cannot create board %d with K %d\n", size, win_length);
+		exit(EXIT_FAILURE);
+	}
+	for (x = 0; x < size; x++) {
+		for (y = 0; y < size; y++) {
+			if (grid[x * size + y] == '1') {
+				continue;
+			}
+			pawn = grid[x * size + y] == 'x' ? BOARD_BITS_X : BOARD_BITS_O;
+			bit = x * board->stride + y;
+			get_board_bits(board, pawn)[bit / 64] |= (uint64_t) 1 << (bit % 64);
+			get_board_bits(board, BOARD_BITS_OCCUPIED)[bit / 64] |=
+					(uint64_t) 1 << (bit % 64);
+			empty--;
+		}
+	}
+	board->hash = hash_board(board);
+	result = make_move(board, move, &empty);
+	grid[move->x * size + move->y] = move->pawn;
+	cases++;
+	expected = reference_check_move(grid, size, win_length, move->x, move->y);
+	if ((result == 1 ? 0 : -1) != expected) {
+		report_mismatch(grid, size, win_length, move, "make_move",
+				result, expected == 0 ? 1 : 0);
+		return;
+	}
+	expected = reference_check_board(grid, size, win_length, move->pawn);
+	if ((result = scan_board(board, move->pawn)) != expected) {
+		report_mismatch(grid, size, win_length, move, "scan_board", result,
+				expected);
+		return;
+	}
+	board_to_grid(board, move->pawn, cells);
+	if ((result = scan_grid_scalar(cells, win_length)) != expected) {
+		report_mismatch(grid, size, win_length, move, "scan_grid_scalar",
+				result, expected);
+		return;
+	}
+	expected = reference_check_board(grid, size, win_length, other);
+	if ((result = scan_board(board, other)) != expected) {
+		report_mismatch(grid, size, win_length, move, "scan_board of the opponent",
+				result, expected);
+	}
+}
+
+/**
+ * Checks every placement of pawns of a player on a small board. The move is
+ * the last field of the placement and the remaining fields are empty or,
+ * when requested, taken by the opponent.
+ * @param[in] arena      Pointer to the arena the board is allocated from.
+ * @param[in] size       Size of the board.
+ * @param[in] win_length Number of consecutive pawns needed to win.
+ * @param[in] opponent   Non-zero when the remaining fields are taken by the opponent.
+ */
+void
+check_all_placements(arena_s *arena, int size, int win_length, int opponent) {
+	int i, last, fields = size * size;
+	unsigned long placement;
+	char grid[EXHAUSTIVE_FIELDS];
+	move_s move;
+	for (placement = 1; placement < 1UL << fields; placement++) {
+		for (i = 0, last = 0; i < fields; i++) {
+			if (placement & 1UL << i) {
+				grid[i] = 'x';
+				last = i;
+			} else {
+				grid[i] = opponent ? 'o' : '1';
+			}
+		}
+		grid[last] = '1';
+		move.x = last / size;
+		move.y = last % size;
+		move.pawn = 'x';
+		check_case(arena, grid, size, win_length, &move);
+	}
+}
+
+/**
+ * Checks lines of pawns one field shorter, equal and one field longer than
+ * the win length in every direction and at every offset, with the move on
+ * each field of the line.
+ * @param[in] arena      Pointer to the arena the board is allocated from.
+ * @param[in] size       Size of the board.
+ * @param[in] win_length Number of consecutive pawns needed to win.
+ */
+void
+check_lines(arena_s *arena, int size, int win_length) {
+	const int dx[4] = { 0, 1, 1, 1 };
+	const int dy[4] = { 1, 0, 1, -1 };
+	int d, length, x, y, i, k, ex, ey;
+	char grid[MAX_BOARD_SIZE * MAX_BOARD_SIZE];
+	move_s move;
+	for (d = 0; d < 4; d++) {
+		for (length = win_length - 1; length <= win_length + 1; length++) {
+			for (x = 0; x < size; x++) {
+				for (y = 0; y < size; y++) {
+					ex = x + (length - 1) * dx[d];
+					ey = y + (length - 1) * dy[d];
+					if (ex >= size || ey < 0 || ey >= size) {
+						continue;
+					}
+					for (i = 0; i < length; i++) {
+						memset(grid, '1', size * size);
+						for (k = 0; k < length; k++) {
+							grid[(x + k * dx[d]) * size + y + k * dy[d]] = 'o';
+						}
+						move.x = x + i * dx[d];
+						move.y = y + i * dy[d];
+						move.pawn = 'o';
+						grid[move.x * size + move.y] = '1';
+						check_case(arena, grid, size, win_length, &move);
+					}
+				}
+			}
+		}
+	}
+}
+
+/**
+ * Checks random positions of random density with a move on a random empty field.
+ * @param[in] arena      Pointer to the arena the board is allocated from.
+ * @param[in] size       Size of the board.
+ * @param[in] win_length Number of consecutive pawns needed to win.
+ */
+void
+check_random(arena_s *arena, int size, int win_length) {
+	int n, i, density, field, fields = size * size;
+	char grid[MAX_BOARD_SIZE * MAX_BOARD_SIZE];
+	move_s move;
+	for (n = 0; n < RANDOM_CASES; n++) {
+		density = next_random(100);
+		for (i = 0; i < fields; i++) {
+			if (next_random(100) < density) {
+				grid[i] = next_random(2) ? 'x' : 'o';
+			} else {
+				grid[i] = '1';
+			}
+		}
+		field = next_random(fields);
+		grid[field] = '1';
+		move.x = field / size;
+		move.y = field % size;
+		move.pawn = next_random(2) ? 'x' : 'o';
+		check_case(arena, grid, size, win_length, &move);
+	}
+}
+
+/**
+ * Main function of the test.
+ * @return EXIT_SUCCESS when the board agrees with the reference scanner in every case.
+ */
+int
+main(void) {
+	int size, win_length;
+	arena_s *arena;
+	if ((arena = create_arena(get_board_arena_size(MAX_BOARD_SIZE,
+			MIN_WIN_LENGTH))) == NULL) {
+		perror("create_arena");
+		return EXIT_FAILURE;
+	}
+	for (size = MIN_BOARD_SIZE; size <= MAX_BOARD_SIZE; size++) {
+		for (win_length = MIN_WIN_LENGTH;
+				win_length <= MAX_WIN_LENGTH && win_length <= size;
+				win_length++) {
+			if (size * size <= EXHAUSTIVE_FIELDS) {
+				check_all_placements(arena, size, win_length, 0);
+				check_all_placements(arena, size, win_length, 1);
+			}
+			check_lines(arena, size, win_length);
+			check_random(arena, size, win_length);
+		}
+	}
+	destroy_arena(arena);
+	if (failures > 0) {
+		fprintf(stderr, "%ld of %ld cases failed\n", failures, cases);
+		return EXIT_FAILURE;
+	}
+	printf("All %ld cases passed\n", cases);
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,815 @@
+/**
+ * @file bot.c
+ * @ingroup bot
+ *
+ * @author Piotr Janaszek <janas03@yahoo.pl>
+ * @date Created on: Oct 18, 2026
+ *
+ * @brief File containing methods for a computer player searching its moves on a compute pool.
+ *
+ * A bot takes the place of the second player. The game thread talks to it as
+ * to any client, through one end of a socket pair, so turns, moves and the end
+ * of the game need no special cases. When it is the bot's turn the game thread
+ * copies the position into a job and queues it in the compute pool, then goes
+ * on serving its clients. A worker searches the position and writes the chosen
+ * move into the other end of the pair as a make move request, which wakes up
+ * the game thread like a move of a human player would.
+ *
+ * The search is a negamax with alpha-beta pruning deepened iteratively until
+ * the time budget of the move runs out. Only empty fields near the pawns are
+ * considered, ordered by the lines they make and break, with the move from the
+ * transposition table first. Wins in one move end the search at once, and a
+ * threat of the opponent to win in one move leaves only the blocking moves.
+ * The transposition table is shared by all searches and needs no lock: an
+ * entry is valid only when its check word matches the key, which a torn
+ * write never does.
+ *
+ * A bot may instead search with Monte Carlo trees. Then MCTS_TREES trees of
+ * the same position are queued at once, each grown by its own worker, and the
+ * last one to finish sums the playouts of every move and plays the move
+ * tried most.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/socket.h>
+
+#include "board_handler.h"
+#include "bot.h"
+#include "common.h"
+#include "compute_pool.h"
+#include "config.h"
+#include "logger.h"
+#include "mcts.h"
+#include "messenger.h"
+#include "solved_table.h"
+#include "structs.h"
+#include "zobrist.h"
+
+/*! \def BOT_WIN_SCORE
+ * Score of a won position, lowered by the number of moves needed to win it.
+ */
+#define BOT_WIN_SCORE 1000000
+
+/*! \def NO_MOVE
+ * Move stored in the transposition table when no move is known.
+ */
+#define NO_MOVE 0xffff
+
+/**
+ * The transposition table shared by all searches.
+ */
+static tt_entry_s *tt_entries = NULL;
+
+/**
+ * Guard making the transposition table allocated exactly once.
+ */
+static pthread_once_t tt_once = PTHREAD_ONCE_INIT;
+
+/**
+ * Steps along the x axis of the four line directions.
+ */
+static const int step_x[4] = { 0, 1, 1, 1 };
+
+/**
+ * Steps along the y axis of the four line directions.
+ */
+static const int step_y[4] = { 1, 0, 1, -1 };
+
+/**
+ * Allocates the transposition table. Searches run without it when there is
+ * not enough memory.
+ */
+void
+create_tt(void) {
+	if ((tt_entries = calloc(BOT_TT_ENTRIES, sizeof(tt_entry_s))) == NULL) {
+		fprintf(stderr, "Cannot allocate memory for transposition table\n");
+	}
+}
+
+/**
+ * Computes the transposition table key of a searched position.
+ * @param[in] search Pointer to the search.
+ * @return The key telling apart positions, rules and players to move.
+ */
+uint64_t
+get_search_key(search_s *search) {
+	return search->hash ^ search->salt
+			^ (search->side == 2 ? 0x6a09e667f3bcc908ULL : 0);
+}
+
+/**
+ * Looks a position up in the transposition table.
+ * @param[in]  key  The key of the position.
+ * @param[out] data Packed data of the entry when it is found.
+ * @return Non-zero value when the entry is found.
+ */
+int
+probe_tt(uint64_t key, uint64_t *data) {
+	tt_entry_s *entry;
+	uint64_t check, value;
+	if (tt_entries == NULL) {
+		return 0;
+	}
+	entry = &tt_entries[key & (BOT_TT_ENTRIES - 1)];
+	check = __atomic_load_n(&entry->check, __ATOMIC_RELAXED);
+	value = __atomic_load_n(&entry->data, __ATOMIC_RELAXED);
+	if ((value >> 63) == 0 || (check ^ value) != key) {
+		return 0;
+	}
+	*data = value;
+	return 1;
+}
+
+/**
+ * Stores a searched position in the transposition table, replacing whatever
+ * the entry held.
+ * @param[in] key   The key of the position.
+ * @param[in] depth Depth the position was searched to.
+ * @param[in] bound Whether the score is exact or a bound.
+ * @param[in] score Score of the position.
+ * @param[in] move  The best move found or NO_MOVE.
+ * \sa tt_bound_e
+ */
+void
+store_tt(uint64_t key, int depth, tt_bound_e bound, int score, int move) {
+	tt_entry_s *entry;
+	uint64_t value;
+	if (tt_entries == NULL) {
+		return;
+	}
+	value = (uint64_t) (uint32_t) score | ((uint64_t) (move & 0xffff) << 32)
+			| ((uint64_t) (depth & 0xff) << 48) | ((uint64_t) bound << 56)
+			| ((uint64_t) 1 << 63);
+	entry = &tt_entries[key & (BOT_TT_ENTRIES - 1)];
+	__atomic_store_n(&entry->check, key ^ value, __ATOMIC_RELAXED);
+	__atomic_store_n(&entry->data, value, __ATOMIC_RELAXED);
+}
+
+/**
+ * Counts pawns of a player lying next to a field in one direction, at most
+ * win_length - 1 of them.
+ * @param[in] search Pointer to the search.
+ * @param[in] move   The field.
+ * @param[in] dir    Index of the direction.
+ * @param[in] sign   1 to go along the direction, -1 to go against it.
+ * @param[in] side   The player, 1 or 2.
+ * @return Number of consecutive pawns.
+ */
+int
+get_run(search_s *search, int move, int dir, int sign, int side) {
+	int count = 0, size = search->size;
+	int x = move / size + sign * step_x[dir];
+	int y = move % size + sign * step_y[dir];
+	while (count < search->win_length - 1 && x >= 0 && y >= 0 && x < size
+			&& y < size && search->cells[x * size + y] == side) {
+		count++;
+		x += sign * step_x[dir];
+		y += sign * step_y[dir];
+	}
+	return count;
+}
+
+/**
+ * Scores an empty field for move ordering: lines the player to move makes
+ * and lines of the opponent it breaks.
+ * @param[in] search Pointer to the search.
+ * @param[in] move   The field.
+ * @return ORDER_WIN for a winning move, otherwise a score with ORDER_BLOCK
+ * set when the move blocks the opponent's win.
+ */
+int
+score_move(search_s *search, int move) {
+	int dir, own, opponent, score = 0;
+	for (dir = 0; dir < 4; dir++) {
+		own = 1 + get_run(search, move, dir, 1, search->side)
+				+ get_run(search, move, dir, -1, search->side);
+		opponent = 1 + get_run(search, move, dir, 1, 3 - search->side)
+				+ get_run(search, move, dir, -1, 3 - search->side);
+		if (own >= search->win_length) {
+			return ORDER_WIN;
+		}
+		if (opponent >= search->win_length) {
+			score |= ORDER_BLOCK;
+			opponent = search->win_length;
+		}
+		score += (1 << (3 * own)) + (1 << (3 * opponent));
+	}
+	return score;
+}
+
+/**
+ * Generates the moves worth searching in a position together with their
+ * ordering scores. In a gravity game these are the tops of all columns, in
+ * other games the empty fields near any pawn or the centre of an empty board.
+ * @param[in]  search Pointer to the search.
+ * @param[out] moves  Array the moves are written to.
+ * @param[out] scores Array the ordering scores are written to.
+ * @return Number of moves.
+ */
+int
+generate_moves(search_s *search, int *moves, int *scores) {
+	int i, y, nx, ny, n = 0, size = search->size;
+	unsigned char near[MAX_BOARD_SIZE * MAX_BOARD_SIZE];
+	if (search->mode == GAME_MODE_GRAVITY) {
+		for (y = 0; y < size; y++) {
+			if (search->heights[y] < size) {
+				moves[n++] = (size - 1 - search->heights[y]) * size + y;
+			}
+		}
+	} else if (search->no_empty == size * size) {
+		moves[n++] = (size / 2) * size + size / 2;
+	} else {
+		memset(near, 0, size * size);
+		for (i = 0; i < size * size; i++) {
+			if (search->cells[i] == 0) {
+				continue;
+			}
+			for (nx = i / size - BOT_NEIGHBOURHOOD;
+					nx <= i / size + BOT_NEIGHBOURHOOD; nx++) {
+				for (ny = i % size - BOT_NEIGHBOURHOOD;
+						ny <= i % size + BOT_NEIGHBOURHOOD; ny++) {
+					if (nx < 0 || ny < 0 || nx >= size || ny >= size
+							|| search->cells[nx * size + ny] != 0
+							|| near[nx * size + ny]) {
+						continue;
+					}
+					near[nx * size + ny] = 1;
+					moves[n++] = nx * size + ny;
+				}
+			}
+		}
+	}
+	for (i = 0; i < n; i++) {
+		scores[i] = score_move(search, moves[i]);
+	}
+	return n;
+}
+
+/**
+ * Puts a pawn of the player to move on a field and passes the turn.
+ * @param[in] search Pointer to the search.
+ * @param[in] move   The field.
+ */
+void
+play_move(search_s *search, int move) {
+	int x = move / search->size, y = move % search->size;
+	search->cells[move] = search->side;
+	search->hash ^= get_zobrist_key(search->size, x, y,
+			search->side == 1 ? 'x' : 'o');
+	search->no_empty--;
+	if (search->mode == GAME_MODE_GRAVITY) {
+		search->heights[y]++;
+	}
+	search->side = 3 - search->side;
+}
+
+/**
+ * Takes back a move played by play_move.
+ * @param[in] search Pointer to the search.
+ * @param[in] move   The field.
+ */
+void
+undo_move(search_s *search, int move) {
+	int x = move / search->size, y = move % search->size;
+	search->side = 3 - search->side;
+	search->cells[move] = 0;
+	search->hash ^= get_zobrist_key(search->size, x, y,
+			search->side == 1 ? 'x' : 'o');
+	search->no_empty++;
+	if (search->mode == GAME_MODE_GRAVITY) {
+		search->heights[y]--;
+	}
+}
+
+/**
+ * Evaluates a position for the player to move. Every line of win_length
+ * fields holding pawns of one player only counts for that player, the more
+ * pawns the more it counts.
+ * @param[in] search Pointer to the search.
+ * @return Score of the position, positive when the player to move is better.
+ */
+int
+evaluate(search_s *search) {
+	int dir, x, y, i, cell, count[3], score[3] = { 0, 0, 0 };
+	int size = search->size, length = search->win_length;
+	for (dir = 0; dir < 4; dir++) {
+		for (x = 0; x < size; x++) {
+			for (y = 0; y < size; y++) {
+				if (x + (length - 1) * step_x[dir] >= size
+						|| y + (length - 1) * step_y[dir] >= size
+						|| y + (length - 1) * step_y[dir] < 0) {
+					continue;
+				}
+				count[1] = count[2] = 0;
+				for (i = 0; i < length; i++) {
+					cell = search->cells[(x + i * step_x[dir]) * size + y
+							+ i * step_y[dir]];
+					count[cell]++;
+				}
+				if (count[2] == 0 && count[1] > 0) {
+					score[1] += 1 << (3 * count[1]);
+				} else if (count[1] == 0 && count[2] > 0) {
+					score[2] += 1 << (3 * count[2]);
+				}
+			}
+		}
+	}
+	return score[search->side] - score[3 - search->side];
+}
+
+/**
+ * Searches a position with negamax and alpha-beta pruning.
+ * @param[in] search Pointer to the search.
+ * @param[in] depth  Number of moves left to search.
+ * @param[in] alpha  Score the player to move is already sure of.
+ * @param[in] beta   Score the opponent is already sure of.
+ * @param[in] ply    Number of moves played since the root.
+ * @return Score of the position for the player to move.
+ */
+int
+negamax(search_s *search, int depth, int alpha, int beta, int ply) {
+	int i, j, n, t, score, best_score, best_move, tt_move = -1;
+	int tt_score, tt_depth, alpha0 = alpha;
+	int moves[MAX_BOARD_SIZE * MAX_BOARD_SIZE];
+	int scores[MAX_BOARD_SIZE * MAX_BOARD_SIZE];
+	uint64_t key, data;
+	tt_bound_e bound;
+	if ((++search->nodes & 1023) == 0
+			&& (get_monotonic_ms() >= search->deadline
+					|| __atomic_load_n(search->cancelled, __ATOMIC_RELAXED))) {
+		search->stopped = 1;
+	}
+	if (search->stopped || search->no_empty == 0) {
+		return 0;
+	}
+	key = get_search_key(search);
+	if (probe_tt(key, &data)) {
+		tt_score = (int) (uint32_t) data;
+		tt_move = (data >> 32) & 0xffff;
+		tt_depth = (data >> 48) & 0xff;
+		bound = (data >> 56) & 3;
+		if (ply > 0 && tt_depth >= depth) {
+			if (bound == TT_BOUND_EXACT) {
+				return tt_score;
+			} else if (bound == TT_BOUND_LOWER && tt_score > alpha) {
+				alpha = tt_score;
+			} else if (bound == TT_BOUND_UPPER && tt_score < beta) {
+				beta = tt_score;
+			}
+			if (alpha >= beta) {
+				return tt_score;
+			}
+		}
+	}
+	if (depth == 0) {
+		return evaluate(search);
+	}
+	if ((n = generate_moves(search, moves, scores)) == 0) {
+		return 0;
+	}
+	for (i = 0, t = 0; i < n; i++) {
+		if (scores[i] == ORDER_WIN) {
+			if (ply == 0) {
+				search->best = moves[i];
+			}
+			return BOT_WIN_SCORE - ply - 1;
+		}
+		if (scores[i] & ORDER_BLOCK) {
+			moves[t] = moves[i];
+			scores[t++] = scores[i];
+		}
+	}
+	if (t > 0) {
+		/* only blocking moves do not lose at once */
+		n = t;
+	}
+	for (i = 0; i < n; i++) {
+		if (moves[i] == tt_move) {
+			scores[i] = ORDER_WIN;
+		}
+	}
+	best_score = -BOT_WIN_SCORE - 1;
+	best_move = moves[0];
+	for (i = 0; i < n && i < BOT_MAX_BRANCHING; i++) {
+		for (j = i + 1; j < n; j++) {
+			if (scores[j] > scores[i]) {
+				t = scores[i];
+				scores[i] = scores[j];
+				scores[j] = t;
+				t = moves[i];
+				moves[i] = moves[j];
+				moves[j] = t;
+			}
+		}
+		play_move(search, moves[i]);
+		score = -negamax(search, depth - 1, -beta, -alpha, ply + 1);
+		undo_move(search, moves[i]);
+		if (search->stopped) {
+			return 0;
+		}
+		if (score > best_score) {
+			best_score = score;
+			best_move = moves[i];
+			if (ply == 0) {
+				search->best = best_move;
+			}
+		}
+		if (score > alpha) {
+			alpha = score;
+		}
+		if (alpha >= beta) {
+			break;
+		}
+	}
+	if (best_score <= alpha0) {
+		bound = TT_BOUND_UPPER;
+	} else if (best_score >= beta) {
+		bound = TT_BOUND_LOWER;
+	} else {
+		bound = TT_BOUND_EXACT;
+	}
+	store_tt(key, depth, bound, best_score, best_move);
+	return best_score;
+}
+
+/**
+ * Finds a move for the player to move, deepening the search one move at a
+ * time until the deadline or a forced result. Reports the reached depth and
+ * the speed of the search.
+ * @param[in] search Pointer to the search holding the position, the rules
+ * and the deadline.
+ * @return The chosen field, x * size + y, or -1 when there is no move.
+ * \sa search_s
+ */
+int
+search_bot_move(search_s *search) {
+	int i, n, depth, score, reached = 0, last_score = 0, best = -1;
+	int moves[MAX_BOARD_SIZE * MAX_BOARD_SIZE];
+	int scores[MAX_BOARD_SIZE * MAX_BOARD_SIZE];
+	long long elapsed, start = get_monotonic_ms();
+	pthread_once(&tt_once, create_tt);
+	init_zobrist_keys();
+	search->salt = (uint64_t) search->size * 0xbb67ae8584caa73bULL
+			^ (uint64_t) search->win_length * 0x3c6ef372fe94f82bULL
+			^ (search->mode == GAME_MODE_GRAVITY ? 0xa54ff53a5f1d36f1ULL : 0);
+	search->nodes = 0;
+	search->stopped = 0;
+	if ((n = generate_moves(search, moves, scores)) == 0) {
+		return -1;
+	}
+	for (i = 0, best = moves[0]; i < n; i++) {
+		if (scores[i] > scores[0]) {
+			scores[0] = scores[i];
+			best = moves[i];
+		}
+	}
+	for (depth = 1; depth <= BOT_MAX_DEPTH && depth <= search->no_empty;
+			depth++) {
+		search->best = -1;
+		score = negamax(search, depth, -BOT_WIN_SCORE - 1, BOT_WIN_SCORE + 1,
+				0);
+		if (search->stopped) {
+			break;
+		}
+		if (search->best != -1) {
+			best = search->best;
+		}
+		reached = depth;
+		last_score = score;
+		if (score > BOT_WIN_SCORE - BOT_MAX_DEPTH
+				|| score < -BOT_WIN_SCORE + BOT_MAX_DEPTH) {
+			break;
+		}
+	}
+	elapsed = get_monotonic_ms() - start;
+	LOG_INFO_TEXT(
+			"(Bot) Move %d %d: depth %d, score %d, %ld nodes in %lld ms, %lld nodes/s",
+			best / search->size + 1, best % search->size + 1, reached,
+			last_score, search->nodes, elapsed,
+			search->nodes * 1000LL / (elapsed > 0 ? elapsed : 1));
+	return best;
+}
+
+/**
+ * Drops a holder of a bot and releases the bot when it was the last one.
+ * @param[in] bot Pointer to the bot.
+ */
+void
+release_bot(bot_s *bot) {
+	int last;
+	pthread_mutex_lock(&bot->mutex);
+	last = --bot->refs == 0;
+	pthread_mutex_unlock(&bot->mutex);
+	if (last) {
+		close(bot->fds[1]);
+		pthread_mutex_destroy(&bot->mutex);
+		free(bot);
+	}
+}
+
+/**
+ * Sends a move chosen by a search to the game thread unless the game is
+ * already over.
+ * @param[in] bot    Pointer to the bot.
+ * @param[in] search Pointer to the finished search.
+ * @param[in] move   The chosen field or -1 when there is none.
+ */
+void
+send_bot_move(bot_s *bot, search_s *search, int move) {
+	request_s request;
+	char message[MAX_MSG_SIZE];
+	if (move == -1 || __atomic_load_n(&bot->cancelled, __ATOMIC_RELAXED)) {
+		return;
+	}
+	memset(&request, 0, sizeof(request_s));
+	request.type = MSG_MAKE_MOVE_REQ;
+	if (search->mode == GAME_MODE_GRAVITY) {
+		snprintf(request.payload, MAX_REQ_SIZE, "%d%s",
+				move % search->size + 1, PAYLOAD_DELIM);
+	} else {
+		snprintf(request.payload, MAX_REQ_SIZE, "%d%s%d%s",
+				move / search->size + 1, PAYLOAD_DELIM,
+				move % search->size + 1, PAYLOAD_DELIM);
+	}
+	request_to_string(&request, message);
+	if (send(bot->fds[1], message, MAX_MSG_SIZE, MSG_NOSIGNAL)
+			!= MAX_MSG_SIZE) {
+		LOG_WARNING("(Bot) Cannot send a move to the game");
+	}
+}
+
+/**
+ * Runs an alpha-beta bot search on a compute pool worker and sends the
+ * chosen move to the game thread.
+ * @param[in] job Pointer to the job embedded in a bot job.
+ * \sa bot_job_s
+ */
+void
+run_bot_search(compute_job_s *job) {
+	bot_job_s *bot_job = (bot_job_s*) job;
+	bot_s *bot = bot_job->bot;
+	send_bot_move(bot, &bot_job->search, search_bot_move(&bot_job->search));
+	release_bot(bot);
+	free(bot_job);
+}
+
+/**
+ * Adds the results of one Monte Carlo tree to the results shared by the
+ * trees of a move. The last tree to finish chooses the move, reports the
+ * speed of the search and sends the move to the game thread.
+ * @param[in] bot    Pointer to the bot.
+ * @param[in] share  Pointer to the shared results.
+ * @param[in] search Pointer to the position searched.
+ * @param[in] stats  Results of the tree or NULL when it was not searched.
+ * \sa mcts_share_s
+ */
+void
+finish_mcts_tree(bot_s *bot, mcts_share_s *share, search_s *search,
+		mcts_stats_s *stats) {
+	int i, last, move;
+	double value;
+	long long elapsed;
+	pthread_mutex_lock(&share->mutex);
+	if (stats != NULL) {
+		share->stats.playouts += stats->playouts;
+		for (i = 0; i < search->size * search->size; i++) {
+			share->stats.visits[i] += stats->visits[i];
+			share->stats.wins[i] += stats->wins[i];
+		}
+	}
+	last = --share->remaining == 0;
+	pthread_mutex_unlock(&share->mutex);
+	if (!last) {
+		return;
+	}
+	move = get_mcts_move(&share->stats, search->size * search->size, &value);
+	elapsed = get_monotonic_ms() - share->start;
+	if (move != -1) {
+		LOG_INFO_TEXT(
+				"(Bot) Move %d %d: win rate %.3f, %ld playouts in %lld ms, %lld playouts/s",
+				move / search->size + 1, move % search->size + 1, value,
+				share->stats.playouts, elapsed,
+				share->stats.playouts * 1000LL / (elapsed > 0 ? elapsed : 1));
+	}
+	send_bot_move(bot, search, move);
+	pthread_mutex_destroy(&share->mutex);
+	free(share);
+}
+
+/**
+ * Searches one of the Monte Carlo trees of a bot's move on a compute pool
+ * worker.
+ * @param[in] job Pointer to the job embedded in a bot job.
+ * \sa bot_job_s
+ */
+void
+run_mcts_tree(compute_job_s *job) {
+	bot_job_s *bot_job = (bot_job_s*) job;
+	bot_s *bot = bot_job->bot;
+	mcts_stats_s *stats = calloc(1, sizeof(mcts_stats_s));
+	if (stats != NULL
+			&& run_mcts(&bot_job->search, (uintptr_t) bot_job, stats) == -1) {
+		free(stats);
+		stats = NULL;
+	}
+	finish_mcts_tree(bot, bot_job->share, &bot_job->search, stats);
+	free(stats);
+	release_bot(bot);
+	free(bot_job);
+}
+
+/**
+ * Creates a bot with a socket pair connecting it to a game thread.
+ * @param[in] pool      Pointer to the pool the bot's searches run on.
+ * @param[in] budget_ms Time the bot thinks over a move, in milliseconds.
+ * @param[in] engine    The engine searching the bot's moves.
+ * @return Pointer to the created bot or NULL upon error.
+ * \sa bot_s bot_engine_e
+ */
+bot_s*
+create_bot(compute_pool_s *pool, int budget_ms, bot_engine_e engine) {
+	bot_s *bot = calloc(1, sizeof(bot_s));
+	if (bot == NULL) {
+		fprintf(stderr, "Cannot allocate memory for bot\n");
+		return NULL;
+	}
+	if (socketpair(AF_UNIX, SOCK_STREAM, 0, bot->fds) == -1) {
+		perror("socketpair");
+		free(bot);
+		return NULL;
+	}
+	fcntl(bot->fds[1], F_SETFL, fcntl(bot->fds[1], F_GETFL) | O_NONBLOCK);
+	bot->player.player_fd = bot->fds[0];
+	strncpy(bot->player.player_nick, BOT_NICK, MAX_NICK_LEN - 1);
+	bot->budget_ms = budget_ms;
+	bot->engine = engine;
+	bot->refs = 1;
+	bot->pool = pool;
+	pthread_mutex_init(&bot->mutex, NULL);
+	return bot;
+}
+
+/**
+ * Copies the position of a dense board game into a search.
+ * @param[out] search Pointer to the search.
+ * @param[in]  game   Pointer to the game.
+ * @param[in]  side   The player to move, 1 or 2.
+ * \sa search_s game_s
+ */
+void
+load_search_position(search_s *search, game_s *game, int side) {
+	int x, y;
+	char field;
+	search->size = game->size;
+	search->win_length = game->win_length;
+	search->mode = game->mode;
+	search->side = side;
+	search->no_empty = 0;
+	search->hash = game->board->hash;
+	for (x = 0; x < game->size; x++) {
+		for (y = 0; y < game->size; y++) {
+			field = get_field(game->board, x, y);
+			search->cells[x * game->size + y] =
+					field == 'x' ? 1 : field == 'o' ? 2 : 0;
+			search->no_empty += field == '1';
+		}
+		search->heights[x] = game->heights != NULL ? game->heights[x] : 0;
+	}
+}
+
+/**
+ * Creates a job searching the current position of a game for a bot.
+ * @param[in] bot  Pointer to the bot.
+ * @param[in] game Pointer to the game the bot plays.
+ * @return Pointer to the job or NULL when memory cannot be allocated.
+ * \sa bot_job_s
+ */
+bot_job_s*
+create_bot_job(bot_s *bot, game_s *game) {
+	search_s *search;
+	bot_job_s *bot_job = malloc(sizeof(bot_job_s));
+	if (bot_job == NULL) {
+		return NULL;
+	}
+	search = &bot_job->search;
+	load_search_position(search, game, 2);
+	search->deadline = get_monotonic_ms() + bot->budget_ms;
+	search->max_playouts = 0;
+	search->cancelled = &bot->cancelled;
+	bot_job->job.run = run_bot_search;
+	bot_job->bot = bot;
+	bot_job->share = NULL;
+	pthread_mutex_lock(&bot->mutex);
+	bot->refs++;
+	pthread_mutex_unlock(&bot->mutex);
+	return bot_job;
+}
+
+/**
+ * Queues MCTS_TREES Monte Carlo trees searching a position in parallel. The
+ * trees share their results through a structure released by the last one.
+ * @param[in] bot     Pointer to the bot.
+ * @param[in] game    Pointer to the game the bot plays.
+ * @param[in] bot_job Pointer to the job of the first tree.
+ * @retval  0 When at least one tree is queued.
+ * @retval -1 When the pool is busy or memory cannot be allocated.
+ */
+int
+start_mcts_search(bot_s *bot, game_s *game, bot_job_s *bot_job) {
+	int i, queued = 0;
+	bot_job_s *tree;
+	search_s search = bot_job->search;
+	mcts_share_s *share = calloc(1, sizeof(mcts_share_s));
+	if (share == NULL) {
+		release_bot(bot);
+		free(bot_job);
+		return -1;
+	}
+	pthread_mutex_init(&share->mutex, NULL);
+	share->start = get_monotonic_ms();
+	/* held until all trees are queued, so none of them finishes the move early */
+	share->remaining = MCTS_TREES + 1;
+	for (i = 0; i < MCTS_TREES; i++) {
+		tree = i == 0 ? bot_job : create_bot_job(bot, game);
+		if (tree == NULL) {
+			share->remaining--;
+			continue;
+		}
+		tree->job.run = run_mcts_tree;
+		tree->share = share;
+		if (submit_compute_job(bot->pool, &tree->job) == -1) {
+			share->remaining--;
+			release_bot(bot);
+			free(tree);
+			continue;
+		}
+		queued++;
+	}
+	if (queued == 0) {
+		pthread_mutex_destroy(&share->mutex);
+		free(share);
+		return -1;
+	}
+	finish_mcts_tree(bot, share, &search, NULL);
+	return 0;
+}
+
+/**
+ * Queues a search of the bot's move in the current position of a game, or
+ * sends the move at once when the position is in a solved table. It is
+ * called by the game thread and returns at once.
+ * @param[in] bot  Pointer to the bot.
+ * @param[in] game Pointer to the game the bot plays.
+ * @retval  0 When the search is queued.
+ * @retval -1 When the pool is busy or memory cannot be allocated.
+ * \sa bot_s game_s
+ */
+int
+start_bot_search(bot_s *bot, game_s *game) {
+	int outcome, move;
+	char buffer[MAX_MSG_SIZE];
+	bot_job_s *bot_job;
+	/* responses sent to the bot are of no use to it */
+	while (recv(bot->fds[1], buffer, sizeof(buffer), MSG_DONTWAIT) > 0) {
+	}
+	if (game->board == NULL || (bot_job = create_bot_job(bot, game)) == NULL) {
+		return -1;
+	}
+	if (lookup_solved_position(game->size, game->win_length, game->mode,
+			bot_job->search.cells, &outcome, &move) == 0 && move != -1) {
+		LOG_INFO("(Bot) Move %d %d from solved table, outcome %d",
+				move / game->size + 1, move % game->size + 1, outcome);
+		send_bot_move(bot, &bot_job->search, move);
+		release_bot(bot);
+		free(bot_job);
+	} else if (bot->engine == BOT_ENGINE_MCTS) {
+		if (start_mcts_search(bot, game, bot_job) == -1) {
+			return -1;
+		}
+	} else if (submit_compute_job(bot->pool, &bot_job->job) == -1) {
+		release_bot(bot);
+		free(bot_job);
+		return -1;
+	}
+	bot->thinking = 1;
+	return 0;
+}
+
+/**
+ * Closes the game's end of a bot when the game is released. A search still
+ * running stops at its next check and releases the bot itself.
+ * @param[in] bot Pointer to the bot.
+ */
+void
+close_bot(bot_s *bot) {
+	__atomic_store_n(&bot->cancelled, 1, __ATOMIC_RELAXED);
+	close(bot->fds[0]);
+	release_bot(bot);
+}
@@ -0,0 +1,36 @@
+/**
+ * @file bot.h
+ * @ingroup bot
+ *
+ * @author Piotr Janaszek <janas03@yahoo.pl>
+ * @date Created on: Oct 18, 2026
+ *
+ * @brief File containing methods for a computer player searching its moves on a compute pool.
+ */
+
+#ifndef BOT_H_
+#define BOT_H_
+
+#include "structs.h"
+
+/*! \def ORDER_WIN
+ * Ordering score of a move winning the game at once.
+ */
+#define ORDER_WIN (1 << 30)
+
+/*! \def ORDER_BLOCK
+ * Ordering flag of a move blocking the opponent's win in one move.
+ */
+#define ORDER_BLOCK (1 << 28)
+
+int score_move(search_s *search, int move);
+int generate_moves(search_s *search, int *moves, int *scores);
+void play_move(search_s *search, int move);
+void undo_move(search_s *search, int move);
+int search_bot_move(search_s *search);
+void load_search_position(search_s *search, game_s *game, int side);
+bot_s* create_bot(compute_pool_s *pool, int budget_ms, bot_engine_e engine);
+int start_bot_search(bot_s *bot, game_s *game);
+void close_bot(bot_s *bot);
+
+#endif /* BOT_H_ */
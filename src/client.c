@@ -120,6 +120,7 @@ print_menu(player_mode_e mode) {
 	switch (mode) {
 	case PLAYER_MODE_START:
 		printf("1 - Log in to the server\n");
+		printf("2 - Resume a game\n");
 		break;
 	case PLAYER_MODE_LOGGED_IN:
 		printf("1 - Print list of players\n");
@@ -127,6 +128,8 @@ print_menu(player_mode_e mode) {
 		printf("3 - Create new game\n");
 		printf("4 - Connect to an existing game\n");
 		printf("5 - Connect to a game as spectator\n");
+		printf("6 - Quick match\n");
+		printf("7 - Play against the server\n");
 		break;
 	case PLAYER_MODE_CONNECTED:
 		printf("1 - Print board\n");
@@ -134,6 +137,7 @@ print_menu(player_mode_e mode) {
 		printf("3 - Make move\n");
 		printf("4 - Leave a message\n");
 		printf("5 - Give up\n");
+		printf("6 - Ask for a hint\n");
 		break;
 	case PLAYER_MODE_SPECTATOR:
 		printf("1 - Back to main menu\n");
@@ -167,6 +171,9 @@ choice_handler(int choice, int server_socket, int *game_id, player_mode_e *curre
 		case 1:
 			send_game_login_request(server_socket, current_mode);
 			break;
+		case 2:
+			send_resume_request(server_socket, current_mode, game_id);
+			break;
 		default:
 			print_choice_error();
 			break;
@@ -188,6 +195,12 @@ choice_handler(int choice, int server_socket, int *game_id, player_mode_e *curre
 		case 5:
 			send_connect_spectator_request(server_socket, current_mode, game_id);
 			break;
+		case 6:
+			send_quick_match_request(server_socket, current_mode, game_id);
+			break;
+		case 7:
+			send_create_bot_game_request(server_socket, current_mode, game_id);
+			break;
 		default:
 			print_choice_error();
 			break;
@@ -209,6 +222,9 @@ choice_handler(int choice, int server_socket, int *game_id, player_mode_e *curre
 		case 5:
 			send_giveup_request(server_socket, current_mode, game_id);
 			break;
+		case 6:
+			send_hint_request(server_socket);
+			break;
 		default:
 			print_choice_error();
 			break;
@@ -229,15 +245,23 @@ choice_handler(int choice, int server_socket, int *game_id, player_mode_e *curre
  * Handles incoming messages from a server without sending a request.
  * @param[in] server_socket File descriptor of the socket connected to the server.
  * @param[in] current_mode  Pointer to the current mode of a menu level.
+ * @param[in] game_id       Pointer to a game ID that a user is currently connected to.
  */
 void
-handle_incoming_message(int server_socket, player_mode_e *current_mode) {
+handle_incoming_message(int server_socket, player_mode_e *current_mode,
+		int *game_id) {
 	response_s response;
 	receive_response_message(server_socket, &response);
 	switch (response.type) {
 	case MSG_PRINT_BOARD_SPC_RSP:
 		get_print_board_message(&response);
 		break;
+	case MSG_PRINT_MOVE_SPC_RSP:
+		get_print_move_message(&response);
+		break;
+	case MSG_FORCED_OUTCOME_SPC_RSP:
+		get_forced_outcome_message(&response);
+		break;
 	case MSG_LEAVE_MESSAGE_RSP:
 		get_message_from_opponent(&response);
 		break;
@@ -250,9 +274,18 @@ handle_incoming_message(int server_socket, player_mode_e *current_mode) {
 	case MSG_PRINT_LOST_RSP:
 		get_print_lost_message(&response, current_mode);
 		break;
+	case MSG_PRINT_WIN_RSP:
+		get_print_win_message(&response, current_mode);
+		break;
+	case MSG_KEEPALIVE_RSP:
+		send_keepalive_message(server_socket);
+		break;
 	case MSG_PRINT_DRAW_RSP:
 		get_print_draw_message(&response, current_mode);
 		break;
+	case MSG_QUICK_MATCH_RSP:
+		get_quick_match_message(&response, current_mode, game_id);
+		break;
 	default:
 		break;
 	}
@@ -279,7 +312,7 @@ doClient(int server_socket) {
 		fflush(stdout);
 		if (pselect(fdmax + 1, &rdfs, NULL, NULL, NULL, NULL) > 0) {
 			if (FD_ISSET(server_socket, &rdfs)) {
-				handle_incoming_message(server_socket, &current_mode);
+				handle_incoming_message(server_socket, &current_mode, &game_id);
 			}
 			if (FD_ISSET(STDIN_FILENO, &rdfs)) {
 				read_line(choice, HEADER);
@@ -31,6 +31,36 @@ get_print_board_message(response_s *response) {
 	print_spectator_board(response);
 }
 
+/**
+ * Prints out the last move performed on a large board.
+ * @param[in] response Pointer to a message containing the move.
+ */
+void
+get_print_move_message(response_s *response) {
+	if (response->error != MSG_RSP_ERROR_NONE) {
+		print_error_message(response->error);
+		return;
+	}
+	print_spectator_move(response);
+}
+
+/**
+ * Prints out who wins the watched game with perfect play from now on.
+ * @param[in] response Pointer to a message containing 'x', 'o' or '-' for a draw.
+ */
+void
+get_forced_outcome_message(response_s *response) {
+	if (response->error != MSG_RSP_ERROR_NONE) {
+		print_error_message(response->error);
+		return;
+	}
+	if (response->payload[0] == '-') {
+		printf("\nWith perfect play the game is a draw\n");
+	} else {
+		printf("\nWith perfect play %c wins\n", response->payload[0]);
+	}
+}
+
 /**
  * Prints out a message from an opponent (private chat).
  * @param[in] response Pointer to a message containing text from the opponent.
@@ -54,6 +84,11 @@ get_message_from_opponent(response_s *response) {
  */
 void
 get_cleanup_message(response_s *response, player_mode_e *mode) {
+	if (response->error == MSG_RSP_ERROR_TIMED_OUT) {
+		printf("\n\nNobody joined your game in time. Back to main menu\n");
+		*mode = PLAYER_MODE_LOGGED_IN;
+		return;
+	}
 	if (response->error != MSG_RSP_ERROR_NONE) {
 		print_error_message(response->error);
 		return;
@@ -88,6 +123,11 @@ get_print_result_message(response_s *response, player_mode_e *mode) {
  */
 void
 get_print_lost_message(response_s *response, player_mode_e *mode) {
+	if (response->error == MSG_RSP_ERROR_TIMED_OUT) {
+		printf("\n\nYou ran out of time. You lost the game!\n");
+		*mode = PLAYER_MODE_LOGGED_IN;
+		return;
+	}
 	if (response->error != MSG_RSP_ERROR_NONE) {
 		print_error_message(response->error);
 		return;
@@ -96,6 +136,21 @@ get_print_lost_message(response_s *response, player_mode_e *mode) {
 	*mode = PLAYER_MODE_LOGGED_IN;
 }
 
+/**
+ * Prints out a message showing that the opponent ran out of time.
+ * @param[in] response Pointer to a message containing error.
+ * @param[in] mode     Pointer to the current mode of a menu level.
+ */
+void
+get_print_win_message(response_s *response, player_mode_e *mode) {
+	if (response->error != MSG_RSP_ERROR_TIMED_OUT) {
+		print_error_message(response->error);
+		return;
+	}
+	printf("\n\nYour opponent ran out of time. You won the game!\n");
+	*mode = PLAYER_MODE_LOGGED_IN;
+}
+
 /**
  * Prints out a message showing that the game has ended with a draw.
  * @param[in] response Pointer to a message containing error.
@@ -110,3 +165,22 @@ get_print_draw_message(response_s *response, player_mode_e *mode) {
 	printf("\n\nThere is a draw! Game has ended.\n");
 	*mode = PLAYER_MODE_LOGGED_IN;
 }
+
+/**
+ * Prints out a notification that a queued quick match has found an opponent.
+ * @param[in] response Pointer to a message containing the game ID.
+ * @param[in] mode     Pointer to the current mode of a menu level.
+ * @param[in] game_id  Pointer to a game ID that a user is currently connected to.
+ */
+void
+get_quick_match_message(response_s *response, player_mode_e *mode,
+		int *game_id) {
+	if (response->error != MSG_RSP_ERROR_NONE) {
+		print_error_message(response->error);
+		return;
+	}
+	if (*mode == PLAYER_MODE_CONNECTED) {
+		*game_id = atoi(response->payload);
+		printf("\n\nOpponent found. Game %d started\n", *game_id);
+	}
+}
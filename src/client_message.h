@@ -14,10 +14,15 @@
 #include "structs.h"
 
 void get_print_board_message(response_s *response);
+void get_print_move_message(response_s *response);
+void get_forced_outcome_message(response_s *response);
 void get_message_from_opponent(response_s *response);
 void get_cleanup_message(response_s *response, player_mode_e *mode);
 void get_print_result_message(response_s *response, player_mode_e *mode);
 void get_print_lost_message(response_s *response, player_mode_e *mode);
+void get_print_win_message(response_s *response, player_mode_e *mode);
 void get_print_draw_message(response_s *response, player_mode_e *mode);
+void get_quick_match_message(response_s *response, player_mode_e *mode,
+		int *game_id);
 
 #endif /* CLIENT_MESSAGE_H_ */
@@ -21,6 +21,7 @@
 #include <netinet/in.h>
 #include <signal.h>
 #include <netdb.h>
+#include <time.h>
 
 #include "config.h"
 
@@ -148,3 +149,25 @@ max(int one, int two) {
 	}
 	return one;
 }
+
+/**
+ * Gets the monotonic time.
+ * @return Current monotonic time in milliseconds.
+ */
+long long
+get_monotonic_ms(void) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec * 1000LL + now.tv_nsec / 1000000;
+}
+
+/**
+ * Gets the monotonic time with the full precision of the clock.
+ * @return Current monotonic time in nanoseconds.
+ */
+long long
+get_monotonic_ns(void) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec * 1000000000LL + now.tv_nsec;
+}
@@ -17,5 +17,7 @@ ssize_t bulk_read(int fd, char *buf, size_t count);
 ssize_t bulk_write(int fd, char *buf, size_t count);
 void read_line(char *buffer, int size);
 int max(int one, int two);
+long long get_monotonic_ms(void);
+long long get_monotonic_ns(void);
 
 #endif /* COMMON_H_ */
@@ -0,0 +1,147 @@
+/**
+ * @file compute_pool.c
+ * @ingroup compute_pool
+ *
+ * @author Piotr Janaszek <janas03@yahoo.pl>
+ * @date Created on: Oct 18, 2026
+ *
+ * @brief File containing methods for running long computations on a pool of worker threads.
+ *
+ * Threads serving clients must never wait for a computation, so they hand it
+ * over to the pool as a job and get the result back through a descriptor they
+ * already watch. The pool has a fixed number of workers taking jobs from one
+ * bounded FIFO queue. A job that does not fit into the queue is refused at
+ * once rather than queued, so the caller can tell its client the server is
+ * busy. Jobs are intrusive: the caller embeds compute_job_s in its own
+ * structure and the job's function owns that structure when it runs.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "config.h"
+#include "structs.h"
+
+/**
+ * Main function of a worker thread. Runs queued jobs until the pool is
+ * stopped and its queue is empty.
+ * @param[in] arg Pointer to the pool.
+ * @return NULL.
+ */
+void*
+compute_worker(void *arg) {
+	compute_pool_s *pool = (compute_pool_s*) arg;
+	compute_job_s *job;
+	pthread_mutex_lock(&pool->mutex);
+	for (;;) {
+		while (pool->head == NULL && !pool->stop) {
+			pthread_cond_wait(&pool->ready, &pool->mutex);
+		}
+		if (pool->head == NULL) {
+			break;
+		}
+		job = pool->head;
+		pool->head = job->next;
+		if (pool->head == NULL) {
+			pool->tail = NULL;
+		}
+		pool->queued--;
+		pthread_mutex_unlock(&pool->mutex);
+		job->run(job);
+		pthread_mutex_lock(&pool->mutex);
+	}
+	pthread_mutex_unlock(&pool->mutex);
+	return NULL;
+}
+
+/**
+ * Creates a compute pool and starts its workers.
+ * @param[in] no_workers Number of worker threads.
+ * @param[in] capacity   Maximum number of jobs waiting in the queue.
+ * @return Pointer to the created pool or NULL upon error.
+ * \sa compute_pool_s
+ */
+compute_pool_s*
+create_compute_pool(int no_workers, int capacity) {
+	int i;
+	compute_pool_s *pool = calloc(1, sizeof(compute_pool_s));
+	if (pool == NULL) {
+		fprintf(stderr, "Cannot allocate memory for compute pool\n");
+		return NULL;
+	}
+	if ((pool->workers = calloc(no_workers, sizeof(pthread_t))) == NULL) {
+		fprintf(stderr, "Cannot allocate memory for compute workers\n");
+		free(pool);
+		return NULL;
+	}
+	pthread_mutex_init(&pool->mutex, NULL);
+	pthread_cond_init(&pool->ready, NULL);
+	pool->capacity = capacity;
+	for (i = 0; i < no_workers; i++) {
+		if (pthread_create(&pool->workers[i], NULL, compute_worker, pool) != 0) {
+			fprintf(stderr, "Cannot start compute worker %d\n", i);
+			break;
+		}
+		pool->no_workers++;
+	}
+	if (pool->no_workers == 0) {
+		pthread_cond_destroy(&pool->ready);
+		pthread_mutex_destroy(&pool->mutex);
+		free(pool->workers);
+		free(pool);
+		return NULL;
+	}
+	return pool;
+}
+
+/**
+ * Queues a job to be run by one of the workers.
+ * @param[in] pool Pointer to the pool.
+ * @param[in] job  Pointer to the job, owned by the pool until it runs.
+ * @retval  0 When the job is queued.
+ * @retval -1 When the queue is full or the pool is stopped.
+ * \sa compute_job_s
+ */
+int
+submit_compute_job(compute_pool_s *pool, compute_job_s *job) {
+	pthread_mutex_lock(&pool->mutex);
+	if (pool->stop || pool->queued >= pool->capacity) {
+		pthread_mutex_unlock(&pool->mutex);
+		return -1;
+	}
+	job->next = NULL;
+	if (pool->tail != NULL) {
+		pool->tail->next = job;
+	} else {
+		pool->head = job;
+	}
+	pool->tail = job;
+	pool->queued++;
+	pthread_cond_signal(&pool->ready);
+	pthread_mutex_unlock(&pool->mutex);
+	return 0;
+}
+
+/**
+ * Stops the pool, lets the workers finish the jobs already queued and
+ * releases the pool.
+ * @param[in] pool Pointer to the pool.
+ */
+void
+destroy_compute_pool(compute_pool_s *pool) {
+	int i;
+	pthread_mutex_lock(&pool->mutex);
+	pool->stop = 1;
+	pthread_cond_broadcast(&pool->ready);
+	pthread_mutex_unlock(&pool->mutex);
+	for (i = 0; i < pool->no_workers; i++) {
+		pthread_join(pool->workers[i], NULL);
+	}
+	pthread_cond_destroy(&pool->ready);
+	pthread_mutex_destroy(&pool->mutex);
+	free(pool->workers);
+	free(pool);
+}
@@ -0,0 +1,20 @@
+/**
+ * @file compute_pool.h
+ * @ingroup compute_pool
+ *
+ * @author Piotr Janaszek <janas03@yahoo.pl>
+ * @date Created on: Oct 18, 2026
+ *
+ * @brief File containing methods for running long computations on a pool of worker threads.
+ */
+
+#ifndef COMPUTE_POOL_H_
+#define COMPUTE_POOL_H_
+
+#include "structs.h"
+
+compute_pool_s* create_compute_pool(int no_workers, int capacity);
+int submit_compute_job(compute_pool_s *pool, compute_job_s *job);
+void destroy_compute_pool(compute_pool_s *pool);
+
+#endif /* COMPUTE_POOL_H_ */
@@ -38,6 +38,113 @@
  */
 #define SPECTATORS_NO 5
 
+/**
+ * Largest game ID.
+ */
+#define MAX_GAME_ID 100
+
+/**
+ * Number of hexadecimal digits of a session token.
+ */
+#define SESSION_TOKEN_LEN 16
+
+/**
+ * Time the seat of a player who lost the connection is kept for the player
+ * to resume the game, in milliseconds.
+ */
+#define SESSION_GRACE_MS 30000
+
+/**
+ * Length of a tick of the timing wheels, in milliseconds.
+ */
+#define TIMER_TICK_MS 10
+
+/**
+ * Number of slots in a level of a timing wheel.
+ */
+#define TIMER_WHEEL_SLOTS 64
+
+/**
+ * Number of levels of a timing wheel, enough for any monotonic time.
+ */
+#define TIMER_WHEEL_LEVELS 8
+
+/**
+ * Time a player has for a move before losing the game, in milliseconds.
+ */
+#define MOVE_CLOCK_MS 120000
+
+/**
+ * Time a client may stay in the lobby without sending a request before it is
+ * disconnected, in milliseconds.
+ */
+#define LOBBY_IDLE_MS 900000
+
+/**
+ * Time of silence after which a client is pinged, in milliseconds.
+ */
+#define KEEPALIVE_MS 30000
+
+/**
+ * Time a pinged client has to answer before it is disconnected, in milliseconds.
+ */
+#define KEEPALIVE_REPLY_MS 10000
+
+/**
+ * Time a game waits for its second player before it is removed, in milliseconds.
+ */
+#define WAITING_GAME_MS 600000
+
+/**
+ * Port of the local admin endpoint serving metrics, 0 leaves it off.
+ */
+#define METRICS_PORT 0
+
+/**
+ * Number of buckets of a metrics histogram: 8 sub-buckets for every power of
+ * two up to 2^36, about 69 seconds in nanoseconds.
+ */
+#define METRICS_HISTOGRAM_BUCKETS 280
+
+/**
+ * Lowest level of log entries built in: 0 debug, 1 info, 2 warning, 3 error.
+ * Calls logging below it compile to nothing. Debug builds log everything.
+ */
+#ifndef LOG_LEVEL
+#ifdef DEBUG
+#define LOG_LEVEL 0
+#else
+#define LOG_LEVEL 1
+#endif
+#endif
+
+/**
+ * Number of entries of the log ring of a thread, a power of two. Entries
+ * logged while the ring is full are dropped and counted.
+ */
+#define LOG_RING_SIZE 1024
+
+/**
+ * Maximum number of integer arguments of a log entry formatted by the
+ * flusher.
+ */
+#define LOG_ARGS_NO 4
+
+/**
+ * Size of the text of a log entry formatted by the logging thread.
+ */
+#define LOG_TEXT_SIZE 112
+
+/**
+ * Interval between flushes of the log rings, in milliseconds.
+ */
+#define LOG_FLUSH_MS 20
+
+/**
+ * Maximum number of threads reading the lobby without blocking writers.
+ */
+#define LOBBY_READERS 8
+
 /**
  * Message delimiter. It is used to separate header (and error) from payload.
  */
@@ -74,6 +181,66 @@
  */
 #define MAX_BOARD_SIZE 20
 
+/**
+ * Number of consecutive pawns needed to win a game.
+ */
+#define WIN_LENGTH 4
+
+/**
+ * Largest size of a sparse board. Boards larger than MAX_BOARD_SIZE only
+ * store occupied fields, and size 0 stands for an unbounded board.
+ */
+#define MAX_SPARSE_BOARD_SIZE 1000
+
+/**
+ * Largest absolute value of a coordinate of a move on an unbounded board.
+ */
+#define SPARSE_COORD_LIMIT 1000000
+
+/**
+ * Number of fields a sparse board makes room for when it is created.
+ */
+#define SPARSE_INITIAL_CELLS 64
+
+/**
+ * Number of occupied fields sent in one response to a print cells request.
+ */
+#define CELLS_PER_PAGE 20
+
+/**
+ * Restriction set on the number of consecutive pawns needed to win a game.
+ */
+#define MIN_WIN_LENGTH 3
+
+/**
+ * Restriction set on the number of consecutive pawns needed to win a game.
+ */
+#define MAX_WIN_LENGTH 6
+
+/**
+ * Distance in bits between vertically adjacent fields of the largest bitboard.
+ * Every row is followed by one empty guard bit so that shifted lines never wrap
+ * from one row into the next.
+ */
+#define BOARD_STRIDE (MAX_BOARD_SIZE + 1)
+
+/**
+ * Number of 64-bit words holding a bitset of the largest board.
+ */
+#define BOARD_WORDS ((MAX_BOARD_SIZE * BOARD_STRIDE + 63) / 64)
+
+/**
+ * Distance in bytes between vertically adjacent fields of a scanner grid.
+ * Columns past the board are padding, so a whole row fits one 32-byte vector.
+ */
+#define GRID_STRIDE 32
+
+/**
+ * Number of rows of a scanner grid. Rows past the board are padding, so lines
+ * starting at any field can be read without bounds checks.
+ */
+#define GRID_ROWS (MAX_BOARD_SIZE + MAX_WIN_LENGTH)
+
 /**
  * Restriction set while creating a new game.
  */
@@ -99,4 +266,209 @@
  */
 #define MAX_NICK_LEN 32
 
+/**
+ * Alignment of blocks carved out of a memory arena.
+ */
+#define ARENA_ALIGNMENT 16
+
+/**
+ * Size of a CPU cache line. Boards are aligned to it.
+ */
+#define CACHE_LINE_SIZE 64
+
+/**
+ * Seed of the generator drawing Zobrist keys. Changing it changes the hash of
+ * every position.
+ */
+#define ZOBRIST_SEED 0x46494c4e4f4c4953ULL
+
+/**
+ * Number of worker threads searching moves for bots.
+ */
+#define BOT_THREADS 2
+
+/**
+ * Number of searches that may wait for a free worker.
+ */
+#define BOT_QUEUE_CAPACITY 64
+
+/**
+ * Time a bot thinks over a move when a game does not set it, in milliseconds.
+ */
+#define BOT_BUDGET_MS 1000
+
+/**
+ * Restriction set on the time a bot thinks over a move, in milliseconds.
+ */
+#define MIN_BOT_BUDGET_MS 10
+
+/**
+ * Restriction set on the time a bot thinks over a move, in milliseconds.
+ */
+#define MAX_BOT_BUDGET_MS 10000
+
+/**
+ * Deepest iteration of a bot search, in moves.
+ */
+#define BOT_MAX_DEPTH 32
+
+/**
+ * Number of best ordered moves a bot searches in every position.
+ */
+#define BOT_MAX_BRANCHING 16
+
+/**
+ * Distance from the pawns on the board within which a bot considers moves.
+ */
+#define BOT_NEIGHBOURHOOD 2
+
+/**
+ * Number of entries of the transposition table shared by all bot searches,
+ * a power of two.
+ */
+#define BOT_TT_ENTRIES (1 << 18)
+
+/**
+ * Interval after which a game thread retries a bot search refused by a busy
+ * compute pool, in nanoseconds.
+ */
+#define BOT_RETRY_NS 100000000
+
+/**
+ * Nick name of bots.
+ */
+#define BOT_NICK "bot"
+
+/**
+ * Number of Monte Carlo trees searched in parallel for one move of a bot.
+ */
+#define MCTS_TREES 2
+
+/**
+ * Number of random playouts run together in lockstep from every new leaf of
+ * a Monte Carlo tree. Lanes are checked four at a time and reported in a
+ * 32-bit mask, so it is a multiple of 4 up to 32.
+ */
+#define MCTS_BATCH 32
+
+/**
+ * Maximum number of nodes of one Monte Carlo tree.
+ */
+#define MCTS_MAX_NODES (1 << 16)
+
+/**
+ * Weight of exploration in the UCT formula choosing moves in a Monte Carlo tree.
+ */
+#define MCTS_EXPLORATION 1.4
+
+/**
+ * Default number of playouts the analyzer runs for every position.
+ */
+#define ANALYZER_PLAYOUTS 20000
+
+/**
+ * Number of bytes of recorded games the verifier hands out to a worker at a
+ * time. Workers steal chunks from each other when they run out of their own.
+ */
+#define VERIFIER_CHUNK_SIZE (1 << 16)
+
+/**
+ * Default name of the game journal. Segments of the journal are files named
+ * after it with a six-digit number appended.
+ */
+#define JOURNAL_NAME "server.journal"
+
+/**
+ * Default durability level of the game journal, JOURNAL_DURABILITY_GROUP.
+ */
+#define JOURNAL_DURABILITY 2
+
+/**
+ * Default interval between syncs of the game journal, in milliseconds.
+ * Records written meanwhile are synced together.
+ */
+#define JOURNAL_FSYNC_MS 10
+
+/**
+ * Size of each of the two buffers journal records are gathered in.
+ */
+#define JOURNAL_BUFFER_SIZE (1 << 20)
+
+/**
+ * Size after which the journal continues in a new segment.
+ */
+#define JOURNAL_SEGMENT_SIZE (64 << 20)
+
+/**
+ * Number of journal records checked as one piece of work while games are
+ * recovered from the journal.
+ */
+#define RECOVERY_CHUNK_RECORDS (1 << 16)
+
+/**
+ * Interval between recovery progress reports, in milliseconds.
+ */
+#define RECOVERY_PROGRESS_MS 250
+
+/**
+ * Largest board size solved tables are made for.
+ */
+#define MAX_SOLVED_SIZE 6
+
+/**
+ * Name of the file of a solved table, made of the board size, the win length
+ * and the game mode. Tables are looked for in the working directory.
+ */
+#define SOLVED_TABLE_NAME "solved_%d_%d_%d.tbl"
+
+/**
+ * Magic bytes starting every solved table file.
+ */
+#define SOLVED_TABLE_MAGIC "FILNSLV1"
+
+/**
+ * Number of entries of the transposition table shared by solver threads.
+ */
+#define SOLVER_TT_ENTRIES (1 << 22)
+
+/**
+ * Default number of moves from the empty board within which the solver
+ * stores every position in the table.
+ */
+#define SOLVER_STORED_PLIES 8
+
+/**
+ * Number of worker threads of the pool searching hints and analyses. It is
+ * separate from the bot pool, so analyses never delay bots' moves.
+ */
+#define HINT_THREADS 1
+
+/**
+ * Number of hint searches that may wait in the queue. Requests beyond it are
+ * refused as busy at once.
+ */
+#define HINT_QUEUE_CAPACITY 8
+
+/**
+ * Time within which a hint request is answered, in milliseconds. A search
+ * still queued at the deadline is not run and one running stops at it.
+ */
+#define HINT_DEADLINE_MS 1500
+
+/**
+ * Time a hint search runs for when it starts well before its deadline, in
+ * milliseconds.
+ */
+#define HINT_SEARCH_MS 500
+
+/**
+ * Number of entries of the cache of hint results, a power of two.
+ */
+#define HINT_CACHE_ENTRIES 1024
+
+/**
+ * Maximum number of requests waiting for one running hint search.
+ */
+#define HINT_WAITERS 8
+
 #endif /* CONFIG_H_ */
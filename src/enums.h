@@ -56,7 +56,24 @@ typedef enum {
 	MSG_PRINT_WIN_RSP,
 	MSG_PRINT_LOST_RSP,
 	MSG_PRINT_DRAW_RSP,
-	MSG_CLEANUP_RSP
+	MSG_CLEANUP_RSP,
+	MSG_QUICK_MATCH_REQ,
+	MSG_QUICK_MATCH_RSP,
+	MSG_PRINT_CELLS_REQ,
+	MSG_PRINT_CELLS_RSP,
+	MSG_PRINT_MOVE_SPC_RSP,
+	MSG_CREATE_BOT_GAME_REQ,
+	MSG_CREATE_BOT_GAME_RSP,
+	MSG_FORCED_OUTCOME_SPC_RSP,
+	MSG_HINT_REQ,
+	MSG_HINT_RSP,
+	MSG_ANALYZE_REQ,
+	MSG_ANALYZE_RSP,
+	MSG_RESUME_REQ,
+	MSG_RESUME_RSP,
+	MSG_KEEPALIVE_REQ,
+	MSG_KEEPALIVE_RSP,
+	MSG_TYPES_NO
 } message_type_e;
 
 /**
@@ -72,7 +89,18 @@ typedef enum {
 	MSG_RSP_ERROR_TOO_MANY_SPECTATORS,
 	MSG_RSP_ERROR_WRONG_TURN,
 	MSG_RSP_ERROR_WRONG_MOVE,
-	MSG_RSP_ERROR_WAIT_OPPONENT
+	MSG_RSP_ERROR_WAIT_OPPONENT,
+	MSG_RSP_ERROR_WRONG_WIN_LENGTH,
+	MSG_RSP_ERROR_BOARD_TOO_LARGE,
+	MSG_RSP_ERROR_WRONG_GAME_MODE,
+	MSG_RSP_ERROR_WRONG_BOT_BUDGET,
+	MSG_RSP_ERROR_WRONG_BOT_ENGINE,
+	MSG_RSP_ERROR_SERVER_BUSY,
+	MSG_RSP_ERROR_DEADLINE_EXCEEDED,
+	MSG_RSP_ERROR_WRONG_POSITION,
+	MSG_RSP_ERROR_WRONG_PLAYER,
+	MSG_RSP_ERROR_WRONG_SESSION,
+	MSG_RSP_ERROR_TIMED_OUT
 } message_error_e;
 
 /**
@@ -84,4 +112,125 @@ typedef enum {
 	GAME_STATE_RESOLVED
 } game_state_e;
 
+/**
+ * The enumeration of a game mode chosen when a game is created.
+ */
+typedef enum {
+	GAME_MODE_FREE = 0, /**< A pawn may be put on any empty field. */
+	GAME_MODE_GRAVITY, /**< A pawn is dropped into a column and falls to its lowest empty field. */
+	GAME_MODES_NO
+} game_mode_e;
+
+/**
+ * The enumeration of a bound stored with a score in the transposition table.
+ */
+typedef enum {
+	TT_BOUND_EXACT = 1,
+	TT_BOUND_LOWER,
+	TT_BOUND_UPPER
+} tt_bound_e;
+
+/**
+ * The enumeration of engines a bot may search its moves with.
+ */
+typedef enum {
+	BOT_ENGINE_ALPHA_BETA = 0,
+	BOT_ENGINE_MCTS,
+	BOT_ENGINES_NO
+} bot_engine_e;
+
+/**
+ * The enumeration of records of the game journal.
+ */
+typedef enum {
+	JOURNAL_GAME_CREATED = 1,
+	JOURNAL_GAME_STARTED,
+	JOURNAL_MOVE,
+	JOURNAL_GAME_ENDED
+} journal_record_e;
+
+/**
+ * The enumeration of durability levels of the game journal: no journal,
+ * records written to the file, written and synced every few milliseconds,
+ * or synced before a move is answered.
+ */
+typedef enum {
+	JOURNAL_DURABILITY_OFF = 0,
+	JOURNAL_DURABILITY_WRITE,
+	JOURNAL_DURABILITY_GROUP,
+	JOURNAL_DURABILITY_SYNC,
+	JOURNAL_DURABILITIES_NO
+} journal_durability_e;
+
+/**
+ * The enumeration of what a timer times.
+ */
+typedef enum {
+	TIMER_LOBBY_IDLE = 0, /**< A client in the lobby sends no requests. */
+	TIMER_KEEPALIVE, /**< A client is due to be pinged. */
+	TIMER_KEEPALIVE_REPLY, /**< A pinged client has not answered. */
+	TIMER_WAITING_GAME, /**< A game waits for its second player. */
+	TIMER_MOVE_CLOCK, /**< The player to move thinks. */
+	TIMER_KEPT_SEAT /**< The seat of a disconnected player is kept. */
+} timer_e;
+
+/**
+ * The enumeration of counters of the metrics registry. Gauges are exported
+ * as the difference of a pair of counters, so both ends may be counted by
+ * different threads.
+ */
+typedef enum {
+	METRIC_CONNECTIONS_OPENED = 0,
+	METRIC_CONNECTIONS_CLOSED,
+	METRIC_GAMES_ADDED,
+	METRIC_GAMES_REMOVED,
+	METRIC_SPECTATORS_JOINED,
+	METRIC_SPECTATORS_LEFT,
+	METRIC_BYTES_IN,
+	METRIC_BYTES_OUT,
+	METRIC_MAIN_LOOP_ITERATIONS,
+	METRIC_GAME_LOOP_ITERATIONS,
+	METRIC_COUNTERS_NO
+} metrics_counter_e;
+
+/**
+ * The enumeration of log levels. LOG_LEVEL in config.h holds the lowest level
+ * built in, as its number.
+ */
+typedef enum {
+	LOG_LEVEL_DEBUG = 0,
+	LOG_LEVEL_INFO,
+	LOG_LEVEL_WARNING,
+	LOG_LEVEL_ERROR,
+	LOG_LEVELS_NO
+} log_level_e;
+
+/**
+ * The enumeration of bitsets kept by a board.
+ */
+typedef enum {
+	BOARD_BITS_X = 0,
+	BOARD_BITS_O,
+	BOARD_BITS_OCCUPIED,
+	BOARD_BITS_NO
+} board_bits_e;
+
+/**
+ * The enumeration of lists served from the lobby.
+ */
+typedef enum {
+	LOBBY_FILTER_GAMES = 0,
+	LOBBY_FILTER_PLAYERS,
+	LOBBY_FILTERS_NO
+} lobby_filter_e;
+
+/**
+ * The enumeration of a cached lobby payload state.
+ */
+typedef enum {
+	LOBBY_PAYLOAD_EMPTY = 0,
+	LOBBY_PAYLOAD_ENCODING,
+	LOBBY_PAYLOAD_READY
+} lobby_payload_e;
+
 #endif /* ENUMS_H_ */
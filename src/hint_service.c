@@ -0,0 +1,364 @@
+/**
+ * @file hint_service.c
+ * @ingroup hint_service
+ *
+ * @author Piotr Janaszek <janas03@yahoo.pl>
+ * @date Created on: Oct 18, 2026
+ *
+ * @brief File containing methods for serving hints and analyses of positions.
+ *
+ * A hint is a suggested move and the chance of the player to move to win,
+ * found with a Monte Carlo tree search. Searches run on a compute pool of
+ * their own with a short queue: a request finding the queue full is refused
+ * as busy at once, and every request has a deadline after which it is
+ * answered with an error instead of a move. Positions in solved tables are
+ * answered at once. Results are cached by the canonical key of the position,
+ * so symmetric copies share them, and a request for a position already being
+ * searched waits for that search. The thread serving a client never waits
+ * for a search: finished hints are written to a pipe the thread watches
+ * together with its clients, and the thread sends them on.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+
+#include "common.h"
+#include "compute_pool.h"
+#include "config.h"
+#include "mcts.h"
+#include "solved_table.h"
+#include "structs.h"
+
+/**
+ * The pool running hint searches.
+ */
+static compute_pool_s *hint_pool = NULL;
+
+/**
+ * The cache of hint results indexed by canonical keys.
+ */
+static hint_result_s *hint_cache = NULL;
+
+/**
+ * Searches queued or running.
+ */
+static hint_job_s *hint_jobs = NULL;
+
+/**
+ * Flag stopping running searches when the service stops.
+ */
+static int hint_stopping = 0;
+
+/**
+ * Mutex guarding the cache, the running searches and their waiters.
+ */
+static pthread_mutex_t hint_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Starts the pool running hint searches. It has to be called before any
+ * hint is requested.
+ * @retval  0 Upon success.
+ * @retval -1 When the pool or the cache cannot be created.
+ */
+int
+start_hint_service(void) {
+	int i;
+	if ((hint_cache = malloc(HINT_CACHE_ENTRIES * sizeof(hint_result_s)))
+			== NULL) {
+		fprintf(stderr, "Cannot allocate memory for hint cache\n");
+		return -1;
+	}
+	for (i = 0; i < HINT_CACHE_ENTRIES; i++) {
+		hint_cache[i].move = -1;
+	}
+	if ((hint_pool = create_compute_pool(HINT_THREADS, HINT_QUEUE_CAPACITY))
+			== NULL) {
+		free(hint_cache);
+		hint_cache = NULL;
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * Stops the hint pool. Running searches stop at once and queued ones are
+ * answered with an error.
+ */
+void
+stop_hint_service(void) {
+	__atomic_store_n(&hint_stopping, 1, __ATOMIC_RELAXED);
+	destroy_compute_pool(hint_pool);
+	hint_pool = NULL;
+	free(hint_cache);
+	hint_cache = NULL;
+}
+
+/**
+ * Creates a channel finished hints are sent to a thread through.
+ * @return Pointer to the created channel or NULL upon error.
+ * \sa hint_channel_s
+ */
+hint_channel_s*
+create_hint_channel(void) {
+	hint_channel_s *channel = malloc(sizeof(hint_channel_s));
+	if (channel == NULL) {
+		fprintf(stderr, "Cannot allocate memory for hint channel\n");
+		return NULL;
+	}
+	if (pipe(channel->fds) == -1) {
+		perror("pipe");
+		free(channel);
+		return NULL;
+	}
+	fcntl(channel->fds[0], F_SETFL, fcntl(channel->fds[0], F_GETFL) | O_NONBLOCK);
+	fcntl(channel->fds[1], F_SETFL, fcntl(channel->fds[1], F_GETFL) | O_NONBLOCK);
+	return channel;
+}
+
+/**
+ * Closes a channel. Requests still waiting for searches are forgotten, the
+ * searches themselves go on and fill the cache.
+ * @param[in] channel Pointer to the channel or NULL.
+ */
+void
+close_hint_channel(hint_channel_s *channel) {
+	int i, kept;
+	hint_job_s *hint;
+	if (channel == NULL) {
+		return;
+	}
+	pthread_mutex_lock(&hint_mutex);
+	for (hint = hint_jobs; hint != NULL; hint = hint->next) {
+		for (i = 0, kept = 0; i < hint->no_waiters; i++) {
+			if (hint->waiters[i].channel != channel) {
+				hint->waiters[kept++] = hint->waiters[i];
+			}
+		}
+		hint->no_waiters = kept;
+	}
+	pthread_mutex_unlock(&hint_mutex);
+	close(channel->fds[0]);
+	close(channel->fds[1]);
+	free(channel);
+}
+
+/**
+ * Reads a finished hint from a channel.
+ * @param[in]  channel Pointer to the channel.
+ * @param[out] notice  Pointer to the hint.
+ * @retval  0 When a hint is read.
+ * @retval -1 When there is no hint left.
+ */
+int
+read_hint_notice(hint_channel_s *channel, hint_notice_s *notice) {
+	return read(channel->fds[0], notice, sizeof(hint_notice_s))
+			== sizeof(hint_notice_s) ? 0 : -1;
+}
+
+/**
+ * Builds the response carrying a hint: the move, with coordinates counted
+ * from 1, and the chance of the player to move to win.
+ * @param[in]  notice   Pointer to the hint.
+ * @param[out] response Pointer to the response.
+ * \sa hint_notice_s response_s
+ */
+void
+get_hint_response(const hint_notice_s *notice, response_s *response) {
+	response->type = notice->type;
+	response->error = notice->error;
+	response->payload[0] = '\0';
+	if (notice->error == MSG_RSP_ERROR_NONE) {
+		snprintf(response->payload, MAX_RSP_SIZE, "%d%s%d%s%.3f%s",
+				notice->move / notice->size + 1, PAYLOAD_DELIM,
+				notice->move % notice->size + 1, PAYLOAD_DELIM, notice->value,
+				PAYLOAD_DELIM);
+	}
+}
+
+/**
+ * Gets the cache entry of a position.
+ * @param[in] search Pointer to the position.
+ * @param[in] key    Canonical key of the position.
+ * @return Pointer to the entry, which may hold another position.
+ */
+hint_result_s*
+get_hint_entry(const search_s *search, uint64_t key) {
+	return &hint_cache[(key ^ (uint64_t) search->win_length << 40
+			^ (uint64_t) search->mode << 48) & (HINT_CACHE_ENTRIES - 1)];
+}
+
+/**
+ * Sends a finished search to all requests waiting for it. It has to be called
+ * with the hint mutex locked.
+ * @param[in] hint   Pointer to the search.
+ * @param[in] error  Error of the responses.
+ * @param[in] move   The best move in the canonical copy.
+ * @param[in] value  Chance of the player to move to win.
+ */
+void
+notify_hint_waiters(hint_job_s *hint, message_error_e error, int move,
+		double value) {
+	int i;
+	hint_notice_s notice;
+	memset(&notice, 0, sizeof(hint_notice_s));
+	notice.error = error;
+	notice.size = hint->search.size;
+	notice.value = value;
+	for (i = 0; i < hint->no_waiters; i++) {
+		notice.client_fd = hint->waiters[i].client_fd;
+		notice.type = hint->waiters[i].type;
+		notice.move = error == MSG_RSP_ERROR_NONE ?
+				transform_cell(hint->search.size, hint->waiters[i].transform,
+						move, 1) : -1;
+		/* notices are shorter than PIPE_BUF, so writes are never split */
+		if (write(hint->waiters[i].channel->fds[1], &notice,
+				sizeof(hint_notice_s)) != sizeof(hint_notice_s)) {
+			fprintf(stderr, "(Hint) Cannot send a hint to a thread\n");
+		}
+	}
+}
+
+/**
+ * Runs a hint search on a worker of the hint pool and sends the result to
+ * the waiting requests.
+ * @param[in] job Pointer to the job embedded in a hint job.
+ * \sa hint_job_s
+ */
+void
+run_hint_search(compute_job_s *job) {
+	int move = -1;
+	double value = 0;
+	long long now = get_monotonic_ms();
+	message_error_e error = MSG_RSP_ERROR_DEADLINE_EXCEEDED;
+	hint_job_s *hint = (hint_job_s*) job, **link;
+	hint_result_s *entry;
+	mcts_stats_s *stats;
+	if (now < hint->deadline && !__atomic_load_n(&hint_stopping,
+			__ATOMIC_RELAXED) && (stats = calloc(1, sizeof(mcts_stats_s)))
+			!= NULL) {
+		hint->search.deadline = now + HINT_SEARCH_MS < hint->deadline ?
+				now + HINT_SEARCH_MS : hint->deadline;
+		hint->search.max_playouts = 0;
+		hint->search.cancelled = &hint_stopping;
+		if (run_mcts(&hint->search, hint->key, stats) == 0
+				&& (move = get_mcts_move(stats,
+						hint->search.size * hint->search.size, &value)) != -1) {
+			move = transform_cell(hint->search.size, hint->transform, move, 0);
+			error = MSG_RSP_ERROR_NONE;
+		}
+		free(stats);
+	}
+	pthread_mutex_lock(&hint_mutex);
+	for (link = &hint_jobs; *link != hint; link = &(*link)->next) {
+	}
+	*link = hint->next;
+	if (error == MSG_RSP_ERROR_NONE && hint_cache != NULL) {
+		entry = get_hint_entry(&hint->search, hint->key);
+		entry->key = hint->key;
+		entry->size = hint->search.size;
+		entry->win_length = hint->search.win_length;
+		entry->mode = hint->search.mode;
+		entry->move = move;
+		entry->value = value;
+	}
+	notify_hint_waiters(hint, error, move, value);
+	pthread_mutex_unlock(&hint_mutex);
+	free(hint);
+}
+
+/**
+ * Requests a hint for a position. The answer is given at once when the
+ * position is solved or cached, or when the request is refused. Otherwise
+ * the request waits for a search, a running one for the same position or a
+ * new one, and the answer comes through the channel.
+ * @param[in]  channel   Pointer to the channel of the thread serving the client.
+ * @param[in]  client_fd File descriptor of the client.
+ * @param[in]  type      Type of the response.
+ * @param[in]  search    Pointer to the position.
+ * @param[out] notice    Pointer to the answer given at once.
+ * @retval 1 When the answer is given at once.
+ * @retval 0 When the answer comes through the channel.
+ * \sa hint_channel_s hint_notice_s
+ */
+int
+request_hint(hint_channel_s *channel, int client_fd, message_type_e type,
+		const search_s *search, hint_notice_s *notice) {
+	int transform, outcome, move;
+	uint64_t key;
+	hint_result_s *entry;
+	hint_job_s *hint;
+	memset(notice, 0, sizeof(hint_notice_s));
+	notice->client_fd = client_fd;
+	notice->type = type;
+	notice->size = search->size;
+	notice->error = MSG_RSP_ERROR_NONE;
+	if (search->no_empty == 0) {
+		notice->error = MSG_RSP_ERROR_WRONG_POSITION;
+		return 1;
+	}
+	if (lookup_solved_position(search->size, search->win_length, search->mode,
+			search->cells, &outcome, &move) == 0 && move != -1) {
+		notice->move = move;
+		notice->value = (outcome + 1) / 2.0;
+		return 1;
+	}
+	notice->error = MSG_RSP_ERROR_SERVER_BUSY;
+	if (channel == NULL || hint_pool == NULL) {
+		return 1;
+	}
+	key = get_canonical_key(search->cells, search->size, search->mode,
+			&transform);
+	pthread_mutex_lock(&hint_mutex);
+	entry = get_hint_entry(search, key);
+	if (entry->move != -1 && entry->key == key && entry->size == search->size
+			&& entry->win_length == search->win_length
+			&& entry->mode == search->mode) {
+		notice->error = MSG_RSP_ERROR_NONE;
+		notice->move = transform_cell(search->size, transform, entry->move, 1);
+		notice->value = entry->value;
+		pthread_mutex_unlock(&hint_mutex);
+		return 1;
+	}
+	for (hint = hint_jobs; hint != NULL; hint = hint->next) {
+		if (hint->key == key && hint->search.size == search->size
+				&& hint->search.win_length == search->win_length
+				&& hint->search.mode == search->mode) {
+			break;
+		}
+	}
+	if (hint == NULL) {
+		if ((hint = malloc(sizeof(hint_job_s))) == NULL) {
+			pthread_mutex_unlock(&hint_mutex);
+			return 1;
+		}
+		hint->job.run = run_hint_search;
+		hint->search = *search;
+		hint->key = key;
+		hint->transform = transform;
+		hint->deadline = get_monotonic_ms() + HINT_DEADLINE_MS;
+		hint->no_waiters = 0;
+		if (submit_compute_job(hint_pool, &hint->job) == -1) {
+			pthread_mutex_unlock(&hint_mutex);
+			free(hint);
+			return 1;
+		}
+		/* the worker locks the mutex before it looks for the search */
+		hint->next = hint_jobs;
+		hint_jobs = hint;
+	} else if (hint->no_waiters == HINT_WAITERS) {
+		pthread_mutex_unlock(&hint_mutex);
+		return 1;
+	}
+	hint->waiters[hint->no_waiters].channel = channel;
+	hint->waiters[hint->no_waiters].client_fd = client_fd;
+	hint->waiters[hint->no_waiters].type = type;
+	hint->waiters[hint->no_waiters].transform = transform;
+	hint->no_waiters++;
+	pthread_mutex_unlock(&hint_mutex);
+	return 0;
+}
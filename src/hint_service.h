@@ -0,0 +1,25 @@
+/**
+ * @file hint_service.h
+ * @ingroup hint_service
+ *
+ * @author Piotr Janaszek <janas03@yahoo.pl>
+ * @date Created on: Oct 18, 2026
+ *
+ * @brief File containing methods for serving hints and analyses of positions.
+ */
+
+#ifndef HINT_SERVICE_H_
+#define HINT_SERVICE_H_
+
+#include "structs.h"
+
+int start_hint_service(void);
+void stop_hint_service(void);
+hint_channel_s* create_hint_channel(void);
+void close_hint_channel(hint_channel_s *channel);
+int read_hint_notice(hint_channel_s *channel, hint_notice_s *notice);
+void get_hint_response(const hint_notice_s *notice, response_s *response);
+int request_hint(hint_channel_s *channel, int client_fd, message_type_e type,
+		const search_s *search, hint_notice_s *notice);
+
+#endif /* HINT_SERVICE_H_ */
@@ -0,0 +1,413 @@
+/**
+ * @file journal.c
+ * @ingroup journal
+ *
+ * @author Piotr Janaszek <janas03@yahoo.pl>
+ * @date Created on: Oct 18, 2026
+ *
+ * @brief File containing methods for writing the game journal.
+ *
+ * Every game creation, start, accepted move and game end is appended to a
+ * binary journal as a fixed-size record, so games can be told again after a
+ * crash. Game threads only copy their record into the active buffer under a
+ * mutex; a flusher thread swaps the buffers, writes the full one out and
+ * syncs the file, so all records gathered since the previous write share a
+ * single write and a single sync (a group commit). How long the flusher
+ * gathers records and whether it syncs depends on the durability level: in
+ * the sync level a game thread waits for the sync of its record before the
+ * move is answered, in the other levels it does not wait at all. The journal
+ * is split into segments, each opened after the last one found on disk.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <sys/stat.h>
+#include <pthread.h>
+
+#include "config.h"
+#include "structs.h"
+
+/**
+ * The open journal or NULL when journaling is off.
+ */
+static journal_s *journal = NULL;
+
+/**
+ * Computes the checksum of a record: the FNV-1a hash of all its bytes
+ * following the checksum itself.
+ * @param[in] record Pointer to the record.
+ * @return The checksum.
+ * \sa journal_record_s
+ */
+uint32_t
+get_journal_checksum(const journal_record_s *record) {
+	size_t i;
+	uint32_t hash = 2166136261u;
+	const unsigned char *bytes = (const unsigned char*) record;
+	for (i = sizeof(record->checksum); i < sizeof(journal_record_s); i++) {
+		hash = (hash ^ bytes[i]) * 16777619u;
+	}
+	return hash;
+}
+
+/**
+ * Opens a journal segment for writing.
+ * @param[in] name    Name the segments are named after.
+ * @param[in] segment Number of the segment.
+ * @return File descriptor of the segment or -1 upon error.
+ */
+int
+open_journal_segment(const char *name, int segment) {
+	char path[300];
+	snprintf(path, sizeof(path), "%s.%06d", name, segment);
+	return TEMP_FAILURE_RETRY(open(path, O_WRONLY | O_CREAT | O_EXCL | O_APPEND,
+			S_IRUSR | S_IWUSR | S_IRGRP));
+}
+
+/**
+ * Writes a buffer out to the open segment, continuing in a new segment when
+ * the open one is full, and syncs it unless the durability level says not
+ * to. It runs without the mutex held, only the flusher touches the file.
+ * When a new segment cannot be opened the descriptor is left at -1.
+ * @param[in] data   The records.
+ * @param[in] length Length of the records in bytes.
+ * @retval  0 Upon success.
+ * @retval -1 When the records cannot be written, with errno set.
+ */
+int
+write_journal_buffer(const char *data, size_t length) {
+	ssize_t written;
+	if (journal->fd == -1) {
+		errno = EBADF;
+		return -1;
+	}
+	if (journal->segment_size > 0
+			&& journal->segment_size + length > JOURNAL_SEGMENT_SIZE) {
+		if (journal->durability >= JOURNAL_DURABILITY_GROUP
+				&& fdatasync(journal->fd) == -1) {
+			return -1;
+		}
+		close(journal->fd);
+		journal->segment_size = 0;
+		if ((journal->fd = open_journal_segment(journal->name,
+				++journal->segment)) == -1) {
+			return -1;
+		}
+	}
+	while (length > 0) {
+		if ((written = TEMP_FAILURE_RETRY(write(journal->fd, data, length)))
+				< 0) {
+			return -1;
+		}
+		data += written;
+		length -= written;
+		journal->segment_size += written;
+	}
+	if (journal->durability >= JOURNAL_DURABILITY_GROUP
+			&& fdatasync(journal->fd) == -1) {
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * Stops journaling after a buffer could not be written out. Records that are
+ * not durable yet stay that way and new ones are no longer appended. In the
+ * sync level moves are answered only once they are synced, so the server
+ * cannot go on and exits; restarting it recovers the games from the records
+ * synced so far.
+ * @param[in] error The errno of the failed write.
+ */
+void
+fail_journal(int error) {
+	fprintf(stderr, "Journal %s.%06d cannot be written: %s\n", journal->name,
+			journal->segment, strerror(error));
+	if (journal->durability == JOURNAL_DURABILITY_SYNC) {
+		fprintf(stderr, "Moves cannot be made durable, exiting\n");
+		exit(EXIT_FAILURE);
+	}
+	fprintf(stderr, "Journaling stopped, games from now on cannot be "
+			"recovered\n");
+	if (journal->fd != -1) {
+		close(journal->fd);
+		journal->fd = -1;
+	}
+}
+
+/**
+ * The flusher thread. It waits for records, gives other threads the sync
+ * interval to add theirs unless they wait for the sync, then writes the
+ * gathered buffer out while the other buffer takes new records. Records
+ * count as durable only once their write, and sync if any, succeeded.
+ * @param[in] arg Unused.
+ * @return NULL.
+ */
+void*
+flush_journal(void *arg) {
+	int full, error;
+	size_t length;
+	uint64_t appended;
+	struct timespec deadline;
+	pthread_mutex_lock(&journal->mutex);
+	while (!journal->stop || journal->used > 0) {
+		if (journal->failed) {
+			journal->used = 0;
+		}
+		if (journal->used == 0) {
+			pthread_cond_wait(&journal->wake, &journal->mutex);
+			continue;
+		}
+		if (journal->durability != JOURNAL_DURABILITY_SYNC) {
+			clock_gettime(CLOCK_MONOTONIC, &deadline);
+			deadline.tv_nsec += journal->interval_ms * 1000000L;
+			deadline.tv_sec += deadline.tv_nsec / 1000000000L;
+			deadline.tv_nsec %= 1000000000L;
+			full = 0;
+			while (!journal->stop && !full
+					&& pthread_cond_timedwait(&journal->wake, &journal->mutex,
+							&deadline) != ETIMEDOUT) {
+				full = journal->used + sizeof(journal_record_s)
+						> JOURNAL_BUFFER_SIZE;
+			}
+		}
+		length = journal->used;
+		appended = journal->appended;
+		journal->active = 1 - journal->active;
+		journal->used = 0;
+		pthread_cond_broadcast(&journal->flushed);
+		pthread_mutex_unlock(&journal->mutex);
+		error = write_journal_buffer(journal->buffers[1 - journal->active],
+				length) == -1 ? errno : 0;
+		if (error != 0) {
+			fail_journal(error);
+		}
+		pthread_mutex_lock(&journal->mutex);
+		if (error != 0) {
+			journal->failed = 1;
+		} else {
+			journal->durable = appended;
+		}
+		journal->flushes++;
+		pthread_cond_broadcast(&journal->flushed);
+	}
+	pthread_mutex_unlock(&journal->mutex);
+	return NULL;
+}
+
+/**
+ * Opens the game journal and starts its flusher. The journal continues in a
+ * new segment after the last segment found.
+ * @param[in] name        Name the segments are named after.
+ * @param[in] durability  The durability level, JOURNAL_DURABILITY_OFF leaves journaling off.
+ * @param[in] interval_ms Interval between syncs, in milliseconds.
+ * @retval  0 Upon success.
+ * @retval -1 When the journal cannot be opened.
+ * \sa journal_durability_e
+ */
+int
+open_journal(const char *name, journal_durability_e durability,
+		int interval_ms) {
+	char path[300];
+	pthread_condattr_t attr;
+	if (durability == JOURNAL_DURABILITY_OFF) {
+		return 0;
+	}
+	if ((journal = calloc(1, sizeof(journal_s))) == NULL) {
+		return -1;
+	}
+	if ((journal->buffers[0] = malloc(JOURNAL_BUFFER_SIZE)) == NULL
+			|| (journal->buffers[1] = malloc(JOURNAL_BUFFER_SIZE)) == NULL) {
+		free(journal->buffers[0]);
+		free(journal);
+		journal = NULL;
+		return -1;
+	}
+	strncpy(journal->name, name, sizeof(journal->name) - 1);
+	journal->durability = durability;
+	journal->interval_ms = interval_ms;
+	for (;;) {
+		snprintf(path, sizeof(path), "%s.%06d", name, journal->segment);
+		if (access(path, F_OK) != 0) {
+			break;
+		}
+		journal->segment++;
+	}
+	if ((journal->fd = open_journal_segment(name, journal->segment)) == -1) {
+		perror("Open journal");
+		free(journal->buffers[0]);
+		free(journal->buffers[1]);
+		free(journal);
+		journal = NULL;
+		return -1;
+	}
+	pthread_mutex_init(&journal->mutex, NULL);
+	pthread_condattr_init(&attr);
+	pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+	pthread_cond_init(&journal->wake, &attr);
+	pthread_condattr_destroy(&attr);
+	pthread_cond_init(&journal->flushed, NULL);
+	if (pthread_create(&journal->flusher, NULL, flush_journal, NULL) != 0) {
+		ERR("pthread_create");
+	}
+	fprintf(stderr, "Journal %s.%06d opened\n", name, journal->segment);
+	return 0;
+}
+
+/**
+ * Gets the name of the open journal.
+ * @return The name the segments are named after or NULL when journaling is off.
+ */
+const char*
+get_journal_name(void) {
+	return journal != NULL ? journal->name : NULL;
+}
+
+/**
+ * Writes out the records left, stops the flusher and closes the journal.
+ */
+void
+close_journal(void) {
+	if (journal == NULL) {
+		return;
+	}
+	pthread_mutex_lock(&journal->mutex);
+	journal->stop = 1;
+	pthread_cond_signal(&journal->wake);
+	pthread_mutex_unlock(&journal->mutex);
+	pthread_join(journal->flusher, NULL);
+	if (journal->fd != -1) {
+		fdatasync(journal->fd);
+		close(journal->fd);
+	}
+	fprintf(stderr, "Journal closed: %lu records in %ld writes\n",
+			(unsigned long) journal->appended, journal->flushes);
+	pthread_cond_destroy(&journal->wake);
+	pthread_cond_destroy(&journal->flushed);
+	pthread_mutex_destroy(&journal->mutex);
+	free(journal->buffers[0]);
+	free(journal->buffers[1]);
+	free(journal);
+	journal = NULL;
+}
+
+/**
+ * Appends a record to the journal. It waits only when both buffers are full
+ * or, in the sync level, until the record is synced. Nothing is appended once
+ * journaling has stopped after a failed write.
+ * @param[in] record Pointer to the record, its checksum is filled in here.
+ * \sa journal_record_s
+ */
+void
+append_journal_record(journal_record_s *record) {
+	uint64_t number;
+	if (journal == NULL) {
+		return;
+	}
+	record->checksum = get_journal_checksum(record);
+	pthread_mutex_lock(&journal->mutex);
+	while (!journal->failed
+			&& journal->used + sizeof(journal_record_s) > JOURNAL_BUFFER_SIZE) {
+		pthread_cond_signal(&journal->wake);
+		pthread_cond_wait(&journal->flushed, &journal->mutex);
+	}
+	if (journal->failed) {
+		pthread_mutex_unlock(&journal->mutex);
+		return;
+	}
+	memcpy(journal->buffers[journal->active] + journal->used, record,
+			sizeof(journal_record_s));
+	journal->used += sizeof(journal_record_s);
+	number = ++journal->appended;
+	if (journal->used == sizeof(journal_record_s)
+			|| journal->durability == JOURNAL_DURABILITY_SYNC) {
+		pthread_cond_signal(&journal->wake);
+	}
+	if (journal->durability == JOURNAL_DURABILITY_SYNC) {
+		while (journal->durable < number) {
+			pthread_cond_wait(&journal->flushed, &journal->mutex);
+		}
+	}
+	pthread_mutex_unlock(&journal->mutex);
+}
+
+/**
+ * Journals the creation of a game.
+ * @param[in] game Pointer to the created game.
+ * \sa game_s
+ */
+void
+journal_game_created(game_s *game) {
+	journal_record_s record;
+	memset(&record, 0, sizeof(record));
+	record.type = JOURNAL_GAME_CREATED;
+	record.game_id = game->id;
+	record.size = game->size;
+	record.win_length = game->win_length;
+	record.mode = game->mode;
+	memcpy(record.nick, game->players[0]->player_nick, MAX_NICK_LEN - 1);
+	append_journal_record(&record);
+}
+
+/**
+ * Journals the start of a game: the second player, the bot if it is one, and
+ * who moves first.
+ * @param[in] game Pointer to the started game.
+ * \sa game_s
+ */
+void
+journal_game_started(game_s *game) {
+	journal_record_s record;
+	memset(&record, 0, sizeof(record));
+	record.type = JOURNAL_GAME_STARTED;
+	record.game_id = game->id;
+	if (game->bot != NULL) {
+		record.x = game->bot->budget_ms;
+		record.y = game->bot->engine;
+	}
+	record.value = game->first_seat;
+	memcpy(record.nick, game->players[1]->player_nick, MAX_NICK_LEN - 1);
+	append_journal_record(&record);
+}
+
+/**
+ * Journals an accepted move. The move is the last one counted in the game.
+ * @param[in] game Pointer to the game.
+ * @param[in] move Pointer to the move.
+ * \sa game_s move_s
+ */
+void
+journal_move(game_s *game, move_s *move) {
+	journal_record_s record;
+	memset(&record, 0, sizeof(record));
+	record.type = JOURNAL_MOVE;
+	record.game_id = game->id;
+	record.x = move->x;
+	record.y = move->y;
+	record.pawn = move->pawn;
+	record.ply = game->no_moves;
+	append_journal_record(&record);
+}
+
+/**
+ * Journals the end of a game.
+ * @param[in] game    Pointer to the game.
+ * @param[in] outcome Pawn of the winner, '-' for a draw or 0 when the game
+ * was abandoned.
+ * \sa game_s
+ */
+void
+journal_game_ended(game_s *game, char outcome) {
+	journal_record_s record;
+	memset(&record, 0, sizeof(record));
+	record.type = JOURNAL_GAME_ENDED;
+	record.game_id = game->id;
+	record.value = outcome;
+	record.ply = game->no_moves;
+	append_journal_record(&record);
+}
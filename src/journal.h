@@ -0,0 +1,26 @@
+/**
+ * @file journal.h
+ * @ingroup journal
+ *
+ * @author Piotr Janaszek <janas03@yahoo.pl>
+ * @date Created on: Oct 18, 2026
+ *
+ * @brief File containing methods for writing the game journal.
+ */
+
+#ifndef JOURNAL_H_
+#define JOURNAL_H_
+
+#include "structs.h"
+
+uint32_t get_journal_checksum(const journal_record_s *record);
+int open_journal(const char *name, journal_durability_e durability,
+		int interval_ms);
+void close_journal(void);
+const char* get_journal_name(void);
+void journal_game_created(game_s *game);
+void journal_game_started(game_s *game);
+void journal_move(game_s *game, move_s *move);
+void journal_game_ended(game_s *game, char outcome);
+
+#endif /* JOURNAL_H_ */
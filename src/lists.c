@@ -6,6 +6,10 @@
  * @date Created on: Jul 11, 2012
  *
  * @brief File containing methods for creating and manipulating lists of players, games and threads.
+ *
+ * All the lists are intrusive doubly linked lists: every player, game and thread
+ * structure holds its own links and a list keeps pointers to its head and tail,
+ * so adding and removing an element takes constant time.
  */
 
 #define _GNU_SOURCE
@@ -13,13 +17,17 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "arena.h"
+#include "bot.h"
+#include "metrics.h"
+#include "sparse_board.h"
 #include "structs.h"
 
 /***** Players list methods *****/
 
 /**
  * Creates list for players.
- * @return Pointer to the head of the players list. \sa players_list_s
+ * @return Pointer to the players list. \sa players_list_s
  */
 players_list_s*
 create_players_list(void) {
@@ -29,14 +37,15 @@ create_players_list(void) {
 		fprintf(stderr, "Cannot allocate memory for players list\n");
 		return NULL;
 	}
-	players_list->value = NULL;
-	players_list->next = NULL;
+	players_list->head = NULL;
+	players_list->tail = NULL;
+	players_list->count = 0;
 	return players_list;
 }
 
 /**
- * Adds new player to a list.
- * @param[in] players_list Pointer to the head of the players list.
+ * Adds new player to the end of a list.
+ * @param[in] players_list Pointer to the players list.
  * @param[in] player       Pointer to a structure containing player information.
  * @retval  0 Upon successful adding new player to the list.
  * @retval -1 When an error occurs.
@@ -44,43 +53,34 @@ create_players_list(void) {
  */
 int
 add_player_to_list(players_list_s *players_list, player_s *player) {
-	players_list_s *list, *new_list;
-	list = players_list;
-
-	if (list->value == NULL) {
-		list->value = player;
-		return 0;
-	}
-
-	while (list->next != NULL) {
-		list = list->next;
-	}
-
-	new_list = create_players_list();
-	if (new_list == NULL) {
+	if (players_list == NULL || player == NULL) {
 		return -1;
 	}
-
-	list->next = new_list;
-	new_list->value = player;
+	player->prev = players_list->tail;
+	player->next = NULL;
+	if (players_list->tail != NULL) {
+		players_list->tail->next = player;
+	} else {
+		players_list->head = player;
+	}
+	players_list->tail = player;
+	players_list->count++;
 	return 0;
 }
 
 /**
  * Searches a players list to find a player in with a given nick.
- * @param[in] players_list Pointer to the head of the players list.
+ * @param[in] players_list Pointer to the players list.
  * @param[in] nick         Nick name of a player to find.
  * @retval  0 When a player with a given nick is found in a list.
  * @retval -1 When a player with a given nick is not found in a list.
  */
 int
 find_player_by_nick(players_list_s *players_list, char *nick) {
-	players_list_s *list = players_list;
-	while (list != NULL && list->value != NULL) {
-		if (strncmp(list->value->player_nick, nick, MAX_NICK_LEN) == 0) {
+	player_s *player;
+	for (player = players_list->head; player != NULL; player = player->next) {
+		if (strncmp(player->player_nick, nick, MAX_NICK_LEN) == 0) {
 			return 0;
-		} else {
-			list = list->next;
 		}
 	}
 	return -1;
@@ -89,78 +89,57 @@ find_player_by_nick(players_list_s *players_list, char *nick) {
 /**
  * Searches a players list to find a player with a given file descriptor. When the player is
  * found a pointer to a structure is returned, NULL otherwise.
- * @param[in]  players_list Pointer to the head of the players list.
+ * @param[in]  players_list Pointer to the players list.
  * @param[out] player       Pointer to a structure which points to a found player.
  * @param[in]  client_fd    File descriptor number of a searched player.
  * \sa player_s
  */
 void
 get_player_by_file_desc(players_list_s *players_list, player_s **player, int client_fd) {
-	players_list_s *list = players_list;
-	while (list != NULL && list->value != NULL) {
-		if (list->value->player_fd == client_fd) {
-			*player = list->value;
+	player_s *list;
+	for (list = players_list->head; list != NULL; list = list->next) {
+		if (list->player_fd == client_fd) {
+			*player = list;
 			return;
-		} else {
-			list = list->next;
 		}
 	}
 	*player = NULL;
 }
 
 /**
- * Removes given player structure from a players list.
- * @param[in] players_list Pointer to the head of the players list.
- * @param[in] player       Pointer to a structure which contains player to remove.
+ * Removes given player structure from a players list and frees it.
+ * @param[in] players_list Pointer to the players list.
+ * @param[in] player       Pointer to a player held in the list.
  * \sa player_s
  */
 void
-remove_player_from_list(players_list_s **players_list, player_s *player) {
-	players_list_s *prev, *list = *players_list;
-	if (list == NULL || list->value == NULL) {
+remove_player_from_list(players_list_s *players_list, player_s *player) {
+	if (player == NULL || (player->prev == NULL && players_list->head != player)) {
 		return;
 	}
-	if (list->next == NULL) {
-		if (strncmp(list->value->player_nick, player->player_nick, MAX_NICK_LEN) == 0) {
-			free(list->value);
-			list->value = NULL;
-		}
-		return;
+	if (player->prev != NULL) {
+		player->prev->next = player->next;
+	} else {
+		players_list->head = player->next;
 	}
-	prev = NULL;
-	while (list !=NULL && list->value != NULL) {
-		if (strncmp(list->value->player_nick, player->player_nick, MAX_NICK_LEN) == 0) {
-			/* delete first */
-			if (prev == NULL) {
-				free(list->value);
-				*players_list = list->next;
-				return;
-			}
-			/* delete last */
-			if (list->next == NULL) {
-				prev->next = NULL;
-				free(list->value);
-				return;
-			}
-			/* delete middle */
-			prev->next = list->next;
-			free(list->value);
-			return;
-		}
-		prev = list;
-		list = list->next;
+	if (player->next != NULL) {
+		player->next->prev = player->prev;
+	} else {
+		players_list->tail = player->prev;
 	}
+	players_list->count--;
+	free(player);
 }
 
 /**
  * Removes from a players list given player structure based on player's file descriptor.
- * @param[in] players_list Pointer to the head of the players list.
+ * @param[in] players_list Pointer to the players list.
  * @param[in] client_fd    File descriptor number of a player to remove.
  */
 void
-remove_player_from_list2(players_list_s **players_list, int client_fd) {
+remove_player_from_list2(players_list_s *players_list, int client_fd) {
 	player_s *player;
-	get_player_by_file_desc(*players_list, &player, client_fd);
+	get_player_by_file_desc(players_list, &player, client_fd);
 	if (player != NULL) {
 		remove_player_from_list(players_list, player);
 	} else {
@@ -169,27 +148,25 @@ remove_player_from_list2(players_list_s **players_list, int client_fd) {
 }
 
 /**
- * Destroys a players list by freeing all the pointers.
- * @param[in] players_list Pointer to the head of the players list.
+ * Destroys a players list by freeing all the players and the list itself.
+ * @param[in] players_list Pointer to the players list.
  */
 void
 destroy_players(players_list_s *players_list) {
-	players_list_s *next_list = players_list->next;
-	while (next_list != NULL) {
-		free(players_list);
-		players_list = next_list;
-		next_list = next_list->next;
+	player_s *next, *player = players_list->head;
+	while (player != NULL) {
+		next = player->next;
+		free(player);
+		player = next;
 	}
-
 	free(players_list);
-	players_list = NULL;
 }
 
 /***** Games list methods *****/
 
 /**
  * Creates list for games.
- * @return Pointer to the head of the games list.
+ * @return Pointer to the games list.
  * \sa games_list_s
  */
 games_list_s*
@@ -200,14 +177,15 @@ create_games_list(void) {
 		fprintf(stderr, "Cannot allocate memory for games list\n");
 		return NULL;
 	}
-	games_list->value = NULL;
-	games_list->next = NULL;
+	games_list->head = NULL;
+	games_list->tail = NULL;
+	games_list->count = 0;
 	return games_list;
 }
 
 /**
- * Adds new game to a list.
- * @param[in] games_list Pointer to the head of the games list.
+ * Adds new game to the end of a list.
+ * @param[in] games_list Pointer to the games list.
  * @param[in] game       Pointer to a structure containing game information.
  * @retval  0 Upon successful adding new game to the list.
  * @retval -1 When an error occurs.
@@ -215,134 +193,124 @@ create_games_list(void) {
  */
 int
 add_game_to_list(games_list_s *games_list, game_s *game) {
-	games_list_s *list, *new_list;
-	list = games_list;
-
-	if (list->value == NULL) {
-		list->value = game;
-		return 0;
-	}
-
-	while (list->next != NULL) {
-		list = list->next;
-	}
-
-	new_list = create_games_list();
-	if (new_list == NULL) {
+	if (games_list == NULL || game == NULL) {
 		return -1;
 	}
-
-	list->next = new_list;
-	new_list->value = game;
+	game->prev = games_list->tail;
+	game->next = NULL;
+	if (games_list->tail != NULL) {
+		games_list->tail->next = game;
+	} else {
+		games_list->head = game;
+	}
+	games_list->tail = game;
+	games_list->count++;
+	count_metric(METRIC_GAMES_ADDED, 1);
 	return 0;
 }
 
 /**
  * Searches a games list to find a game with a given game ID. When the game is
  * found a pointer to a structure is returned, NULL otherwise.
- * @param[in]  games_list Pointer to the head of the games list.
+ * @param[in]  games_list Pointer to the games list.
  * @param[out] game       Pointer to a structure which points to a found game.
  * @param[in]  game_id    Game ID which should be found.
  * \sa game_s
  */
 void
 get_game_by_id(games_list_s *games_list, game_s **game, int game_id) {
-	games_list_s *list = games_list;
-	while (list != NULL && list->value != NULL) {
-		if (list->value->id == game_id) {
-			*game = list->value;
+	game_s *list;
+	for (list = games_list->head; list != NULL; list = list->next) {
+		if (list->id == game_id) {
+			*game = list;
 			return;
-		} else {
-			list = list->next;
 		}
 	}
 	*game = NULL;
 }
 
 /**
- * Removes given game structure from a games list.
- * @param[in] games_list Pointer to the head of the games list.
- * @param[in] game       Pointer to a structure which contains game to remove.
+ * Releases a game: its bot and sparse board, if any, and then the game arena holding
+ * the game structure itself.
+ * @param[in] game Pointer to the game.
+ * \sa game_s sparse_board_s
+ */
+void
+destroy_game(game_s *game) {
+	if (game->bot != NULL) {
+		close_bot(game->bot);
+	}
+	destroy_sparse_board(game->sparse);
+	destroy_arena(game->arena);
+}
+
+/**
+ * Removes given game structure from a games list and releases the game arena.
+ * @param[in] games_list Pointer to the games list.
+ * @param[in] game       Pointer to a game held in the list.
  * \sa game_s
  */
 void
-remove_game_from_list(games_list_s **games_list, game_s *game) {
-	games_list_s *prev, *list = *games_list;
-	if (list == NULL || list->value == NULL) {
+remove_game_from_list(games_list_s *games_list, game_s *game) {
+	if (game == NULL || (game->prev == NULL && games_list->head != game)) {
 		return;
 	}
-	if (list->next == NULL) {
-		if (list->value->id == game->id) {
-			free(list->value);
-			list->value = NULL;
-		}
-		return;
+	if (game->prev != NULL) {
+		game->prev->next = game->next;
+	} else {
+		games_list->head = game->next;
 	}
-	prev = NULL;
-	while (list != NULL && list->value != NULL) {
-		if (list->value->id == game->id) {
-			/* delete first */
-			if (prev == NULL) {
-				free(list->value);
-				*games_list = list->next;
-				return;
-			}
-			/* delete last */
-			if (list->next == NULL) {
-				prev->next = NULL;
-				free(list->value);
-				return;
-			}
-			/* delete middle */
-			prev->next = list->next;
-			free(list->value);
-			return;
-		}
-		prev = list;
-		list = list->next;
+	if (game->next != NULL) {
+		game->next->prev = game->prev;
+	} else {
+		games_list->tail = game->prev;
 	}
+	games_list->count--;
+	/* spectators still watching go back to the lobby with the game */
+	count_metric(METRIC_GAMES_REMOVED, 1);
+	count_metric(METRIC_SPECTATORS_LEFT, game->no_connected_spectators);
+	destroy_game(game);
 }
 
 /**
- * Destroys a games list by freeing all the pointers.
- * @param[in] games_list Pointer to the head of the games list.
+ * Destroys a games list by releasing all the games and the list itself.
+ * @param[in] games_list Pointer to the games list.
  */
 void
 destroy_games(games_list_s *games_list) {
-	games_list_s *next_list = games_list->next;
-	while (next_list != NULL) {
-		free(games_list);
-		games_list = next_list;
-		next_list = next_list->next;
+	game_s *next, *game = games_list->head;
+	while (game != NULL) {
+		next = game->next;
+		destroy_game(game);
+		game = next;
 	}
-
 	free(games_list);
-	games_list = NULL;
 }
 
 /***** Thread list methods *****/
 
 /**
  * Creates list for threads.
- * @return Pointer to the head of the threads list.
+ * @return Pointer to the threads list.
  * \sa threads_list_s
  */
 threads_list_s*
 create_threads_list(void) {
 	threads_list_s *threads_list = NULL;
-	threads_list = malloc(sizeof(thread_s));
+	threads_list = malloc(sizeof(threads_list_s));
 	if (threads_list == NULL) {
 		fprintf(stderr, "Cannot allocate memory for threads list\n");
 		return NULL;
 	}
-	threads_list->value = NULL;
-	threads_list->next = NULL;
+	threads_list->head = NULL;
+	threads_list->tail = NULL;
+	threads_list->count = 0;
 	return threads_list;
 }
 
 /**
- * Adds new thread to a list.
- * @param[in] threads_list Pointer to the head of the threads list.
+ * Adds new thread to the end of a list.
+ * @param[in] threads_list Pointer to the threads list.
  * @param[in] thread       Pointer to a structure containing thread information.
  * @retval  0 Upon successful adding new thread to the list.
  * @retval -1 When an error occurs.
@@ -350,107 +318,77 @@ create_threads_list(void) {
  */
 int
 add_thread_to_list(threads_list_s *threads_list, thread_s *thread) {
-	threads_list_s *list, *new_list;
-	list = threads_list;
-
-	if (list->value == NULL) {
-		list->value = thread;
-		return 0;
-	}
-
-	while (list->next != NULL) {
-		list = list->next;
-	}
-
-	new_list = create_threads_list();
-	if (new_list == NULL) {
+	if (threads_list == NULL || thread == NULL) {
 		return -1;
 	}
-
-	list->next = new_list;
-	new_list->value = thread;
+	thread->prev = threads_list->tail;
+	thread->next = NULL;
+	if (threads_list->tail != NULL) {
+		threads_list->tail->next = thread;
+	} else {
+		threads_list->head = thread;
+	}
+	threads_list->tail = thread;
+	threads_list->count++;
 	return 0;
 }
 
 /**
  * Searches a threads list to find a thread with a given game ID. When the thread is
  * found a pointer to a structure is returned, NULL otherwise.
- * @param[in]  threads_list Pointer to the head of the threads list.
+ * @param[in]  threads_list Pointer to the threads list.
  * @param[out] thread       Pointer to a structure which points to a found thread.
  * @param[in]  id           Game ID which should be found.
  * \sa thread_s
  */
 void
 get_thread_by_id(threads_list_s *threads_list, thread_s **thread, int id) {
-	threads_list_s *list = threads_list;
-	while (list != NULL && list->value != NULL) {
-		if (list->value->game_id == id) {
-			*thread = list->value;
+	thread_s *list;
+	for (list = threads_list->head; list != NULL; list = list->next) {
+		if (list->game_id == id) {
+			*thread = list;
 			return;
-		} else {
-			list = list->next;
 		}
 	}
 	*thread = NULL;
 }
 
 /**
- * Removes given thread structure from a threads list.
- * @param[in] threads_list Pointer to the head of the threads list.
- * @param[in] thread       Pointer to a structure which contains thread to remove.
+ * Removes given thread structure from a threads list and frees it.
+ * @param[in] threads_list Pointer to the threads list.
+ * @param[in] thread       Pointer to a thread held in the list.
  * \sa thread_s
  */
 void
-remove_thread_from_list(threads_list_s **threads_list, thread_s *thread) {
-	threads_list_s *prev, *list = *threads_list;
-	if (list == NULL || list->value == NULL) {
+remove_thread_from_list(threads_list_s *threads_list, thread_s *thread) {
+	if (thread == NULL || (thread->prev == NULL && threads_list->head != thread)) {
 		return;
 	}
-	if (list->next == NULL) {
-		if (list->value->game_id == thread->game_id) {
-			free(list->value);
-			list->value = NULL;
-		}
-		return;
+	if (thread->prev != NULL) {
+		thread->prev->next = thread->next;
+	} else {
+		threads_list->head = thread->next;
 	}
-	prev = NULL;
-	while (list !=NULL && list->value != NULL) {
-		if (list->value->game_id == thread->game_id) {
-			/* delete first */
-			if (prev == NULL) {
-				free(list->value);
-				*threads_list = list->next;
-				return;
-			}
-			/* delete last */
-			if (list->next == NULL) {
-				prev->next = NULL;
-				free(list->value);
-				return;
-			}
-			/* delete middle */
-			prev->next = list->next;
-			free(list->value);
-			return;
-		}
-		prev = list;
-		list = list->next;
+	if (thread->next != NULL) {
+		thread->next->prev = thread->prev;
+	} else {
+		threads_list->tail = thread->prev;
 	}
+	threads_list->count--;
+	free(thread);
 }
 
 /**
- * Destroys a threads list by freeing all the pointers.
- * @param[in] threads_list Pointer to the head of the threads list.
+ * Destroys a threads list by freeing all the threads and the list itself.
+ * @param[in] threads_list Pointer to the threads list.
  */
 void
 destroy_threads(threads_list_s *threads_list) {
-	threads_list_s *next_list = threads_list->next;
-	while (next_list != NULL) {
-		free(threads_list);
-		threads_list = next_list;
-		next_list = next_list->next;
+	thread_s *next, *thread = threads_list->head;
+	while (thread != NULL) {
+		next = thread->next;
+		free(thread);
+		thread = next;
 	}
-
 	free(threads_list);
-	threads_list = NULL;
 }
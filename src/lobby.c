@@ -0,0 +1,361 @@
+/**
+ * @file lobby.c
+ * @ingroup lobby
+ *
+ * @author Piotr Janaszek <janas03@yahoo.pl>
+ * @date Created on: Oct 18, 2026
+ *
+ * @brief File containing methods for publishing and reading snapshots of the games lobby.
+ *
+ * The lobby is an immutable, versioned copy of the games list. Every change to
+ * the games list publishes a new snapshot which replaces the current one with
+ * a single atomic exchange. Readers never take a lock nor allocate memory: they
+ * announce the snapshot they read in a hazard slot, and writers free a retired
+ * snapshot only when no hazard slot points to it.
+ *
+ * Each snapshot also caches its list responses already encoded. A payload is
+ * encoded once per snapshot version and filter by the first reader asking for
+ * it; readers arriving meanwhile wait for that encoding instead of repeating it.
+ * Publishing a new snapshot is what invalidates the cache.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "config.h"
+#include "structs.h"
+
+/**
+ * Hazard slot used by the current thread or -1 when it is not assigned yet.
+ */
+static __thread int lobby_reader_slot = -1;
+
+/**
+ * Creates a lobby snapshot with a place for a given number of games and players.
+ * @param[in] no_games   Number of games the snapshot holds.
+ * @param[in] no_players Number of players the snapshot holds.
+ * @param[in] version    Version of the snapshot.
+ * @return Pointer to the created snapshot or NULL upon error.
+ * \sa lobby_snapshot_s
+ */
+lobby_snapshot_s*
+create_lobby_snapshot(int no_games, int no_players, unsigned long version) {
+	int i;
+	lobby_snapshot_s *snapshot = NULL;
+	snapshot = malloc(sizeof(lobby_snapshot_s) + no_games * sizeof(lobby_game_s)
+			+ no_players * MAX_NICK_LEN);
+	if (snapshot == NULL) {
+		fprintf(stderr, "Cannot allocate memory for lobby snapshot\n");
+		return NULL;
+	}
+	snapshot->version = version;
+	snapshot->no_games = no_games;
+	snapshot->no_players = no_players;
+	snapshot->games = (lobby_game_s*) (snapshot + 1);
+	snapshot->players = (char (*)[MAX_NICK_LEN]) (snapshot->games + no_games);
+	for (i = 0; i < LOBBY_FILTERS_NO; i++) {
+		snapshot->encoded[i] = LOBBY_PAYLOAD_EMPTY;
+	}
+	snapshot->next = NULL;
+	return snapshot;
+}
+
+/**
+ * Creates the lobby and publishes its first (empty) snapshot.
+ * @param[in] games_list         Pointer to the games list the lobby is built from.
+ * @param[in] games_list_mutex   Pointer to a mutex guarding games list.
+ * @param[in] players_list       Pointer to the players list the lobby is built from.
+ * @param[in] players_list_mutex Pointer to a mutex guarding players list.
+ * @return Pointer to the created lobby or NULL upon error.
+ * \sa lobby_s
+ */
+lobby_s*
+create_lobby(games_list_s *games_list, pthread_mutex_t *games_list_mutex,
+		players_list_s *players_list, pthread_mutex_t *players_list_mutex) {
+	int i;
+	lobby_s *lobby = malloc(sizeof(lobby_s));
+	if (lobby == NULL) {
+		fprintf(stderr, "Cannot allocate memory for lobby\n");
+		return NULL;
+	}
+	lobby->current = create_lobby_snapshot(0, 0, 0);
+	if (lobby->current == NULL) {
+		free(lobby);
+		return NULL;
+	}
+	lobby->retired = NULL;
+	lobby->version = 0;
+	lobby->next_reader_slot = 0;
+	for (i = 0; i < LOBBY_READERS; i++) {
+		lobby->hazards[i] = NULL;
+	}
+	lobby->games_list = games_list;
+	lobby->games_list_mutex = games_list_mutex;
+	lobby->players_list = players_list;
+	lobby->players_list_mutex = players_list_mutex;
+	pthread_mutex_init(&lobby->mutex, NULL);
+	return lobby;
+}
+
+/**
+ * Checks whether any reader still holds a given snapshot.
+ * @param[in] lobby    Pointer to the lobby.
+ * @param[in] snapshot Pointer to the snapshot to be checked.
+ * @retval 1 When the snapshot is in use.
+ * @retval 0 When the snapshot can be freed.
+ */
+int
+is_lobby_snapshot_used(lobby_s *lobby, lobby_snapshot_s *snapshot) {
+	int i;
+	for (i = 0; i < LOBBY_READERS; i++) {
+		if (__atomic_load_n(&lobby->hazards[i], __ATOMIC_SEQ_CST) == snapshot) {
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/**
+ * Frees retired snapshots which are no longer read by anyone.
+ * Must be called with the lobby mutex held.
+ * @param[in] lobby Pointer to the lobby.
+ */
+void
+reclaim_lobby_snapshots(lobby_s *lobby) {
+	lobby_snapshot_s *snapshot, **prev = &lobby->retired;
+	while ((snapshot = *prev) != NULL) {
+		if (is_lobby_snapshot_used(lobby, snapshot)) {
+			prev = &snapshot->next;
+		} else {
+			*prev = snapshot->next;
+			free(snapshot);
+		}
+	}
+}
+
+/**
+ * Copies a game into a lobby snapshot entry.
+ * @param[out] entry Pointer to the snapshot entry.
+ * @param[in]  game  Pointer to the game to be copied.
+ * \sa lobby_game_s game_s
+ */
+void
+fill_lobby_game(lobby_game_s *entry, game_s *game) {
+	int i;
+	entry->id = game->id;
+	entry->size = game->size;
+	entry->win_length = game->win_length;
+	entry->mode = game->mode;
+	entry->free_spectators = SPECTATORS_NO - game->no_connected_spectators;
+	entry->no_players = 0;
+	for (i = 0; i < 2; i++) {
+		if (game->players[i] != NULL) {
+			strncpy(entry->nicks[i], game->players[i]->player_nick, MAX_NICK_LEN);
+			entry->nicks[i][MAX_NICK_LEN - 1] = '\0';
+			entry->no_players++;
+		} else {
+			entry->nicks[i][0] = '\0';
+		}
+	}
+}
+
+/**
+ * Builds a new snapshot of the games and players lists and publishes it atomically.
+ * It has to be called after every change that is visible in the lobby, which
+ * also invalidates all the cached responses.
+ * @param[in] lobby Pointer to the lobby.
+ */
+void
+publish_lobby(lobby_s *lobby) {
+	int i = 0;
+	game_s *game;
+	player_s *player;
+	lobby_snapshot_s *snapshot, *old;
+	pthread_mutex_lock(&lobby->mutex);
+	pthread_mutex_lock(lobby->games_list_mutex);
+	pthread_mutex_lock(lobby->players_list_mutex);
+	snapshot = create_lobby_snapshot(lobby->games_list->count,
+			lobby->players_list->count, lobby->version + 1);
+	if (snapshot == NULL) {
+		pthread_mutex_unlock(lobby->players_list_mutex);
+		pthread_mutex_unlock(lobby->games_list_mutex);
+		pthread_mutex_unlock(&lobby->mutex);
+		return;
+	}
+	for (game = lobby->games_list->head; game != NULL; game = game->next) {
+		fill_lobby_game(&snapshot->games[i++], game);
+	}
+	i = 0;
+	for (player = lobby->players_list->head; player != NULL; player = player->next) {
+		strncpy(snapshot->players[i], player->player_nick, MAX_NICK_LEN);
+		snapshot->players[i++][MAX_NICK_LEN - 1] = '\0';
+	}
+	pthread_mutex_unlock(lobby->players_list_mutex);
+	pthread_mutex_unlock(lobby->games_list_mutex);
+	lobby->version++;
+	old = __atomic_exchange_n(&lobby->current, snapshot, __ATOMIC_SEQ_CST);
+	old->next = lobby->retired;
+	lobby->retired = old;
+	reclaim_lobby_snapshots(lobby);
+	pthread_mutex_unlock(&lobby->mutex);
+}
+
+/**
+ * Encodes the games held in a snapshot into a games list response payload.
+ * @param[in]  snapshot Pointer to the snapshot.
+ * @param[out] payload  Buffer of size MAX_RSP_SIZE for the encoded games.
+ */
+void
+encode_lobby_games(lobby_snapshot_s *snapshot, char *payload) {
+	int i, n, len = 0;
+	char temp[128];
+	lobby_game_s *entry;
+	memset(payload, '0', MAX_RSP_SIZE);
+	for (i = 0; i < snapshot->no_games; i++) {
+		entry = &snapshot->games[i];
+		if (entry->no_players < 2) {
+			n = snprintf(temp, 128, "%d%s%d%s%d%s%d%s%d%s%s%s", entry->id,
+					INNER_DELIM, entry->size, INNER_DELIM, entry->win_length,
+					INNER_DELIM, entry->mode, INNER_DELIM,
+					entry->free_spectators, INNER_DELIM, entry->nicks[0],
+					PAYLOAD_DELIM);
+		} else {
+			n = snprintf(temp, 128, "%d%s%d%s%d%s%d%s%d%s%s%s%s%s", entry->id,
+					INNER_DELIM, entry->size, INNER_DELIM, entry->win_length,
+					INNER_DELIM, entry->mode, INNER_DELIM,
+					entry->free_spectators, INNER_DELIM, entry->nicks[0],
+					INNER_DELIM, entry->nicks[1], PAYLOAD_DELIM);
+		}
+		if (n >= 128 || len + n >= MAX_RSP_SIZE) {
+			break;
+		}
+		memcpy(payload + len, temp, n);
+		len += n;
+	}
+	if (len > 0) {
+		payload[len] = '\0';
+	}
+	payload[MAX_RSP_SIZE - 1] = '\0';
+}
+
+/**
+ * Encodes the players held in a snapshot into a players list response payload.
+ * @param[in]  snapshot Pointer to the snapshot.
+ * @param[out] payload  Buffer of size MAX_RSP_SIZE for the encoded players.
+ */
+void
+encode_lobby_players(lobby_snapshot_s *snapshot, char *payload) {
+	int i, n, len = 0;
+	char temp[MAX_NICK_LEN + 1];
+	memset(payload, '0', MAX_RSP_SIZE);
+	for (i = 0; i < snapshot->no_players; i++) {
+		n = snprintf(temp, MAX_NICK_LEN + 1, "%s%s", snapshot->players[i],
+				PAYLOAD_DELIM);
+		if (n > MAX_NICK_LEN) {
+			n = MAX_NICK_LEN;
+		}
+		if (len + n >= MAX_RSP_SIZE) {
+			break;
+		}
+		memcpy(payload + len, temp, n);
+		len += n;
+	}
+	if (len > 0) {
+		payload[len] = '\0';
+	}
+	payload[MAX_RSP_SIZE - 1] = '\0';
+}
+
+/**
+ * Gets a response payload of a snapshot, encoding it on the first request.
+ * Concurrent readers of the same snapshot and filter wait for a single encoding.
+ * @param[in] snapshot Pointer to the acquired snapshot.
+ * @param[in] filter   Kind of the list to be returned.
+ * @return Pointer to the encoded payload of size MAX_RSP_SIZE.
+ * \sa lobby_filter_e
+ */
+char*
+get_lobby_payload(lobby_snapshot_s *snapshot, lobby_filter_e filter) {
+	int expected = LOBBY_PAYLOAD_EMPTY;
+	if (__atomic_load_n(&snapshot->encoded[filter], __ATOMIC_ACQUIRE)
+			== LOBBY_PAYLOAD_READY) {
+		return snapshot->payloads[filter];
+	}
+	if (__atomic_compare_exchange_n(&snapshot->encoded[filter], &expected,
+			LOBBY_PAYLOAD_ENCODING, 0, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) {
+		if (filter == LOBBY_FILTER_GAMES) {
+			encode_lobby_games(snapshot, snapshot->payloads[filter]);
+		} else {
+			encode_lobby_players(snapshot, snapshot->payloads[filter]);
+		}
+		__atomic_store_n(&snapshot->encoded[filter], LOBBY_PAYLOAD_READY,
+				__ATOMIC_RELEASE);
+		return snapshot->payloads[filter];
+	}
+	while (__atomic_load_n(&snapshot->encoded[filter], __ATOMIC_ACQUIRE)
+			!= LOBBY_PAYLOAD_READY) {
+		sched_yield();
+	}
+	return snapshot->payloads[filter];
+}
+
+/**
+ * Gets the current lobby snapshot. The snapshot stays valid until it is released.
+ * @param[in] lobby Pointer to the lobby.
+ * @return Pointer to the current snapshot.
+ * \sa release_lobby_snapshot
+ */
+lobby_snapshot_s*
+acquire_lobby_snapshot(lobby_s *lobby) {
+	lobby_snapshot_s *snapshot;
+	if (lobby_reader_slot == -1) {
+		lobby_reader_slot = __atomic_fetch_add(&lobby->next_reader_slot, 1,
+				__ATOMIC_RELAXED);
+	}
+	if (lobby_reader_slot >= LOBBY_READERS) {
+		/* out of hazard slots - fall back to blocking writers */
+		pthread_mutex_lock(&lobby->mutex);
+		return lobby->current;
+	}
+	do {
+		snapshot = __atomic_load_n(&lobby->current, __ATOMIC_ACQUIRE);
+		__atomic_store_n(&lobby->hazards[lobby_reader_slot], snapshot,
+				__ATOMIC_SEQ_CST);
+	} while (snapshot != __atomic_load_n(&lobby->current, __ATOMIC_SEQ_CST));
+	return snapshot;
+}
+
+/**
+ * Releases a snapshot obtained by acquire_lobby_snapshot.
+ * @param[in] lobby    Pointer to the lobby.
+ * @param[in] snapshot Pointer to the snapshot to be released.
+ */
+void
+release_lobby_snapshot(lobby_s *lobby, lobby_snapshot_s *snapshot) {
+	if (lobby_reader_slot >= LOBBY_READERS) {
+		pthread_mutex_unlock(&lobby->mutex);
+		return;
+	}
+	__atomic_store_n(&lobby->hazards[lobby_reader_slot], NULL, __ATOMIC_RELEASE);
+}
+
+/**
+ * Destroys the lobby together with all its snapshots.
+ * @param[in] lobby Pointer to the lobby.
+ */
+void
+destroy_lobby(lobby_s *lobby) {
+	lobby_snapshot_s *next, *snapshot = lobby->retired;
+	while (snapshot != NULL) {
+		next = snapshot->next;
+		free(snapshot);
+		snapshot = next;
+	}
+	free(lobby->current);
+	pthread_mutex_destroy(&lobby->mutex);
+	free(lobby);
+}
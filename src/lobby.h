@@ -0,0 +1,24 @@
+/**
+ * @file lobby.h
+ * @ingroup lobby
+ *
+ * @author Piotr Janaszek <janas03@yahoo.pl>
+ * @date Created on: Oct 18, 2026
+ *
+ * @brief File containing methods for publishing and reading snapshots of the games lobby.
+ */
+
+#ifndef LOBBY_H_
+#define LOBBY_H_
+
+#include "structs.h"
+
+lobby_s* create_lobby(games_list_s *games_list, pthread_mutex_t *games_list_mutex,
+		players_list_s *players_list, pthread_mutex_t *players_list_mutex);
+void publish_lobby(lobby_s *lobby);
+char* get_lobby_payload(lobby_snapshot_s *snapshot, lobby_filter_e filter);
+lobby_snapshot_s* acquire_lobby_snapshot(lobby_s *lobby);
+void release_lobby_snapshot(lobby_s *lobby, lobby_snapshot_s *snapshot);
+void destroy_lobby(lobby_s *lobby);
+
+#endif /* LOBBY_H_ */
@@ -0,0 +1,390 @@
+/**
+ * @file logger.c
+ * @ingroup logger
+ *
+ * @author Piotr Janaszek <janas03@yahoo.pl>
+ * @date Created on: Oct 18, 2026
+ *
+ * @brief File containing methods for logging through per-thread rings.
+ *
+ * Every thread logs into its own ring found through a thread-local pointer,
+ * so logging takes no lock and makes no system call but reading the clock. An
+ * entry with integer arguments keeps a pointer to its format, which has to be
+ * a string literal, and the arguments; formatting it is left to the flusher.
+ * Entries with other arguments are formatted by the logging thread into the
+ * entry. A full ring drops the entry rather than wait. A background thread
+ * flushes all the rings to the standard error every LOG_FLUSH_MS, merging
+ * their entries by time and writing them in batches. Rings are registered on
+ * the first entry of a thread and handed to the next thread when their owner
+ * ends, so they are never freed. Until the logger starts, after it stops, and
+ * in programs that never start it, entries are written at once.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <unistd.h>
+#include <signal.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "config.h"
+#include "structs.h"
+
+/**
+ * Size of the buffer a batch of entries is formatted into.
+ */
+#define LOG_BUFFER_SIZE 65536
+
+/**
+ * Names of the log levels.
+ */
+static const char *log_level_names[LOG_LEVELS_NO] = {
+	"DEBUG", "INFO", "WARNING", "ERROR"
+};
+
+/**
+ * The registered rings, only ever prepended to.
+ */
+static log_ring_s *log_rings = NULL;
+
+/**
+ * Mutex guarding registration of rings.
+ */
+static pthread_mutex_t log_rings_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Mutex letting one thread flush at a time.
+ */
+static pthread_mutex_t log_flush_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Key releasing the ring of a thread when the thread ends.
+ */
+static pthread_key_t log_key;
+
+/**
+ * Makes the key be created once.
+ */
+static pthread_once_t log_once = PTHREAD_ONCE_INIT;
+
+/**
+ * The ring of the current thread or NULL before its first entry.
+ */
+static __thread log_ring_s *log_ring = NULL;
+
+/**
+ * Whether the flusher runs.
+ */
+static int log_running = 0;
+
+/**
+ * Whether the flusher is being stopped.
+ */
+static volatile int log_stopping = 0;
+
+/**
+ * The flusher thread.
+ */
+static pthread_t log_thread;
+
+/**
+ * Hands the ring of an ending thread over to the next registering thread.
+ * @param[in] ring Pointer to the ring.
+ */
+void
+release_log_ring(void *ring) {
+	pthread_mutex_lock(&log_rings_mutex);
+	((log_ring_s*) ring)->owned = 0;
+	pthread_mutex_unlock(&log_rings_mutex);
+}
+
+/**
+ * Creates the key releasing rings.
+ */
+void
+create_log_key(void) {
+	pthread_key_create(&log_key, release_log_ring);
+}
+
+/**
+ * Gets the ring of the current thread, registering one on the first call.
+ * @return Pointer to the ring or NULL when none can be allocated.
+ * \sa log_ring_s
+ */
+log_ring_s*
+get_log_ring(void) {
+	log_ring_s *ring;
+	if (log_ring != NULL) {
+		return log_ring;
+	}
+	pthread_once(&log_once, create_log_key);
+	pthread_mutex_lock(&log_rings_mutex);
+	for (ring = log_rings; ring != NULL && ring->owned; ring = ring->next)
+		;
+	if (ring == NULL && posix_memalign((void**) &ring, CACHE_LINE_SIZE,
+			sizeof(log_ring_s)) == 0) {
+		memset(ring, 0, sizeof(log_ring_s));
+		ring->next = log_rings;
+		/* the flusher walks the rings without the mutex */
+		__atomic_store_n(&log_rings, ring, __ATOMIC_RELEASE);
+	} else if (ring == NULL) {
+		pthread_mutex_unlock(&log_rings_mutex);
+		return NULL;
+	}
+	ring->owned = 1;
+	pthread_mutex_unlock(&log_rings_mutex);
+	pthread_setspecific(log_key, ring);
+	return log_ring = ring;
+}
+
+/**
+ * Formats an entry as a line: the time, the level and the message.
+ * @param[in]  entry  Pointer to the entry.
+ * @param[out] buffer Buffer to format the line into.
+ * @param[in]  size   Size of the buffer.
+ * @return Length of the line, at most size - 1.
+ * \sa log_entry_s
+ */
+int
+format_log_entry(const log_entry_s *entry, char *buffer, int size) {
+	int length;
+	time_t seconds = entry->time / 1000000000LL;
+	struct tm tm;
+	localtime_r(&seconds, &tm);
+	length = strftime(buffer, size, "%Y-%m-%d %H:%M:%S", &tm);
+	length += snprintf(buffer + length, size - length, ".%06lld %-7s ",
+			entry->time % 1000000000LL / 1000, log_level_names[entry->level]);
+	if (entry->format != NULL) {
+		length += snprintf(buffer + length, size - length, entry->format,
+				entry->args[0], entry->args[1], entry->args[2],
+				entry->args[3]);
+	} else {
+		length += snprintf(buffer + length, size - length, "%s", entry->text);
+	}
+	if (length > size - 2) {
+		length = size - 2;
+	}
+	buffer[length++] = '\n';
+	buffer[length] = '\0';
+	return length;
+}
+
+/**
+ * Writes a whole buffer to the standard error.
+ * @param[in] buffer The buffer.
+ * @param[in] length Number of bytes to write.
+ */
+void
+write_logs(const char *buffer, int length) {
+	ssize_t written;
+	while (length > 0) {
+		if ((written = write(STDERR_FILENO, buffer, length)) <= 0) {
+			return;
+		}
+		buffer += written;
+		length -= written;
+	}
+}
+
+/**
+ * Writes an entry at once, used while the flusher does not run.
+ * @param[in] entry Pointer to the entry.
+ */
+void
+write_log_entry(const log_entry_s *entry) {
+	char line[LOG_TEXT_SIZE + 128];
+	write_logs(line, format_log_entry(entry, line, sizeof(line)));
+}
+
+/**
+ * Takes the next free entry of the ring of the current thread.
+ * @return Pointer to the entry or NULL when the ring is full.
+ */
+static inline log_entry_s*
+reserve_log_entry(log_ring_s *ring) {
+	if (ring->head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE)
+			>= LOG_RING_SIZE) {
+		__atomic_store_n(&ring->dropped, ring->dropped + 1, __ATOMIC_RELAXED);
+		return NULL;
+	}
+	return &ring->entries[ring->head & (LOG_RING_SIZE - 1)];
+}
+
+/**
+ * Logs a format whose conversions all take int arguments, up to LOG_ARGS_NO
+ * of them. The format is kept by pointer, so it has to outlive the entry.
+ * Called through the LOG_DEBUG, LOG_INFO, LOG_WARNING and LOG_ERROR macros,
+ * which pass LOG_ARGS_NO zeros after the arguments, so exactly LOG_ARGS_NO
+ * arguments are read.
+ * @param[in] level  Level of the entry.
+ * @param[in] format The format.
+ * \sa log_level_e
+ */
+void
+log_event(log_level_e level, const char *format, ...) {
+	int i;
+	va_list args;
+	struct timespec now;
+	log_entry_s local, *entry = &local;
+	log_ring_s *ring = __atomic_load_n(&log_running, __ATOMIC_RELAXED)
+			? get_log_ring() : NULL;
+	if (ring != NULL && (entry = reserve_log_entry(ring)) == NULL) {
+		return;
+	}
+	clock_gettime(CLOCK_REALTIME, &now);
+	entry->time = now.tv_sec * 1000000000LL + now.tv_nsec;
+	entry->level = level;
+	entry->format = format;
+	va_start(args, format);
+	for (i = 0; i < LOG_ARGS_NO; i++) {
+		entry->args[i] = va_arg(args, int);
+	}
+	va_end(args);
+	if (ring == NULL) {
+		write_log_entry(entry);
+		return;
+	}
+	__atomic_store_n(&ring->head, ring->head + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * Logs a format with any arguments. The text is formatted at once, cut at
+ * LOG_TEXT_SIZE.
+ * @param[in] level  Level of the entry.
+ * @param[in] format The format.
+ * \sa log_level_e
+ */
+void
+log_text(log_level_e level, const char *format, ...) {
+	va_list args;
+	struct timespec now;
+	log_entry_s local, *entry = &local;
+	log_ring_s *ring = __atomic_load_n(&log_running, __ATOMIC_RELAXED)
+			? get_log_ring() : NULL;
+	if (ring != NULL && (entry = reserve_log_entry(ring)) == NULL) {
+		return;
+	}
+	clock_gettime(CLOCK_REALTIME, &now);
+	entry->time = now.tv_sec * 1000000000LL + now.tv_nsec;
+	entry->level = level;
+	entry->format = NULL;
+	va_start(args, format);
+	vsnprintf(entry->text, LOG_TEXT_SIZE, format, args);
+	va_end(args);
+	if (ring == NULL) {
+		write_log_entry(entry);
+		return;
+	}
+	__atomic_store_n(&ring->head, ring->head + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * Writes out the entries of all the rings, and how many entries were dropped
+ * since the last flush. The entries found in the rings when the flush starts
+ * are merged by time.
+ */
+void
+flush_logs(void) {
+	int length = 0;
+	char *buffer;
+	uint64_t dropped;
+	log_entry_s *entry, *first;
+	log_ring_s *ring, *oldest, *rings;
+	if ((buffer = malloc(LOG_BUFFER_SIZE)) == NULL) {
+		return;
+	}
+	pthread_mutex_lock(&log_flush_mutex);
+	rings = __atomic_load_n(&log_rings, __ATOMIC_ACQUIRE);
+	for (ring = rings; ring != NULL; ring = ring->next) {
+		ring->limit = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+		dropped = __atomic_load_n(&ring->dropped, __ATOMIC_RELAXED);
+		if (dropped != ring->reported) {
+			length += snprintf(buffer + length, LOG_BUFFER_SIZE - length,
+					"Logger: %llu entries dropped\n",
+					(unsigned long long) (dropped - ring->reported));
+			ring->reported = dropped;
+		}
+	}
+	for (;;) {
+		oldest = NULL;
+		first = NULL;
+		for (ring = rings; ring != NULL; ring = ring->next) {
+			if (ring->tail == ring->limit) {
+				continue;
+			}
+			entry = &ring->entries[ring->tail & (LOG_RING_SIZE - 1)];
+			if (first == NULL || entry->time < first->time) {
+				oldest = ring;
+				first = entry;
+			}
+		}
+		if (oldest == NULL) {
+			break;
+		}
+		if (length > LOG_BUFFER_SIZE - LOG_TEXT_SIZE - 256) {
+			write_logs(buffer, length);
+			length = 0;
+		}
+		length += format_log_entry(first, buffer + length,
+				LOG_BUFFER_SIZE - length);
+		/* the entry may be reused once formatted */
+		__atomic_store_n(&oldest->tail, oldest->tail + 1, __ATOMIC_RELEASE);
+	}
+	write_logs(buffer, length);
+	pthread_mutex_unlock(&log_flush_mutex);
+	free(buffer);
+}
+
+/**
+ * Flushes the rings every LOG_FLUSH_MS until the logger stops.
+ * @param[in] arg Unused.
+ * @return NULL.
+ */
+void*
+run_log_flusher(void *arg) {
+	sigset_t mask;
+	struct timespec interval = { LOG_FLUSH_MS / 1000,
+			(LOG_FLUSH_MS % 1000) * 1000000L };
+	/* signals are left to the other threads */
+	sigfillset(&mask);
+	pthread_sigmask(SIG_BLOCK, &mask, NULL);
+	while (!log_stopping) {
+		nanosleep(&interval, NULL);
+		flush_logs();
+	}
+	return NULL;
+}
+
+/**
+ * Starts the flusher, after which entries go through the rings. Entries
+ * still in the rings when the program exits are flushed then.
+ * @retval  0 Upon success.
+ * @retval -1 When the flusher cannot be started.
+ */
+int
+start_logger(void) {
+	if (pthread_create(&log_thread, NULL, run_log_flusher, NULL) != 0) {
+		return -1;
+	}
+	atexit(flush_logs);
+	__atomic_store_n(&log_running, 1, __ATOMIC_RELAXED);
+	return 0;
+}
+
+/**
+ * Stops the flusher, writes out the remaining entries and goes back to
+ * writing entries at once.
+ */
+void
+stop_logger(void) {
+	if (!log_running) {
+		return;
+	}
+	__atomic_store_n(&log_running, 0, __ATOMIC_RELAXED);
+	log_stopping = 1;
+	pthread_join(log_thread, NULL);
+	flush_logs();
+}
@@ -0,0 +1,53 @@
+/**
+ * @file logger.h
+ * @ingroup logger
+ *
+ * @author Piotr Janaszek <janas03@yahoo.pl>
+ * @date Created on: Oct 18, 2026
+ *
+ * @brief File containing methods for logging through per-thread rings.
+ */
+
+#ifndef LOGGER_H_
+#define LOGGER_H_
+
+#include "config.h"
+#include "enums.h"
+
+/*! \def LOG_DEBUG(...)
+ * Macros logging a format with up to LOG_ARGS_NO integer arguments at a
+ * level, formatted later by the flusher. The _TEXT variants take any
+ * arguments and format them at once. Levels below LOG_LEVEL compile to
+ * nothing, arguments included.
+ */
+#if LOG_LEVEL <= 0
+#define LOG_DEBUG(...) log_event(LOG_LEVEL_DEBUG, __VA_ARGS__, 0, 0, 0, 0)
+#define LOG_DEBUG_TEXT(...) log_text(LOG_LEVEL_DEBUG, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) ((void) 0)
+#define LOG_DEBUG_TEXT(...) ((void) 0)
+#endif
+#if LOG_LEVEL <= 1
+#define LOG_INFO(...) log_event(LOG_LEVEL_INFO, __VA_ARGS__, 0, 0, 0, 0)
+#define LOG_INFO_TEXT(...) log_text(LOG_LEVEL_INFO, __VA_ARGS__)
+#else
+#define LOG_INFO(...) ((void) 0)
+#define LOG_INFO_TEXT(...) ((void) 0)
+#endif
+#if LOG_LEVEL <= 2
+#define LOG_WARNING(...) log_event(LOG_LEVEL_WARNING, __VA_ARGS__, 0, 0, 0, 0)
+#define LOG_WARNING_TEXT(...) log_text(LOG_LEVEL_WARNING, __VA_ARGS__)
+#else
+#define LOG_WARNING(...) ((void) 0)
+#define LOG_WARNING_TEXT(...) ((void) 0)
+#endif
+#define LOG_ERROR(...) log_event(LOG_LEVEL_ERROR, __VA_ARGS__, 0, 0, 0, 0)
+#define LOG_ERROR_TEXT(...) log_text(LOG_LEVEL_ERROR, __VA_ARGS__)
+
+void log_event(log_level_e level, const char *format, ...);
+void log_text(log_level_e level, const char *format, ...);
+void flush_logs(void);
+int start_logger(void);
+void stop_logger(void);
+
+#endif /* LOGGER_H_ */
@@ -0,0 +1,111 @@
+/**
+ * @file matchmaker.c
+ * @ingroup matchmaker
+ *
+ * @author Piotr Janaszek <janas03@yahoo.pl>
+ * @date Created on: Oct 18, 2026
+ *
+ * @brief File containing methods for queueing players waiting for a quick match.
+ *
+ * There is one FIFO queue per board size. Players are linked into a queue
+ * through their own queue links, so enqueueing, pairing and leaving a queue
+ * take constant time. Queues are used by the main server loop only.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "config.h"
+#include "structs.h"
+
+/**
+ * Creates the matchmaker with empty queues for every board size.
+ * @return Pointer to the created matchmaker or NULL upon error.
+ * \sa matchmaker_s
+ */
+matchmaker_s*
+create_matchmaker(void) {
+	matchmaker_s *matchmaker = NULL;
+	matchmaker = malloc(sizeof(matchmaker_s));
+	if (matchmaker == NULL) {
+		fprintf(stderr, "Cannot allocate memory for matchmaker\n");
+		return NULL;
+	}
+	memset(matchmaker, 0, sizeof(matchmaker_s));
+	return matchmaker;
+}
+
+/**
+ * Adds a player to the end of the queue for a given board size.
+ * @param[in] matchmaker Pointer to the matchmaker.
+ * @param[in] player     Pointer to a player waiting for an opponent.
+ * @param[in] size       Size of the board the player wants to play on.
+ * \sa player_s
+ */
+void
+enqueue_player(matchmaker_s *matchmaker, player_s *player, int size) {
+	player->queue_prev = matchmaker->tails[size];
+	player->queue_next = NULL;
+	player->queued_size = size;
+	if (matchmaker->tails[size] != NULL) {
+		matchmaker->tails[size]->queue_next = player;
+	} else {
+		matchmaker->heads[size] = player;
+	}
+	matchmaker->tails[size] = player;
+}
+
+/**
+ * Removes a player from the queue it waits in. Does nothing when the player
+ * is not queued.
+ * @param[in] matchmaker Pointer to the matchmaker.
+ * @param[in] player     Pointer to a player to be removed.
+ * \sa player_s
+ */
+void
+remove_queued_player(matchmaker_s *matchmaker, player_s *player) {
+	int size = player->queued_size;
+	if (size == 0) {
+		return;
+	}
+	if (player->queue_prev != NULL) {
+		player->queue_prev->queue_next = player->queue_next;
+	} else {
+		matchmaker->heads[size] = player->queue_next;
+	}
+	if (player->queue_next != NULL) {
+		player->queue_next->queue_prev = player->queue_prev;
+	} else {
+		matchmaker->tails[size] = player->queue_prev;
+	}
+	player->queue_prev = NULL;
+	player->queue_next = NULL;
+	player->queued_size = 0;
+}
+
+/**
+ * Takes the player waiting longest for a given board size out of the queue.
+ * @param[in] matchmaker Pointer to the matchmaker.
+ * @param[in] size       Size of the board.
+ * @return Pointer to the dequeued player or NULL when nobody waits.
+ * \sa player_s
+ */
+player_s*
+dequeue_player(matchmaker_s *matchmaker, int size) {
+	player_s *player = matchmaker->heads[size];
+	if (player != NULL) {
+		remove_queued_player(matchmaker, player);
+	}
+	return player;
+}
+
+/**
+ * Destroys the matchmaker. Queued players are owned by the players list.
+ * @param[in] matchmaker Pointer to the matchmaker.
+ */
+void
+destroy_matchmaker(matchmaker_s *matchmaker) {
+	free(matchmaker);
+}
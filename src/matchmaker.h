@@ -0,0 +1,22 @@
+/**
+ * @file matchmaker.h
+ * @ingroup matchmaker
+ *
+ * @author Piotr Janaszek <janas03@yahoo.pl>
+ * @date Created on: Oct 18, 2026
+ *
+ * @brief File containing methods for queueing players waiting for a quick match.
+ */
+
+#ifndef MATCHMAKER_H_
+#define MATCHMAKER_H_
+
+#include "structs.h"
+
+matchmaker_s* create_matchmaker(void);
+void enqueue_player(matchmaker_s *matchmaker, player_s *player, int size);
+player_s* dequeue_player(matchmaker_s *matchmaker, int size);
+void remove_queued_player(matchmaker_s *matchmaker, player_s *player);
+void destroy_matchmaker(matchmaker_s *matchmaker);
+
+#endif /* MATCHMAKER_H_ */
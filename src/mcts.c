@@ -0,0 +1,676 @@
+/**
+ * @file mcts.c
+ * @ingroup mcts
+ *
+ * @author Piotr Janaszek <janas03@yahoo.pl>
+ * @date Created on: Oct 18, 2026
+ *
+ * @brief File containing methods for Monte Carlo tree search with batched random playouts.
+ *
+ * The tree is grown by UCT: from the root the child with the best sum of its
+ * win rate and an exploration bonus is followed down to a leaf, the leaf is
+ * expanded with the moves the alpha-beta bot would consider, and a batch of
+ * MCTS_BATCH random games is played from the first new child. The games of a
+ * batch run in lockstep, one move in every lane per step. The batch keeps its
+ * bitboards and lists of empty fields structure-of-arrays, with the lanes of
+ * a word side by side, so a vector holds the same word of several lanes. Every
+ * step draws the random numbers of all lanes in vectors and gathers the drawn
+ * fields, puts the pawns lane by lane and checks all lanes for a line with
+ * the doubling shift/and of check_line. Like board_scanner.c the kernels are
+ * chosen once for the running CPU, AVX2, SSE2 or plain C, and a debug build
+ * compares the vector result with the scalar one. The results of the batch
+ * are counted once on the way back to the root. Moves winning at once end the game in the tree itself
+ * and threats to win in one move leave only the blocking replies, as in the
+ * alpha-beta search.
+ *
+ * A search owns its tree and its batch, so several searches of the same
+ * position run on different cores without locks and their root results are
+ * summed by the caller.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define MCTS_X86
+#endif
+
+#include "arena.h"
+#include "board_handler.h"
+#include "bot.h"
+#include "common.h"
+#include "config.h"
+#include "structs.h"
+
+_Static_assert(MCTS_BATCH % 4 == 0 && MCTS_BATCH <= 32,
+		"lanes are checked four at a time and reported in a 32-bit mask");
+
+/**
+ * Kernel drawing a field in every lane, chosen for the running CPU.
+ */
+static void (*draw_kernel)(playout_batch_s *batch);
+
+/**
+ * Kernel checking the lanes for lines of pawns, chosen for the running CPU.
+ */
+static unsigned (*lines_kernel)(uint64_t (*bits)[MCTS_BATCH], int words,
+		int stride, int win_length);
+
+/**
+ * Guards the choice of the kernels.
+ */
+static pthread_once_t lane_kernels_once = PTHREAD_ONCE_INIT;
+
+/**
+ * Draws an entry of the list of empty fields in every lane, one lane at a
+ * time. The random generators are xorshift64, which needs no 64-bit
+ * multiplication and so runs in vectors too, and the entry is the high half
+ * of a draw scaled by the length of the list.
+ * @param[in,out] batch Pointer to the batch.
+ * \sa playout_batch_s
+ */
+void
+draw_lanes_scalar(playout_batch_s *batch) {
+	int lane;
+	uint64_t seed;
+	for (lane = 0; lane < MCTS_BATCH; lane++) {
+		seed = batch->seeds[lane];
+		seed ^= seed << 13;
+		seed ^= seed >> 7;
+		seed ^= seed << 17;
+		batch->seeds[lane] = seed;
+		batch->picks[lane] = (seed >> 32) * batch->no_empty[lane] >> 32;
+		batch->cells[lane] = batch->empty[batch->picks[lane]][lane];
+	}
+}
+
+/**
+ * Checks the lanes for lines of pawns one lane at a time, the same way as
+ * check_line: every step ands the bitboard with a copy shifted by a multiple
+ * of the distance between fields of a line, doubling the length of the runs.
+ * @param[in] bits       Words of the bitboards of a player, lanes side by side.
+ * @param[in] words      Number of words of a bitboard.
+ * @param[in] stride     Distance in bits between vertically adjacent fields.
+ * @param[in] win_length Number of consecutive pawns needed to win.
+ * @return Mask of the lanes holding a line.
+ */
+unsigned
+check_lanes_scalar(uint64_t (*bits)[MCTS_BATCH], int words, int stride,
+		int win_length) {
+	const int distances[4] = { 1, stride, stride + 1, stride - 1 };
+	int lane, d, i, q, r, length, step;
+	uint64_t runs[BOARD_WORDS], shifted, found;
+	unsigned lines = 0;
+	for (lane = 0; lane < MCTS_BATCH; lane++) {
+		found = 0;
+		for (d = 0; d < 4; d++) {
+			for (i = 0; i < words; i++) {
+				runs[i] = bits[i][lane];
+			}
+			for (length = 1; length < win_length; length += step) {
+				step = length * 2 <= win_length ? length : win_length - length;
+				q = step * distances[d] / 64;
+				r = step * distances[d] % 64;
+				for (i = 0; i < words; i++) {
+					shifted = i + q < words ? runs[i + q] >> r : 0;
+					if (r > 0 && i + q + 1 < words) {
+						shifted |= runs[i + q + 1] << (64 - r);
+					}
+					runs[i] &= shifted;
+				}
+			}
+			for (i = 0; i < words; i++) {
+				found |= runs[i];
+			}
+		}
+		if (found != 0) {
+			lines |= 1u << lane;
+		}
+	}
+	return lines;
+}
+
+#ifdef MCTS_X86
+
+/**
+ * Draws an entry of the list of empty fields in every lane, two lanes at a
+ * time. SSE2 has no gather, so the fields are read one by one.
+ * @param[in,out] batch Pointer to the batch.
+ * \sa draw_lanes_scalar
+ */
+__attribute__((target("sse2")))
+void
+draw_lanes_sse2(playout_batch_s *batch) {
+	int lane;
+	__m128i seeds, picks;
+	for (lane = 0; lane < MCTS_BATCH; lane += 2) {
+		seeds = _mm_loadu_si128((const __m128i*) &batch->seeds[lane]);
+		seeds = _mm_xor_si128(seeds, _mm_slli_epi64(seeds, 13));
+		seeds = _mm_xor_si128(seeds, _mm_srli_epi64(seeds, 7));
+		seeds = _mm_xor_si128(seeds, _mm_slli_epi64(seeds, 17));
+		_mm_storeu_si128((__m128i*) &batch->seeds[lane], seeds);
+		picks = _mm_srli_epi64(_mm_mul_epu32(_mm_srli_epi64(seeds, 32),
+				_mm_loadu_si128((const __m128i*) &batch->no_empty[lane])), 32);
+		_mm_storeu_si128((__m128i*) &batch->picks[lane], picks);
+		batch->cells[lane] = batch->empty[batch->picks[lane]][lane];
+		batch->cells[lane + 1] = batch->empty[batch->picks[lane + 1]][lane + 1];
+	}
+}
+
+/**
+ * Checks the lanes for lines of pawns two lanes at a time.
+ * @param[in] bits       Words of the bitboards of a player, lanes side by side.
+ * @param[in] words      Number of words of a bitboard.
+ * @param[in] stride     Distance in bits between vertically adjacent fields.
+ * @param[in] win_length Number of consecutive pawns needed to win.
+ * @return Mask of the lanes holding a line.
+ * \sa check_lanes_scalar
+ */
+__attribute__((target("sse2")))
+unsigned
+check_lanes_sse2(uint64_t (*bits)[MCTS_BATCH], int words, int stride,
+		int win_length) {
+	const int distances[4] = { 1, stride, stride + 1, stride - 1 };
+	int lane, d, i, q, r, length, step, zero;
+	__m128i runs[BOARD_WORDS], shifted, found, right, left;
+	unsigned lines = 0;
+	for (lane = 0; lane < MCTS_BATCH; lane += 2) {
+		found = _mm_setzero_si128();
+		for (d = 0; d < 4; d++) {
+			for (i = 0; i < words; i++) {
+				runs[i] = _mm_loadu_si128((const __m128i*) &bits[i][lane]);
+			}
+			for (length = 1; length < win_length; length += step) {
+				step = length * 2 <= win_length ? length : win_length - length;
+				q = step * distances[d] / 64;
+				r = step * distances[d] % 64;
+				right = _mm_cvtsi32_si128(r);
+				/* shifting by 64 gives zero, which is what r == 0 needs */
+				left = _mm_cvtsi32_si128(64 - r);
+				for (i = 0; i < words; i++) {
+					shifted = i + q < words ?
+							_mm_srl_epi64(runs[i + q], right) :
+							_mm_setzero_si128();
+					if (i + q + 1 < words) {
+						shifted = _mm_or_si128(shifted,
+								_mm_sll_epi64(runs[i + q + 1], left));
+					}
+					runs[i] = _mm_and_si128(runs[i], shifted);
+				}
+			}
+			for (i = 0; i < words; i++) {
+				found = _mm_or_si128(found, runs[i]);
+			}
+		}
+		/* a lane is clear when both of its 32-bit halves are zero */
+		zero = _mm_movemask_epi8(_mm_cmpeq_epi32(found, _mm_setzero_si128()));
+		lines |= (unsigned) (((zero & 0xFF) != 0xFF)
+				| ((zero >> 8) != 0xFF) << 1) << lane;
+	}
+	return lines;
+}
+
+/**
+ * Draws an entry of the list of empty fields in every lane, four lanes at a
+ * time, and gathers the fields of the entries.
+ * @param[in,out] batch Pointer to the batch.
+ * \sa draw_lanes_scalar
+ */
+__attribute__((target("avx2")))
+void
+draw_lanes_avx2(playout_batch_s *batch) {
+	int lane;
+	__m256i seeds, picks, offsets;
+	const __m256i lanes = _mm256_set_epi64x(3, 2, 1, 0);
+	const __m256i batch_size = _mm256_set1_epi64x(MCTS_BATCH);
+	for (lane = 0; lane < MCTS_BATCH; lane += 4) {
+		seeds = _mm256_loadu_si256((const __m256i*) &batch->seeds[lane]);
+		seeds = _mm256_xor_si256(seeds, _mm256_slli_epi64(seeds, 13));
+		seeds = _mm256_xor_si256(seeds, _mm256_srli_epi64(seeds, 7));
+		seeds = _mm256_xor_si256(seeds, _mm256_slli_epi64(seeds, 17));
+		_mm256_storeu_si256((__m256i*) &batch->seeds[lane], seeds);
+		picks = _mm256_srli_epi64(_mm256_mul_epu32(
+				_mm256_srli_epi64(seeds, 32),
+				_mm256_loadu_si256((const __m256i*) &batch->no_empty[lane])), 32);
+		_mm256_storeu_si256((__m256i*) &batch->picks[lane], picks);
+		offsets = _mm256_add_epi64(_mm256_mul_epu32(picks, batch_size),
+				_mm256_add_epi64(lanes, _mm256_set1_epi64x(lane)));
+		_mm_storeu_si128((__m128i*) &batch->cells[lane],
+				_mm256_i64gather_epi32(&batch->empty[0][0], offsets, 4));
+	}
+}
+
+/**
+ * Checks the lanes for lines of pawns four lanes at a time.
+ * @param[in] bits       Words of the bitboards of a player, lanes side by side.
+ * @param[in] words      Number of words of a bitboard.
+ * @param[in] stride     Distance in bits between vertically adjacent fields.
+ * @param[in] win_length Number of consecutive pawns needed to win.
+ * @return Mask of the lanes holding a line.
+ * \sa check_lanes_scalar
+ */
+__attribute__((target("avx2")))
+unsigned
+check_lanes_avx2(uint64_t (*bits)[MCTS_BATCH], int words, int stride,
+		int win_length) {
+	const int distances[4] = { 1, stride, stride + 1, stride - 1 };
+	int lane, d, i, q, r, length, step;
+	__m256i runs[BOARD_WORDS], shifted, found;
+	__m128i right, left;
+	unsigned lines = 0;
+	for (lane = 0; lane < MCTS_BATCH; lane += 4) {
+		found = _mm256_setzero_si256();
+		for (d = 0; d < 4; d++) {
+			for (i = 0; i < words; i++) {
+				runs[i] = _mm256_loadu_si256((const __m256i*) &bits[i][lane]);
+			}
+			for (length = 1; length < win_length; length += step) {
+				step = length * 2 <= win_length ? length : win_length - length;
+				q = step * distances[d] / 64;
+				r = step * distances[d] % 64;
+				right = _mm_cvtsi32_si128(r);
+				/* shifting by 64 gives zero, which is what r == 0 needs */
+				left = _mm_cvtsi32_si128(64 - r);
+				for (i = 0; i < words; i++) {
+					shifted = i + q < words ?
+							_mm256_srl_epi64(runs[i + q], right) :
+							_mm256_setzero_si256();
+					if (i + q + 1 < words) {
+						shifted = _mm256_or_si256(shifted,
+								_mm256_sll_epi64(runs[i + q + 1], left));
+					}
+					runs[i] = _mm256_and_si256(runs[i], shifted);
+				}
+			}
+			for (i = 0; i < words; i++) {
+				found = _mm256_or_si256(found, runs[i]);
+			}
+		}
+		lines |= (unsigned) (~_mm256_movemask_pd(_mm256_castsi256_pd(
+				_mm256_cmpeq_epi64(found, _mm256_setzero_si256()))) & 15)
+				<< lane;
+	}
+	return lines;
+}
+
+#endif
+
+/**
+ * Chooses the widest kernels supported by the running CPU.
+ */
+void
+choose_lane_kernels(void) {
+	draw_kernel = draw_lanes_scalar;
+	lines_kernel = check_lanes_scalar;
+#ifdef MCTS_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) {
+		draw_kernel = draw_lanes_avx2;
+		lines_kernel = check_lanes_avx2;
+	} else if (__builtin_cpu_supports("sse2")) {
+		draw_kernel = draw_lanes_sse2;
+		lines_kernel = check_lanes_sse2;
+	}
+#endif
+}
+
+/**
+ * Creates a batch of playouts.
+ * @param[in] arena      Pointer to the arena the batch is allocated from.
+ * @param[in] size       Size of the board.
+ * @param[in] win_length Number of consecutive pawns needed to win.
+ * @return Pointer to the batch or NULL when the arena is too small.
+ * \sa playout_batch_s
+ */
+playout_batch_s*
+create_playout_batch(arena_s *arena, int size, int win_length) {
+	playout_batch_s *batch = arena_alloc_aligned(arena,
+			sizeof(playout_batch_s), CACHE_LINE_SIZE);
+	if (batch == NULL) {
+		return NULL;
+	}
+	if ((batch->board = create_new_board(arena, size, win_length)) == NULL) {
+		return NULL;
+	}
+	pthread_once(&lane_kernels_once, choose_lane_kernels);
+	return batch;
+}
+
+/**
+ * Plays a batch of random games from a position. All lanes start from the
+ * position and advance together until every game is won or drawn. A step
+ * draws a field in every lane and checks the bitboards of all lanes at once;
+ * a lane still running has no line before the step, so a line found after it
+ * goes through the field just taken.
+ * @param[in] batch  Pointer to the batch.
+ * @param[in] search Pointer to the position and the rules.
+ * @param[in] seed   Seed the lanes' generators are derived from.
+ * @return Wins of the player who made the last move of the position, a draw
+ * counting as half a win.
+ * \sa playout_batch_s search_s
+ */
+double
+run_playouts(playout_batch_s *batch, search_s *search, uint64_t seed) {
+	int i, lane, running, side, cell, bit, x, y, n = 0, size = search->size;
+	int words = batch->board->words, stride = batch->board->stride;
+	int empty[MAX_BOARD_SIZE * MAX_BOARD_SIZE];
+	uint64_t position[2][BOARD_WORDS];
+	unsigned lines;
+	double wins = 0;
+	memset(position, 0, sizeof(position));
+	for (i = 0; i < size * size; i++) {
+		if (search->cells[i] != 0) {
+			bit = i / size * stride + i % size;
+			position[search->cells[i] - 1][bit >> 6] |= (uint64_t) 1
+					<< (bit & 63);
+		} else if (search->mode != GAME_MODE_GRAVITY) {
+			empty[n++] = i;
+		}
+	}
+	if (search->mode == GAME_MODE_GRAVITY) {
+		for (i = 0; i < size; i++) {
+			if (search->heights[i] < size) {
+				empty[n++] = i;
+			}
+		}
+	}
+	for (i = 0; i < words; i++) {
+		for (lane = 0; lane < MCTS_BATCH; lane++) {
+			batch->bits[0][i][lane] = position[0][i];
+			batch->bits[1][i][lane] = position[1][i];
+		}
+	}
+	for (i = 0; i < n; i++) {
+		for (lane = 0; lane < MCTS_BATCH; lane++) {
+			batch->empty[i][lane] = empty[i];
+		}
+	}
+	for (lane = 0; lane < MCTS_BATCH; lane++) {
+		memcpy(batch->heights[lane], search->heights, size * sizeof(int));
+		batch->no_empty[lane] = n;
+		/* xorshift64 never leaves zero, so no seed may be zero */
+		batch->seeds[lane] = (seed + lane + 1) * 0x9e3779b97f4a7c15ULL | 1;
+		batch->winners[lane] = n > 0 ? -1 : 0;
+	}
+	side = search->side;
+	running = n;
+	while (running > 0) {
+		draw_kernel(batch);
+		for (lane = 0; lane < MCTS_BATCH; lane++) {
+			if (batch->winners[lane] != -1) {
+				continue;
+			}
+			i = batch->picks[lane];
+			cell = batch->cells[lane];
+			if (search->mode == GAME_MODE_GRAVITY) {
+				y = cell;
+				x = size - 1 - batch->heights[lane][cell]++;
+				if (batch->heights[lane][cell] == size) {
+					batch->empty[i][lane] =
+							batch->empty[--batch->no_empty[lane]][lane];
+				}
+			} else {
+				x = cell / size;
+				y = cell % size;
+				batch->empty[i][lane] =
+						batch->empty[--batch->no_empty[lane]][lane];
+			}
+			bit = x * stride + y;
+			batch->bits[side - 1][bit >> 6][lane] |= (uint64_t) 1 << (bit & 63);
+		}
+		lines = lines_kernel(batch->bits[side - 1], words, stride,
+				search->win_length);
+#ifdef DEBUG
+		if (lines != check_lanes_scalar(batch->bits[side - 1], words, stride,
+				search->win_length)) {
+			fprintf(stderr, "Vector and scalar lane checks disagree on board %d\n",
+					size);
+			abort();
+		}
+#endif
+		running = 0;
+		for (lane = 0; lane < MCTS_BATCH; lane++) {
+			if (batch->winners[lane] != -1) {
+				continue;
+			}
+			if (lines >> lane & 1) {
+				batch->winners[lane] = side;
+			} else if (batch->no_empty[lane] == 0) {
+				batch->winners[lane] = 0;
+			} else {
+				running++;
+			}
+		}
+		side = 3 - side;
+	}
+	for (lane = 0; lane < MCTS_BATCH; lane++) {
+		if (batch->winners[lane] == 0) {
+			wins += 0.5;
+		} else if (batch->winners[lane] != search->side) {
+			wins += 1;
+		}
+	}
+	return wins;
+}
+
+/**
+ * Expands a leaf of the tree with the moves worth playing in its position.
+ * A winning move, when there is one, becomes the only child.
+ * @param[in] nodes     Pointer to the nodes of the tree.
+ * @param[in] no_nodes  Pointer to the number of nodes used.
+ * @param[in] leaf      Index of the leaf.
+ * @param[in] search    Pointer to the position of the leaf.
+ * @retval  0 When the leaf is expanded.
+ * @retval -1 When the tree is full or the position has no moves.
+ * \sa mcts_node_s
+ */
+int
+expand_node(mcts_node_s *nodes, int *no_nodes, int leaf, search_s *search) {
+	int i, j, t, n, blocks = 0;
+	int moves[MAX_BOARD_SIZE * MAX_BOARD_SIZE];
+	int scores[MAX_BOARD_SIZE * MAX_BOARD_SIZE];
+	mcts_node_s *child;
+	if ((n = generate_moves(search, moves, scores)) == 0) {
+		return -1;
+	}
+	for (i = 0; i < n; i++) {
+		if (scores[i] == ORDER_WIN) {
+			moves[0] = moves[i];
+			scores[0] = scores[i];
+			n = 1;
+			break;
+		}
+		if (scores[i] & ORDER_BLOCK) {
+			moves[blocks] = moves[i];
+			scores[blocks++] = scores[i];
+		}
+	}
+	if (n > 1 && blocks > 0) {
+		n = blocks;
+	}
+	if (*no_nodes + n > MCTS_MAX_NODES) {
+		return -1;
+	}
+	/* unvisited children are tried in this order */
+	for (i = 0; i < n; i++) {
+		for (j = i + 1; j < n; j++) {
+			if (scores[j] > scores[i]) {
+				t = scores[i];
+				scores[i] = scores[j];
+				scores[j] = t;
+				t = moves[i];
+				moves[i] = moves[j];
+				moves[j] = t;
+			}
+		}
+		child = &nodes[*no_nodes + i];
+		child->move = moves[i];
+		child->first_child = -1;
+		child->no_children = 0;
+		child->terminal = scores[i] == ORDER_WIN ? 1
+				: search->no_empty == 1 ? 2 : 0;
+		child->visits = 0;
+		child->wins = 0;
+	}
+	nodes[leaf].first_child = *no_nodes;
+	nodes[leaf].no_children = n;
+	*no_nodes += n;
+	return 0;
+}
+
+/**
+ * Chooses the child of a node to follow by UCT, unvisited children first.
+ * @param[in] nodes Pointer to the nodes of the tree.
+ * @param[in] node  Index of the node.
+ * @return Index of the chosen child.
+ * \sa mcts_node_s
+ */
+int
+select_child(mcts_node_s *nodes, int node) {
+	int i, best = -1;
+	double value, best_value = -1, log_visits = log(nodes[node].visits + 1);
+	mcts_node_s *child;
+	for (i = 0; i < nodes[node].no_children; i++) {
+		child = &nodes[nodes[node].first_child + i];
+		if (child->visits == 0) {
+			return nodes[node].first_child + i;
+		}
+		value = child->wins / child->visits
+				+ MCTS_EXPLORATION * sqrt(log_visits / child->visits);
+		if (value > best_value) {
+			best_value = value;
+			best = nodes[node].first_child + i;
+		}
+	}
+	return best;
+}
+
+/**
+ * Searches a position with one Monte Carlo tree until the deadline, the
+ * cancel flag or the playout limit of the search stops it, and adds the
+ * results of the moves at the root to the statistics.
+ * @param[in]  search Pointer to the search holding the position, the rules and the limits.
+ * @param[in]  seed   Seed making trees searched in parallel differ.
+ * @param[out] stats  Statistics the results are added to.
+ * @retval  0 When the search is done.
+ * @retval -1 When memory cannot be allocated or there is no move.
+ * \sa search_s mcts_stats_s
+ */
+int
+run_mcts(search_s *search, uint64_t seed, mcts_stats_s *stats) {
+	int i, node, depth, no_nodes = 1;
+	int path[MAX_BOARD_SIZE * MAX_BOARD_SIZE + 1];
+	long n, iterations = 0;
+	double wins;
+	search_s position;
+	mcts_node_s *nodes;
+	playout_batch_s *batch;
+	arena_s *arena = create_arena(
+			arena_aligned_size(MCTS_MAX_NODES * sizeof(mcts_node_s))
+			+ CACHE_LINE_SIZE - ARENA_ALIGNMENT
+			+ arena_aligned_size(sizeof(playout_batch_s))
+			+ get_board_arena_size(search->size, search->win_length));
+	if (arena == NULL) {
+		fprintf(stderr, "Cannot allocate memory for Monte Carlo tree\n");
+		return -1;
+	}
+	nodes = arena_alloc(arena, MCTS_MAX_NODES * sizeof(mcts_node_s));
+	batch = create_playout_batch(arena, search->size, search->win_length);
+	if (nodes == NULL || batch == NULL) {
+		destroy_arena(arena);
+		return -1;
+	}
+	nodes[0].move = -1;
+	nodes[0].first_child = -1;
+	nodes[0].no_children = 0;
+	nodes[0].terminal = 0;
+	nodes[0].visits = 0;
+	nodes[0].wins = 0;
+	search->stopped = 0;
+	if (expand_node(nodes, &no_nodes, 0, search) == -1) {
+		destroy_arena(arena);
+		return -1;
+	}
+	for (;;) {
+		if ((iterations++ & 15) == 0
+				&& (get_monotonic_ms() >= search->deadline
+						|| (search->cancelled != NULL
+								&& __atomic_load_n(search->cancelled,
+										__ATOMIC_RELAXED)))) {
+			break;
+		}
+		/* games ended in the tree are no playouts but still bound the work */
+		if (search->max_playouts > 0 && (stats->playouts >= search->max_playouts
+				|| iterations > search->max_playouts)) {
+			break;
+		}
+		position = *search;
+		node = 0;
+		depth = 0;
+		path[depth++] = node;
+		while (nodes[node].no_children > 0 && nodes[node].terminal == 0) {
+			node = select_child(nodes, node);
+			play_move(&position, nodes[node].move);
+			path[depth++] = node;
+			if (nodes[node].visits > 0 && nodes[node].terminal == 0
+					&& nodes[node].first_child == -1
+					&& expand_node(nodes, &no_nodes, node, &position) == 0) {
+				node = nodes[node].first_child;
+				play_move(&position, nodes[node].move);
+				path[depth++] = node;
+				break;
+			}
+		}
+		if (nodes[node].terminal != 0) {
+			n = 1;
+			wins = nodes[node].terminal == 1 ? 1 : 0.5;
+		} else {
+			/* wins of the player who made the last move on the path */
+			n = MCTS_BATCH;
+			wins = run_playouts(batch, &position,
+					seed ^ (uint64_t) iterations << 20);
+			stats->playouts += n;
+		}
+		for (i = 0; i < depth; i++) {
+			/* players alternate along the path */
+			nodes[path[i]].visits += n;
+			nodes[path[i]].wins +=
+					(depth - 1 - i) % 2 == 0 ? wins : n - wins;
+		}
+	}
+	for (i = 0; i < nodes[0].no_children; i++) {
+		node = nodes[0].first_child + i;
+		stats->visits[nodes[node].move] += nodes[node].visits;
+		stats->wins[nodes[node].move] += nodes[node].wins;
+	}
+	destroy_arena(arena);
+	return 0;
+}
+
+/**
+ * Chooses the move with the most playouts at the root.
+ * @param[in]  stats  Pointer to the statistics of the root.
+ * @param[in]  cells  Number of fields of the board.
+ * @param[out] value  Win rate of the player to move after the move or NULL.
+ * @return The field of the move or -1 when no move was searched.
+ * \sa mcts_stats_s
+ */
+int
+get_mcts_move(mcts_stats_s *stats, int cells, double *value) {
+	int i, best = -1;
+	for (i = 0; i < cells; i++) {
+		if (stats->visits[i] > 0
+				&& (best == -1 || stats->visits[i] > stats->visits[best])) {
+			best = i;
+		}
+	}
+	if (value != NULL) {
+		*value = best != -1 ? stats->wins[best] / stats->visits[best] : 0.5;
+	}
+	return best;
+}
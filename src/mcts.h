@@ -0,0 +1,19 @@
+/**
+ * @file mcts.h
+ * @ingroup mcts
+ *
+ * @author Piotr Janaszek <janas03@yahoo.pl>
+ * @date Created on: Oct 18, 2026
+ *
+ * @brief File containing methods for Monte Carlo tree search with batched random playouts.
+ */
+
+#ifndef MCTS_H_
+#define MCTS_H_
+
+#include "structs.h"
+
+int run_mcts(search_s *search, uint64_t seed, mcts_stats_s *stats);
+int get_mcts_move(mcts_stats_s *stats, int cells, double *value);
+
+#endif /* MCTS_H_ */
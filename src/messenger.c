@@ -24,9 +24,26 @@
 
 #include "config.h"
 #include "common.h"
+#include "logger.h"
 #include "messenger.h"
 #include "structs.h"
 
+/**
+ * Called with every response sent, NULL when nothing is.
+ */
+static response_hook_f response_hook = NULL;
+
+/**
+ * Sets the function called with the type, error and size of every response
+ * sent, so the server can count them without the clients linking its
+ * metrics. It is set before any response is sent.
+ * @param[in] hook The function or NULL for none.
+ */
+void
+set_response_hook(response_hook_f hook) {
+	response_hook = hook;
+}
+
 /**
  * Converts request structure into a character string.
  * @param[in]  request Pointer to a structure containing request data.
@@ -145,15 +162,18 @@ send_response_message(int client_fd, response_s *response) {
 	ssize_t size;
 	char *message = malloc(MAX_MSG_SIZE);
 	if (message == NULL) {
-		fprintf(stderr, "Unable to allocate memory for response string\n");
+		LOG_ERROR("Unable to allocate memory for response string");
 	}
 
 	response_to_string(response, message);
 	size = bulk_write(client_fd, message, MAX_MSG_SIZE);
 	if (size == MAX_MSG_SIZE) {
-		fprintf(stderr, "Response successfully sent to client fd %d\n",	client_fd);
+		if (response_hook != NULL) {
+			response_hook(response->type, response->error, size);
+		}
+		LOG_DEBUG("Response successfully sent to client fd %d", client_fd);
 	} else {
-		fprintf(stderr, "Error!\n");
+		LOG_WARNING("Error!");
 	}
 
 	free(message);
@@ -187,7 +207,20 @@ receive_response_message(int server_fd, response_s *response) {
 }
 
 /**
- * Sends a request and receives a response message from the server.
+ * Answers a ping of the server.
+ * @param[in] server_fd File descriptor of the socket connected to the server.
+ */
+void
+send_keepalive_message(int server_fd) {
+	request_s request;
+	request.type = MSG_KEEPALIVE_REQ;
+	memset(request.payload, 0, sizeof(request.payload));
+	send_request_message(server_fd, &request);
+}
+
+/**
+ * Sends a request and receives a response message from the server. Pings
+ * the server sent meanwhile are answered and skipped.
  * @param[in]  server_fd File descriptor of the socket connected to the server.
  * @param[in]  request   Pointer to a structure containing response data to be sent.
  * @param[out] response  Pointer to a structure containing response data to which write.
@@ -197,4 +230,8 @@ void
 send_receive_message(int server_fd, request_s *request, response_s *response) {
 	send_request_message(server_fd, request);
 	receive_response_message(server_fd, response);
+	while (response->type == MSG_KEEPALIVE_RSP) {
+		send_keepalive_message(server_fd);
+		receive_response_message(server_fd, response);
+	}
 }
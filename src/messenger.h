@@ -18,8 +18,10 @@ void string_to_request(char *message, request_s *request);
 void response_to_string(response_s *response, char *message);
 void string_to_response(char *message, response_s *response);
 void send_request_message(int server_fd, request_s * request);
+void set_response_hook(response_hook_f hook);
 void send_response_message(int client_fd, response_s *response);
 void receive_response_message(int server_fd, response_s *response);
+void send_keepalive_message(int server_fd);
 void send_receive_message(int server_fd, request_s *request, response_s *response);
 
 #endif /* MESSENGER_H_ */
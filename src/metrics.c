@@ -0,0 +1,515 @@
+/**
+ * @file metrics.c
+ * @ingroup metrics
+ *
+ * @author Piotr Janaszek <janas03@yahoo.pl>
+ * @date Created on: Oct 18, 2026
+ *
+ * @brief File containing methods for recording and exporting server metrics.
+ *
+ * Every thread records into its own shard of counters and histograms, found
+ * through a thread-local pointer, so recording is a few plain additions: a
+ * shard has a single writer, which stores with relaxed atomics and takes no
+ * lock. Shards are registered on the first record of a thread and handed to
+ * the next thread when their owner ends, so game threads coming and going do
+ * not lose counts nor grow the registry. Reading merges all the shards under
+ * the registry mutex, which only registration and readers take. Latencies go
+ * into log-linear histograms with 8 sub-buckets per power of two. The merged
+ * values are served in the Prometheus text format by a thread answering HTTP
+ * requests on a local admin port.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <signal.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "config.h"
+#include "structs.h"
+
+/**
+ * Number of bits of a value choosing its sub-bucket within a power of two.
+ */
+#define METRICS_SUB_BITS 3
+
+/**
+ * Prefix of the exported metric names.
+ */
+#define METRICS_PREFIX "four_in_a_line_"
+
+/**
+ * Names of the message types used as label values.
+ */
+static const char *message_type_names[MSG_TYPES_NO] = {
+	"leave_req", "leave_rsp", "login_req", "login_rsp", "logout_req",
+	"logout_rsp", "players_list_req", "players_list_rsp", "games_list_req",
+	"games_list_rsp", "create_game_req", "create_game_rsp", "connect_game_req",
+	"connect_game_rsp", "connect_spectator_req", "connect_spectator_rsp",
+	"print_board_req", "print_board_rsp", "check_turn_req", "check_turn_rsp",
+	"make_move_req", "make_move_rsp", "leave_message_req", "leave_message_rsp",
+	"back_to_menu_req", "back_to_menu_rsp", "print_board_spc_rsp",
+	"print_result_spc_rsp", "print_win_rsp", "print_lost_rsp",
+	"print_draw_rsp", "cleanup_rsp", "quick_match_req", "quick_match_rsp",
+	"print_cells_req", "print_cells_rsp", "print_move_spc_rsp",
+	"create_bot_game_req", "create_bot_game_rsp", "forced_outcome_spc_rsp",
+	"hint_req", "hint_rsp", "analyze_req", "analyze_rsp", "resume_req",
+	"resume_rsp", "keepalive_req", "keepalive_rsp"
+};
+
+/**
+ * The registered shards.
+ */
+static metrics_shard_s *metrics_shards = NULL;
+
+/**
+ * Mutex guarding the registry, taken only to register a shard and to read.
+ */
+static pthread_mutex_t metrics_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Key releasing the shard of a thread when the thread ends.
+ */
+static pthread_key_t metrics_key;
+
+/**
+ * Makes the key be created once.
+ */
+static pthread_once_t metrics_once = PTHREAD_ONCE_INIT;
+
+/**
+ * The shard of the current thread or NULL before its first record.
+ */
+static __thread metrics_shard_s *metrics_shard = NULL;
+
+/**
+ * Listening socket of the admin endpoint or -1.
+ */
+static int metrics_socket = -1;
+
+/**
+ * Whether the admin endpoint is being stopped.
+ */
+static volatile int metrics_stopping = 0;
+
+/**
+ * Thread serving the admin endpoint.
+ */
+static pthread_t metrics_thread;
+
+/**
+ * Hands the shard of an ending thread over to the next registering thread.
+ * @param[in] shard Pointer to the shard.
+ */
+void
+release_metrics_shard(void *shard) {
+	pthread_mutex_lock(&metrics_mutex);
+	((metrics_shard_s*) shard)->owned = 0;
+	pthread_mutex_unlock(&metrics_mutex);
+}
+
+/**
+ * Creates the key releasing shards.
+ */
+void
+create_metrics_key(void) {
+	pthread_key_create(&metrics_key, release_metrics_shard);
+}
+
+/**
+ * Gets the shard of the current thread, registering one on the first call.
+ * @return Pointer to the shard or NULL when none can be allocated.
+ * \sa metrics_shard_s
+ */
+metrics_shard_s*
+get_metrics_shard(void) {
+	metrics_shard_s *shard;
+	if (metrics_shard != NULL) {
+		return metrics_shard;
+	}
+	pthread_once(&metrics_once, create_metrics_key);
+	pthread_mutex_lock(&metrics_mutex);
+	for (shard = metrics_shards; shard != NULL && shard->owned;
+			shard = shard->next)
+		;
+	if (shard == NULL && (shard = calloc(1, sizeof(metrics_shard_s))) != NULL) {
+		shard->next = metrics_shards;
+		metrics_shards = shard;
+	}
+	if (shard != NULL) {
+		shard->owned = 1;
+	}
+	pthread_mutex_unlock(&metrics_mutex);
+	if (shard != NULL) {
+		pthread_setspecific(metrics_key, shard);
+	}
+	return metrics_shard = shard;
+}
+
+/**
+ * Adds to a value of the shard of the current thread. The thread is the only
+ * writer, so a relaxed load and store do without a locked instruction.
+ * @param[in] field Pointer to the value.
+ * @param[in] value Value to add.
+ */
+static inline void
+add_metric(uint64_t *field, uint64_t value) {
+	__atomic_store_n(field, __atomic_load_n(field, __ATOMIC_RELAXED) + value,
+			__ATOMIC_RELAXED);
+}
+
+/**
+ * Gets the bucket of a histogram a value is recorded in.
+ * @param[in] value The value.
+ * @return Index of the bucket.
+ */
+int
+get_metrics_bucket(uint64_t value) {
+	int exponent;
+	if (value < (1 << METRICS_SUB_BITS)) {
+		return value;
+	}
+	exponent = 63 - __builtin_clzll(value);
+	if (exponent >= METRICS_HISTOGRAM_BUCKETS / (1 << METRICS_SUB_BITS)
+			+ METRICS_SUB_BITS - 1) {
+		return METRICS_HISTOGRAM_BUCKETS - 1;
+	}
+	return ((exponent - METRICS_SUB_BITS + 1) << METRICS_SUB_BITS)
+			+ ((value >> (exponent - METRICS_SUB_BITS))
+					& ((1 << METRICS_SUB_BITS) - 1));
+}
+
+/**
+ * Records a value in a histogram of the shard of the current thread.
+ * @param[in] histogram Pointer to the histogram.
+ * @param[in] value     The value.
+ */
+static inline void
+record_histogram(metrics_histogram_s *histogram, uint64_t value) {
+	add_metric(&histogram->count, 1);
+	add_metric(&histogram->sum, value);
+	add_metric(&histogram->buckets[get_metrics_bucket(value)], 1);
+}
+
+/**
+ * Adds to a server-wide counter.
+ * @param[in] counter The counter.
+ * @param[in] value   Value to add.
+ * \sa metrics_counter_e
+ */
+void
+count_metric(metrics_counter_e counter, uint64_t value) {
+	metrics_shard_s *shard = get_metrics_shard();
+	if (shard != NULL) {
+		add_metric(&shard->counters[counter], value);
+	}
+}
+
+/**
+ * Records a served request and the time its handler took.
+ * @param[in] type       Type of the request.
+ * @param[in] latency_ns Time the handler took, in nanoseconds.
+ * \sa message_type_e
+ */
+void
+record_request_metrics(int type, long long latency_ns) {
+	metrics_shard_s *shard = get_metrics_shard();
+	if (shard == NULL || type < 0 || type >= MSG_TYPES_NO) {
+		return;
+	}
+	add_metric(&shard->requests[type], 1);
+	record_histogram(&shard->latency[type], latency_ns > 0 ? latency_ns : 0);
+}
+
+/**
+ * Records a sent response: its size and whether it carries an error.
+ * @param[in] type  Type of the response.
+ * @param[in] error Error of the response.
+ * @param[in] bytes Number of bytes sent.
+ * \sa message_type_e message_error_e
+ */
+void
+record_response_metrics(int type, message_error_e error, size_t bytes) {
+	metrics_shard_s *shard = get_metrics_shard();
+	if (shard == NULL) {
+		return;
+	}
+	add_metric(&shard->counters[METRIC_BYTES_OUT], bytes);
+	if (error != MSG_RSP_ERROR_NONE && type >= 0 && type < MSG_TYPES_NO) {
+		add_metric(&shard->errors[type], 1);
+	}
+}
+
+/**
+ * Records the number of recipients of a broadcast message.
+ * @param[in] recipients Number of recipients.
+ */
+void
+record_fanout_metrics(int recipients) {
+	metrics_shard_s *shard = get_metrics_shard();
+	if (shard != NULL) {
+		record_histogram(&shard->fanout, recipients);
+	}
+}
+
+/**
+ * Adds a histogram of a shard to a merged histogram.
+ * @param[in,out] merged    Pointer to the merged histogram.
+ * @param[in]     histogram Pointer to the histogram of a shard.
+ */
+void
+merge_histogram(metrics_histogram_s *merged, metrics_histogram_s *histogram) {
+	int i;
+	merged->count += __atomic_load_n(&histogram->count, __ATOMIC_RELAXED);
+	merged->sum += __atomic_load_n(&histogram->sum, __ATOMIC_RELAXED);
+	for (i = 0; i < METRICS_HISTOGRAM_BUCKETS; i++) {
+		merged->buckets[i] += __atomic_load_n(&histogram->buckets[i],
+				__ATOMIC_RELAXED);
+	}
+}
+
+/**
+ * Merges all the shards.
+ * @param[out] merged Pointer to the merged shard, cleared here.
+ */
+void
+merge_metrics_shards(metrics_shard_s *merged) {
+	int i;
+	metrics_shard_s *shard;
+	memset(merged, 0, sizeof(metrics_shard_s));
+	pthread_mutex_lock(&metrics_mutex);
+	for (shard = metrics_shards; shard != NULL; shard = shard->next) {
+		for (i = 0; i < METRIC_COUNTERS_NO; i++) {
+			merged->counters[i] += __atomic_load_n(&shard->counters[i],
+					__ATOMIC_RELAXED);
+		}
+		for (i = 0; i < MSG_TYPES_NO; i++) {
+			merged->requests[i] += __atomic_load_n(&shard->requests[i],
+					__ATOMIC_RELAXED);
+			merged->errors[i] += __atomic_load_n(&shard->errors[i],
+					__ATOMIC_RELAXED);
+			merge_histogram(&merged->latency[i], &shard->latency[i]);
+		}
+		merge_histogram(&merged->fanout, &shard->fanout);
+	}
+	pthread_mutex_unlock(&metrics_mutex);
+}
+
+/**
+ * Writes the buckets of a histogram in the Prometheus text format. The
+ * buckets end at powers of two, every one counting the values below it.
+ * @param[in] out       Stream to write to.
+ * @param[in] name      Name of the histogram.
+ * @param[in] label     Label pair put before le, or an empty string.
+ * @param[in] histogram Pointer to the histogram.
+ * @param[in] scale     Divisor turning recorded values into exported units.
+ * @param[in] first     Exponent of the first bucket bound.
+ * @param[in] last      Exponent of the last bucket bound.
+ */
+void
+write_histogram(FILE *out, const char *name, const char *label,
+		metrics_histogram_s *histogram, double scale, int first, int last) {
+	int exponent, bucket = 0;
+	uint64_t below = 0;
+	for (exponent = first; exponent <= last; exponent++) {
+		for (; bucket < get_metrics_bucket(1ULL << exponent); bucket++) {
+			below += histogram->buckets[bucket];
+		}
+		fprintf(out, "%s_bucket{%s%sle=\"%.9g\"} %llu\n", name, label,
+				label[0] != '\0' ? "," : "",
+				((1ULL << exponent) - 1) / scale, (unsigned long long) below);
+	}
+	fprintf(out, "%s_bucket{%s%sle=\"+Inf\"} %llu\n", name, label,
+			label[0] != '\0' ? "," : "",
+			(unsigned long long) histogram->count);
+	fprintf(out, "%s_sum%s%s%s %.9g\n", name, label[0] != '\0' ? "{" : "",
+			label, label[0] != '\0' ? "}" : "", histogram->sum / scale);
+	fprintf(out, "%s_count%s%s%s %llu\n", name, label[0] != '\0' ? "{" : "",
+			label, label[0] != '\0' ? "}" : "",
+			(unsigned long long) histogram->count);
+}
+
+/**
+ * Writes a counter or a gauge without labels in the Prometheus text format.
+ * @param[in] out   Stream to write to.
+ * @param[in] name  Name of the metric without the prefix.
+ * @param[in] type  "counter" or "gauge".
+ * @param[in] help  Description of the metric.
+ * @param[in] value The value.
+ */
+void
+write_metric(FILE *out, const char *name, const char *type, const char *help,
+		long long value) {
+	fprintf(out, "# HELP " METRICS_PREFIX "%s %s\n", name, help);
+	fprintf(out, "# TYPE " METRICS_PREFIX "%s %s\n", name, type);
+	fprintf(out, METRICS_PREFIX "%s %lld\n", name, value);
+}
+
+/**
+ * Merges all the shards and formats them in the Prometheus text format.
+ * @param[out] length Length of the text.
+ * @return The text, to be released with free, or NULL upon error.
+ */
+char*
+format_metrics(size_t *length) {
+	int i;
+	char *text = NULL, label[64];
+	FILE *out;
+	uint64_t *counters;
+	metrics_shard_s *merged;
+	if ((merged = malloc(sizeof(metrics_shard_s))) == NULL) {
+		return NULL;
+	}
+	if ((out = open_memstream(&text, length)) == NULL) {
+		free(merged);
+		return NULL;
+	}
+	merge_metrics_shards(merged);
+	counters = merged->counters;
+	fprintf(out, "# HELP " METRICS_PREFIX "requests_total Requests served, by message type.\n");
+	fprintf(out, "# TYPE " METRICS_PREFIX "requests_total counter\n");
+	for (i = 0; i < MSG_TYPES_NO; i++) {
+		if (merged->requests[i] != 0) {
+			fprintf(out, METRICS_PREFIX "requests_total{type=\"%s\"} %llu\n",
+					message_type_names[i],
+					(unsigned long long) merged->requests[i]);
+		}
+	}
+	fprintf(out, "# HELP " METRICS_PREFIX "errors_total Responses carrying an error, by message type.\n");
+	fprintf(out, "# TYPE " METRICS_PREFIX "errors_total counter\n");
+	for (i = 0; i < MSG_TYPES_NO; i++) {
+		if (merged->errors[i] != 0) {
+			fprintf(out, METRICS_PREFIX "errors_total{type=\"%s\"} %llu\n",
+					message_type_names[i],
+					(unsigned long long) merged->errors[i]);
+		}
+	}
+	fprintf(out, "# HELP " METRICS_PREFIX "request_duration_seconds Time spent handling a request, by message type.\n");
+	fprintf(out, "# TYPE " METRICS_PREFIX "request_duration_seconds histogram\n");
+	for (i = 0; i < MSG_TYPES_NO; i++) {
+		if (merged->latency[i].count != 0) {
+			snprintf(label, sizeof(label), "type=\"%s\"", message_type_names[i]);
+			/* from about a microsecond to about a minute */
+			write_histogram(out, METRICS_PREFIX "request_duration_seconds",
+					label, &merged->latency[i], 1e9, 10, 36);
+		}
+	}
+	fprintf(out, "# HELP " METRICS_PREFIX "broadcast_recipients Recipients of a broadcast message.\n");
+	fprintf(out, "# TYPE " METRICS_PREFIX "broadcast_recipients histogram\n");
+	write_histogram(out, METRICS_PREFIX "broadcast_recipients", "",
+			&merged->fanout, 1, 0, 4);
+	write_metric(out, "connections", "gauge", "Open client connections.",
+			counters[METRIC_CONNECTIONS_OPENED]
+					- counters[METRIC_CONNECTIONS_CLOSED]);
+	write_metric(out, "connections_total", "counter",
+			"Client connections accepted.",
+			counters[METRIC_CONNECTIONS_OPENED]);
+	write_metric(out, "games", "gauge", "Games waiting or being played.",
+			counters[METRIC_GAMES_ADDED] - counters[METRIC_GAMES_REMOVED]);
+	write_metric(out, "spectators", "gauge", "Connected spectators.",
+			counters[METRIC_SPECTATORS_JOINED]
+					- counters[METRIC_SPECTATORS_LEFT]);
+	write_metric(out, "received_bytes_total", "counter",
+			"Bytes of requests received.", counters[METRIC_BYTES_IN]);
+	write_metric(out, "sent_bytes_total", "counter",
+			"Bytes of responses sent.", counters[METRIC_BYTES_OUT]);
+	write_metric(out, "main_loop_iterations_total", "counter",
+			"Iterations of the main event loop.",
+			counters[METRIC_MAIN_LOOP_ITERATIONS]);
+	write_metric(out, "game_loop_iterations_total", "counter",
+			"Iterations of the event loops of all game threads.",
+			counters[METRIC_GAME_LOOP_ITERATIONS]);
+	fclose(out);
+	free(merged);
+	return text;
+}
+
+/**
+ * Serves the admin endpoint: every connection gets the metrics and is
+ * closed, whatever it asked for.
+ * @param[in] arg Unused.
+ * @return NULL.
+ */
+void*
+serve_metrics(void *arg) {
+	int fd;
+	char request[1024], header[128];
+	char *text;
+	size_t length;
+	sigset_t mask;
+	struct timeval timeout = { 1, 0 };
+	/* signals are left to the main thread */
+	sigfillset(&mask);
+	pthread_sigmask(SIG_BLOCK, &mask, NULL);
+	while (!metrics_stopping) {
+		if ((fd = accept(metrics_socket, NULL, NULL)) < 0) {
+			continue;
+		}
+		setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+		if (recv(fd, request, sizeof(request), 0) > 0
+				&& (text = format_metrics(&length)) != NULL) {
+			snprintf(header, sizeof(header), "HTTP/1.0 200 OK\r\n"
+					"Content-Type: text/plain; version=0.0.4\r\n"
+					"Content-Length: %lu\r\n\r\n", (unsigned long) length);
+			send(fd, header, strlen(header), MSG_NOSIGNAL);
+			send(fd, text, length, MSG_NOSIGNAL);
+			free(text);
+		}
+		close(fd);
+	}
+	return NULL;
+}
+
+/**
+ * Starts serving metrics on a port of the loopback interface.
+ * @param[in] port The port, 0 leaves the endpoint off.
+ * @retval  0 Upon success.
+ * @retval -1 When the port cannot be bound.
+ */
+int
+start_metrics_server(int port) {
+	int t = 1;
+	struct sockaddr_in addr;
+	if (port == 0) {
+		return 0;
+	}
+	if ((metrics_socket = socket(PF_INET, SOCK_STREAM, 0)) < 0) {
+		return -1;
+	}
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(port);
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	setsockopt(metrics_socket, SOL_SOCKET, SO_REUSEADDR, &t, sizeof(t));
+	if (bind(metrics_socket, (struct sockaddr*) &addr, sizeof(addr)) < 0
+			|| listen(metrics_socket, BACKLOG) < 0
+			|| pthread_create(&metrics_thread, NULL, serve_metrics, NULL) != 0) {
+		close(metrics_socket);
+		metrics_socket = -1;
+		return -1;
+	}
+	fprintf(stderr, "Metrics served on 127.0.0.1:%d\n", port);
+	return 0;
+}
+
+/**
+ * Stops serving metrics.
+ */
+void
+stop_metrics_server(void) {
+	if (metrics_socket == -1) {
+		return;
+	}
+	metrics_stopping = 1;
+	/* wakes the thread up from accept */
+	shutdown(metrics_socket, SHUT_RDWR);
+	pthread_join(metrics_thread, NULL);
+	close(metrics_socket);
+	metrics_socket = -1;
+}
@@ -0,0 +1,28 @@
+/**
+ * @file metrics.h
+ * @ingroup metrics
+ *
+ * @author Piotr Janaszek <janas03@yahoo.pl>
+ * @date Created on: Oct 18, 2026
+ *
+ * @brief File containing methods for recording and exporting server metrics.
+ */
+
+#ifndef METRICS_H_
+#define METRICS_H_
+
+#include <stddef.h>
+
+#include "structs.h"
+
+metrics_shard_s* get_metrics_shard(void);
+int get_metrics_bucket(uint64_t value);
+void count_metric(metrics_counter_e counter, uint64_t value);
+void record_request_metrics(int type, long long latency_ns);
+void record_response_metrics(int type, message_error_e error, size_t bytes);
+void record_fanout_metrics(int recipients);
+char* format_metrics(size_t *length);
+int start_metrics_server(int port);
+void stop_metrics_server(void);
+
+#endif /* METRICS_H_ */
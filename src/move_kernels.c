@@ -0,0 +1,161 @@
+/**
+ * @file move_kernels.c
+ * @ingroup move_kernels
+ *
+ * @author Piotr Janaszek <janas03@yahoo.pl>
+ * @date Created on: Oct 18, 2026
+ *
+ * @brief File containing win checks specialized for every board size and win length.
+ *
+ * A move can only complete a line passing through the moved pawn. For each of
+ * the four directions the kernel gathers the 2 * K - 1 fields of that line
+ * centred on the move into a small mask and looks for K consecutive set bits
+ * in it by anding the mask with shifted copies of itself. The code is written
+ * once as an always inlined function of the board size and K, and the macros
+ * below instantiate it for every (size, K) pair, so in every kernel both are
+ * constants: the loops are fully unrolled, the bit offsets and bounds are
+ * folded and no branch depends on the board. A board picks its kernel from the
+ * table once, when it is created.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "config.h"
+#include "structs.h"
+
+_Static_assert(MIN_BOARD_SIZE == 4 && MAX_BOARD_SIZE == 20,
+		"move kernels are instantiated for board sizes 4 to 20");
+_Static_assert(MIN_WIN_LENGTH == 3 && MAX_WIN_LENGTH == 6,
+		"move kernels are instantiated for win lengths 3 to 6");
+
+/**
+ * Gathers the fields of a player lying on one line through a move.
+ * @param[in] bits       Pointer to the bitset of the player.
+ * @param[in] x          The x coordinate of the move.
+ * @param[in] y          The y coordinate of the move.
+ * @param[in] dx         Step along the x axis.
+ * @param[in] dy         Step along the y axis.
+ * @param[in] size       Size of the board.
+ * @param[in] win_length Number of consecutive pawns needed to win.
+ * @return Mask whose bit i is set when the player has a pawn on the field
+ * i - win_length + 1 steps away from the move.
+ */
+static inline __attribute__((always_inline)) unsigned
+gather_line(const uint64_t *bits, int x, int y, const int dx, const int dy,
+		const int size, const int win_length) {
+	int i, cx, cy, bit;
+	unsigned line = 0;
+#pragma GCC unroll 16
+	for (i = 0; i < 2 * win_length - 1; i++) {
+		cx = x + (i - win_length + 1) * dx;
+		cy = y + (i - win_length + 1) * dy;
+		if (cx >= 0 && cy >= 0 && cx < size && cy < size) {
+			bit = cx * (size + 1) + cy;
+			line |= (unsigned) ((bits[bit >> 6] >> (bit & 63)) & 1) << i;
+		}
+	}
+	return line;
+}
+
+/**
+ * Checks whether a mask holds a given number of consecutive set bits.
+ * @param[in] line       The mask to be checked.
+ * @param[in] win_length Number of consecutive bits.
+ * @return Non-zero value when the bits are found.
+ */
+static inline __attribute__((always_inline)) unsigned
+has_run(unsigned line, const int win_length) {
+	int i;
+	unsigned run = line;
+#pragma GCC unroll 8
+	for (i = 1; i < win_length; i++) {
+		run &= line >> i;
+	}
+	return run;
+}
+
+/**
+ * Checks whether a move has completed a line of pawns. This is the body of
+ * every kernel, instantiated with constant size and win length.
+ * @param[in] board      Pointer to the board the move was performed on.
+ * @param[in] move       Structure containing coordinates of a move and a player's pawn.
+ * @param[in] size       Size of the board.
+ * @param[in] win_length Number of consecutive pawns needed to win.
+ * @retval  0 When a line of pawns is found.
+ * @retval -1 When a line of pawns is not found.
+ */
+static inline __attribute__((always_inline)) int
+check_move(board_s *board, move_s *move, const int size,
+		const int win_length) {
+	const int words = (size * (size + 1) + 63) / 64;
+	const uint64_t *bits = board->bits
+			+ (move->pawn == 'x' ? BOARD_BITS_X : BOARD_BITS_O) * words;
+	if (has_run(gather_line(bits, move->x, move->y, 0, 1, size, win_length),
+			win_length)
+			|| has_run(gather_line(bits, move->x, move->y, 1, 0, size,
+					win_length), win_length)
+			|| has_run(gather_line(bits, move->x, move->y, 1, 1, size,
+					win_length), win_length)
+			|| has_run(gather_line(bits, move->x, move->y, 1, -1, size,
+					win_length), win_length)) {
+		return 0;
+	}
+	return -1;
+}
+
+/*! \def MOVE_KERNEL(S, K)
+ * Macro defining the kernel for boards of size S and win length K.
+ */
+#define MOVE_KERNEL(S, K) \
+	static int check_move_##S##_##K(board_s *board, move_s *move) { \
+		return check_move(board, move, S, K); \
+	}
+
+/*! \def MOVE_KERNELS(K)
+ * Macro defining kernels for all board sizes and win length K.
+ */
+#define MOVE_KERNELS(K) \
+	MOVE_KERNEL(4, K) MOVE_KERNEL(5, K) MOVE_KERNEL(6, K) MOVE_KERNEL(7, K) \
+	MOVE_KERNEL(8, K) MOVE_KERNEL(9, K) MOVE_KERNEL(10, K) MOVE_KERNEL(11, K) \
+	MOVE_KERNEL(12, K) MOVE_KERNEL(13, K) MOVE_KERNEL(14, K) \
+	MOVE_KERNEL(15, K) MOVE_KERNEL(16, K) MOVE_KERNEL(17, K) \
+	MOVE_KERNEL(18, K) MOVE_KERNEL(19, K) MOVE_KERNEL(20, K)
+
+/*! \def MOVE_KERNELS_ROW(K)
+ * Macro listing kernels for all board sizes and win length K.
+ */
+#define MOVE_KERNELS_ROW(K) { \
+	check_move_4_##K, check_move_5_##K, check_move_6_##K, check_move_7_##K, \
+	check_move_8_##K, check_move_9_##K, check_move_10_##K, check_move_11_##K, \
+	check_move_12_##K, check_move_13_##K, check_move_14_##K, \
+	check_move_15_##K, check_move_16_##K, check_move_17_##K, \
+	check_move_18_##K, check_move_19_##K, check_move_20_##K }
+
+MOVE_KERNELS(3)
+MOVE_KERNELS(4)
+MOVE_KERNELS(5)
+MOVE_KERNELS(6)
+
+/**
+ * Kernels indexed by win length and board size.
+ */
+static const move_kernel_f move_kernels[MAX_WIN_LENGTH - MIN_WIN_LENGTH + 1][MAX_BOARD_SIZE
+		- MIN_BOARD_SIZE + 1] = { MOVE_KERNELS_ROW(3), MOVE_KERNELS_ROW(4),
+		MOVE_KERNELS_ROW(5), MOVE_KERNELS_ROW(6) };
+
+/**
+ * Gets the kernel checking moves on a board of a given size and win length.
+ * @param[in] size       Size of the board.
+ * @param[in] win_length Number of consecutive pawns needed to win.
+ * @return Pointer to the kernel or NULL when there is no such kernel.
+ */
+move_kernel_f
+get_move_kernel(int size, int win_length) {
+	if (size < MIN_BOARD_SIZE || size > MAX_BOARD_SIZE
+			|| win_length < MIN_WIN_LENGTH || win_length > MAX_WIN_LENGTH) {
+		return NULL;
+	}
+	return move_kernels[win_length - MIN_WIN_LENGTH][size - MIN_BOARD_SIZE];
+}
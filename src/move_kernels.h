@@ -0,0 +1,18 @@
+/**
+ * @file move_kernels.h
+ * @ingroup move_kernels
+ *
+ * @author Piotr Janaszek <janas03@yahoo.pl>
+ * @date Created on: Oct 18, 2026
+ *
+ * @brief File containing win checks specialized for every board size and win length.
+ */
+
+#ifndef MOVE_KERNELS_H_
+#define MOVE_KERNELS_H_
+
+#include "structs.h"
+
+move_kernel_f get_move_kernel(int size, int win_length);
+
+#endif /* MOVE_KERNELS_H_ */
@@ -0,0 +1,511 @@
+/**
+ * @file recovery.c
+ * @ingroup recovery
+ *
+ * @author Piotr Janaszek <janas03@yahoo.pl>
+ * @date Created on: Oct 18, 2026
+ *
+ * @brief File containing methods for restoring unfinished games from the game journal.
+ *
+ * All journal segments are mapped into memory and recovered in three steps.
+ * First workers check the checksums of chunks of records taken in turn; a
+ * segment ends at its first record with a wrong checksum, which is where a
+ * write was torn by the crash. Then one pass over the records links the
+ * records of every game, the last creation of a game ID starting a new game
+ * and an end record dropping it. Last workers take the started games still
+ * unfinished in turn and rebuild them move by move through the same rules a
+ * played move goes through, so a game with a broken record is dropped rather
+ * than restored wrong. Restored games wait in the lobby for their players,
+ * who take their seats back by connecting to the game; the bot of a bot game
+ * is seated at once. Progress is reported while the workers run and the
+ * replay throughput at the end.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "arena.h"
+#include "board_handler.h"
+#include "bot.h"
+#include "common.h"
+#include "config.h"
+#include "journal.h"
+#include "lists.h"
+#include "logger.h"
+#include "request_handler.h"
+#include "sparse_board.h"
+#include "structs.h"
+
+/**
+ * Maps all segments of the journal into memory, from the first one up to
+ * the first number missing.
+ * @param[out] recovery Pointer to the recovery, its segments are set.
+ * @param[in]  name     Name the segments are named after.
+ * @retval  0 Upon success.
+ * @retval -1 When a segment cannot be mapped.
+ * \sa recovery_s journal_segment_s
+ */
+int
+map_journal_segments(recovery_s *recovery, const char *name) {
+	int fd;
+	char path[300];
+	struct stat st;
+	journal_segment_s *segment, *segments;
+	for (;;) {
+		snprintf(path, sizeof(path), "%s.%06d", name, recovery->no_segments);
+		if ((fd = open(path, O_RDONLY)) == -1) {
+			return 0;
+		}
+		if (fstat(fd, &st) == -1 || (segments = realloc(recovery->segments,
+				(recovery->no_segments + 1) * sizeof(journal_segment_s)))
+				== NULL) {
+			close(fd);
+			return -1;
+		}
+		recovery->segments = segments;
+		segment = &segments[recovery->no_segments++];
+		segment->length = st.st_size;
+		segment->no_records = st.st_size / sizeof(journal_record_s);
+		segment->valid = segment->no_records;
+		segment->base = recovery->no_records;
+		segment->records = NULL;
+		if (segment->no_records > 0) {
+			segment->records = mmap(NULL, segment->length, PROT_READ,
+					MAP_PRIVATE, fd, 0);
+			if (segment->records == MAP_FAILED) {
+				segment->records = NULL;
+				close(fd);
+				return -1;
+			}
+			madvise((void*) segment->records, segment->length,
+					MADV_SEQUENTIAL);
+		}
+		close(fd);
+		recovery->no_records += segment->no_records;
+	}
+}
+
+/**
+ * Unmaps all segments of the journal.
+ * @param[in] recovery Pointer to the recovery.
+ * \sa recovery_s
+ */
+void
+unmap_journal_segments(recovery_s *recovery) {
+	int i;
+	for (i = 0; i < recovery->no_segments; i++) {
+		if (recovery->segments[i].records != NULL) {
+			munmap((void*) recovery->segments[i].records,
+					recovery->segments[i].length);
+		}
+	}
+	free(recovery->segments);
+}
+
+/**
+ * Finds the segment holding a record.
+ * @param[in] recovery Pointer to the recovery.
+ * @param[in] index    Index of the record in the whole journal.
+ * @return Pointer to the segment.
+ * \sa journal_segment_s
+ */
+journal_segment_s*
+get_record_segment(recovery_s *recovery, long index) {
+	int low = 0, high = recovery->no_segments - 1, middle;
+	while (low < high) {
+		middle = (low + high + 1) / 2;
+		if (recovery->segments[middle].base <= index) {
+			low = middle;
+		} else {
+			high = middle - 1;
+		}
+	}
+	return &recovery->segments[low];
+}
+
+/**
+ * Gets a record of the journal.
+ * @param[in] recovery Pointer to the recovery.
+ * @param[in] index    Index of the record in the whole journal.
+ * @return Pointer to the mapped record.
+ * \sa journal_record_s
+ */
+const journal_record_s*
+get_recovered_record(recovery_s *recovery, long index) {
+	journal_segment_s *segment = get_record_segment(recovery, index);
+	return &segment->records[index - segment->base];
+}
+
+/**
+ * Checks the checksums of a chunk of records and clears their links. The
+ * valid part of the segment is cut at the first record with a wrong checksum.
+ * @param[in] recovery Pointer to the recovery.
+ * @param[in] chunk    Number of the chunk.
+ * \sa recovery_s
+ */
+void
+check_journal_chunk(recovery_s *recovery, long chunk) {
+	int s;
+	long i, valid, begin, end, no_chunks;
+	journal_segment_s *segment = recovery->segments;
+	/* chunks never cross segments, so every segment starts a new chunk */
+	for (s = 0; s < recovery->no_segments; s++) {
+		segment = &recovery->segments[s];
+		no_chunks = (segment->no_records + RECOVERY_CHUNK_RECORDS - 1)
+				/ RECOVERY_CHUNK_RECORDS;
+		if (chunk < no_chunks) {
+			break;
+		}
+		chunk -= no_chunks;
+	}
+	begin = segment->base + chunk * RECOVERY_CHUNK_RECORDS;
+	end = begin + RECOVERY_CHUNK_RECORDS;
+	if (end > segment->base + segment->no_records) {
+		end = segment->base + segment->no_records;
+	}
+	memset(&recovery->links[begin], 0xff, (end - begin) * sizeof(long));
+	for (i = begin; i < end; i++) {
+		if (get_journal_checksum(&segment->records[i - segment->base])
+				!= segment->records[i - segment->base].checksum) {
+			break;
+		}
+	}
+	if (i < end) {
+		valid = __atomic_load_n(&segment->valid, __ATOMIC_RELAXED);
+		while (i - segment->base < valid
+				&& !__atomic_compare_exchange_n(&segment->valid, &valid,
+						i - segment->base, 0, __ATOMIC_RELAXED,
+						__ATOMIC_RELAXED))
+			;
+	}
+	__atomic_add_fetch(&recovery->checked, end - begin, __ATOMIC_RELAXED);
+}
+
+/**
+ * Links the records of every game and finds the started games left
+ * unfinished. The last creation of a game ID starts a new game, an end
+ * record drops it and records of games not created are skipped.
+ * @param[in] recovery Pointer to the recovery, its games are set.
+ * @return Number of games created but never started, which are dropped.
+ * \sa recovery_s recovered_game_s
+ */
+int
+link_journal_records(recovery_s *recovery) {
+	int s, id, waiting = 0;
+	long i, index;
+	long created[MAX_GAME_ID + 1], started[MAX_GAME_ID + 1], last[MAX_GAME_ID
+			+ 1];
+	const journal_record_s *record;
+	journal_segment_s *segment;
+	for (id = 0; id <= MAX_GAME_ID; id++) {
+		created[id] = -1;
+	}
+	for (s = 0; s < recovery->no_segments; s++) {
+		segment = &recovery->segments[s];
+		for (i = 0; i < segment->valid; i++) {
+			record = &segment->records[i];
+			index = segment->base + i;
+			if ((id = record->game_id) < 1 || id > MAX_GAME_ID
+					|| (record->type != JOURNAL_GAME_CREATED
+							&& created[id] == -1)) {
+				continue;
+			}
+			switch (record->type) {
+			case JOURNAL_GAME_CREATED:
+				created[id] = last[id] = index;
+				started[id] = -1;
+				break;
+			case JOURNAL_GAME_STARTED:
+				if (started[id] == -1) {
+					started[id] = index;
+					recovery->links[last[id]] = index;
+					last[id] = index;
+				}
+				break;
+			case JOURNAL_MOVE:
+				recovery->links[last[id]] = index;
+				last[id] = index;
+				break;
+			case JOURNAL_GAME_ENDED:
+				created[id] = -1;
+				break;
+			}
+		}
+	}
+	if ((recovery->games = calloc(MAX_GAME_ID, sizeof(recovered_game_s)))
+			== NULL) {
+		return -1;
+	}
+	for (id = 1; id <= MAX_GAME_ID; id++) {
+		if (created[id] != -1 && started[id] == -1) {
+			waiting++;
+		} else if (created[id] != -1) {
+			recovery->games[recovery->no_games].created = created[id];
+			recovery->games[recovery->no_games++].started = started[id];
+		}
+	}
+	return waiting;
+}
+
+/**
+ * Rebuilds a game from its records: the game is created as it was and every
+ * move is made again through the rules. A move out of turn, out of order or
+ * not allowed by the rules drops the game.
+ * @param[in] recovery  Pointer to the recovery.
+ * @param[in] recovered Pointer to the game to rebuild, its game and outcome are set.
+ * \sa recovered_game_s journal_record_s
+ */
+void
+replay_recovered_game(recovery_s *recovery, recovered_game_s *recovered) {
+	int result = 0;
+	long index;
+	move_s move;
+	game_s *game = NULL;
+	const journal_record_s *record = get_recovered_record(recovery,
+			recovered->created), *start;
+	start = get_recovered_record(recovery, recovered->started);
+	if (record->mode >= GAME_MODES_NO || record->win_length < MIN_WIN_LENGTH
+			|| record->win_length > MAX_WIN_LENGTH || record->size < 0
+			|| (record->size > 0 && record->size < MIN_BOARD_SIZE)
+			|| record->size > MAX_SPARSE_BOARD_SIZE
+			|| (record->mode == GAME_MODE_GRAVITY
+					&& (record->size == 0 || record->size > MAX_BOARD_SIZE))
+			|| (start->value != 0 && start->value != 1)
+			|| allocate_new_game(&game, record->size, record->win_length,
+					record->mode) == -1) {
+		return;
+	}
+	game->id = record->game_id;
+	game->first_seat = start->value;
+	game->seats = arena_alloc(game->arena, 2 * MAX_NICK_LEN);
+	memcpy(game->seats[0], record->nick, MAX_NICK_LEN - 1);
+	memcpy(game->seats[1], start->nick, MAX_NICK_LEN - 1);
+	game->seats[0][MAX_NICK_LEN - 1] = game->seats[1][MAX_NICK_LEN - 1] = '\0';
+	for (index = recovery->links[recovered->started]; index != -1 && result == 0;
+			index = recovery->links[index]) {
+		record = get_recovered_record(recovery, index);
+		move.x = record->x;
+		move.y = record->y;
+		move.pawn = (game->first_seat + game->no_moves) % 2 == 0 ? 'x' : 'o';
+		if (record->ply != game->no_moves + 1 || record->pawn != move.pawn
+				|| (game->heights != NULL
+						&& move.x != get_drop_row(game->heights, game->size,
+								move.y))) {
+			result = -1;
+		} else if (game->sparse != NULL) {
+			result = make_sparse_move(game->sparse, &move, &game->free);
+		} else {
+			result = make_move(game->board, &move, &game->free);
+		}
+		if (result == -1) {
+			LOG_WARNING("Recovery: move %d of game %d is not valid",
+					(int) record->ply, game->id);
+			destroy_game(game);
+			return;
+		}
+		if (game->moves != NULL) {
+			game->moves[game->no_moves] = move;
+		}
+		game->no_moves++;
+		if (game->heights != NULL) {
+			game->heights[move.y]++;
+		}
+		if (result == 1) {
+			recovered->outcome = move.pawn;
+		} else if (result == 2) {
+			recovered->outcome = '-';
+		}
+	}
+	if (index != -1) {
+		LOG_WARNING("Recovery: game %d goes on after its end", game->id);
+		destroy_game(game);
+		return;
+	}
+	__atomic_add_fetch(&recovery->moves, game->no_moves, __ATOMIC_RELAXED);
+	recovered->game = game;
+}
+
+/**
+ * The worker checking chunks of records taken in turn.
+ * @param[in] arg Pointer to the recovery.
+ * @return NULL.
+ * \sa recovery_s
+ */
+void*
+check_journal_worker(void *arg) {
+	long chunk;
+	recovery_s *recovery = arg;
+	while ((chunk = __atomic_fetch_add(&recovery->next_chunk, 1,
+			__ATOMIC_RELAXED)) < recovery->no_chunks) {
+		check_journal_chunk(recovery, chunk);
+	}
+	return NULL;
+}
+
+/**
+ * The worker replaying games taken in turn.
+ * @param[in] arg Pointer to the recovery.
+ * @return NULL.
+ * \sa recovery_s
+ */
+void*
+replay_journal_worker(void *arg) {
+	int game;
+	recovery_s *recovery = arg;
+	while ((game = __atomic_fetch_add(&recovery->next_game, 1,
+			__ATOMIC_RELAXED)) < recovery->no_games) {
+		replay_recovered_game(recovery, &recovery->games[game]);
+		__atomic_add_fetch(&recovery->replayed, 1, __ATOMIC_RELAXED);
+	}
+	return NULL;
+}
+
+/**
+ * Runs workers over the recovery and reports their progress until all of
+ * them are done.
+ * @param[in] recovery Pointer to the recovery.
+ * @param[in] worker   The worker routine.
+ * @param[in] threads  Number of workers.
+ * @param[in] done     Pointer to the number of items done.
+ * @param[in] total    Number of items.
+ * @param[in] items    Name of the items in reports.
+ * \sa recovery_s
+ */
+void
+run_recovery_workers(recovery_s *recovery, void *(*worker)(void*),
+		int threads, long *done, long total, const char *items) {
+	int i;
+	pthread_t *workers;
+	struct timespec deadline;
+	if ((workers = malloc(threads * sizeof(pthread_t))) == NULL) {
+		worker(recovery);
+		return;
+	}
+	for (i = 0; i < threads; i++) {
+		if (pthread_create(&workers[i], NULL, worker, recovery) != 0) {
+			ERR("pthread_create");
+		}
+	}
+	clock_gettime(CLOCK_REALTIME, &deadline);
+	for (i = 0; i < threads; i++) {
+		for (;;) {
+			deadline.tv_nsec += RECOVERY_PROGRESS_MS * 1000000L;
+			deadline.tv_sec += deadline.tv_nsec / 1000000000L;
+			deadline.tv_nsec %= 1000000000L;
+			if (pthread_timedjoin_np(workers[i], NULL, &deadline) == 0) {
+				break;
+			}
+			LOG_INFO_TEXT("Recovery: %ld/%ld %s",
+					__atomic_load_n(done, __ATOMIC_RELAXED), total, items);
+		}
+	}
+	free(workers);
+}
+
+/**
+ * Restores the games left unfinished in the journal and adds them to the
+ * games list, where they wait for their players. Games whose replayed moves
+ * already end them are journaled as ended instead. It has to be called
+ * before any client is served and after the journal is opened.
+ * @param[in] name       Name the segments are named after.
+ * @param[in] games_list Pointer to a list holding games.
+ * @param[in] pool       Pointer to the pool running bot searches.
+ * @return Number of restored games or -1 upon error.
+ * \sa recovery_s games_list_s
+ */
+int
+recover_games(const char *name, games_list_s *games_list,
+		compute_pool_s *pool) {
+	int i, waiting, restored = 0, finished = 0;
+	int threads = sysconf(_SC_NPROCESSORS_ONLN);
+	long long start = get_monotonic_ms(), elapsed;
+	long valid = 0;
+	recovery_s recovery;
+	recovered_game_s *recovered;
+	const journal_record_s *record;
+	memset(&recovery, 0, sizeof(recovery));
+	if (map_journal_segments(&recovery, name) == -1) {
+		LOG_ERROR_TEXT("Map journal: %s", strerror(errno));
+		unmap_journal_segments(&recovery);
+		return -1;
+	}
+	if (recovery.no_records == 0) {
+		unmap_journal_segments(&recovery);
+		return 0;
+	}
+	if ((recovery.links = malloc(recovery.no_records * sizeof(long))) == NULL) {
+		unmap_journal_segments(&recovery);
+		return -1;
+	}
+	if (threads < 1) {
+		threads = 1;
+	}
+	for (i = 0; i < recovery.no_segments; i++) {
+		recovery.no_chunks += (recovery.segments[i].no_records
+				+ RECOVERY_CHUNK_RECORDS - 1) / RECOVERY_CHUNK_RECORDS;
+	}
+	LOG_INFO_TEXT("Recovery: %ld records in %d segments, %d threads",
+			recovery.no_records, recovery.no_segments, threads);
+	run_recovery_workers(&recovery, check_journal_worker, threads,
+			&recovery.checked, recovery.no_records, "records checked");
+	for (i = 0; i < recovery.no_segments; i++) {
+		valid += recovery.segments[i].valid;
+		if (recovery.segments[i].valid < recovery.segments[i].no_records) {
+			LOG_WARNING_TEXT("Recovery: segment %d is cut after %ld records",
+					i, recovery.segments[i].valid);
+		}
+	}
+	if ((waiting = link_journal_records(&recovery)) == -1) {
+		free(recovery.links);
+		unmap_journal_segments(&recovery);
+		return -1;
+	}
+	run_recovery_workers(&recovery, replay_journal_worker, threads,
+			&recovery.replayed, recovery.no_games, "games replayed");
+	for (i = 0; i < recovery.no_games; i++) {
+		recovered = &recovery.games[i];
+		if (recovered->game == NULL) {
+			continue;
+		}
+		if (recovered->outcome != 0) {
+			journal_game_ended(recovered->game, recovered->outcome);
+			destroy_game(recovered->game);
+			finished++;
+			continue;
+		}
+		record = get_recovered_record(&recovery, recovered->started);
+		if (record->x > 0) {
+			if ((recovered->game->bot = create_bot(pool, record->x,
+					record->y < BOT_ENGINES_NO ? record->y : BOT_ENGINE_ALPHA_BETA))
+					== NULL) {
+				destroy_game(recovered->game);
+				continue;
+			}
+			recovered->game->players[1] = &recovered->game->bot->player;
+			recovered->game->no_connected_players = 1;
+		}
+		add_game_to_list(games_list, recovered->game);
+		restored++;
+	}
+	elapsed = get_monotonic_ms() - start;
+	LOG_INFO("Recovery: %d games restored, %d finished, %d dropped, "
+			"%d never started", restored, finished,
+			recovery.no_games - restored - finished, waiting);
+	LOG_INFO_TEXT("Recovery: %ld records, %ld moves replayed in %lld ms, "
+			"%.0f records/s, %.0f moves/s", valid, recovery.moves, elapsed,
+			elapsed > 0 ? valid * 1000.0 / elapsed : 0.0,
+			elapsed > 0 ? recovery.moves * 1000.0 / elapsed : 0.0);
+	free(recovery.games);
+	free(recovery.links);
+	unmap_journal_segments(&recovery);
+	return restored;
+}
@@ -0,0 +1,19 @@
+/**
+ * @file recovery.h
+ * @ingroup recovery
+ *
+ * @author Piotr Janaszek <janas03@yahoo.pl>
+ * @date Created on: Oct 18, 2026
+ *
+ * @brief File containing methods for restoring unfinished games from the game journal.
+ */
+
+#ifndef RECOVERY_H_
+#define RECOVERY_H_
+
+#include "structs.h"
+
+int recover_games(const char *name, games_list_s *games_list,
+		compute_pool_s *pool);
+
+#endif /* RECOVERY_H_ */
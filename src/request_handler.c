@@ -17,15 +17,46 @@
 #include <time.h>
 #include <unistd.h>
 #include <pthread.h>
+#include <sys/random.h>
 
+#include "arena.h"
 #include "board_handler.h"
+#include "bot.h"
+#include "common.h"
+#include "hint_service.h"
+#include "journal.h"
 #include "lists.h"
+#include "lobby.h"
+#include "logger.h"
+#include "matchmaker.h"
 #include "messenger.h"
+#include "metrics.h"
+#include "sparse_board.h"
 #include "structs.h"
 #include "thread_handler.h"
+#include "zobrist.h"
+
+/**
+ * Draws a session token, a random number written as hexadecimal digits.
+ * @param[out] token Buffer of SESSION_TOKEN_LEN + 1 characters for the token.
+ */
+void
+create_session_token(char *token) {
+	int i;
+	unsigned char bytes[SESSION_TOKEN_LEN / 2];
+	if (getrandom(bytes, sizeof(bytes), 0) != sizeof(bytes)) {
+		for (i = 0; i < (int) sizeof(bytes); i++) {
+			bytes[i] = rand();
+		}
+	}
+	for (i = 0; i < (int) sizeof(bytes); i++) {
+		snprintf(token + 2 * i, 3, "%02x", bytes[i]);
+	}
+}
 
 /**
  * Creates new player structure given client file descriptor and nick name.
+ * The player gets a session token to resume a game with.
  * @param[in]  client_fd  File descriptor of a client that is currently served.
  * @param[out] new_player Pointer to a structure containing player information.
  * @param[in]  nick       Nick name of newly created player.
@@ -37,12 +68,18 @@ int
 create_new_player(int client_fd, player_s **new_player, char *nick) {
 	(*new_player) = malloc(sizeof(player_s));
 	if ((*new_player) == NULL) {
-		fprintf(stderr, "Failed to allocate memory for new player\n");
+		LOG_ERROR("Failed to allocate memory for new player");
 		return -1;
 	}
 	(*new_player)->game_id = 0;
 	(*new_player)->player_fd = client_fd;
+	(*new_player)->prev = NULL;
+	(*new_player)->next = NULL;
+	(*new_player)->queued_size = 0;
+	(*new_player)->queue_prev = NULL;
+	(*new_player)->queue_next = NULL;
 	strncpy((*new_player)->player_nick, nick, MAX_NICK_LEN);
+	create_session_token((*new_player)->token);
 	return 0;
 }
 
@@ -61,64 +98,160 @@ get_random_player() {
 
 /**
  * Randomly chooses free game ID in range from 1 to 100.
- * @param[in] games_list Pointer to the head of the games list.
+ * @param[in] games_list Pointer to the games list.
  * @return Randomly generated game ID or -1 upon error.
  * \sa games_list_s
  */
 int
 get_next_free_game_id(games_list_s *games_list) {
-	int id, flag = 0;
+	int id;
 	unsigned int iseed = (unsigned int) time(NULL);
-	games_list_s *list = games_list;
+	game_s *game = NULL;
 	srand(iseed);
-	id = (int) (rand() % 100) + 1;
-	while (list != NULL && list->value != NULL) {
-		if (list->value->id == id) {
-			flag = 1;
-			break;
-		}
-		list = list->next;
-	}
-	if (flag == 0) {
+	id = (int) (rand() % MAX_GAME_ID) + 1;
+	get_game_by_id(games_list, &game, id);
+	if (game == NULL) {
 		return id;
 	}
 	return -1;
 }
 
+/**
+ * Checks whether a board of a given size only stores occupied fields.
+ * @param[in] size Size of the board or 0 for an unbounded board.
+ * @return Non-zero value for sparse boards.
+ */
+int
+is_sparse_size(int size) {
+	return size == 0 || size > MAX_BOARD_SIZE;
+}
+
+/**
+ * Computes the size of an arena holding a game with a board of a given size.
+ * The arena contains the game structure, thread arguments, board, move log,
+ * spectators set, a scratch buffer used while encoding the board and room for
+ * the nicks of the players of a game restored from the journal. Sparse
+ * boards grow with the moves, so they and their moves are kept outside it.
+ * @param[in] size       Size of the board or 0 for an unbounded board.
+ * @param[in] win_length Number of consecutive pawns needed to win.
+ * @param[in] mode       Game mode, gravity games also keep column heights.
+ * @return Number of bytes needed by the game arena.
+ * \sa game_mode_e
+ */
+size_t
+get_game_arena_size(int size, int win_length, game_mode_e mode) {
+	size_t arena_size = arena_aligned_size(sizeof(game_s))
+			+ arena_aligned_size(sizeof(thread_data_s))
+			+ arena_aligned_size(SPECTATORS_NO * sizeof(int))
+			+ arena_aligned_size(NROWS * NCOLS + 1)
+			+ arena_aligned_size(2 * MAX_NICK_LEN);
+	if (!is_sparse_size(size)) {
+		arena_size += get_board_arena_size(size, win_length)
+				+ arena_aligned_size(size * size * sizeof(move_s));
+	}
+	if (mode == GAME_MODE_GRAVITY) {
+		arena_size += arena_aligned_size(size * sizeof(int));
+	}
+	return arena_size;
+}
+
+/**
+ * Allocates a game with an empty board of a given size. The game and all its
+ * buffers are carved out of a single arena sized from the board size, so the
+ * game is released at once by destroying the arena. Boards larger than
+ * MAX_BOARD_SIZE or unbounded are sparse boards recording the moves
+ * themselves. The game has no ID and no players yet.
+ * @param[out] new_game   Pointer to a structure containing game information.
+ * @param[in]  size       Size of the board to create or 0 for an unbounded board.
+ * @param[in]  win_length Number of consecutive pawns needed to win.
+ * @param[in]  mode       Game mode, a gravity game needs a bounded board.
+ * @retval  0 Upon successful allocation of new game.
+ * @retval -1 If an error during allocation occurs.
+ * \sa game_s arena_s sparse_board_s game_mode_e
+ */
+int
+allocate_new_game(game_s **new_game, int size, int win_length,
+		game_mode_e mode) {
+	int i;
+	arena_s *arena = create_arena(get_game_arena_size(size, win_length, mode));
+	if (arena == NULL) {
+		LOG_ERROR("Failed to allocate memory for new game");
+		return -1;
+	}
+	(*new_game) = arena_alloc(arena, sizeof(game_s));
+	(*new_game)->arena = arena;
+	(*new_game)->tdata = arena_alloc(arena, sizeof(thread_data_s));
+	(*new_game)->board = NULL;
+	(*new_game)->sparse = NULL;
+	(*new_game)->moves = NULL;
+	(*new_game)->heights = NULL;
+	(*new_game)->bot = NULL;
+	(*new_game)->seats = NULL;
+	if (mode == GAME_MODE_GRAVITY) {
+		(*new_game)->heights = arena_alloc(arena, size * sizeof(int));
+		memset((*new_game)->heights, 0, size * sizeof(int));
+	}
+	if (is_sparse_size(size)) {
+		(*new_game)->sparse = create_sparse_board(size, win_length);
+	} else {
+		(*new_game)->board = create_new_board(arena, size, win_length);
+		(*new_game)->moves = arena_alloc(arena, size * size * sizeof(move_s));
+	}
+	(*new_game)->spectators = arena_alloc(arena, SPECTATORS_NO * sizeof(int));
+	(*new_game)->scratch = arena_alloc(arena, NROWS * NCOLS + 1);
+	if (((*new_game)->board == NULL && (*new_game)->sparse == NULL)
+			|| (*new_game)->scratch == NULL) {
+		LOG_ERROR("Failed to allocate memory for new board");
+		destroy_game(*new_game);
+		return -1;
+	}
+	(*new_game)->id = -1;
+	(*new_game)->size = size;
+	(*new_game)->win_length = win_length;
+	(*new_game)->mode = mode;
+	(*new_game)->scratch_ready = 0;
+	(*new_game)->forced = 0;
+	(*new_game)->first_seat = 0;
+	(*new_game)->waiting_since = get_monotonic_ms();
+	(*new_game)->free = size * size;
+	(*new_game)->current_player = -1;
+	(*new_game)->no_connected_players = 0;
+	(*new_game)->no_connected_spectators = 0;
+	(*new_game)->no_moves = 0;
+	(*new_game)->state = GAME_STATE_WAITING;
+	(*new_game)->players[0] = NULL;
+	(*new_game)->players[1] = NULL;
+	for (i = 0; i < SPECTATORS_NO; i++) {
+		(*new_game)->spectators[i] = -1;
+	}
+	return 0;
+}
+
 /**
  * Creates new game structure given player information and size of the board.
- * @param[in]  games_list Pointer to the head of the games list.
+ * @param[in]  games_list Pointer to the games list.
  * @param[out] new_game   Pointer to a structure containing game information.
  * @param[in]  player     Pointer to a structure containing player information.
- * @param[in]  size       Size of the board to create.
+ * @param[in]  size       Size of the board to create or 0 for an unbounded board.
+ * @param[in]  win_length Number of consecutive pawns needed to win.
+ * @param[in]  mode       Game mode, a gravity game needs a bounded board.
  * @retval  0 Upon successful creation of new game.
  * @retval -1 If an error during creation occurs.
- * \sa games_list_s game_s player_s
+ * \sa games_list_s game_s player_s allocate_new_game
  */
 int
 create_new_game(games_list_s *games_list, game_s **new_game,
-		player_s *player, int size) {
-	int i, new_id = -1;
-	(*new_game) = malloc(sizeof(game_s));
-	if ((*new_game) == NULL) {
-		fprintf(stderr, "Failed to allocate memory for new board\n");
+		player_s *player, int size, int win_length, game_mode_e mode) {
+	int new_id = -1;
+	if (allocate_new_game(new_game, size, win_length, mode) == -1) {
 		return -1;
 	}
 	while (new_id == -1) {
 		new_id = get_next_free_game_id(games_list);
 	};
 	(*new_game)->id = new_id;
-	(*new_game)->free = size * size;
-	(*new_game)->current_player = -1;
-	(*new_game)->no_connected_players = 0;
-	(*new_game)->no_connected_spectators = 0;
-	(*new_game)->board = create_new_board(size);
-	(*new_game)->state = GAME_STATE_WAITING;
 	(*new_game)->players[0] = player;
-	(*new_game)->players[1] = NULL;
-	for (i = 0; i < SPECTATORS_NO; i++) {
-		(*new_game)->spectators[i] = -1;
-	}
+	journal_game_created(*new_game);
 
 	return 0;
 }
@@ -180,12 +313,13 @@ set_spectator_fd_unused(int client_fd, game_s *game) {
  * Handles game login request sent from a connecting client.
  * @param[in] client_fd    File descriptor of a client that is logged to server.
  * @param[in] request      Pointer to a structure containing request data.
- * @param[in] players_list Pointer to the head of the players list.
- * \sa request_s players_list_s
+ * @param[in] players_list Pointer to the players list.
+ * @param[in] lobby        Pointer to the lobby.
+ * \sa request_s players_list_s lobby_s
  */
 void
 handle_game_login_request(int client_fd, request_s *request,
-		players_list_s *players_list) {
+		players_list_s *players_list, lobby_s *lobby) {
 	char nick[MAX_NICK_LEN];
 	player_s *player = NULL;
 	response_s response;
@@ -207,116 +341,186 @@ handle_game_login_request(int client_fd, request_s *request,
 		send_response_message(client_fd, &response);
 		return;
 	}
+	publish_lobby(lobby);
+	snprintf(response.payload, MAX_RSP_SIZE, "%s%s", player->token,
+			PAYLOAD_DELIM);
 	response.error = MSG_RSP_ERROR_NONE;
 	send_response_message(client_fd, &response);
 }
 
+/**
+ * Handles a request of a new connection to resume a game whose player lost
+ * the connection, given the player's session token. The seat is found while
+ * it is still kept and handed over to the thread serving the game, which
+ * answers with a snapshot of the board.
+ * @param[in] client_fd        File descriptor of a client that is currently served.
+ * @param[in] request          Pointer to a structure containing the session token.
+ * @param[in] base_rdfs        Bit array holding file descriptor to be served by the server.
+ * @param[in] players_list     Pointer to a list holding players.
+ * @param[in] games_list       Pointer to a list holding games.
+ * @param[in] games_list_mutex Pointer to a mutex guarding games list.
+ * @param[in] threads_list     Pointer to a list holding threads.
+ * \sa request_s player_s thread_data_s
+ */
+void
+handle_resume_request(int client_fd, request_s *request, fd_set *base_rdfs,
+		players_list_s *players_list, games_list_s *games_list,
+		pthread_mutex_t *games_list_mutex, threads_list_s *threads_list) {
+	int seat, game_id = -1;
+	char token[SESSION_TOKEN_LEN + 1];
+	response_s response;
+	game_s *game;
+	player_s *player = NULL;
+	thread_s *thread = NULL;
+	response.type = MSG_RESUME_RSP;
+	memset(response.payload, 0, MAX_RSP_SIZE);
+	strtok(request->payload, PAYLOAD_DELIM);
+	strncpy(token, request->payload, SESSION_TOKEN_LEN);
+	token[SESSION_TOKEN_LEN] = '\0';
+	get_player_by_file_desc(players_list, &player, client_fd);
+	if (player != NULL || strlen(token) != SESSION_TOKEN_LEN) {
+		/* a logged in client already plays under another nick */
+		response.error = MSG_RSP_ERROR_WRONG_SESSION;
+		send_response_message(client_fd, &response);
+		return;
+	}
+	pthread_mutex_lock(games_list_mutex);
+	for (game = games_list->head; game != NULL && game_id == -1;
+			game = game->next) {
+		if (game->state != GAME_STATE_STARTED) {
+			continue;
+		}
+		for (seat = 0; seat < 2; seat++) {
+			player = game->players[seat];
+			if (player != NULL && player->player_fd == -1
+					&& strcmp(player->token, token) == 0) {
+				/* the thread installs the descriptor when it is signalled */
+				player->player_fd = client_fd;
+				game_id = game->id;
+				break;
+			}
+		}
+	}
+	pthread_mutex_unlock(games_list_mutex);
+	if (game_id != -1) {
+		get_thread_by_id(threads_list, &thread, game_id);
+	}
+	if (thread == NULL) {
+		response.error = MSG_RSP_ERROR_WRONG_SESSION;
+		send_response_message(client_fd, &response);
+		return;
+	}
+	FD_CLR(client_fd, base_rdfs);
+	pthread_kill(thread->pthread, SIGRTMIN + 1);
+}
+
 /**
  * Handles client request to list all players connected to the server.
- * @param[in] client_fd    File descriptor of a client that is currently served.
- * @param[in] players_list Pointer to the head of the players list.
- * \sa players_list_s
+ * The response is served from the payload cached in the current lobby snapshot.
+ * @param[in] client_fd File descriptor of a client that is currently served.
+ * @param[in] lobby     Pointer to the lobby.
+ * \sa lobby_s
  */
 void
-handle_players_list_request(int client_fd, players_list_s **players_list) {
-	int i = 0, len = 0, count;
-	char temp[MAX_NICK_LEN + 1];
-	players_list_s *list = *players_list;
+handle_players_list_request(int client_fd, lobby_s *lobby) {
+	lobby_snapshot_s *snapshot;
 	response_s response;
 	response.type = MSG_PLAYERS_LIST_RSP;
-	count = (MAX_REQ_SIZE) / MAX_NICK_LEN;
 
-	memset(response.payload, '0', MAX_RSP_SIZE);
-	while (list != NULL && list->value != NULL && i <= count) {
-		snprintf(temp, MAX_NICK_LEN + 1, "%s%s", list->value->player_nick,
-				PAYLOAD_DELIM);
-		strncpy(response.payload + len, temp, MAX_NICK_LEN);
-		len += strlen(temp);
-		list = list->next;
-		i++;
-	}
+	snapshot = acquire_lobby_snapshot(lobby);
+	memcpy(response.payload, get_lobby_payload(snapshot, LOBBY_FILTER_PLAYERS),
+			MAX_RSP_SIZE);
+	release_lobby_snapshot(lobby, snapshot);
 	response.error = MSG_RSP_ERROR_NONE;
 	send_response_message(client_fd, &response);
 }
 
 /**
  * Handles client request to list all games that are currently on the server.
- * @param[in] client_fd  File descriptor of a client that is currently served.
- * @param[in] games_list Pointer to the head of the games list.
- * \sa games_list_s
+ * The response is served from the payload cached in the current lobby snapshot,
+ * so listing never blocks nor is blocked by creating, joining or ending games.
+ * @param[in] client_fd File descriptor of a client that is currently served.
+ * @param[in] lobby     Pointer to the lobby.
+ * \sa lobby_s lobby_snapshot_s
  */
 void
-handle_game_list_request(int client_fd, games_list_s **games_list) {
-	int i = 0, len = 0;
-	char temp[128];
-	games_list_s *list = *games_list;
+handle_game_list_request(int client_fd, lobby_s *lobby) {
+	lobby_snapshot_s *snapshot;
 	response_s response;
 	response.type = MSG_GAMES_LIST_RSP;
 
-	memset(response.payload, '0', MAX_RSP_SIZE);
-	while (list != NULL && list->value != NULL) {
-		if (list->value->players[1] == NULL) {
-			snprintf(temp, 128, "%d%s%d%s%d%s%s%s", list->value->id,
-					INNER_DELIM, get_board_size(list->value->board),
-					INNER_DELIM, (SPECTATORS_NO - list->value->no_connected_spectators),
-					INNER_DELIM, list->value->players[0]->player_nick,
-					PAYLOAD_DELIM);
-			strncpy(response.payload + len, temp, 128);
-			len += strlen(temp);
-		} else if (list->value->players[1] != NULL) {
-			snprintf(temp, 128, "%d%s%d%s%d%s%s%s%s%s", list->value->id,
-					INNER_DELIM, get_board_size(list->value->board),
-					INNER_DELIM, (SPECTATORS_NO - list->value->no_connected_spectators),
-					INNER_DELIM, list->value->players[0]->player_nick,
-					INNER_DELIM, list->value->players[1]->player_nick,
-					PAYLOAD_DELIM);
-			strncpy(response.payload + len, temp, 128);
-			len += strlen(temp);
-		}
-		list = list->next;
-		i++;
-	}
-
+	snapshot = acquire_lobby_snapshot(lobby);
+	memcpy(response.payload, get_lobby_payload(snapshot, LOBBY_FILTER_GAMES),
+			MAX_RSP_SIZE);
+	release_lobby_snapshot(lobby, snapshot);
 	response.error = MSG_RSP_ERROR_NONE;
 	send_response_message(client_fd, &response);
 }
 
 /**
- * Handles client request to create new game.
+ * Handles client request to create new game. The payload holds the board size
+ * optionally followed by the win length and the game mode.
  * @param[in] client_fd        File descriptor of a client that is currently served.
  * @param[in] request          Pointer to a structure containing request data.
- * @param[in] players_list     Pointer to the head of the players list.
- * @param[in] games_list       Pointer to the head of the games list.
+ * @param[in] players_list     Pointer to the players list.
+ * @param[in] games_list       Pointer to the games list.
  * @param[in] games_list_mutex Pointer to a mutex guarding games list.
- * \sa request_s players_list_s games_list_s pthread_mutex_t
+ * @param[in] lobby            Pointer to the lobby.
+ * @param[in] matchmaker       Pointer to the quick match queues.
+ * \sa request_s players_list_s games_list_s pthread_mutex_t lobby_s
  */
 void
 handle_create_new_game_request(int client_fd, request_s *request,
 		players_list_s *players_list, games_list_s *games_list,
-		pthread_mutex_t *games_list_mutex) {
+		pthread_mutex_t *games_list_mutex, lobby_s *lobby,
+		matchmaker_s *matchmaker) {
 	int ret;
 	response_s response;
 	game_s *game = NULL;
 	player_s *player = NULL;
-	int size = atoi(request->payload);
+	int size, win_length = WIN_LENGTH, mode = GAME_MODE_FREE;
+	char *token, *saveptr = NULL;
 	response.type = MSG_CREATE_GAME_RSP;
 
-	if (size < 4 || size > 20) {
+	token = strtok_r(request->payload, PAYLOAD_DELIM, &saveptr);
+	size = token != NULL ? atoi(token) : -1;
+	if ((token = strtok_r(NULL, PAYLOAD_DELIM, &saveptr)) != NULL) {
+		win_length = atoi(token);
+	}
+	if ((token = strtok_r(NULL, PAYLOAD_DELIM, &saveptr)) != NULL) {
+		mode = atoi(token);
+	}
+	if (size < 0 || (size > 0 && size < MIN_BOARD_SIZE)
+			|| size > MAX_SPARSE_BOARD_SIZE) {
 		response.error = MSG_RSP_ERROR_WRONG_BORAD_SIZE;
 		send_response_message(client_fd, &response);
 		return;
 	}
+	if (win_length < MIN_WIN_LENGTH || win_length > MAX_WIN_LENGTH
+			|| (size > 0 && win_length > size)) {
+		response.error = MSG_RSP_ERROR_WRONG_WIN_LENGTH;
+		send_response_message(client_fd, &response);
+		return;
+	}
+	if (mode < GAME_MODE_FREE || mode >= GAME_MODES_NO
+			|| (mode == GAME_MODE_GRAVITY && size == 0)) {
+		response.error = MSG_RSP_ERROR_WRONG_GAME_MODE;
+		send_response_message(client_fd, &response);
+		return;
+	}
 	get_player_by_file_desc(players_list, &player, client_fd);
 	if (player == NULL) {
 		response.error = MSG_RSP_INTERNAL_SERVER_ERROR;
 		send_response_message(client_fd, &response);
 		return;
 	}
-	if (create_new_game(games_list, &game, player, size) == -1) {
+	if (create_new_game(games_list, &game, player, size, win_length, mode)
+			== -1) {
 		response.error = MSG_RSP_INTERNAL_SERVER_ERROR;
 		send_response_message(client_fd, &response);
 		return;
 	}
+	remove_queued_player(matchmaker, player);
 
 	pthread_mutex_lock(games_list_mutex);
 	ret = add_game_to_list(games_list, game);
@@ -329,14 +533,176 @@ handle_create_new_game_request(int client_fd, request_s *request,
 	}
 
 	game->no_connected_players++;
+	publish_lobby(lobby);
 	snprintf(response.payload, 4, "%d", game->id);
 	response.error = MSG_RSP_ERROR_NONE;
 	send_response_message(client_fd, &response);
 }
 
+/**
+ * Starts new thread that will serve all communication between server and
+ * clients of a game whose players are all seated and whose current player is set.
+ * @param[in] game               Pointer to the game.
+ * @param[in] base_rdfs          Bit array holding file descriptor to be served by the server.
+ * @param[in] players_list       Pointer to a list holding players.
+ * @param[in] games_list         Pointer to a list holding games.
+ * @param[in] threads_list       Pointer to a list holding threads.
+ * @param[in] players_list_mutex Pointer to a mutex guarding players list.
+ * @param[in] games_list_mutex   Pointer to a mutex guarding games list.
+ * @param[in] threads_list_mutex Pointer to a mutex guarding threads list.
+ * @param[in] lobby              Pointer to the lobby.
+ * \sa game_s thread_data_s
+ */
+void
+launch_game(game_s *game, fd_set *base_rdfs, players_list_s *players_list,
+		games_list_s *games_list, threads_list_s *threads_list,
+		pthread_mutex_t *players_list_mutex, pthread_mutex_t *games_list_mutex,
+		pthread_mutex_t *threads_list_mutex, lobby_s *lobby) {
+	thread_data_s *data;
+	game->state = GAME_STATE_STARTED;
+	/* thread arguments live in the game arena so they outlive this call */
+	data = game->tdata;
+	data->games_list = games_list;
+	data->players_list = players_list;
+	data->parent_pid = getpid();
+	data->game = game;
+	data->players_list_mutex = players_list_mutex;
+	data->games_list_mutex = games_list_mutex;
+	data->threads_list_mutex = threads_list_mutex;
+	data->threads_list = threads_list;
+	data->lobby = lobby;
+	data->players_fd[0] = game->players[0]->player_fd;
+	data->players_fd[1] = game->players[1]->player_fd;
+	data->away_until[0] = 0;
+	data->away_until[1] = 0;
+	memcpy(data->spectators_fd, game->spectators, SPECTATORS_NO * sizeof(int));
+	data->rd_fds = base_rdfs;
+	FD_CLR(data->players_fd[0], base_rdfs);
+	FD_CLR(data->players_fd[1], base_rdfs);
+	clear_spectators_fds(base_rdfs, data);
+	initialize_thread(data, threads_list, threads_list_mutex);
+	publish_lobby(lobby);
+}
+
+/**
+ * Seats the second player in a waiting game, draws the player moving first
+ * and starts the game.
+ * @param[in] game               Pointer to a waiting game.
+ * @param[in] player             Pointer to the player joining the game.
+ * @param[in] base_rdfs          Bit array holding file descriptor to be served by the server.
+ * @param[in] players_list       Pointer to a list holding players.
+ * @param[in] games_list         Pointer to a list holding games.
+ * @param[in] threads_list       Pointer to a list holding threads.
+ * @param[in] players_list_mutex Pointer to a mutex guarding players list.
+ * @param[in] games_list_mutex   Pointer to a mutex guarding games list.
+ * @param[in] threads_list_mutex Pointer to a mutex guarding threads list.
+ * @param[in] lobby              Pointer to the lobby.
+ * \sa game_s player_s launch_game
+ */
+void
+start_game(game_s *game, player_s *player, fd_set *base_rdfs,
+		players_list_s *players_list, games_list_s *games_list,
+		threads_list_s *threads_list, pthread_mutex_t *players_list_mutex,
+		pthread_mutex_t *games_list_mutex, pthread_mutex_t *threads_list_mutex,
+		lobby_s *lobby) {
+	game->no_connected_players++;
+	game->players[1] = player;
+	game->first_seat = get_random_player();
+	game->current_player = game->players[game->first_seat]->player_fd;
+	journal_game_started(game);
+	launch_game(game, base_rdfs, players_list, games_list, threads_list,
+			players_list_mutex, games_list_mutex, threads_list_mutex, lobby);
+}
+
+/**
+ * Seats a player in a game restored from the journal, in the seat kept for
+ * the player's nick. The game goes on once all its players are seated, with
+ * the player whose turn it was when the server stopped.
+ * @param[in] game               Pointer to the restored game.
+ * @param[in] player             Pointer to the player joining the game.
+ * @param[in] base_rdfs          Bit array holding file descriptor to be served by the server.
+ * @param[in] players_list       Pointer to a list holding players.
+ * @param[in] games_list         Pointer to a list holding games.
+ * @param[in] threads_list       Pointer to a list holding threads.
+ * @param[in] players_list_mutex Pointer to a mutex guarding players list.
+ * @param[in] games_list_mutex   Pointer to a mutex guarding games list.
+ * @param[in] threads_list_mutex Pointer to a mutex guarding threads list.
+ * @param[in] lobby              Pointer to the lobby.
+ * @retval MSG_RSP_ERROR_NONE         When the player is seated.
+ * @retval MSG_RSP_ERROR_WRONG_PLAYER When no free seat is kept for the player.
+ * \sa game_s launch_game
+ */
+message_error_e
+resume_restored_game(game_s *game, player_s *player,
+		fd_set *base_rdfs, players_list_s *players_list,
+		games_list_s *games_list, threads_list_s *threads_list,
+		pthread_mutex_t *players_list_mutex, pthread_mutex_t *games_list_mutex,
+		pthread_mutex_t *threads_list_mutex, lobby_s *lobby) {
+	int seat;
+	for (seat = 0; seat < 2; seat++) {
+		if (game->players[seat] == NULL
+				&& strncmp(game->seats[seat], player->player_nick,
+						MAX_NICK_LEN) == 0) {
+			break;
+		}
+	}
+	if (seat == 2) {
+		return MSG_RSP_ERROR_WRONG_PLAYER;
+	}
+	game->players[seat] = player;
+	game->no_connected_players++;
+	LOG_INFO_TEXT("Player %s is back in restored game %d", player->player_nick,
+			game->id);
+	if (game->no_connected_players < 2) {
+		publish_lobby(lobby);
+		return MSG_RSP_ERROR_NONE;
+	}
+	game->seats = NULL;
+	game->current_player = game->players[(game->first_seat + game->no_moves)
+			% 2]->player_fd;
+	launch_game(game, base_rdfs, players_list, games_list, threads_list,
+			players_list_mutex, games_list_mutex, threads_list_mutex, lobby);
+	return MSG_RSP_ERROR_NONE;
+}
+
+/**
+ * Takes a disconnected player out of the games waiting for players, so no
+ * game points to the player once it is freed. A game the player created is
+ * removed and journaled as ended, as if the player left it, and seats the
+ * player holds in restored games are freed.
+ * @param[in] games_list       Pointer to a list holding games.
+ * @param[in] games_list_mutex Pointer to a mutex guarding games list.
+ * @param[in] player           Pointer to the disconnected player.
+ * \sa game_s
+ */
+void
+leave_waiting_games(games_list_s *games_list,
+		pthread_mutex_t *games_list_mutex, player_s *player) {
+	int seat;
+	game_s *game, *next;
+	pthread_mutex_lock(games_list_mutex);
+	for (game = games_list->head; game != NULL; game = next) {
+		next = game->next;
+		if (game->seats != NULL) {
+			for (seat = 0; seat < 2; seat++) {
+				if (game->players[seat] == player) {
+					game->players[seat] = NULL;
+					game->no_connected_players--;
+				}
+			}
+		} else if (game->state == GAME_STATE_WAITING
+				&& (game->players[0] == player || game->players[1] == player)) {
+			journal_game_ended(game, 0);
+			remove_game_from_list(games_list, game);
+		}
+	}
+	pthread_mutex_unlock(games_list_mutex);
+}
+
 /**
  * Handles client request to connect to existing game by initializing new thread that will
- * serve all communication between server and clients.
+ * serve all communication between server and clients. The response tells the
+ * board size and the game mode.
  * @param[in] client_fd          File descriptor of a client that is currently served.
  * @param[in] request            Pointer to a structure containing request data.
  * @param[in] base_rdfs          Bit array holding file descriptor to be served by the server.
@@ -346,22 +712,24 @@ handle_create_new_game_request(int client_fd, request_s *request,
  * @param[in] players_list_mutex Pointer to a mutex guarding players list.
  * @param[in] games_list_mutex   Pointer to a mutex guarding games list.
  * @param[in] threads_list_mutex  Pointer to a mutex guarding threads list.
- * \sa request_s players_list_s games_list_s threads_list_s
+ * @param[in] lobby              Pointer to the lobby.
+ * @param[in] matchmaker         Pointer to the quick match queues.
+ * \sa request_s players_list_s games_list_s threads_list_s lobby_s
  */
 void
 handle_connect_to_existing_game_request(int client_fd, request_s *request,
-		fd_set *base_rdfs, players_list_s **players_list,
-		games_list_s **games_list, threads_list_s **threads_list,
+		fd_set *base_rdfs, players_list_s *players_list,
+		games_list_s *games_list, threads_list_s *threads_list,
 		pthread_mutex_t *players_list_mutex, pthread_mutex_t *games_list_mutex,
-		pthread_mutex_t *threads_list_mutex) {
+		pthread_mutex_t *threads_list_mutex, lobby_s *lobby,
+		matchmaker_s *matchmaker) {
 	int game_id = atoi(request->payload);
-	thread_data_s data;
 	response_s response;
 	game_s *game = NULL;
 	player_s *player = NULL;
 	response.type = MSG_CONNECT_GAME_RSP;
 
-	get_game_by_id(*games_list, &game, game_id);
+	get_game_by_id(games_list, &game, game_id);
 	if (game == NULL) {
 		response.error = MSG_RSP_ERROR_WRONG_GAME_ID;
 		send_response_message(client_fd, &response);
@@ -373,34 +741,319 @@ handle_connect_to_existing_game_request(int client_fd, request_s *request,
 		return;
 	}
 
-	get_player_by_file_desc(*players_list, &player, client_fd);
+	get_player_by_file_desc(players_list, &player, client_fd);
+	if (player == NULL) {
+		response.error = MSG_RSP_INTERNAL_SERVER_ERROR;
+		send_response_message(client_fd, &response);
+		return;
+	}
+	remove_queued_player(matchmaker, player);
+	snprintf(response.payload, MAX_RSP_SIZE, "%d%s%d%s", game->size,
+			PAYLOAD_DELIM, game->mode, PAYLOAD_DELIM);
+	if (game->seats != NULL) {
+		response.error = resume_restored_game(game, player, base_rdfs,
+				players_list, games_list, threads_list, players_list_mutex,
+				games_list_mutex, threads_list_mutex, lobby);
+		send_response_message(client_fd, &response);
+		return;
+	}
+	start_game(game, player, base_rdfs, players_list, games_list, threads_list,
+			players_list_mutex, games_list_mutex, threads_list_mutex, lobby);
+	response.error = MSG_RSP_ERROR_NONE;
+	send_response_message(client_fd, &response);
+}
+
+/**
+ * Handles client request for a quick match on a board of a given size. When
+ * another player waits for the same board size a new game is created for both
+ * of them and started at once, otherwise the client is queued and notified
+ * later with an unsolicited response holding the game ID.
+ * @param[in] client_fd          File descriptor of a client that is currently served.
+ * @param[in] request            Pointer to a structure containing request data.
+ * @param[in] base_rdfs          Bit array holding file descriptor to be served by the server.
+ * @param[in] players_list       Pointer to a list holding players.
+ * @param[in] games_list         Pointer to a list holding games.
+ * @param[in] threads_list       Pointer to a list holding threads.
+ * @param[in] players_list_mutex Pointer to a mutex guarding players list.
+ * @param[in] games_list_mutex   Pointer to a mutex guarding games list.
+ * @param[in] threads_list_mutex Pointer to a mutex guarding threads list.
+ * @param[in] lobby              Pointer to the lobby.
+ * @param[in] matchmaker         Pointer to the quick match queues.
+ * \sa request_s matchmaker_s
+ */
+void
+handle_quick_match_request(int client_fd, request_s *request,
+		fd_set *base_rdfs, players_list_s *players_list,
+		games_list_s *games_list, threads_list_s *threads_list,
+		pthread_mutex_t *players_list_mutex, pthread_mutex_t *games_list_mutex,
+		pthread_mutex_t *threads_list_mutex, lobby_s *lobby,
+		matchmaker_s *matchmaker) {
+	int ret, size = atoi(request->payload);
+	response_s response;
+	game_s *game = NULL;
+	player_s *player = NULL, *opponent = NULL;
+	memset(response.payload, 0, MAX_RSP_SIZE);
+	response.type = MSG_QUICK_MATCH_RSP;
+
+	if (size < MIN_BOARD_SIZE || size > MAX_BOARD_SIZE) {
+		response.error = MSG_RSP_ERROR_WRONG_BORAD_SIZE;
+		send_response_message(client_fd, &response);
+		return;
+	}
+	get_player_by_file_desc(players_list, &player, client_fd);
 	if (player == NULL) {
 		response.error = MSG_RSP_INTERNAL_SERVER_ERROR;
 		send_response_message(client_fd, &response);
 		return;
 	}
+	remove_queued_player(matchmaker, player);
+	if ((opponent = dequeue_player(matchmaker, size)) == NULL) {
+		enqueue_player(matchmaker, player, size);
+		strncpy(response.payload, "0", 2);
+		response.error = MSG_RSP_ERROR_NONE;
+		send_response_message(client_fd, &response);
+		return;
+	}
+
+	if (create_new_game(games_list, &game, opponent, size, WIN_LENGTH,
+			GAME_MODE_FREE) == -1) {
+		enqueue_player(matchmaker, opponent, size);
+		response.error = MSG_RSP_INTERNAL_SERVER_ERROR;
+		send_response_message(client_fd, &response);
+		return;
+	}
+	pthread_mutex_lock(games_list_mutex);
+	ret = add_game_to_list(games_list, game);
+	pthread_mutex_unlock(games_list_mutex);
+	if (ret == -1) {
+		destroy_game(game);
+		enqueue_player(matchmaker, opponent, size);
+		response.error = MSG_RSP_INTERNAL_SERVER_ERROR;
+		send_response_message(client_fd, &response);
+		return;
+	}
 	game->no_connected_players++;
-	game->players[1] = player;
-	game->state = GAME_STATE_STARTED;
-	data.games_list = games_list;
-	data.players_list = players_list;
-	data.parent_pid = getpid();
-	data.game = game;
-	data.players_list_mutex = players_list_mutex;
-	data.games_list_mutex = games_list_mutex;
-	data.threads_list_mutex = threads_list_mutex;
-	data.threads_list = threads_list;
-	data.game->current_player = game->players[get_random_player()]->player_fd;
-	data.players_fd[0] = game->players[0]->player_fd;
-	data.players_fd[1] = game->players[1]->player_fd;
-	memcpy(data.spectators_fd, game->spectators, SPECTATORS_NO * sizeof(int));
-	data.rd_fds = base_rdfs;
-	FD_CLR(data.players_fd[0], base_rdfs);
-	FD_CLR(data.players_fd[1], base_rdfs);
-	clear_spectators_fds(base_rdfs, &data);
-	initialize_thread(&data, *threads_list, threads_list_mutex);
+	snprintf(response.payload, 4, "%d", game->id);
+	response.error = MSG_RSP_ERROR_NONE;
+	send_response_message(opponent->player_fd, &response);
+	send_response_message(client_fd, &response);
+	start_game(game, player, base_rdfs, players_list, games_list, threads_list,
+			players_list_mutex, games_list_mutex, threads_list_mutex, lobby);
+}
+
+/**
+ * Handles client request for a game against the server's bot. The game starts
+ * at once with the bot as the second player; the bot thinks over every move
+ * for the requested time on the compute pool, with alpha-beta or Monte Carlo
+ * tree search.
+ * @param[in] client_fd          File descriptor of a client that is currently served.
+ * @param[in] request            Pointer to a structure containing request data.
+ * @param[in] base_rdfs          Bit array holding file descriptor to be served by the server.
+ * @param[in] players_list       Pointer to a list holding players.
+ * @param[in] games_list         Pointer to a list holding games.
+ * @param[in] threads_list       Pointer to a list holding threads.
+ * @param[in] players_list_mutex Pointer to a mutex guarding players list.
+ * @param[in] games_list_mutex   Pointer to a mutex guarding games list.
+ * @param[in] threads_list_mutex Pointer to a mutex guarding threads list.
+ * @param[in] lobby              Pointer to the lobby.
+ * @param[in] matchmaker         Pointer to the quick match queues.
+ * @param[in] pool               Pointer to the pool running bot searches.
+ * \sa request_s bot_s compute_pool_s
+ */
+void
+handle_create_bot_game_request(int client_fd, request_s *request,
+		fd_set *base_rdfs, players_list_s *players_list,
+		games_list_s *games_list, threads_list_s *threads_list,
+		pthread_mutex_t *players_list_mutex, pthread_mutex_t *games_list_mutex,
+		pthread_mutex_t *threads_list_mutex, lobby_s *lobby,
+		matchmaker_s *matchmaker, compute_pool_s *pool) {
+	int ret;
+	response_s response;
+	game_s *game = NULL;
+	player_s *player = NULL;
+	int size, win_length = WIN_LENGTH, mode = GAME_MODE_FREE;
+	int budget_ms = BOT_BUDGET_MS, engine = BOT_ENGINE_ALPHA_BETA;
+	char *token, *saveptr = NULL;
+	memset(response.payload, 0, MAX_RSP_SIZE);
+	response.type = MSG_CREATE_BOT_GAME_RSP;
+
+	token = strtok_r(request->payload, PAYLOAD_DELIM, &saveptr);
+	size = token != NULL ? atoi(token) : -1;
+	if ((token = strtok_r(NULL, PAYLOAD_DELIM, &saveptr)) != NULL) {
+		win_length = atoi(token);
+	}
+	if ((token = strtok_r(NULL, PAYLOAD_DELIM, &saveptr)) != NULL) {
+		mode = atoi(token);
+	}
+	if ((token = strtok_r(NULL, PAYLOAD_DELIM, &saveptr)) != NULL
+			&& atoi(token) != 0) {
+		budget_ms = atoi(token);
+	}
+	if ((token = strtok_r(NULL, PAYLOAD_DELIM, &saveptr)) != NULL) {
+		engine = atoi(token);
+	}
+	/* the bot searches dense boards only */
+	if (size < MIN_BOARD_SIZE || size > MAX_BOARD_SIZE) {
+		response.error = MSG_RSP_ERROR_WRONG_BORAD_SIZE;
+		send_response_message(client_fd, &response);
+		return;
+	}
+	if (win_length < MIN_WIN_LENGTH || win_length > MAX_WIN_LENGTH
+			|| win_length > size) {
+		response.error = MSG_RSP_ERROR_WRONG_WIN_LENGTH;
+		send_response_message(client_fd, &response);
+		return;
+	}
+	if (mode < GAME_MODE_FREE || mode >= GAME_MODES_NO) {
+		response.error = MSG_RSP_ERROR_WRONG_GAME_MODE;
+		send_response_message(client_fd, &response);
+		return;
+	}
+	if (budget_ms < MIN_BOT_BUDGET_MS || budget_ms > MAX_BOT_BUDGET_MS) {
+		response.error = MSG_RSP_ERROR_WRONG_BOT_BUDGET;
+		send_response_message(client_fd, &response);
+		return;
+	}
+	if (engine < BOT_ENGINE_ALPHA_BETA || engine >= BOT_ENGINES_NO) {
+		response.error = MSG_RSP_ERROR_WRONG_BOT_ENGINE;
+		send_response_message(client_fd, &response);
+		return;
+	}
+	get_player_by_file_desc(players_list, &player, client_fd);
+	if (player == NULL) {
+		response.error = MSG_RSP_INTERNAL_SERVER_ERROR;
+		send_response_message(client_fd, &response);
+		return;
+	}
+	if (create_new_game(games_list, &game, player, size, win_length, mode)
+			== -1) {
+		response.error = MSG_RSP_INTERNAL_SERVER_ERROR;
+		send_response_message(client_fd, &response);
+		return;
+	}
+	if ((game->bot = create_bot(pool, budget_ms, engine)) == NULL) {
+		destroy_game(game);
+		response.error = MSG_RSP_INTERNAL_SERVER_ERROR;
+		send_response_message(client_fd, &response);
+		return;
+	}
+	pthread_mutex_lock(games_list_mutex);
+	ret = add_game_to_list(games_list, game);
+	pthread_mutex_unlock(games_list_mutex);
+	if (ret == -1) {
+		destroy_game(game);
+		response.error = MSG_RSP_INTERNAL_SERVER_ERROR;
+		send_response_message(client_fd, &response);
+		return;
+	}
+	remove_queued_player(matchmaker, player);
+	game->no_connected_players++;
+	snprintf(response.payload, 4, "%d", game->id);
 	response.error = MSG_RSP_ERROR_NONE;
 	send_response_message(client_fd, &response);
+	start_game(game, &game->bot->player, base_rdfs, players_list, games_list,
+			threads_list, players_list_mutex, games_list_mutex,
+			threads_list_mutex, lobby);
+}
+
+/**
+ * Reads a position sent for analysis: the size of the board, the win length,
+ * the game mode and the fields row by row, '1' empty, 'x' or 'o'. The player
+ * to move follows from the numbers of pawns.
+ * @param[in]  payload Payload of the request.
+ * @param[out] search  Pointer to the position.
+ * @return MSG_RSP_ERROR_NONE or the error telling what is wrong.
+ * \sa search_s
+ */
+message_error_e
+parse_analyzed_position(char *payload, search_s *search) {
+	int x, y, size, no_x = 0, no_o = 0;
+	char *token, *saveptr = NULL, field;
+	token = strtok_r(payload, PAYLOAD_DELIM, &saveptr);
+	size = token != NULL ? atoi(token) : -1;
+	token = strtok_r(NULL, PAYLOAD_DELIM, &saveptr);
+	search->win_length = token != NULL ? atoi(token) : -1;
+	token = strtok_r(NULL, PAYLOAD_DELIM, &saveptr);
+	search->mode = token != NULL ? atoi(token) : -1;
+	token = strtok_r(NULL, PAYLOAD_DELIM, &saveptr);
+	if (size < MIN_BOARD_SIZE || size > MAX_BOARD_SIZE) {
+		return MSG_RSP_ERROR_WRONG_BORAD_SIZE;
+	}
+	if (search->win_length < MIN_WIN_LENGTH
+			|| search->win_length > MAX_WIN_LENGTH || search->win_length > size) {
+		return MSG_RSP_ERROR_WRONG_WIN_LENGTH;
+	}
+	if (search->mode < GAME_MODE_FREE || search->mode >= GAME_MODES_NO) {
+		return MSG_RSP_ERROR_WRONG_GAME_MODE;
+	}
+	if (token == NULL || (int) strlen(token) != size * size) {
+		return MSG_RSP_ERROR_WRONG_POSITION;
+	}
+	search->size = size;
+	search->no_empty = 0;
+	search->hash = 0;
+	memset(search->heights, 0, sizeof(search->heights));
+	for (x = 0; x < size; x++) {
+		for (y = 0; y < size; y++) {
+			field = token[x * size + y];
+			if (field != '1' && field != 'x' && field != 'o') {
+				return MSG_RSP_ERROR_WRONG_POSITION;
+			}
+			search->cells[x * size + y] = field == 'x' ? 1 : field == 'o' ? 2 : 0;
+			if (field == '1') {
+				search->no_empty++;
+				continue;
+			}
+			/* pawns of a gravity game lie on the bottom or on other pawns */
+			if (search->mode == GAME_MODE_GRAVITY && x < size - 1
+					&& token[(x + 1) * size + y] == '1') {
+				return MSG_RSP_ERROR_WRONG_POSITION;
+			}
+			search->heights[y]++;
+			no_x += field == 'x';
+			no_o += field == 'o';
+			search->hash ^= get_zobrist_key(size, x, y, field);
+		}
+	}
+	if (no_x != no_o && no_x != no_o + 1) {
+		return MSG_RSP_ERROR_WRONG_POSITION;
+	}
+	search->side = no_x == no_o ? 1 : 2;
+	return MSG_RSP_ERROR_NONE;
+}
+
+/**
+ * Handles client request to analyze a supplied position. The answer is a
+ * suggested move and the chance to win of the player to move. Searches run
+ * on the hint pool; when the answer is not known at once it comes through
+ * the hint channel of the main thread and is sent by the main loop.
+ * @param[in] client_fd File descriptor of a client that is currently served.
+ * @param[in] request   Pointer to a structure containing request data.
+ * @param[in] hints     Pointer to the hint channel of the main thread.
+ * \sa request_s hint_channel_s
+ */
+void
+handle_analyze_request(int client_fd, request_s *request,
+		hint_channel_s *hints) {
+	search_s *search;
+	hint_notice_s notice;
+	response_s response;
+	memset(response.payload, 0, MAX_RSP_SIZE);
+	response.type = MSG_ANALYZE_RSP;
+	if ((search = malloc(sizeof(search_s))) == NULL) {
+		response.error = MSG_RSP_INTERNAL_SERVER_ERROR;
+		send_response_message(client_fd, &response);
+		return;
+	}
+	if ((response.error = parse_analyzed_position(request->payload, search))
+			!= MSG_RSP_ERROR_NONE) {
+		send_response_message(client_fd, &response);
+	} else if (request_hint(hints, client_fd, MSG_ANALYZE_RSP, search, &notice)
+			== 1) {
+		get_hint_response(&notice, &response);
+		send_response_message(client_fd, &response);
+	}
+	free(search);
 }
 
 /**
@@ -411,12 +1064,13 @@ handle_connect_to_existing_game_request(int client_fd, request_s *request,
  * @param[in] base_rdfs    Bit array holding file descriptor to be served by the server.
  * @param[in] games_list   Pointer to a list holding games.
  * @param[in] threads_list Pointer to a list holding threads.
- * \sa request_s games_list_s threads_list_s
+ * @param[in] lobby        Pointer to the lobby.
+ * \sa request_s games_list_s threads_list_s lobby_s
  */
 void
 handle_connect_as_spectator_request(int client_fd, request_s *request,
 		fd_set *base_rdfs, games_list_s *games_list,
-		threads_list_s *threads_list) {
+		threads_list_s *threads_list, lobby_s *lobby) {
 	int game_id = atoi(request->payload);
 	response_s response;
 	game_s *game = NULL;
@@ -438,13 +1092,17 @@ handle_connect_as_spectator_request(int client_fd, request_s *request,
 	if (thread == NULL) {
 		update_spectators(client_fd, game);
 		game->no_connected_spectators++;
+		count_metric(METRIC_SPECTATORS_JOINED, 1);
+		publish_lobby(lobby);
 		response.error = MSG_RSP_ERROR_NONE;
 		send_response_message(client_fd, &response);
-		printf("New spectator connected\n");
+		LOG_INFO("New spectator connected");
 		return;
 	}
 	update_spectators(client_fd, game);
 	game->no_connected_spectators++;
+	count_metric(METRIC_SPECTATORS_JOINED, 1);
+	publish_lobby(lobby);
 	FD_CLR(client_fd, base_rdfs);
 	response.error = MSG_RSP_ERROR_NONE;
 	send_response_message(client_fd, &response);
@@ -457,11 +1115,12 @@ handle_connect_as_spectator_request(int client_fd, request_s *request,
  * @param[in] client_fd  File descriptor of a client that is currently served.
  * @param[in] request    Pointer to a structure containing request data.
  * @param[in] games_list Pointer to a list holding games.
- * \sa request_s games_list_s
+ * @param[in] lobby      Pointer to the lobby.
+ * \sa request_s games_list_s lobby_s
  */
 void
 handle_back_to_menu_request(int client_fd, request_s *request,
-		games_list_s *games_list) {
+		games_list_s *games_list, lobby_s *lobby) {
 	int game_id = atoi(request->payload);
 	response_s response;
 	game_s *game = NULL;
@@ -473,10 +1132,12 @@ handle_back_to_menu_request(int client_fd, request_s *request,
 		return;
 	}
 	game->no_connected_spectators--;
+	count_metric(METRIC_SPECTATORS_LEFT, 1);
 	set_spectator_fd_unused(client_fd, game);
+	publish_lobby(lobby);
 	response.error = MSG_RSP_ERROR_NONE;
 	send_response_message(client_fd, &response);
-	printf("Spectator disconnected\n");
+	LOG_INFO("Spectator disconnected");
 }
 
 /**
@@ -501,17 +1162,30 @@ handle_game_message(int client_fd, request_s *request) {
  * @param[in] request          Pointer to a structure containing request data.
  * @param[in] games_list       Pointer to a list holding games.
  * @param[in] games_list_mutex Pointer to a mutex guarding games list.
- * \sa request_s games_list_s
+ * @param[in] lobby            Pointer to the lobby.
+ * @param[in] players_list     Pointer to a list holding players.
+ * @param[in] matchmaker       Pointer to the quick match queues.
+ * \sa request_s games_list_s lobby_s
  */
 void
 handle_leave_game_request(int client_fd, request_s *request,
-		games_list_s **games_list, pthread_mutex_t *games_list_mutex) {
+		games_list_s *games_list, pthread_mutex_t *games_list_mutex,
+		lobby_s *lobby, players_list_s *players_list, matchmaker_s *matchmaker) {
 	int game_id;
 	response_s response;
 	game_s *game = NULL;
+	player_s *player = NULL;
 	response.type = MSG_LEAVE_RSP;
 	game_id = atoi(request->payload);
-	get_game_by_id(*games_list, &game, game_id);
+	get_player_by_file_desc(players_list, &player, client_fd);
+	if (player != NULL && player->queued_size != 0) {
+		/* leaving the quick match queue */
+		remove_queued_player(matchmaker, player);
+		response.error = MSG_RSP_ERROR_NONE;
+		send_response_message(client_fd, &response);
+		return;
+	}
+	get_game_by_id(games_list, &game, game_id);
 	if (game == NULL) {
 		response.error = MSG_RSP_ERROR_WRONG_GAME_ID;
 		send_response_message(client_fd, &response);
@@ -519,7 +1193,9 @@ handle_leave_game_request(int client_fd, request_s *request,
 	}
 	response.error = MSG_RSP_ERROR_NONE;
 	send_response_message(client_fd, &response);
+	journal_game_ended(game, 0);
 	pthread_mutex_lock(games_list_mutex);
 	remove_game_from_list(games_list, game);
 	pthread_mutex_unlock(games_list_mutex);
+	publish_lobby(lobby);
 }
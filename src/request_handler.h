@@ -11,25 +11,50 @@
 #ifndef REQUEST_HANDLER_H_
 #define REQUEST_HANDLER_H_
 
+int allocate_new_game(game_s **new_game, int size, int win_length,
+		game_mode_e mode);
+void leave_waiting_games(games_list_s *games_list,
+		pthread_mutex_t *games_list_mutex, player_s *player);
 void handle_game_login_request(int client_fd, request_s *request,
-		players_list_s *players_list);
-void handle_players_list_request(int client_fd, players_list_s **players_list);
-void handle_game_list_request(int client_fd, games_list_s **games_list);
+		players_list_s *players_list, lobby_s *lobby);
+void handle_resume_request(int client_fd, request_s *request, fd_set *base_rdfs,
+		players_list_s *players_list, games_list_s *games_list,
+		pthread_mutex_t *games_list_mutex, threads_list_s *threads_list);
+void handle_players_list_request(int client_fd, lobby_s *lobby);
+void handle_game_list_request(int client_fd, lobby_s *lobby);
 void handle_create_new_game_request(int client_fd, request_s *request,
 		players_list_s *players_list, games_list_s *games_list,
-		pthread_mutex_t *games_list_mutex);
+		pthread_mutex_t *games_list_mutex, lobby_s *lobby,
+		matchmaker_s *matchmaker);
 void handle_connect_to_existing_game_request(int client_fd, request_s *request,
-		fd_set *base_rdfs, players_list_s **players_list,
-		games_list_s **games_list, threads_list_s **threads_list,
+		fd_set *base_rdfs, players_list_s *players_list,
+		games_list_s *games_list, threads_list_s *threads_list,
+		pthread_mutex_t *players_list_mutex, pthread_mutex_t *games_list_mutex,
+		pthread_mutex_t *threads_list_mutex, lobby_s *lobby,
+		matchmaker_s *matchmaker);
+void handle_quick_match_request(int client_fd, request_s *request,
+		fd_set *base_rdfs, players_list_s *players_list,
+		games_list_s *games_list, threads_list_s *threads_list,
+		pthread_mutex_t *players_list_mutex, pthread_mutex_t *games_list_mutex,
+		pthread_mutex_t *threads_list_mutex, lobby_s *lobby,
+		matchmaker_s *matchmaker);
+void handle_create_bot_game_request(int client_fd, request_s *request,
+		fd_set *base_rdfs, players_list_s *players_list,
+		games_list_s *games_list, threads_list_s *threads_list,
 		pthread_mutex_t *players_list_mutex, pthread_mutex_t *games_list_mutex,
-		pthread_mutex_t *threads_list_mutex);
+		pthread_mutex_t *threads_list_mutex, lobby_s *lobby,
+		matchmaker_s *matchmaker, compute_pool_s *pool);
+message_error_e parse_analyzed_position(char *payload, search_s *search);
+void handle_analyze_request(int client_fd, request_s *request,
+		hint_channel_s *hints);
 void handle_connect_as_spectator_request(int client_fd, request_s *request,
 		fd_set *base_rdfs, games_list_s *games_list,
-		threads_list_s *threads_list);
+		threads_list_s *threads_list, lobby_s *lobby);
 void handle_back_to_menu_request(int client_fd, request_s *request,
-		games_list_s *games_list);
+		games_list_s *games_list, lobby_s *lobby);
 void handle_game_message(int client_fd, request_s *request);
 void handle_leave_game_request(int client_fd, request_s *request,
-		games_list_s **games_list, pthread_mutex_t *games_list_mutex);
+		games_list_s *games_list, pthread_mutex_t *games_list_mutex,
+		lobby_s *lobby, players_list_s *players_list, matchmaker_s *matchmaker);
 
 #endif /* REQUEST_HANDLER_H_ */
@@ -13,9 +13,52 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "arena.h"
+#include "board_handler.h"
 #include "common.h"
 #include "messenger.h"
 
+/**
+ * Columns of the gravity game the client plays, used to reject drops into
+ * full columns without asking the server.
+ */
+static columns_s columns;
+
+/**
+ * Session token received at login, used to resume a game after the
+ * connection is lost.
+ */
+static char session_token[SESSION_TOKEN_LEN + 1];
+
+/**
+ * Remembers the board of the game the client has joined. Only gravity games
+ * on bounded boards keep track of the columns.
+ * @param[in] size Size of the board or 0 for an unbounded board.
+ * @param[in] mode Game mode.
+ * \sa game_mode_e
+ */
+void
+set_columns(int size, game_mode_e mode) {
+	columns.size = 0;
+	if (mode == GAME_MODE_GRAVITY && size > 0 && size <= MAX_SPARSE_BOARD_SIZE) {
+		columns.size = size;
+		memset(columns.heights, 0, size * sizeof(int));
+	}
+}
+
+/**
+ * Records that a field of a gravity game is taken, raising its column.
+ * @param[in] x The x coordinate of the field.
+ * @param[in] y The y coordinate of the field.
+ */
+void
+update_columns(int x, int y) {
+	if (y >= 0 && y < columns.size && x >= 0 && x < columns.size
+			&& columns.heights[y] < columns.size - x) {
+		columns.heights[y] = columns.size - x;
+	}
+}
+
 /**
  * Prints out error message that is read from server's response message.
  * @param[in] error The enumeration of message errors.
@@ -53,6 +96,39 @@ print_error_message(message_error_e error) {
 	case MSG_RSP_ERROR_WAIT_OPPONENT:
 		printf("\nWait for an opponent to connect.\n");
 		break;
+	case MSG_RSP_ERROR_WRONG_WIN_LENGTH:
+		printf("\nWrong win length. Type correct length and try again.\n");
+		break;
+	case MSG_RSP_ERROR_BOARD_TOO_LARGE:
+		printf("\nThe board is too large to be sent at once.\n");
+		break;
+	case MSG_RSP_ERROR_WRONG_GAME_MODE:
+		printf("\nWrong game mode. Gravity games need a bounded board.\n");
+		break;
+	case MSG_RSP_ERROR_WRONG_BOT_BUDGET:
+		printf("\nWrong thinking time. Type correct time and try again.\n");
+		break;
+	case MSG_RSP_ERROR_WRONG_BOT_ENGINE:
+		printf("\nWrong bot engine. Type correct engine and try again.\n");
+		break;
+	case MSG_RSP_ERROR_SERVER_BUSY:
+		printf("\nThe server is busy. Try again later.\n");
+		break;
+	case MSG_RSP_ERROR_DEADLINE_EXCEEDED:
+		printf("\nThe server had no time to think it over. Try again later.\n");
+		break;
+	case MSG_RSP_ERROR_WRONG_POSITION:
+		printf("\nThere is nothing to analyze in this position.\n");
+		break;
+	case MSG_RSP_ERROR_WRONG_PLAYER:
+		printf("\nThe game was restored after a restart and waits for its own players.\n");
+		break;
+	case MSG_RSP_ERROR_WRONG_SESSION:
+		printf("\nThe session has expired or is unknown. Log in again.\n");
+		break;
+	case MSG_RSP_ERROR_TIMED_OUT:
+		printf("\nTime is up.\n");
+		break;
 	}
 }
 
@@ -81,16 +157,26 @@ print_games_list(int idx, char *str) {
 		printf("Game ID: %s\n", str);
 		break;
 	case 1:
-		printf("Board size: %s\n", str);
+		if (atoi(str) == 0) {
+			printf("Board size: unbounded\n");
+		} else {
+			printf("Board size: %s\n", str);
+		}
 		break;
 	case 2:
+		printf("Win length: %s\n", str);
+		break;
+	case 3:
+		printf("Mode: %s\n", atoi(str) == GAME_MODE_GRAVITY ? "gravity" : "free");
+		break;
+	case 4:
 		printf("Free spectators: %d\n", atoi(str));
 		printf("Players: \n");
 		break;
-	case 3:
+	case 5:
 		printf("         1. %s\n", str);
 		break;
-	case 4:
+	case 6:
 		printf("         2. %s\n", str);
 		break;
 	default:
@@ -114,27 +200,67 @@ print_divider(int size) {
 
 /**
  * Main function responsible for displaying a board.
- * @param[in] size  Size of the board.
- * @param[in] board Two dimensional array containing current state of a board.
+ * @param[in] board Pointer to the board to be displayed.
  */
 void
-print_board(int size, char board[NROWS][NCOLS]) {
+print_board(board_s *board) {
 	int i, j;
-	print_divider(size);
-	for (i = 0; i < size; i++) {
+	char field;
+	print_divider(board->size);
+	for (i = 0; i < board->size; i++) {
 		printf("|");
-		for (j = 0; j < size; j++) {
-			if (board[i][j] == '0') {
-				continue;
-			}
-			if (board[i][j] == '1') {
+		for (j = 0; j < board->size; j++) {
+			if ((field = get_field(board, i, j)) == '1') {
 				printf("   |");
 			} else {
-				printf(" %c |", board[i][j]);
+				printf(" %c |", field);
+				update_columns(i, j);
 			}
 		}
 		printf("\n");
-		print_divider(size);
+		print_divider(board->size);
+	}
+}
+
+/**
+ * Decodes a board sent by the server and displays it.
+ * @param[in] payload Payload of a message containing board size and fields.
+ */
+void
+print_board_payload(char *payload) {
+	int size;
+	char *result = NULL;
+	arena_s *arena = NULL;
+	board_s *board = NULL;
+	result = strtok(payload, PAYLOAD_DELIM);
+	size = result != NULL ? atoi(result) : 0;
+	result = strtok(NULL, PAYLOAD_DELIM);
+	if ((arena = create_arena(get_board_arena_size(size, WIN_LENGTH))) == NULL) {
+		return;
+	}
+	if ((board = board_from_string(arena, size, result)) == NULL) {
+		print_transmission_error_message();
+		destroy_arena(arena);
+		return;
+	}
+	printf("\n\nCurrent board state:\n");
+	print_board(board);
+	destroy_arena(arena);
+}
+
+/**
+ * Prints out an occupied field of a large board.
+ * @param[in] cell Field encoded as "x;y;pawn".
+ */
+void
+print_cell(char *cell) {
+	char *x, *y, *pawn, *saveptr;
+	x = strtok_r(cell, INNER_DELIM, &saveptr);
+	y = strtok_r(NULL, INNER_DELIM, &saveptr);
+	pawn = strtok_r(NULL, INNER_DELIM, &saveptr);
+	if (x != NULL && y != NULL && pawn != NULL) {
+		printf("  (%s, %s): %s\n", x, y, pawn);
+		update_columns(atoi(x) - 1, atoi(y) - 1);
 	}
 }
 
@@ -162,9 +288,77 @@ send_game_login_request(int server_fd, player_mode_e *mode) {
 		print_error_message(response.error);
 		return;
 	}
+	snprintf(session_token, sizeof(session_token), "%.*s", SESSION_TOKEN_LEN,
+			strtok(response.payload, PAYLOAD_DELIM) != NULL
+					? response.payload : "");
+	printf("\nYour session token is %s, keep it to resume a game after losing "
+			"the connection\n", session_token);
 	*mode = PLAYER_MODE_LOGGED_IN;
 }
 
+/**
+ * Sends a request to the server to resume a game after losing the connection.
+ * The server answers with the game ID, the game mode, the pawn of the player
+ * and the board.
+ * @param[in] server_fd File descriptor of the socket connected to the server.
+ * @param[in] mode      Menu level that will be displayed.
+ * @param[in] game_id   Pointer that stores the game ID of the resumed game.
+ * \sa player_mode_e
+ */
+void
+send_resume_request(int server_fd, player_mode_e *mode, int *game_id) {
+	int i, size;
+	char token[SESSION_TOKEN_LEN + 2];
+	char *id, *game_mode, *pawn, *board_size, *cells, *saveptr;
+	request_s request;
+	response_s response;
+	request.type = MSG_RESUME_REQ;
+	printf("Enter session token (empty for the last one): ");
+	read_line(token, sizeof(token));
+	snprintf(request.payload, sizeof(request.payload), "%s%s",
+			token[0] != '\0' ? token : session_token, PAYLOAD_DELIM);
+	send_receive_message(server_fd, &request, &response);
+	if (response.type != MSG_RESUME_RSP) {
+		print_transmission_error_message();
+		return;
+	}
+	if (response.error != MSG_RSP_ERROR_NONE) {
+		print_error_message(response.error);
+		return;
+	}
+	id = strtok_r(response.payload, PAYLOAD_DELIM, &saveptr);
+	game_mode = strtok_r(NULL, PAYLOAD_DELIM, &saveptr);
+	pawn = strtok_r(NULL, PAYLOAD_DELIM, &saveptr);
+	if (id == NULL || game_mode == NULL || pawn == NULL) {
+		print_transmission_error_message();
+		return;
+	}
+	*mode = PLAYER_MODE_CONNECTED;
+	*game_id = atoi(id);
+	printf("\nGame %d resumed, you play with %s\n", *game_id, pawn);
+	if (token[0] != '\0') {
+		snprintf(session_token, sizeof(session_token), "%.*s",
+				SESSION_TOKEN_LEN, token);
+	}
+	/* the rest is "size#cells#hash#", sparse boards send the size only */
+	board_size = saveptr;
+	size = atoi(board_size);
+	set_columns(size, atoi(game_mode));
+	if ((cells = strchr(board_size, PAYLOAD_DELIM[0])) == NULL
+			|| cells[1] == '\0') {
+		return;
+	}
+	if (strlen(++cells) >= NROWS * NCOLS) {
+		for (i = 0; i < size * size; i++) {
+			if (cells[i / size * NCOLS + i % size] == 'x'
+					|| cells[i / size * NCOLS + i % size] == 'o') {
+				update_columns(i / size, i % size);
+			}
+		}
+	}
+	print_board_payload(board_size);
+}
+
 /**
  * Sends a request to the server to obtain a list of connected players.
  * @param[in] server_fd File descriptor of the socket connected to the server.
@@ -258,14 +452,22 @@ send_games_list_request(int server_fd) {
  */
 void
 send_create_game_request(int server_fd, player_mode_e *mode, int *game_id) {
-	char size[16];
+	char size[16], win_length[16], game_mode[16];
 	request_s request;
 	response_s response;
 	request.type = MSG_CREATE_GAME_REQ;
-	printf("\nEnter board size (min %d, max %d): ", MIN_BOARD_SIZE,
-			MAX_BOARD_SIZE);
+	printf("\nEnter board size (min %d, max %d, 0 for unbounded): ",
+			MIN_BOARD_SIZE, MAX_SPARSE_BOARD_SIZE);
 	read_line(size, sizeof(size));
-	strncpy(request.payload, size, sizeof(size));
+	printf("Enter win length (min %d, max %d): ", MIN_WIN_LENGTH,
+			MAX_WIN_LENGTH);
+	read_line(win_length, sizeof(win_length));
+	printf("Enter game mode (%d free, %d gravity): ", GAME_MODE_FREE,
+			GAME_MODE_GRAVITY);
+	read_line(game_mode, sizeof(game_mode));
+	snprintf(request.payload, sizeof(request.payload), "%d%s%d%s%d%s",
+			atoi(size), PAYLOAD_DELIM, atoi(win_length), PAYLOAD_DELIM,
+			atoi(game_mode), PAYLOAD_DELIM);
 	send_receive_message(server_fd, &request, &response);
 	if (response.type != MSG_CREATE_GAME_RSP) {
 		print_transmission_error_message();
@@ -278,6 +480,7 @@ send_create_game_request(int server_fd, player_mode_e *mode, int *game_id) {
 	if (*mode == PLAYER_MODE_LOGGED_IN) {
 		*mode = PLAYER_MODE_CONNECTED;
 		*game_id = atoi(response.payload);
+		set_columns(atoi(size), atoi(game_mode));
 	}
 }
 
@@ -291,6 +494,7 @@ send_create_game_request(int server_fd, player_mode_e *mode, int *game_id) {
 void
 send_connect_game_request(int server_fd, player_mode_e *mode, int *game_id) {
 	char game_no[3];
+	char *board_size, *game_mode, *saveptr;
 	request_s request;
 	response_s response;
 	request.type = MSG_CONNECT_GAME_REQ;
@@ -309,6 +513,104 @@ send_connect_game_request(int server_fd, player_mode_e *mode, int *game_id) {
 	if (*mode == PLAYER_MODE_LOGGED_IN) {
 		*mode = PLAYER_MODE_CONNECTED;
 		*game_id = atoi(game_no);
+		board_size = strtok_r(response.payload, PAYLOAD_DELIM, &saveptr);
+		game_mode = strtok_r(NULL, PAYLOAD_DELIM, &saveptr);
+		if (board_size != NULL && game_mode != NULL) {
+			set_columns(atoi(board_size), atoi(game_mode));
+		} else {
+			set_columns(0, GAME_MODE_FREE);
+		}
+	}
+}
+
+/**
+ * Sends a request for a quick match on a board of a given size. The server
+ * either pairs the player with someone already waiting or queues the player,
+ * in which case the game ID arrives later without a request.
+ * @param[in] server_fd File descriptor of the socket connected to the server.
+ * @param[in] mode      Pointer to the current mode of a menu level.
+ * @param[in] game_id   Pointer to a game ID that a user is currently connected to.
+ */
+void
+send_quick_match_request(int server_fd, player_mode_e *mode, int *game_id) {
+	char size[16];
+	request_s request;
+	response_s response;
+	request.type = MSG_QUICK_MATCH_REQ;
+	printf("\nEnter board size (min %d, max %d): ", MIN_BOARD_SIZE,
+			MAX_BOARD_SIZE);
+	read_line(size, sizeof(size));
+	strncpy(request.payload, size, sizeof(request.payload));
+	send_receive_message(server_fd, &request, &response);
+	if (response.type != MSG_QUICK_MATCH_RSP) {
+		print_transmission_error_message();
+		return;
+	}
+	if (response.error != MSG_RSP_ERROR_NONE) {
+		print_error_message(response.error);
+		return;
+	}
+	if (*mode == PLAYER_MODE_LOGGED_IN) {
+		*mode = PLAYER_MODE_CONNECTED;
+		*game_id = atoi(response.payload);
+		set_columns(0, GAME_MODE_FREE);
+		if (*game_id == 0) {
+			printf("\nWaiting for an opponent...\n");
+			*game_id = -1;
+		} else {
+			printf("\nOpponent found. Game %d started\n", *game_id);
+		}
+	}
+}
+
+/**
+ * Sends a request to the server to start a game against its bot. The bot
+ * thinks over every move for the given time with the chosen engine.
+ * @param[in] server_fd File descriptor of the socket connected to the server.
+ * @param[in] mode      Pointer to the current mode of a menu level.
+ * @param[in] game_id   Pointer to a game ID that a user is currently connected to.
+ * \sa player_mode_e
+ */
+void
+send_create_bot_game_request(int server_fd, player_mode_e *mode,
+		int *game_id) {
+	char size[16], win_length[16], game_mode[16], budget[16], engine[16];
+	request_s request;
+	response_s response;
+	request.type = MSG_CREATE_BOT_GAME_REQ;
+	printf("\nEnter board size (min %d, max %d): ", MIN_BOARD_SIZE,
+			MAX_BOARD_SIZE);
+	read_line(size, sizeof(size));
+	printf("Enter win length (min %d, max %d): ", MIN_WIN_LENGTH,
+			MAX_WIN_LENGTH);
+	read_line(win_length, sizeof(win_length));
+	printf("Enter game mode (%d free, %d gravity): ", GAME_MODE_FREE,
+			GAME_MODE_GRAVITY);
+	read_line(game_mode, sizeof(game_mode));
+	printf("Enter bot thinking time in ms (min %d, max %d, 0 for %d): ",
+			MIN_BOT_BUDGET_MS, MAX_BOT_BUDGET_MS, BOT_BUDGET_MS);
+	read_line(budget, sizeof(budget));
+	printf("Enter bot engine (%d alpha-beta, %d Monte Carlo): ",
+			BOT_ENGINE_ALPHA_BETA, BOT_ENGINE_MCTS);
+	read_line(engine, sizeof(engine));
+	snprintf(request.payload, sizeof(request.payload), "%d%s%d%s%d%s%d%s%d%s",
+			atoi(size), PAYLOAD_DELIM, atoi(win_length), PAYLOAD_DELIM,
+			atoi(game_mode), PAYLOAD_DELIM, atoi(budget), PAYLOAD_DELIM,
+			atoi(engine), PAYLOAD_DELIM);
+	send_receive_message(server_fd, &request, &response);
+	if (response.type != MSG_CREATE_BOT_GAME_RSP) {
+		print_transmission_error_message();
+		return;
+	}
+	if (response.error != MSG_RSP_ERROR_NONE) {
+		print_error_message(response.error);
+		return;
+	}
+	if (*mode == PLAYER_MODE_LOGGED_IN) {
+		*mode = PLAYER_MODE_CONNECTED;
+		*game_id = atoi(response.payload);
+		set_columns(atoi(size), atoi(game_mode));
+		printf("\nGame %d against the bot started\n", *game_id);
 	}
 }
 
@@ -342,19 +644,59 @@ send_connect_spectator_request(int server_fd, player_mode_e *mode,
 	if (*mode == PLAYER_MODE_LOGGED_IN) {
 		*mode = PLAYER_MODE_SPECTATOR;
 		*game_id = atoi(size);
+		set_columns(0, GAME_MODE_FREE);
 	}
 }
 
+/**
+ * Sends requests to the server for all the occupied fields of a large board,
+ * one page at a time, and prints them out.
+ * @param[in] server_fd File descriptor of the socket connected to the server.
+ */
+void
+send_print_cells_request(int server_fd) {
+	int page = 0, total = 0;
+	char *size, *win_length, *token, *saveptr;
+	request_s request;
+	response_s response;
+	request.type = MSG_PRINT_CELLS_REQ;
+	do {
+		snprintf(request.payload, sizeof(request.payload), "%d", page);
+		send_receive_message(server_fd, &request, &response);
+		if (response.type != MSG_PRINT_CELLS_RSP) {
+			print_transmission_error_message();
+			return;
+		}
+		if (response.error != MSG_RSP_ERROR_NONE) {
+			print_error_message(response.error);
+			return;
+		}
+		size = strtok_r(response.payload, PAYLOAD_DELIM, &saveptr);
+		win_length = strtok_r(NULL, PAYLOAD_DELIM, &saveptr);
+		token = strtok_r(NULL, PAYLOAD_DELIM, &saveptr);
+		total = token != NULL ? atoi(token) : 0;
+		strtok_r(NULL, PAYLOAD_DELIM, &saveptr);
+		if (page == 0 && size != NULL && win_length != NULL) {
+			if (atoi(size) == 0) {
+				printf("\n\nUnbounded board");
+			} else {
+				printf("\n\nBoard %sx%s", size, size);
+			}
+			printf(", %s in a row wins, %d fields taken:\n", win_length, total);
+		}
+		while ((token = strtok_r(NULL, PAYLOAD_DELIM, &saveptr)) != NULL) {
+			print_cell(token);
+		}
+		page++;
+	} while (page * CELLS_PER_PAGE < total);
+}
+
 /**
  * Sends a request to the server to print out current state of a board.
  * @param[in] server_fd File descriptor of the socket connected to the server.
  */
 void
 send_print_board_request(int server_fd) {
-	int i, j, ptr = 0;
-	int size = 0;
-	char temp[3], board[NROWS][NCOLS];
-	char *result = NULL;
 	request_s request;
 	response_s response;
 	request.type = MSG_PRINT_BOARD_REQ;
@@ -363,22 +705,15 @@ send_print_board_request(int server_fd) {
 		print_transmission_error_message();
 		return;
 	}
+	if (response.error == MSG_RSP_ERROR_BOARD_TOO_LARGE) {
+		send_print_cells_request(server_fd);
+		return;
+	}
 	if (response.error != MSG_RSP_ERROR_NONE) {
 		print_error_message(response.error);
 		return;
 	}
-
-	result = strtok(response.payload, PAYLOAD_DELIM);
-	strncpy(temp, result, 3);
-	size = atoi(temp);
-	result = strtok(NULL, PAYLOAD_DELIM);
-	for (i = 0; i < NROWS; i++)
-		for (j = 0; j < NCOLS; j++) {
-			board[i][j] = result[ptr];
-			ptr++;
-		}
-	printf("\nCurrent board state:\n");
-	print_board(size, board);
+	print_board_payload(response.payload);
 }
 
 /**
@@ -421,23 +756,37 @@ send_check_turn_request(int server_fd) {
 
 /**
  * Sends a request to the server to perform a move on the board. If
- * the game is won/lost or drawn it backs to main menu.
+ * the game is won/lost or drawn it backs to main menu. In a gravity game
+ * only a column is sent, and drops into columns known to be full are
+ * rejected without asking the server.
  * @param[in] server_fd File descriptor of the socket connected to the server.
  * @param[in] mode      Menu level that will be displayed.
  * \sa player_mode_e
  */
 void
 send_make_move_request(int server_fd, player_mode_e *mode) {
-	char x[3], y[3];
+	int column = -1;
+	char x[16], y[16];
 	request_s request;
 	response_s response;
 	request.type = MSG_MAKE_MOVE_REQ;
-	printf("\nEnter x coordinate: ");
-	read_line(x, 3);
-	printf("Enter y coordinate: ");
-	read_line(y, 3);
-	snprintf(request.payload, 25, "%d%s%d%s", atoi(x), PAYLOAD_DELIM, atoi(y),
-			PAYLOAD_DELIM);
+	if (columns.size > 0) {
+		printf("\nEnter column: ");
+		read_line(y, sizeof(y));
+		column = atoi(y) - 1;
+		if (get_drop_row(columns.heights, columns.size, column) == -1) {
+			printf("\nColumn %d does not exist or is full.\n", column + 1);
+			return;
+		}
+		snprintf(request.payload, 25, "%d%s", column + 1, PAYLOAD_DELIM);
+	} else {
+		printf("\nEnter x coordinate: ");
+		read_line(x, sizeof(x));
+		printf("Enter y coordinate: ");
+		read_line(y, sizeof(y));
+		snprintf(request.payload, 25, "%d%s%d%s", atoi(x), PAYLOAD_DELIM,
+				atoi(y), PAYLOAD_DELIM);
+	}
 	send_receive_message(server_fd, &request, &response);
 	if (response.type != MSG_MAKE_MOVE_RSP) {
 		if (response.type == MSG_PRINT_WIN_RSP) {
@@ -451,10 +800,47 @@ send_make_move_request(int server_fd, player_mode_e *mode) {
 			return;
 		}
 	}
+	if (response.error != MSG_RSP_ERROR_NONE) {
+		if (response.error == MSG_RSP_ERROR_WRONG_MOVE && column != -1) {
+			/* the server only refuses a drop into a full column */
+			columns.heights[column] = columns.size;
+		}
+		print_error_message(response.error);
+		return;
+	}
+	if (response.type == MSG_MAKE_MOVE_RSP && column != -1) {
+		update_columns(atoi(response.payload) - 1, column);
+	}
+}
+
+/**
+ * Sends a request to the server for a hint: a suggested move for the player
+ * to move and the chance to win.
+ * @param[in] server_fd File descriptor of the socket connected to the server.
+ */
+void
+send_hint_request(int server_fd) {
+	int x, y;
+	double value;
+	request_s request;
+	response_s response;
+	request.type = MSG_HINT_REQ;
+	request.payload[0] = '\0';
+	send_receive_message(server_fd, &request, &response);
+	if (response.type != MSG_HINT_RSP) {
+		print_transmission_error_message();
+		return;
+	}
 	if (response.error != MSG_RSP_ERROR_NONE) {
 		print_error_message(response.error);
 		return;
 	}
+	if (sscanf(response.payload, "%d#%d#%lf", &x, &y, &value) != 3) {
+		print_transmission_error_message();
+		return;
+	}
+	printf("\nSuggested move: %d %d, chance to win %.0f%%\n", x, y,
+			value * 100);
 }
 
 /**
@@ -538,20 +924,25 @@ send_back_to_menu_request(int server_fd, player_mode_e *mode, int *game_id) {
  */
 void
 print_spectator_board(response_s *response) {
-	int i, j, ptr = 0;
-	int size = 0;
-	char temp[3];
-	char *result = NULL;
-	char board[NROWS][NCOLS];
-	result = strtok(response->payload, PAYLOAD_DELIM);
-	strncpy(temp, result, 3);
-	size = atoi(temp);
-	result = strtok(NULL, PAYLOAD_DELIM);
-	for (i = 0; i < NROWS; i++)
-		for (j = 0; j < NCOLS; j++) {
-			board[i][j] = result[ptr];
-			ptr++;
-		}
-	printf("\n\nCurrent board state:\n");
-	print_board(size, board);
+	print_board_payload(response->payload);
+}
+
+/**
+ * Prints out the last move performed on a large board that is sent to
+ * spectators instead of the whole board.
+ * @param[in] response Pointer to a structure containing response
+ * message (coordinates and pawn of the move).
+ * \sa response_s
+ */
+void
+print_spectator_move(response_s *response) {
+	char *x, *y, *pawn, *saveptr;
+	x = strtok_r(response->payload, PAYLOAD_DELIM, &saveptr);
+	y = strtok_r(NULL, PAYLOAD_DELIM, &saveptr);
+	pawn = strtok_r(NULL, PAYLOAD_DELIM, &saveptr);
+	if (x == NULL || y == NULL || pawn == NULL) {
+		print_transmission_error_message();
+		return;
+	}
+	printf("\n\nPawn %s placed at (%s, %s)\n", pawn, x, y);
 }
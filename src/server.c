@@ -26,12 +26,22 @@
 #include <pthread.h>
 #include <fcntl.h>
 
-#include "config.h"
 #include "common.h"
+#include "config.h"
+#include "compute_pool.h"
+#include "hint_service.h"
+#include "journal.h"
 #include "lists.h"
+#include "lobby.h"
+#include "logger.h"
+#include "matchmaker.h"
 #include "messenger.h"
+#include "metrics.h"
+#include "recovery.h"
 #include "request_handler.h"
+#include "solved_table.h"
 #include "structs.h"
+#include "timer_wheel.h"
 
 /**
  * A variable responsible for setting the value determining the main program loop termination.
@@ -44,8 +54,17 @@ volatile sig_atomic_t work = 1;
  */
 void
 usage(char *name) {
-	fprintf(stderr, "Usage: %s port\n", name);
-	fprintf(stderr, "port - port to listen\n");
+	fprintf(stderr, "Usage: %s [-j journal] [-d durability] [-f fsync_ms] [-m metrics_port] port\n",
+			name);
+	fprintf(stderr, "journal    - name of the game journal, default %s\n",
+			JOURNAL_NAME);
+	fprintf(stderr, "durability - 0 off, 1 write, 2 sync every fsync_ms, 3 sync every move, default %d\n",
+			JOURNAL_DURABILITY);
+	fprintf(stderr, "fsync_ms   - interval between journal syncs, default %d\n",
+			JOURNAL_FSYNC_MS);
+	fprintf(stderr, "metrics_port - local port serving metrics, 0 off, default %d\n",
+			METRICS_PORT);
+	fprintf(stderr, "port       - port to listen\n");
 }
 
 /**
@@ -114,6 +133,182 @@ add_new_client(int sfd) {
 	return nfd;
 }
 
+/**
+ * Arms the expiry of every game waiting for players, counted from the moment
+ * the game started waiting. Games are few, so all of them are armed again
+ * whenever a game is created.
+ * @param[in] games_list       Pointer to a list holding games.
+ * @param[in] games_list_mutex Pointer to a mutex guarding games list.
+ * @param[in] timers           Pointer to the timers of the main thread.
+ * \sa lobby_timers_s
+ */
+void
+arm_waiting_game_timers(games_list_s *games_list,
+		pthread_mutex_t *games_list_mutex, lobby_timers_s *timers) {
+	game_s *game;
+	pthread_mutex_lock(games_list_mutex);
+	for (game = games_list->head; game != NULL; game = game->next) {
+		if (game->state == GAME_STATE_WAITING) {
+			arm_timer(&timers->wheel, &timers->waiting[game->id],
+					game->waiting_since + WAITING_GAME_MS);
+		}
+	}
+	pthread_mutex_unlock(games_list_mutex);
+}
+
+/**
+ * Removes a game nobody joined in time and sends its players back to the
+ * lobby. A game that has started or was replaced by a newer one with the
+ * same ID is left alone. A waiting game only points to connected players, as
+ * a disconnecting player takes its waiting games down or leaves their seats.
+ * @param[in] game_id          ID of the game.
+ * @param[in] base_rdfs        Bit array holding file descriptors to be served by the server.
+ * @param[in] games_list       Pointer to a list holding games.
+ * @param[in] games_list_mutex Pointer to a mutex guarding games list.
+ * @param[in] lobby            Pointer to the lobby.
+ * @param[in] timers           Pointer to the timers of the main thread.
+ */
+void
+expire_waiting_game(int game_id, fd_set *base_rdfs, games_list_s *games_list,
+		pthread_mutex_t *games_list_mutex, lobby_s *lobby,
+		lobby_timers_s *timers) {
+	int seat, fds[2] = { -1, -1 };
+	response_s response;
+	game_s *game = NULL;
+	pthread_mutex_lock(games_list_mutex);
+	get_game_by_id(games_list, &game, game_id);
+	if (game == NULL || game->state != GAME_STATE_WAITING) {
+		pthread_mutex_unlock(games_list_mutex);
+		return;
+	}
+	if (game->waiting_since + WAITING_GAME_MS > get_monotonic_ms()) {
+		arm_timer(&timers->wheel, &timers->waiting[game_id],
+				game->waiting_since + WAITING_GAME_MS);
+		pthread_mutex_unlock(games_list_mutex);
+		return;
+	}
+	/* leave_waiting_games detaches players before they are freed */
+	for (seat = 0; seat < 2; seat++) {
+		if (game->players[seat] != NULL) {
+			fds[seat] = game->players[seat]->player_fd;
+		}
+	}
+	journal_game_ended(game, 0);
+	remove_game_from_list(games_list, game);
+	pthread_mutex_unlock(games_list_mutex);
+	LOG_INFO("Game %d expired waiting for players", game_id);
+	response.type = MSG_CLEANUP_RSP;
+	response.error = MSG_RSP_ERROR_TIMED_OUT;
+	memset(response.payload, 0, MAX_RSP_SIZE);
+	for (seat = 0; seat < 2; seat++) {
+		if (fds[seat] != -1 && FD_ISSET(fds[seat], base_rdfs)) {
+			send_response_message(fds[seat], &response);
+		}
+	}
+	publish_lobby(lobby);
+}
+
+/**
+ * Removes a client served by the main thread: takes it out of the quick match
+ * queue and the games it waits in, removes the player, cancels the timers
+ * of the client and closes the descriptor.
+ * @param[in] client_fd          File descriptor of a client that is removed.
+ * @param     base_rdfs          Bit array holding file descriptors to be served by the server.
+ * @param     players_list       Pointer to a list holding players.
+ * @param     games_list         Pointer to a list holding games.
+ * @param     players_list_mutex Pointer to a mutex guarding players list.
+ * @param     games_list_mutex   Pointer to a mutex guarding games list.
+ * @param     lobby              Pointer to the lobby.
+ * @param     matchmaker         Pointer to the quick match queues.
+ * @param     timers             Pointer to the timers of the main thread.
+ */
+void
+remove_client(int client_fd, fd_set *base_rdfs, players_list_s *players_list,
+		games_list_s *games_list, pthread_mutex_t *players_list_mutex,
+		pthread_mutex_t *games_list_mutex, lobby_s *lobby,
+		matchmaker_s *matchmaker, lobby_timers_s *timers) {
+	player_s *player = NULL;
+	get_player_by_file_desc(players_list, &player, client_fd);
+	if (player != NULL) {
+		remove_queued_player(matchmaker, player);
+		leave_waiting_games(games_list, games_list_mutex, player);
+	}
+	pthread_mutex_lock(players_list_mutex);
+	remove_player_from_list2(players_list, client_fd);
+	pthread_mutex_unlock(players_list_mutex);
+	publish_lobby(lobby);
+	count_metric(METRIC_CONNECTIONS_CLOSED, 1);
+	cancel_timer(&timers->wheel, &timers->idle[client_fd]);
+	cancel_timer(&timers->wheel, &timers->keepalive[client_fd]);
+	if (TEMP_FAILURE_RETRY(close(client_fd)) < 0)
+		ERR("close");
+	FD_CLR(client_fd, base_rdfs);
+}
+
+/**
+ * Serves the expired timers of the main thread. A client that stays silent
+ * is pinged, and removed when it does not answer the ping or sends no
+ * request for LOBBY_IDLE_MS. Clients whose descriptors are served by a game
+ * thread are only timed again.
+ * @param[in] base_rdfs          Bit array holding file descriptors to be served by the server.
+ * @param     players_list       Pointer to a list holding players.
+ * @param     games_list         Pointer to a list holding games.
+ * @param     players_list_mutex Pointer to a mutex guarding players list.
+ * @param     games_list_mutex   Pointer to a mutex guarding games list.
+ * @param     lobby              Pointer to the lobby.
+ * @param     matchmaker         Pointer to the quick match queues.
+ * @param     timers             Pointer to the timers of the main thread.
+ * \sa timer_e
+ */
+void
+handle_expired_timers(fd_set *base_rdfs, players_list_s *players_list,
+		games_list_s *games_list, pthread_mutex_t *players_list_mutex,
+		pthread_mutex_t *games_list_mutex, lobby_s *lobby,
+		matchmaker_s *matchmaker, lobby_timers_s *timers) {
+	long long now = get_monotonic_ms();
+	timer_s *timer, *next;
+	response_s response;
+	for (timer = expire_timers(&timers->wheel, now); timer != NULL;
+			timer = next) {
+		next = timer->next;
+		if (timer->kind == TIMER_WAITING_GAME) {
+			expire_waiting_game(timer->key, base_rdfs, games_list,
+					games_list_mutex, lobby, timers);
+			continue;
+		}
+		if (!FD_ISSET(timer->key, base_rdfs)) {
+			/* the client is in a game */
+			if (timer->kind == TIMER_KEEPALIVE_REPLY) {
+				timer->kind = TIMER_KEEPALIVE;
+			}
+			arm_timer(&timers->wheel, timer, now
+					+ (timer->kind == TIMER_LOBBY_IDLE ?
+							LOBBY_IDLE_MS : KEEPALIVE_MS));
+			continue;
+		}
+		switch (timer->kind) {
+		case TIMER_KEEPALIVE:
+			response.type = MSG_KEEPALIVE_RSP;
+			response.error = MSG_RSP_ERROR_NONE;
+			memset(response.payload, 0, MAX_RSP_SIZE);
+			send_response_message(timer->key, &response);
+			timer->kind = TIMER_KEEPALIVE_REPLY;
+			arm_timer(&timers->wheel, timer, now + KEEPALIVE_REPLY_MS);
+			break;
+		case TIMER_KEEPALIVE_REPLY:
+		case TIMER_LOBBY_IDLE:
+			LOG_INFO("Client fd %d timed out. Closing descriptor",
+					timer->key);
+			remove_client(timer->key, base_rdfs, players_list, games_list,
+					players_list_mutex, games_list_mutex, lobby, matchmaker,
+					timers);
+			break;
+		default:
+			break;
+		}
+	}
+}
+
 /**
  * Serves client request by checking a request type and calling appropriate function.
  * @param[in] client_fd          File descriptor of a client that is currently served.
@@ -125,42 +320,70 @@ add_new_client(int sfd) {
  * @param     players_list_mutex Pointer to a mutex guarding players list.
  * @param     games_list_mutex   Pointer to a mutex guarding games list.
  * @param     threads_list_mutex Pointer to a mutex guarding threads list.
- * \sa request_s players_list_s games_list_s threads_list_s message_type_e
+ * @param     lobby              Pointer to the lobby.
+ * @param     matchmaker         Pointer to the quick match queues.
+ * @param     pool               Pointer to the pool running bot searches.
+ * @param     hints              Pointer to the hint channel of the main thread.
+ * @param     timers             Pointer to the timers of the main thread.
+ * \sa request_s players_list_s games_list_s threads_list_s message_type_e lobby_s
  */
 void
 request_handler(int client_fd, request_s *request, fd_set *base_rdfs,
-		players_list_s **players_list, games_list_s **games_list,
-		threads_list_s **threads_list, pthread_mutex_t *players_list_mutex,
-		pthread_mutex_t *games_list_mutex, pthread_mutex_t *threads_list_mutex) {
+		players_list_s *players_list, games_list_s *games_list,
+		threads_list_s *threads_list, pthread_mutex_t *players_list_mutex,
+		pthread_mutex_t *games_list_mutex, pthread_mutex_t *threads_list_mutex,
+		lobby_s *lobby, matchmaker_s *matchmaker, compute_pool_s *pool,
+		hint_channel_s *hints, lobby_timers_s *timers) {
 	switch (request->type) {
 	case MSG_LOGIN_REQ:
-		handle_game_login_request(client_fd, request, *players_list);
+		handle_game_login_request(client_fd, request, players_list, lobby);
 		break;
 	case MSG_PLAYERS_LIST_REQ:
-		handle_players_list_request(client_fd, players_list);
+		handle_players_list_request(client_fd, lobby);
 		break;
 	case MSG_GAMES_LIST_REQ:
-		handle_game_list_request(client_fd, games_list);
+		handle_game_list_request(client_fd, lobby);
 		break;
 	case MSG_CREATE_GAME_REQ:
-		handle_create_new_game_request(client_fd, request, *players_list,
-				*games_list, games_list_mutex);
+		handle_create_new_game_request(client_fd, request, players_list,
+				games_list, games_list_mutex, lobby, matchmaker);
+		arm_waiting_game_timers(games_list, games_list_mutex, timers);
 		break;
 	case MSG_CONNECT_GAME_REQ:
 		handle_connect_to_existing_game_request(client_fd, request, base_rdfs,
 				players_list, games_list, threads_list, players_list_mutex,
-				games_list_mutex, threads_list_mutex);
+				games_list_mutex, threads_list_mutex, lobby, matchmaker);
+		break;
+	case MSG_QUICK_MATCH_REQ:
+		handle_quick_match_request(client_fd, request, base_rdfs,
+				players_list, games_list, threads_list, players_list_mutex,
+				games_list_mutex, threads_list_mutex, lobby, matchmaker);
+		break;
+	case MSG_CREATE_BOT_GAME_REQ:
+		handle_create_bot_game_request(client_fd, request, base_rdfs,
+				players_list, games_list, threads_list, players_list_mutex,
+				games_list_mutex, threads_list_mutex, lobby, matchmaker, pool);
+		break;
+	case MSG_ANALYZE_REQ:
+		handle_analyze_request(client_fd, request, hints);
+		break;
+	case MSG_RESUME_REQ:
+		handle_resume_request(client_fd, request, base_rdfs, players_list,
+				games_list, games_list_mutex, threads_list);
 		break;
 	case MSG_CONNECT_SPECTATOR_REQ:
 		handle_connect_as_spectator_request(client_fd, request, base_rdfs,
-				*games_list, *threads_list);
+				games_list, threads_list, lobby);
 		break;
 	case MSG_BACK_TO_MENU_REQ:
-		handle_back_to_menu_request(client_fd, request, *games_list);
+		handle_back_to_menu_request(client_fd, request, games_list, lobby);
 		break;
 	case MSG_PRINT_BOARD_REQ:
 		handle_game_message(client_fd, request);
 		break;
+	case MSG_PRINT_CELLS_REQ:
+		handle_game_message(client_fd, request);
+		break;
 	case MSG_CHECK_TURN_REQ:
 		handle_game_message(client_fd, request);
 		break;
@@ -170,9 +393,12 @@ request_handler(int client_fd, request_s *request, fd_set *base_rdfs,
 	case MSG_LEAVE_MESSAGE_REQ:
 		handle_game_message(client_fd, request);
 		break;
+	case MSG_HINT_REQ:
+		handle_game_message(client_fd, request);
+		break;
 	case MSG_LEAVE_REQ:
 		handle_leave_game_request(client_fd, request, games_list,
-				games_list_mutex);
+				games_list_mutex, lobby, players_list, matchmaker);
 		break;
 	default:
 		break;
@@ -190,45 +416,58 @@ request_handler(int client_fd, request_s *request, fd_set *base_rdfs,
  * @param     players_list_mutex Pointer to a mutex guarding players list.
  * @param     games_list_mutex   Pointer to a mutex guarding games list.
  * @param     threads_list_mutex Pointer to a mutex guarding threads list.
+ * @param     lobby              Pointer to the lobby.
+ * @param     matchmaker         Pointer to the quick match queues.
+ * @param     pool               Pointer to the pool running bot searches.
+ * @param     hints              Pointer to the hint channel of the main thread.
+ * @param     timers             Pointer to the timers of the main thread.
  */
 void
 communicate(int client_fd, fd_set *base_rdfs,
-		players_list_s **players_list, games_list_s **games_list,
-		threads_list_s **threads_list, pthread_mutex_t *players_list_mutex,
-		pthread_mutex_t *games_list_mutex, pthread_mutex_t *threads_list_mutex) {
+		players_list_s *players_list, games_list_s *games_list,
+		threads_list_s *threads_list, pthread_mutex_t *players_list_mutex,
+		pthread_mutex_t *games_list_mutex, pthread_mutex_t *threads_list_mutex,
+		lobby_s *lobby, matchmaker_s *matchmaker, compute_pool_s *pool,
+		hint_channel_s *hints, lobby_timers_s *timers) {
 	char buffer[MAX_MSG_SIZE];
 	ssize_t size;
+	long long now, started;
 	request_s request;
 	memset(&request, 0, sizeof(request_s));
 	size = bulk_read(client_fd, buffer, MAX_MSG_SIZE);
 	if (size == MAX_MSG_SIZE) {
-		fprintf(stderr, "Message received from fd: %d\n", client_fd);
+		LOG_DEBUG("Message received from fd: %d", client_fd);
+		count_metric(METRIC_BYTES_IN, size);
 		string_to_request(buffer, &request);
+		/* an answer to a ping keeps the client alive, not active */
+		now = get_monotonic_ms();
+		timers->keepalive[client_fd].kind = TIMER_KEEPALIVE;
+		arm_timer(&timers->wheel, &timers->keepalive[client_fd],
+				now + KEEPALIVE_MS);
+		if (request.type != MSG_KEEPALIVE_REQ) {
+			arm_timer(&timers->wheel, &timers->idle[client_fd],
+					now + LOBBY_IDLE_MS);
+		}
+		started = get_monotonic_ns();
 		request_handler(client_fd, &request, base_rdfs, players_list,
 				games_list, threads_list, players_list_mutex, games_list_mutex,
-				threads_list_mutex);
+				threads_list_mutex, lobby, matchmaker, pool, hints, timers);
+		record_request_metrics(request.type, get_monotonic_ns() - started);
 	}
 	if (size == 0) {
-		fprintf(stderr,
-				"End of file. Removing player. Closing descriptor: %d\n",
+		LOG_INFO(
+				"End of file. Removing player. Closing descriptor: %d",
 				client_fd);
-		pthread_mutex_lock(players_list_mutex);
-		remove_player_from_list2(players_list, client_fd);
-		pthread_mutex_unlock(players_list_mutex);
-		if (TEMP_FAILURE_RETRY(close(client_fd)) < 0)
-			ERR("close");
-		FD_CLR(client_fd, base_rdfs);
-
+		remove_client(client_fd, base_rdfs, players_list, games_list,
+				players_list_mutex, games_list_mutex, lobby, matchmaker,
+				timers);
 	}
 	if (size < 0) {
-		fprintf(stderr, "Error. Removing player. Closing descriptor: %d\n",
+		LOG_WARNING("Error. Removing player. Closing descriptor: %d",
 				client_fd);
-		pthread_mutex_lock(players_list_mutex);
-		remove_player_from_list2(players_list, client_fd);
-		pthread_mutex_unlock(players_list_mutex);
-		if (TEMP_FAILURE_RETRY(close(client_fd)) < 0)
-			ERR("close");
-		FD_CLR(client_fd, base_rdfs);
+		remove_client(client_fd, base_rdfs, players_list, games_list,
+				players_list_mutex, games_list_mutex, lobby, matchmaker,
+				timers);
 	}
 }
 
@@ -245,7 +484,7 @@ display_log(int client_fd) {
 	if (getpeername(client_fd, (struct sockaddr*) &addr, &addrlen) == 0) {
 		snprintf(buf, sizeof(buf), "%s:%u", inet_ntoa(addr.sin_addr),
 				(unsigned) ntohs(addr.sin_port));
-		fprintf(stderr, "New client connected %s, fd %d\n", buf, client_fd);
+		LOG_INFO_TEXT("New client connected %s, fd %d", buf, client_fd);
 	}
 }
 
@@ -259,17 +498,17 @@ void
 initialize_structures(players_list_s **players_list,
 		games_list_s **games_list, threads_list_s **threads_list) {
 	(*players_list) = create_players_list();
-	if (players_list == NULL) {
+	if ((*players_list) == NULL) {
 		fprintf(stderr, "Error! Players list is not initialized\n");
 		exit(EXIT_FAILURE);
 	}
 	(*games_list) = create_games_list();
-	if (games_list == NULL) {
+	if ((*games_list) == NULL) {
 		fprintf(stderr, "Error! Games list is not initialized\n");
 		exit(EXIT_FAILURE);
 	}
 	(*threads_list) = create_threads_list();
-	if (threads_list == NULL) {
+	if ((*threads_list) == NULL) {
 		fprintf(stderr, "Error! Threads list is not initialized\n");
 		exit(EXIT_FAILURE);
 	}
@@ -282,10 +521,19 @@ initialize_structures(players_list_s **players_list,
  */
 void
 doServer(int listener_socket, int fifo) {
-	int i, fdmax, newfd;
+	int i, fdmax, newfd, ready;
+	long long now, left;
 	players_list_s *players_list = NULL;
 	games_list_s *games_list = NULL;
 	threads_list_s *threads_list = NULL;
+	lobby_s *lobby = NULL;
+	matchmaker_s *matchmaker = NULL;
+	compute_pool_s *pool = NULL;
+	hint_channel_s *hints = NULL;
+	hint_notice_s notice;
+	response_s response;
+	lobby_timers_s *timers = NULL;
+	struct timespec timeout;
 	pthread_mutex_t players_list_mutex = PTHREAD_MUTEX_INITIALIZER;
 	pthread_mutex_t games_list_mutex = PTHREAD_MUTEX_INITIALIZER;
 	pthread_mutex_t threads_list_mutex = PTHREAD_MUTEX_INITIALIZER;
@@ -298,14 +546,73 @@ doServer(int listener_socket, int fifo) {
 	sigaddset(&mask, SIGINT);
 	sigprocmask(SIG_BLOCK, &mask, &oldmask);
 	initialize_structures(&players_list, &games_list, &threads_list);
+	if ((lobby = create_lobby(games_list, &games_list_mutex,
+			players_list, &players_list_mutex)) == NULL) {
+		fprintf(stderr, "Error! Lobby is not initialized\n");
+		exit(EXIT_FAILURE);
+	}
+	if ((matchmaker = create_matchmaker()) == NULL) {
+		fprintf(stderr, "Error! Matchmaker is not initialized\n");
+		exit(EXIT_FAILURE);
+	}
+	if ((pool = create_compute_pool(BOT_THREADS, BOT_QUEUE_CAPACITY)) == NULL) {
+		fprintf(stderr, "Error! Compute pool is not initialized\n");
+		exit(EXIT_FAILURE);
+	}
+	if (start_hint_service() == -1
+			|| (hints = create_hint_channel()) == NULL) {
+		fprintf(stderr, "Error! Hint service is not initialized\n");
+		exit(EXIT_FAILURE);
+	}
+	FD_SET(hints->fds[0], &base_rdfs);
+	fdmax = max(fdmax, hints->fds[0]);
+	if ((timers = malloc(sizeof(lobby_timers_s))) == NULL) {
+		fprintf(stderr, "Error! Timers are not initialized\n");
+		exit(EXIT_FAILURE);
+	}
+	init_timer_wheel(&timers->wheel, get_monotonic_ms());
+	for (i = 0; i < FD_SETSIZE; i++) {
+		init_timer(&timers->idle[i], TIMER_LOBBY_IDLE, i);
+		init_timer(&timers->keepalive[i], TIMER_KEEPALIVE, i);
+	}
+	for (i = 0; i <= MAX_GAME_ID; i++) {
+		init_timer(&timers->waiting[i], TIMER_WAITING_GAME, i);
+	}
+	load_solved_tables();
+	if (get_journal_name() != NULL
+			&& recover_games(get_journal_name(), games_list, pool) == -1) {
+		fprintf(stderr, "Error! Games are not recovered from the journal\n");
+		exit(EXIT_FAILURE);
+	}
+	arm_waiting_game_timers(games_list, &games_list_mutex, timers);
+	publish_lobby(lobby);
 	printf("Four-in-a-line server started\n");
 	while (work) {
+		count_metric(METRIC_MAIN_LOOP_ITERATIONS, 1);
+		handle_expired_timers(&base_rdfs, players_list, games_list,
+				&players_list_mutex, &games_list_mutex, lobby, matchmaker,
+				timers);
 		rdfs = base_rdfs;
-		if (pselect(fdmax + 1, &rdfs, NULL, NULL, NULL, &oldmask) > 0) {
+		now = get_monotonic_ms();
+		if ((left = get_timer_wheel_timeout(&timers->wheel, now)) != -1) {
+			timeout.tv_sec = left / 1000;
+			timeout.tv_nsec = (left % 1000) * 1000000;
+		}
+		if ((ready = pselect(fdmax + 1, &rdfs, NULL, NULL,
+				left != -1 ? &timeout : NULL, &oldmask)) > 0) {
 			for (i = 0; i <= fdmax; i++) {
 				newfd = -1;
 				if (FD_ISSET(i, &rdfs)) {
-					if (i == listener_socket) {
+					if (i == hints->fds[0]) {
+						/* answers to analyses of clients still in the lobby */
+						while (read_hint_notice(hints, &notice) == 0) {
+							if (FD_ISSET(notice.client_fd, &base_rdfs)) {
+								get_hint_response(&notice, &response);
+								send_response_message(notice.client_fd,
+										&response);
+							}
+						}
+					} else if (i == listener_socket) {
 						/* request from newly connected client */
 						newfd = add_new_client(listener_socket);
 						if (newfd > 0) {
@@ -314,10 +621,17 @@ doServer(int listener_socket, int fifo) {
 								fdmax = newfd;
 							}
 							display_log(newfd);
-							communicate(newfd, &base_rdfs, &players_list,
-									&games_list, &threads_list,
+							count_metric(METRIC_CONNECTIONS_OPENED, 1);
+							timers->keepalive[newfd].kind = TIMER_KEEPALIVE;
+							arm_timer(&timers->wheel, &timers->keepalive[newfd],
+									get_monotonic_ms() + KEEPALIVE_MS);
+							arm_timer(&timers->wheel, &timers->idle[newfd],
+									get_monotonic_ms() + LOBBY_IDLE_MS);
+							communicate(newfd, &base_rdfs, players_list,
+									games_list, threads_list,
 									&players_list_mutex, &games_list_mutex,
-									&threads_list_mutex);
+									&threads_list_mutex, lobby,
+									matchmaker, pool, hints, timers);
 						} else if (i == fifo) {
 							/* trick to update base_rdfs set */
 							char temp[1];
@@ -325,24 +639,32 @@ doServer(int listener_socket, int fifo) {
 						}
 					} else {
 						/* request from already connected client */
-						communicate(i, &base_rdfs, &players_list, &games_list,
-								&threads_list, &players_list_mutex,
-								&games_list_mutex, &threads_list_mutex);
+						communicate(i, &base_rdfs, players_list, games_list,
+								threads_list, &players_list_mutex,
+								&games_list_mutex, &threads_list_mutex, lobby,
+								matchmaker, pool, hints, timers);
 					}
 				}
 			}
-		} else {
+		} else if (ready < 0) {
 			if (EINTR == errno)
 				continue;
 			ERR("pselect");
 		}
 	}
+	destroy_matchmaker(matchmaker);
+	destroy_lobby(lobby);
 	pthread_mutex_destroy(&players_list_mutex);
 	pthread_mutex_destroy(&games_list_mutex);
 	pthread_mutex_destroy(&threads_list_mutex);
 	destroy_players(players_list);
 	destroy_games(games_list);
+	destroy_compute_pool(pool);
 	destroy_threads(threads_list);
+	stop_hint_service();
+	close_hint_channel(hints);
+	unload_solved_tables();
+	free(timers);
 	sigprocmask(SIG_UNBLOCK, &mask, NULL);
 }
 
@@ -355,12 +677,36 @@ doServer(int listener_socket, int fifo) {
  */
 int
 main(int argc, char **argv) {
-	int port, fifo, listener_socket;
-	if (argc != 2) {
+	int c, port, fifo, listener_socket;
+	int durability = JOURNAL_DURABILITY, interval_ms = JOURNAL_FSYNC_MS;
+	int metrics_port = METRICS_PORT;
+	char *journal = JOURNAL_NAME;
+	while ((c = getopt(argc, argv, "j:d:f:m:")) != -1) {
+		switch (c) {
+		case 'j':
+			journal = optarg;
+			break;
+		case 'd':
+			durability = atoi(optarg);
+			break;
+		case 'f':
+			interval_ms = atoi(optarg);
+			break;
+		case 'm':
+			metrics_port = atoi(optarg);
+			break;
+		default:
+			usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+	if (optind != argc - 1 || durability < JOURNAL_DURABILITY_OFF
+			|| durability >= JOURNAL_DURABILITIES_NO || interval_ms < 0
+			|| metrics_port < 0 || metrics_port > 65535) {
 		usage(argv[0]);
 		return EXIT_FAILURE;
 	}
-	port = atoi(argv[1]);
+	port = atoi(argv[optind]);
 	if (port <= 0 || port > 65535) {
 		usage(argv[0]);
 		return EXIT_FAILURE;
@@ -382,8 +728,24 @@ main(int argc, char **argv) {
 		ERR("Setting SIGRTMIN+11:");
 	}
 
+	if (open_journal(journal, durability, interval_ms) == -1) {
+		fprintf(stderr, "Error! Journal is not opened\n");
+		exit(EXIT_FAILURE);
+	}
+	if (start_metrics_server(metrics_port) == -1) {
+		fprintf(stderr, "Error! Metrics port %d is not bound\n", metrics_port);
+		exit(EXIT_FAILURE);
+	}
+	set_response_hook(record_response_metrics);
+	if (start_logger() == -1) {
+		fprintf(stderr, "Error! Logger is not started\n");
+		exit(EXIT_FAILURE);
+	}
 	listener_socket = bind_inet_socket(port, SOCK_STREAM);
 	doServer(listener_socket, fifo);
+	stop_metrics_server();
+	stop_logger();
+	close_journal();
 
 	if (TEMP_FAILURE_RETRY(close(listener_socket)) < 0) {
 		ERR("Close:");
@@ -0,0 +1,261 @@
+/**
+ * @file solved_table.c
+ * @ingroup solved_table
+ *
+ * @author Piotr Janaszek <janas03@yahoo.pl>
+ * @date Created on: Oct 18, 2026
+ *
+ * @brief File containing methods for looking positions up in tables of small boards solved in advance.
+ *
+ * The solver writes a table for one board size, win length and game mode.
+ * A position is stored once for all its symmetric copies, under the least
+ * Zobrist hash of the copies: eight for a free game, the board and its mirror
+ * image for a gravity game, whose columns cannot be turned. The file is a
+ * header, the sorted keys and the packed results, so loading a table is one
+ * mmap call and a lookup is a binary search in the mapped keys. Tables are
+ * loaded once, before any game thread starts, and only read afterwards.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "config.h"
+#include "structs.h"
+#include "zobrist.h"
+
+/**
+ * Loaded tables indexed by board size, win length and game mode.
+ */
+static solved_table_s *solved_tables[MAX_SOLVED_SIZE - MIN_BOARD_SIZE + 1][MAX_WIN_LENGTH
+		- MIN_WIN_LENGTH + 1][GAME_MODES_NO];
+
+/**
+ * Gets the number of symmetries of boards of a game mode. The symmetries of
+ * a gravity game are the transforms 0 and 2.
+ * @param[in] mode The game mode.
+ * @return 8 for a free game and 2 for a gravity game.
+ */
+int
+get_symmetries(game_mode_e mode) {
+	return mode == GAME_MODE_GRAVITY ? 2 : 8;
+}
+
+/**
+ * Moves a field by a symmetry of the board. Bit 2 of the transform swaps the
+ * coordinates, then bit 0 mirrors x and bit 1 mirrors y.
+ * @param[in] size      Size of the board.
+ * @param[in] transform The symmetry, from 0 to 7.
+ * @param[in] cell      The field, x * size + y.
+ * @param[in] inverse   Non-zero to undo the symmetry instead.
+ * @return The moved field.
+ */
+int
+transform_cell(int size, int transform, int cell, int inverse) {
+	int t, x = cell / size, y = cell % size;
+	if ((transform & 4) && !inverse) {
+		t = x;
+		x = y;
+		y = t;
+	}
+	if (transform & 1) {
+		x = size - 1 - x;
+	}
+	if (transform & 2) {
+		y = size - 1 - y;
+	}
+	if ((transform & 4) && inverse) {
+		t = x;
+		x = y;
+		y = t;
+	}
+	return x * size + y;
+}
+
+/**
+ * Computes the key shared by a position and all its symmetric copies.
+ * @param[in]  cells     Fields of the board: 0 empty, 1 'x', 2 'o'.
+ * @param[in]  size      Size of the board.
+ * @param[in]  mode      The game mode.
+ * @param[out] transform The symmetry turning the position into its canonical copy or NULL.
+ * @return The least Zobrist hash of the copies.
+ */
+uint64_t
+get_canonical_key(const unsigned char *cells, int size, game_mode_e mode,
+		int *transform) {
+	int i, t, cell, symmetries = get_symmetries(mode);
+	uint64_t hash, best = 0;
+	init_zobrist_keys();
+	for (t = 0; t < symmetries; t++) {
+		hash = 0;
+		for (i = 0; i < size * size; i++) {
+			if (cells[i] != 0) {
+				cell = transform_cell(size, mode == GAME_MODE_GRAVITY ? 2 * t : t,
+						i, 0);
+				hash ^= get_zobrist_key(size, cell / size, cell % size,
+						cells[i] == 1 ? 'x' : 'o');
+			}
+		}
+		if (t == 0 || hash < best) {
+			best = hash;
+			if (transform != NULL) {
+				*transform = mode == GAME_MODE_GRAVITY ? 2 * t : t;
+			}
+		}
+	}
+	return best;
+}
+
+/**
+ * Maps a solved table file into memory and checks its header.
+ * @param[in] name Name of the file.
+ * @return Pointer to the table or NULL when there is no valid file.
+ * \sa solved_table_s
+ */
+solved_table_s*
+map_solved_table(const char *name) {
+	int fd;
+	struct stat st;
+	solved_table_s *table;
+	if ((fd = open(name, O_RDONLY)) == -1) {
+		return NULL;
+	}
+	if (fstat(fd, &st) == -1 || st.st_size < (off_t) sizeof(solved_header_s)
+			|| (table = malloc(sizeof(solved_table_s))) == NULL) {
+		close(fd);
+		return NULL;
+	}
+	table->length = st.st_size;
+	table->map = mmap(NULL, table->length, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (table->map == MAP_FAILED) {
+		free(table);
+		return NULL;
+	}
+	table->header = table->map;
+	table->keys = (const uint64_t*) (table->header + 1);
+	table->results = (const uint16_t*) (table->keys
+			+ table->header->no_entries);
+	if (memcmp(table->header->magic, SOLVED_TABLE_MAGIC, 8) != 0
+			|| table->header->no_entries > table->length
+			|| sizeof(solved_header_s) + table->header->no_entries
+					* (sizeof(uint64_t) + sizeof(uint16_t)) > table->length) {
+		fprintf(stderr, "Solved table %s is not valid\n", name);
+		munmap(table->map, table->length);
+		free(table);
+		return NULL;
+	}
+	return table;
+}
+
+/**
+ * Maps every solved table found in the working directory. It has to be
+ * called before game threads start.
+ * @return Number of loaded tables.
+ */
+int
+load_solved_tables(void) {
+	int size, win_length, mode, loaded = 0;
+	char name[64];
+	solved_table_s *table;
+	for (size = MIN_BOARD_SIZE; size <= MAX_SOLVED_SIZE; size++) {
+		for (win_length = MIN_WIN_LENGTH;
+				win_length <= MAX_WIN_LENGTH && win_length <= size;
+				win_length++) {
+			for (mode = GAME_MODE_FREE; mode < GAME_MODES_NO; mode++) {
+				snprintf(name, sizeof(name), SOLVED_TABLE_NAME, size,
+						win_length, mode);
+				if ((table = map_solved_table(name)) == NULL) {
+					continue;
+				}
+				if (table->header->size != size
+						|| table->header->win_length != win_length
+						|| table->header->mode != mode) {
+					fprintf(stderr, "Solved table %s is for other rules\n",
+							name);
+					munmap(table->map, table->length);
+					free(table);
+					continue;
+				}
+				solved_tables[size - MIN_BOARD_SIZE][win_length
+						- MIN_WIN_LENGTH][mode] = table;
+				fprintf(stderr, "Solved table %s: %lu positions\n", name,
+						(unsigned long) table->header->no_entries);
+				loaded++;
+			}
+		}
+	}
+	return loaded;
+}
+
+/**
+ * Unmaps all loaded solved tables.
+ */
+void
+unload_solved_tables(void) {
+	int size, win_length, mode;
+	solved_table_s *table;
+	for (size = 0; size <= MAX_SOLVED_SIZE - MIN_BOARD_SIZE; size++) {
+		for (win_length = 0; win_length <= MAX_WIN_LENGTH - MIN_WIN_LENGTH;
+				win_length++) {
+			for (mode = 0; mode < GAME_MODES_NO; mode++) {
+				if ((table = solved_tables[size][win_length][mode]) != NULL) {
+					munmap(table->map, table->length);
+					free(table);
+					solved_tables[size][win_length][mode] = NULL;
+				}
+			}
+		}
+	}
+}
+
+/**
+ * Looks a position up in the solved table of its rules.
+ * @param[in]  size       Size of the board.
+ * @param[in]  win_length Number of consecutive pawns needed to win.
+ * @param[in]  mode       The game mode.
+ * @param[in]  cells      Fields of the board: 0 empty, 1 'x', 2 'o'.
+ * @param[out] outcome    1 when the player to move wins with perfect play,
+ * 0 for a draw and -1 for a loss.
+ * @param[out] move       The best move, x * size + y, or -1 when there is none.
+ * @retval  0 When the position is found.
+ * @retval -1 When there is no table or the position is not stored.
+ */
+int
+lookup_solved_position(int size, int win_length, game_mode_e mode,
+		const unsigned char *cells, int *outcome, int *move) {
+	int transform;
+	uint64_t key, low, high, middle;
+	uint16_t result;
+	solved_table_s *table;
+	if (size < MIN_BOARD_SIZE || size > MAX_SOLVED_SIZE
+			|| win_length < MIN_WIN_LENGTH || win_length > MAX_WIN_LENGTH
+			|| (table = solved_tables[size - MIN_BOARD_SIZE][win_length
+					- MIN_WIN_LENGTH][mode]) == NULL) {
+		return -1;
+	}
+	key = get_canonical_key(cells, size, mode, &transform);
+	low = 0;
+	high = table->header->no_entries;
+	while (low < high) {
+		middle = low + (high - low) / 2;
+		if (table->keys[middle] < key) {
+			low = middle + 1;
+		} else {
+			high = middle;
+		}
+	}
+	if (low == table->header->no_entries || table->keys[low] != key) {
+		return -1;
+	}
+	result = table->results[low];
+	*outcome = (result & 3) - 1;
+	*move = (result >> 2) == 0xff ? -1
+			: transform_cell(size, transform, result >> 2, 1);
+	return 0;
+}
@@ -0,0 +1,25 @@
+/**
+ * @file solved_table.h
+ * @ingroup solved_table
+ *
+ * @author Piotr Janaszek <janas03@yahoo.pl>
+ * @date Created on: Oct 18, 2026
+ *
+ * @brief File containing methods for looking positions up in tables of small boards solved in advance.
+ */
+
+#ifndef SOLVED_TABLE_H_
+#define SOLVED_TABLE_H_
+
+#include "structs.h"
+
+int get_symmetries(game_mode_e mode);
+int transform_cell(int size, int transform, int cell, int inverse);
+uint64_t get_canonical_key(const unsigned char *cells, int size,
+		game_mode_e mode, int *transform);
+int load_solved_tables(void);
+void unload_solved_tables(void);
+int lookup_solved_position(int size, int win_length, game_mode_e mode,
+		const unsigned char *cells, int *outcome, int *move);
+
+#endif /* SOLVED_TABLE_H_ */
@@ -0,0 +1,516 @@
+/**
+ * @file solver.c
+ * @ingroup solver
+ *
+ * @author Piotr Janaszek <janas03@yahoo.pl>
+ * @date Created on: Oct 18, 2026
+ *
+ * @brief File containing the solver writing tables of small boards solved with perfect play.
+ *
+ * The solver first lists every position reachable within a given number of
+ * moves from the empty board, one copy of every class of symmetric positions
+ * found through a hash set of canonical keys. The positions are then split
+ * among workers of a compute pool. Each worker proves the outcome of its
+ * positions with an alpha-beta search over the three outcomes, to the end of
+ * the game, and finds a move keeping that outcome. All workers share one
+ * transposition table keyed by canonical keys, so work done for a symmetric
+ * copy or by another worker is not repeated; the table needs no lock for the
+ * same reason as the bots' one. Finally the positions are sorted by key and
+ * written as a table the server maps at startup.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "bot.h"
+#include "common.h"
+#include "compute_pool.h"
+#include "config.h"
+#include "solved_table.h"
+#include "structs.h"
+
+/*! \def NO_SOLVED_MOVE
+ * Packed move of a position with no move left.
+ */
+#define NO_SOLVED_MOVE 0xff
+
+/**
+ * The transposition table shared by solver threads.
+ */
+static tt_entry_s *solver_tt = NULL;
+
+/**
+ * Keys of the listed positions, for sorting.
+ */
+static uint64_t *sort_keys = NULL;
+
+/**
+ * Prints out parameters required to start the application
+ * @param[in] name Name of the solver application file.
+ */
+void
+usage(char *name) {
+	fprintf(stderr, "Usage: %s -s size -k win_length [-m mode] [-p plies] [-t threads]\n",
+			name);
+	fprintf(stderr, "size       - board size, %d to %d\n", MIN_BOARD_SIZE,
+			MAX_SOLVED_SIZE);
+	fprintf(stderr, "win_length - number of pawns in a line needed to win\n");
+	fprintf(stderr, "mode       - %d free, %d gravity, default free\n",
+			GAME_MODE_FREE, GAME_MODE_GRAVITY);
+	fprintf(stderr, "plies      - positions within this many moves are stored, default %d\n",
+			SOLVER_STORED_PLIES);
+	fprintf(stderr, "threads    - number of worker threads, default one per core\n");
+}
+
+/**
+ * Orders the moves of a position for the solver: all empty fields, or the
+ * tops of columns in a gravity game. A winning move is the only move and a
+ * threat of the opponent leaves only the blocking moves.
+ * @param[in]  search Pointer to the position.
+ * @param[out] moves  Array the moves are written to, best first.
+ * @return Number of moves, or -1 when the first move wins at once.
+ */
+int
+order_solver_moves(search_s *search, int *moves) {
+	int i, j, t, n = 0, blocks = 0, size = search->size;
+	int scores[MAX_SOLVED_SIZE * MAX_SOLVED_SIZE];
+	for (i = 0; i < size * size; i++) {
+		if (search->cells[i] != 0 || (search->mode == GAME_MODE_GRAVITY
+				&& i / size != size - 1 - search->heights[i % size])) {
+			continue;
+		}
+		moves[n] = i;
+		if ((scores[n] = score_move(search, i)) == ORDER_WIN) {
+			moves[0] = i;
+			return -1;
+		}
+		n++;
+	}
+	for (i = 0; i < n; i++) {
+		if (scores[i] & ORDER_BLOCK) {
+			moves[blocks] = moves[i];
+			scores[blocks++] = scores[i];
+		}
+	}
+	if (blocks > 0) {
+		n = blocks;
+	}
+	for (i = 0; i < n; i++) {
+		for (j = i + 1; j < n; j++) {
+			if (scores[j] > scores[i]) {
+				t = scores[i];
+				scores[i] = scores[j];
+				scores[j] = t;
+				t = moves[i];
+				moves[i] = moves[j];
+				moves[j] = t;
+			}
+		}
+	}
+	return n;
+}
+
+/**
+ * Proves the outcome of a position with alpha-beta search to the end of the
+ * game.
+ * @param[in] search Pointer to the position.
+ * @param[in] alpha  Outcome the player to move is already sure of.
+ * @param[in] beta   Outcome the opponent is already sure of.
+ * @return 1 when the player to move wins, 0 for a draw and -1 for a loss,
+ * exact when between alpha and beta and a bound otherwise.
+ */
+int
+solve(search_s *search, int alpha, int beta) {
+	int i, n, value, best = -2, best_move = -1, tt_move = -1, transform;
+	int alpha0 = alpha, moves[MAX_SOLVED_SIZE * MAX_SOLVED_SIZE];
+	uint64_t key, check, data;
+	tt_entry_s *entry;
+	tt_bound_e bound;
+	if (search->no_empty == 0) {
+		return 0;
+	}
+	key = get_canonical_key(search->cells, search->size, search->mode,
+			&transform);
+	entry = &solver_tt[key & (SOLVER_TT_ENTRIES - 1)];
+	check = __atomic_load_n(&entry->check, __ATOMIC_RELAXED);
+	data = __atomic_load_n(&entry->data, __ATOMIC_RELAXED);
+	if ((data >> 63) != 0 && (check ^ data) == key) {
+		value = (int) (data & 3) - 1;
+		bound = (data >> 2) & 3;
+		if (bound == TT_BOUND_EXACT || (bound == TT_BOUND_LOWER && value >= beta)
+				|| (bound == TT_BOUND_UPPER && value <= alpha)) {
+			return value;
+		}
+		if (((data >> 4) & 0xff) != NO_SOLVED_MOVE) {
+			tt_move = transform_cell(search->size, transform,
+					(data >> 4) & 0xff, 1);
+		}
+	}
+	if ((n = order_solver_moves(search, moves)) == -1) {
+		return 1;
+	}
+	for (i = 0; i < n; i++) {
+		if (moves[i] == tt_move) {
+			moves[i] = moves[0];
+			moves[0] = tt_move;
+			break;
+		}
+	}
+	for (i = 0; i < n; i++) {
+		play_move(search, moves[i]);
+		value = -solve(search, -beta, -alpha);
+		undo_move(search, moves[i]);
+		if (value > best) {
+			best = value;
+			best_move = moves[i];
+		}
+		if (value > alpha) {
+			alpha = value;
+		}
+		if (alpha >= beta) {
+			break;
+		}
+	}
+	bound = best <= alpha0 ? TT_BOUND_UPPER
+			: best >= beta ? TT_BOUND_LOWER : TT_BOUND_EXACT;
+	data = (uint64_t) (best + 1) | ((uint64_t) bound << 2)
+			| ((uint64_t) transform_cell(search->size, transform, best_move, 0)
+					<< 4) | ((uint64_t) 1 << 63);
+	__atomic_store_n(&entry->check, key ^ data, __ATOMIC_RELAXED);
+	__atomic_store_n(&entry->data, data, __ATOMIC_RELAXED);
+	return best;
+}
+
+/**
+ * Proves the exact outcome of a position and finds a move keeping it.
+ * @param[in] search Pointer to the position.
+ * @return The outcome plus one in the two lowest bits and the move above
+ * them, NO_SOLVED_MOVE when no move is left.
+ */
+uint16_t
+solve_position(search_s *search) {
+	int i, n, value, best = -2, best_move = NO_SOLVED_MOVE;
+	int moves[MAX_SOLVED_SIZE * MAX_SOLVED_SIZE];
+	if (search->no_empty == 0) {
+		return 1 | NO_SOLVED_MOVE << 2;
+	}
+	if ((n = order_solver_moves(search, moves)) == -1) {
+		return 2 | moves[0] << 2;
+	}
+	for (i = 0; i < n && best < 1; i++) {
+		play_move(search, moves[i]);
+		/* only a better outcome than the best one so far has to be exact */
+		value = -solve(search, -1, -(best > -1 ? best : -1));
+		undo_move(search, moves[i]);
+		if (value > best) {
+			best = value;
+			best_move = moves[i];
+		}
+	}
+	return (best + 1) | best_move << 2;
+}
+
+/**
+ * Sets up a position from masks of the fields of both players.
+ * @param[out] search Pointer to the position.
+ * @param[in]  rules  Pointer to an empty board of the solved rules.
+ * @param[in]  x_mask Fields of 'x'.
+ * @param[in]  o_mask Fields of 'o'.
+ */
+void
+unpack_position(search_s *search, const search_s *rules, uint64_t x_mask,
+		uint64_t o_mask) {
+	int i, size = rules->size;
+	*search = *rules;
+	for (i = 0; i < size * size; i++) {
+		search->cells[i] = (x_mask >> i) & 1 ? 1 : (o_mask >> i) & 1 ? 2 : 0;
+		if (search->cells[i] != 0) {
+			search->no_empty--;
+			search->heights[i % size]++;
+		}
+	}
+	search->side = __builtin_popcountll(x_mask) == __builtin_popcountll(o_mask)
+			? 1 : 2;
+}
+
+/**
+ * Solves a share of the listed positions on a compute pool worker.
+ * @param[in] job Pointer to the job embedded in a solver job.
+ * \sa solver_job_s
+ */
+void
+run_solver_job(compute_job_s *job) {
+	int i;
+	solver_job_s *solver_job = (solver_job_s*) job;
+	search_s search;
+	for (i = solver_job->first; i < solver_job->first + solver_job->count;
+			i++) {
+		unpack_position(&search, solver_job->rules,
+				solver_job->positions[2 * i],
+				solver_job->positions[2 * i + 1]);
+		solver_job->results[i] = solve_position(&search);
+	}
+}
+
+/**
+ * Lists every position reachable within a number of moves, one copy of
+ * every class of symmetric positions, in the canonical orientation.
+ * @param[in]     search    Pointer to the current position.
+ * @param[in]     plies     Number of moves that may still be played.
+ * @param[in,out] set       Open addressing set of keys of listed positions.
+ * @param[in]     set_mask  Size of the set minus one.
+ * @param[in,out] positions Pairs of masks of listed positions.
+ * @param[in,out] count     Number of listed positions.
+ * @param[in]     limit     Capacity of the set and of the list.
+ * @retval  0 When all positions are listed.
+ * @retval -1 When there are more positions than the limit.
+ */
+int
+list_positions(search_s *search, int plies, uint64_t *set, uint64_t set_mask,
+		uint64_t *positions, long *count, long limit) {
+	int i, n, transform, cell;
+	int moves[MAX_SOLVED_SIZE * MAX_SOLVED_SIZE];
+	uint64_t key, slot, x_mask = 0, o_mask = 0;
+	/* the key of the empty board is 0, so keys are stored plus one */
+	key = get_canonical_key(search->cells, search->size, search->mode,
+			&transform) + 1;
+	if (key == 0) {
+		key = 1;
+	}
+	for (slot = key & set_mask; set[slot] != 0; slot = (slot + 1) & set_mask) {
+		if (set[slot] == key) {
+			return 0;
+		}
+	}
+	if (*count >= limit) {
+		return -1;
+	}
+	set[slot] = key;
+	for (i = 0; i < search->size * search->size; i++) {
+		if (search->cells[i] != 0) {
+			cell = transform_cell(search->size, transform, i, 0);
+			if (search->cells[i] == 1) {
+				x_mask |= (uint64_t) 1 << cell;
+			} else {
+				o_mask |= (uint64_t) 1 << cell;
+			}
+		}
+	}
+	positions[2 * *count] = x_mask;
+	positions[2 * *count + 1] = o_mask;
+	(*count)++;
+	if (plies == 0 || search->no_empty == 0) {
+		return 0;
+	}
+	n = search->size * search->size;
+	for (i = 0; i < n; i++) {
+		if (search->cells[i] != 0 || (search->mode == GAME_MODE_GRAVITY
+				&& i / search->size
+						!= search->size - 1 - search->heights[i % search->size])) {
+			continue;
+		}
+		/* a won game has no further positions */
+		if (score_move(search, i) == ORDER_WIN) {
+			continue;
+		}
+		moves[0] = i;
+		play_move(search, moves[0]);
+		if (list_positions(search, plies - 1, set, set_mask, positions, count,
+				limit) == -1) {
+			undo_move(search, moves[0]);
+			return -1;
+		}
+		undo_move(search, moves[0]);
+	}
+	return 0;
+}
+
+/**
+ * Compares two listed positions by their keys.
+ * @param[in] a Pointer to the index of the first position.
+ * @param[in] b Pointer to the index of the second position.
+ * @return Negative, zero or positive value like strcmp.
+ */
+int
+compare_positions(const void *a, const void *b) {
+	uint64_t ka = sort_keys[*(const long*) a], kb = sort_keys[*(const long*) b];
+	return ka < kb ? -1 : ka > kb;
+}
+
+/**
+ * Writes a solved table file.
+ * @param[in] rules     Pointer to an empty board of the solved rules.
+ * @param[in] plies     Number of moves within which positions are stored.
+ * @param[in] positions Pairs of masks of the positions.
+ * @param[in] results   Packed results of the positions.
+ * @param[in] count     Number of positions.
+ * @retval  0 When the table is written.
+ * @retval -1 When an error occurs.
+ */
+int
+write_solved_table(const search_s *rules, int plies, const uint64_t *positions,
+		const uint16_t *results, long count) {
+	long i;
+	long *order;
+	char name[64];
+	uint16_t *sorted_results;
+	uint64_t *sorted_keys;
+	search_s search;
+	solved_header_s header;
+	FILE *file;
+	order = malloc(count * sizeof(long));
+	sort_keys = malloc(count * sizeof(uint64_t));
+	sorted_keys = malloc(count * sizeof(uint64_t));
+	sorted_results = malloc(count * sizeof(uint16_t));
+	if (order == NULL || sort_keys == NULL || sorted_keys == NULL
+			|| sorted_results == NULL) {
+		fprintf(stderr, "Cannot allocate memory for the table\n");
+		return -1;
+	}
+	for (i = 0; i < count; i++) {
+		unpack_position(&search, rules, positions[2 * i], positions[2 * i + 1]);
+		sort_keys[i] = get_canonical_key(search.cells, rules->size, rules->mode,
+				NULL);
+		order[i] = i;
+	}
+	qsort(order, count, sizeof(long), compare_positions);
+	for (i = 0; i < count; i++) {
+		sorted_keys[i] = sort_keys[order[i]];
+		sorted_results[i] = results[order[i]];
+	}
+	memset(&header, 0, sizeof(solved_header_s));
+	memcpy(header.magic, SOLVED_TABLE_MAGIC, 8);
+	header.size = rules->size;
+	header.win_length = rules->win_length;
+	header.mode = rules->mode;
+	header.plies = plies;
+	header.no_entries = count;
+	snprintf(name, sizeof(name), SOLVED_TABLE_NAME, rules->size,
+			rules->win_length, rules->mode);
+	if ((file = fopen(name, "wb")) == NULL) {
+		perror("Open table:");
+		return -1;
+	}
+	if (fwrite(&header, sizeof(solved_header_s), 1, file) != 1
+			|| fwrite(sorted_keys, sizeof(uint64_t), count, file) != count
+			|| fwrite(sorted_results, sizeof(uint16_t), count, file) != count) {
+		perror("Write table:");
+		fclose(file);
+		return -1;
+	}
+	fclose(file);
+	fprintf(stderr, "Table %s written\n", name);
+	free(order);
+	free(sort_keys);
+	free(sorted_keys);
+	free(sorted_results);
+	return 0;
+}
+
+/**
+ * The main procedure.
+ * @param argc The command line.
+ * @param argv The number of options in the command line.
+ * @retval EXIT_SUCCESS Upon successful termination.
+ * @retval EXIT_FAILURE When an error occurs.
+ */
+int
+main(int argc, char **argv) {
+	int c, i, no_jobs, plies = SOLVER_STORED_PLIES;
+	int threads = sysconf(_SC_NPROCESSORS_ONLN);
+	long count = 0, limit = 1 << 22, share;
+	long long start;
+	uint64_t *set, *positions;
+	uint16_t *results;
+	search_s rules;
+	solver_job_s *jobs;
+	compute_pool_s *pool;
+	memset(&rules, 0, sizeof(search_s));
+	rules.mode = GAME_MODE_FREE;
+	while ((c = getopt(argc, argv, "s:k:m:p:t:")) != -1) {
+		switch (c) {
+		case 's':
+			rules.size = atoi(optarg);
+			break;
+		case 'k':
+			rules.win_length = atoi(optarg);
+			break;
+		case 'm':
+			rules.mode = atoi(optarg);
+			break;
+		case 'p':
+			plies = atoi(optarg);
+			break;
+		case 't':
+			threads = atoi(optarg);
+			break;
+		default:
+			usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+	if (rules.size < MIN_BOARD_SIZE || rules.size > MAX_SOLVED_SIZE
+			|| rules.win_length < MIN_WIN_LENGTH
+			|| rules.win_length > MAX_WIN_LENGTH
+			|| rules.win_length > rules.size || rules.mode < GAME_MODE_FREE
+			|| rules.mode >= GAME_MODES_NO || plies < 0 || threads <= 0) {
+		usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+	rules.side = 1;
+	rules.no_empty = rules.size * rules.size;
+	set = calloc(2 * limit, sizeof(uint64_t));
+	positions = malloc(2 * limit * sizeof(uint64_t));
+	solver_tt = calloc(SOLVER_TT_ENTRIES, sizeof(tt_entry_s));
+	if (set == NULL || positions == NULL || solver_tt == NULL) {
+		fprintf(stderr, "Cannot allocate memory for the solver\n");
+		return EXIT_FAILURE;
+	}
+	start = get_monotonic_ms();
+	if (list_positions(&rules, plies, set, 2 * limit - 1, positions, &count,
+			limit) == -1) {
+		fprintf(stderr, "More than %ld positions within %d plies\n", limit,
+				plies);
+		return EXIT_FAILURE;
+	}
+	free(set);
+	fprintf(stderr, "%ld positions within %d plies listed in %lld ms\n",
+			count, plies, get_monotonic_ms() - start);
+	/* small shares keep all workers busy until the end */
+	no_jobs = count < 64 * threads ? count : 64 * threads;
+	share = (count + no_jobs - 1) / no_jobs;
+	results = malloc(count * sizeof(uint16_t));
+	jobs = calloc(no_jobs, sizeof(solver_job_s));
+	if (results == NULL || jobs == NULL
+			|| (pool = create_compute_pool(threads, no_jobs)) == NULL) {
+		fprintf(stderr, "Cannot start the solver workers\n");
+		return EXIT_FAILURE;
+	}
+	start = get_monotonic_ms();
+	for (i = 0; i < no_jobs; i++) {
+		jobs[i].job.run = run_solver_job;
+		jobs[i].rules = &rules;
+		jobs[i].positions = positions;
+		jobs[i].results = results;
+		jobs[i].first = i * share;
+		jobs[i].count = i * share >= count ? 0
+				: (i + 1) * share > count ? count - i * share : share;
+		submit_compute_job(pool, &jobs[i].job);
+	}
+	destroy_compute_pool(pool);
+	fprintf(stderr, "Solved in %lld ms on %d threads, the first player %s\n",
+			get_monotonic_ms() - start, threads,
+			(results[0] & 3) == 2 ? "wins" : (results[0] & 3) == 1 ?
+					"draws" : "loses");
+	if (write_solved_table(&rules, plies, positions, results, count) == -1) {
+		return EXIT_FAILURE;
+	}
+	free(jobs);
+	free(results);
+	free(positions);
+	free(solver_tt);
+	return EXIT_SUCCESS;
+}
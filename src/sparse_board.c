@@ -0,0 +1,255 @@
+/**
+ * @file sparse_board.c
+ * @ingroup sparse_board
+ *
+ * @author Piotr Janaszek <janas03@yahoo.pl>
+ * @date Created on: Oct 18, 2026
+ *
+ * @brief File containing methods for large and unbounded boards storing only occupied fields.
+ *
+ * Boards larger than MAX_BOARD_SIZE, up to MAX_SPARSE_BOARD_SIZE or without
+ * any bounds, keep only the fields taken so far. The fields are appended to an
+ * array in the order of moves and indexed by an open addressing hash table of
+ * twice the capacity, both doubled when full. A move is checked by walking
+ * the four lines through it with hash lookups, so memory and the cost of a
+ * move depend on the number of pawns and the win length, not on the size.
+ * The Zobrist hash of the position is kept up to date with one xor per move.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "config.h"
+#include "structs.h"
+#include "zobrist.h"
+
+/**
+ * Computes the hash table slot of a field.
+ * @param[in] x The x coordinate of the field.
+ * @param[in] y The y coordinate of the field.
+ * @return Mixed bits of both coordinates.
+ */
+unsigned
+hash_field(int x, int y) {
+	uint64_t h = ((uint64_t) (uint32_t) x << 32) | (uint32_t) y;
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdULL;
+	h ^= h >> 33;
+	h *= 0xc4ceb9fe1a85ec53ULL;
+	h ^= h >> 33;
+	return (unsigned) h;
+}
+
+/**
+ * Allocates the cells array and the hash table of a sparse board.
+ * @param[in] board    Pointer to the board.
+ * @param[in] capacity Number of fields to make room for, a power of two.
+ * @retval  0 Upon success.
+ * @retval -1 When memory cannot be allocated.
+ */
+int
+resize_sparse_board(sparse_board_s *board, int capacity) {
+	int i;
+	unsigned slot, mask = 2 * (unsigned) capacity - 1;
+	int *slots = NULL;
+	move_s *cells = NULL;
+	if ((slots = malloc((mask + 1) * sizeof(int))) == NULL) {
+		return -1;
+	}
+	if ((cells = realloc(board->cells, capacity * sizeof(move_s))) == NULL) {
+		free(slots);
+		return -1;
+	}
+	memset(slots, -1, (mask + 1) * sizeof(int));
+	for (i = 0; i < board->no_cells; i++) {
+		slot = hash_field(cells[i].x, cells[i].y) & mask;
+		while (slots[slot] != -1) {
+			slot = (slot + 1) & mask;
+		}
+		slots[slot] = i;
+	}
+	free(board->slots);
+	board->slots = slots;
+	board->cells = cells;
+	board->capacity = capacity;
+	board->mask = mask;
+	return 0;
+}
+
+/**
+ * Creates new empty sparse board.
+ * @param[in] size       Size of the board or 0 for an unbounded board.
+ * @param[in] win_length Number of consecutive pawns needed to win.
+ * @return Pointer to the created board or NULL upon error.
+ * \sa sparse_board_s
+ */
+sparse_board_s*
+create_sparse_board(int size, int win_length) {
+	sparse_board_s *board = calloc(1, sizeof(sparse_board_s));
+	if (board == NULL) {
+		return NULL;
+	}
+	board->size = size;
+	board->win_length = win_length;
+	if (resize_sparse_board(board, SPARSE_INITIAL_CELLS) == -1) {
+		free(board);
+		return NULL;
+	}
+	return board;
+}
+
+/**
+ * Finds an occupied field of a sparse board.
+ * @param[in] board Pointer to the board.
+ * @param[in] x     The x coordinate of the field.
+ * @param[in] y     The y coordinate of the field.
+ * @return Pointer to the field or NULL when the field is empty.
+ */
+move_s*
+find_sparse_field(sparse_board_s *board, int x, int y) {
+	unsigned slot = hash_field(x, y) & board->mask;
+	move_s *cell;
+	while (board->slots[slot] != -1) {
+		cell = &board->cells[board->slots[slot]];
+		if (cell->x == x && cell->y == y) {
+			return cell;
+		}
+		slot = (slot + 1) & board->mask;
+	}
+	return NULL;
+}
+
+/**
+ * Gets the character representing a field of a sparse board.
+ * @param[in] board Pointer to the board.
+ * @param[in] x     The x coordinate of the field.
+ * @param[in] y     The y coordinate of the field.
+ * @return The pawn taking the field or '1' when the field is empty.
+ */
+char
+get_sparse_field(sparse_board_s *board, int x, int y) {
+	move_s *cell = find_sparse_field(board, x, y);
+	return cell != NULL ? cell->pawn : '1';
+}
+
+/**
+ * Counts pawns of a player lying next to a field in one direction, at most
+ * win_length - 1 of them.
+ * @param[in] board Pointer to the board.
+ * @param[in] move  The field and the pawn of the player.
+ * @param[in] dx    Step along the x axis.
+ * @param[in] dy    Step along the y axis.
+ * @return Number of consecutive pawns found.
+ */
+int
+count_sparse_pawns(sparse_board_s *board, move_s *move, int dx, int dy) {
+	int count = 0, x = move->x + dx, y = move->y + dy;
+	while (count < board->win_length - 1
+			&& get_sparse_field(board, x, y) == move->pawn) {
+		count++;
+		x += dx;
+		y += dy;
+	}
+	return count;
+}
+
+/**
+ * Validates, performs and checks a move on a sparse board.
+ * @param[in] board Pointer to the board that a move will be performed on.
+ * @param[in] move  Structure containing coordinates of a move and a player's pawn.
+ * @param[in] free  Pointer showing how many free places left on a bounded board.
+ * @retval  0 When a move is performed and a game is not finished.
+ * @retval  1 When a move is performed and current player wins the game.
+ * @retval  2 When a move is performed and there are no free fields left.
+ * @retval -1 When current move cannot be performed.
+ * \sa make_move
+ */
+int
+make_sparse_move(sparse_board_s *board, move_s *move, int *free) {
+	int i;
+	unsigned slot;
+	const int dx[4] = { 0, 1, 1, 1 };
+	const int dy[4] = { 1, 0, 1, -1 };
+	if (move->pawn != 'x' && move->pawn != 'o') {
+		return -1;
+	}
+	if (board->size > 0 && (move->x < 0 || move->y < 0
+			|| move->x >= board->size || move->y >= board->size)) {
+		return -1;
+	}
+	if (move->x < -SPARSE_COORD_LIMIT || move->y < -SPARSE_COORD_LIMIT
+			|| move->x > SPARSE_COORD_LIMIT || move->y > SPARSE_COORD_LIMIT) {
+		return -1;
+	}
+	if (find_sparse_field(board, move->x, move->y) != NULL) {
+		return -1;
+	}
+	if (board->no_cells == board->capacity
+			&& resize_sparse_board(board, 2 * board->capacity) == -1) {
+		return -1;
+	}
+	board->cells[board->no_cells] = *move;
+	slot = hash_field(move->x, move->y) & board->mask;
+	while (board->slots[slot] != -1) {
+		slot = (slot + 1) & board->mask;
+	}
+	board->slots[slot] = board->no_cells++;
+	board->hash ^= get_sparse_zobrist_key(move->x, move->y, move->pawn);
+
+	for (i = 0; i < 4; i++) {
+		if (1 + count_sparse_pawns(board, move, dx[i], dy[i])
+				+ count_sparse_pawns(board, move, -dx[i], -dy[i])
+				>= board->win_length) {
+			return 1;
+		}
+	}
+	if (board->size > 0 && --(*free) <= 0) {
+		return 2;
+	}
+	return 0;
+}
+
+/**
+ * Encodes a page of occupied fields as "x;y;pawn" entries with 1-based
+ * coordinates, each followed by PAYLOAD_DELIM.
+ * @param[in]  board  Pointer to the board.
+ * @param[in]  first  Index of the first field to be encoded.
+ * @param[out] buffer Buffer the entries are written to.
+ * @param[in]  length Length of the buffer.
+ * @return Number of encoded fields.
+ */
+int
+encode_sparse_cells(sparse_board_s *board, int first, char *buffer,
+		size_t length) {
+	int i, written;
+	size_t used = 0;
+	buffer[0] = '\0';
+	for (i = first; i < board->no_cells && i < first + CELLS_PER_PAGE; i++) {
+		written = snprintf(buffer + used, length - used, "%d%s%d%s%c%s",
+				board->cells[i].x + 1, INNER_DELIM, board->cells[i].y + 1,
+				INNER_DELIM, board->cells[i].pawn, PAYLOAD_DELIM);
+		if (written < 0 || (size_t) written >= length - used) {
+			buffer[used] = '\0';
+			break;
+		}
+		used += written;
+	}
+	return i - first;
+}
+
+/**
+ * Destroys a sparse board and releases all its memory.
+ * @param[in] board Pointer to the board.
+ */
+void
+destroy_sparse_board(sparse_board_s *board) {
+	if (board == NULL) {
+		return;
+	}
+	free(board->slots);
+	free(board->cells);
+	free(board);
+}
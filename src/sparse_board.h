@@ -0,0 +1,25 @@
+/**
+ * @file sparse_board.h
+ * @ingroup sparse_board
+ *
+ * @author Piotr Janaszek <janas03@yahoo.pl>
+ * @date Created on: Oct 18, 2026
+ *
+ * @brief File containing methods for large and unbounded boards storing only occupied fields.
+ */
+
+#ifndef SPARSE_BOARD_H_
+#define SPARSE_BOARD_H_
+
+#include <stddef.h>
+
+#include "structs.h"
+
+sparse_board_s* create_sparse_board(int size, int win_length);
+char get_sparse_field(sparse_board_s *board, int x, int y);
+int make_sparse_move(sparse_board_s *board, move_s *move, int *free);
+int encode_sparse_cells(sparse_board_s *board, int first, char *buffer,
+		size_t length);
+void destroy_sparse_board(sparse_board_s *board);
+
+#endif /* SPARSE_BOARD_H_ */
@@ -11,9 +11,14 @@
 #ifndef STRUCTS_H_
 #define STRUCTS_H_
 
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/select.h>
+
 #include "config.h"
 #include "enums.h"
 
+typedef struct arena_s arena_s;
 typedef struct request_s request_s;
 typedef struct response_s response_s;
 typedef struct player_s player_s;
@@ -21,9 +26,62 @@ typedef struct players_list_s players_list_s;
 typedef struct game_s game_s;
 typedef struct games_list_s games_list_s;
 typedef struct move_s move_s;
+typedef struct board_s board_s;
+typedef struct sparse_board_s sparse_board_s;
+typedef int (*move_kernel_f)(board_s *board, move_s *move);
+typedef void (*response_hook_f)(int type, message_error_e error, size_t bytes);
 typedef struct thread_s thread_s;
 typedef struct threads_list_s threads_list_s;
 typedef struct thread_data_s thread_data_s;
+typedef struct lobby_game_s lobby_game_s;
+typedef struct lobby_snapshot_s lobby_snapshot_s;
+typedef struct lobby_s lobby_s;
+typedef struct matchmaker_s matchmaker_s;
+typedef struct columns_s columns_s;
+typedef struct compute_job_s compute_job_s;
+typedef struct compute_pool_s compute_pool_s;
+typedef struct bot_s bot_s;
+typedef struct search_s search_s;
+typedef struct bot_job_s bot_job_s;
+typedef struct tt_entry_s tt_entry_s;
+typedef struct mcts_node_s mcts_node_s;
+typedef struct mcts_stats_s mcts_stats_s;
+typedef struct mcts_share_s mcts_share_s;
+typedef struct playout_batch_s playout_batch_s;
+typedef struct analysis_job_s analysis_job_s;
+typedef struct solved_header_s solved_header_s;
+typedef struct solved_table_s solved_table_s;
+typedef struct solver_job_s solver_job_s;
+typedef struct hint_result_s hint_result_s;
+typedef struct hint_waiter_s hint_waiter_s;
+typedef struct hint_job_s hint_job_s;
+typedef struct hint_notice_s hint_notice_s;
+typedef struct hint_channel_s hint_channel_s;
+typedef struct verifier_s verifier_s;
+typedef struct verifier_worker_s verifier_worker_s;
+typedef struct journal_record_s journal_record_s;
+typedef struct journal_s journal_s;
+typedef struct journal_segment_s journal_segment_s;
+typedef struct recovered_game_s recovered_game_s;
+typedef struct recovery_s recovery_s;
+typedef struct timer_s timer_s;
+typedef struct timer_wheel_s timer_wheel_s;
+typedef struct lobby_timers_s lobby_timers_s;
+typedef struct metrics_histogram_s metrics_histogram_s;
+typedef struct metrics_shard_s metrics_shard_s;
+typedef struct log_entry_s log_entry_s;
+typedef struct log_ring_s log_ring_s;
+
+/*!
+ * \brief A structure to represent a contiguous block of memory that smaller blocks are carved from.
+ */
+struct arena_s {
+	/*@{*/
+	char *base; /**< The beginning of the usable memory. */
+	size_t size; /**< Number of usable bytes. */
+	size_t used; /**< Number of bytes already allocated. */
+	/*@}*/
+};
 
 /*!
  * \brief A structure to represent request message.
@@ -54,6 +112,12 @@ struct player_s {
 	int player_fd; /**< Player file descriptor. */
 	int game_id; /**< Game ID which players wants to play. */
 	char player_nick[MAX_NICK_LEN]; /**< Player's nick name. */
+	char token[SESSION_TOKEN_LEN + 1]; /**< Session token the player resumes a game with after losing the connection. */
+	player_s *prev; /**< The previous player in the players list. */
+	player_s *next; /**< The next player in the players list. */
+	int queued_size; /**< Board size of the quick match queue the player waits in or 0. */
+	player_s *queue_prev; /**< The previous player in the quick match queue. */
+	player_s *queue_next; /**< The next player in the quick match queue. */
 	/*@}*/
 };
 
@@ -62,8 +126,9 @@ struct player_s {
  */
 struct players_list_s {
 	/*@{*/
-	player_s *value; /**< Player structure. \sa player_s */
-	struct players_list_s *next; /**< The pointer to the next list value. */
+	player_s *head; /**< The first player in the list. \sa player_s */
+	player_s *tail; /**< The last player in the list. \sa player_s */
+	int count; /**< Number of players in the list. */
 	/*@}*/
 };
 
@@ -73,14 +138,33 @@ struct players_list_s {
 struct game_s {
 	/*@{*/
 	int id; /**< Game ID. */
-	int free; /**< Number of spectator places left. \sa SPECTATORS_NO */
+	int size; /**< Size of the board. */
+	int free; /**< Number of free fields left on the board. */
 	int current_player; /**< The current player. */
 	int no_connected_players; /**< Number of connected players. */
 	int no_connected_spectators; /**< Number of connected spectators. */
-	char **board; /**< Pointer to a board. */
+	int no_moves; /**< Number of moves recorded in the move log. */
+	int win_length; /**< Number of consecutive pawns needed to win. */
+	game_mode_e mode; /**< Rule deciding where pawns may be put. \sa game_mode_e */
+	int *heights; /**< Number of pawns in every column of a gravity game or NULL. */
+	board_s *board; /**< Pointer to a board or NULL for large boards. \sa board_s */
+	sparse_board_s *sparse; /**< Pointer to a large board or NULL. \sa sparse_board_s */
+	bot_s *bot; /**< Pointer to the bot playing as the second player or NULL. \sa bot_s */
 	game_state_e state; /**< Current game state. */
 	player_s *players[2]; /**< Array of size 2 containing player structures. \sa player_s */
-	int spectators[SPECTATORS_NO]; /**< Array containing file descriptors of connected spectators. */
+	int *spectators; /**< Array of size SPECTATORS_NO containing file descriptors of connected spectators. */
+	move_s *moves; /**< Move log holding every move performed on the board or NULL for sparse boards, which keep the moves themselves. \sa move_s */
+	char *scratch; /**< Scratch buffer used while encoding the board. */
+	int scratch_ready; /**< Whether the scratch buffer holds an encoded board. */
+	uint64_t scratch_hash; /**< Hash of the board encoded in the scratch buffer. */
+	char forced; /**< Outcome under perfect play announced last: 'x', 'o', '-' for a draw or 0. */
+	int first_seat; /**< Seat of the player who moved first. */
+	long long waiting_since; /**< Monotonic time in milliseconds the game started waiting for its players. */
+	char (*seats)[MAX_NICK_LEN]; /**< Nicks of the players a game restored from the journal waits for, or NULL. */
+	thread_data_s *tdata; /**< Arguments passed to the thread serving the game. \sa thread_data_s */
+	arena_s *arena; /**< Arena holding the game and all its buffers. \sa arena_s */
+	game_s *prev; /**< The previous game in the games list. */
+	game_s *next; /**< The next game in the games list. */
 	/*@}*/
 };
 
@@ -89,8 +173,46 @@ struct game_s {
  */
 struct games_list_s {
 	/*@{*/
-	game_s *value; /**< Game structure. \sa game_s */
-	struct games_list_s *next; /**< The pointer to the next list value. */
+	game_s *head; /**< The first game in the list. \sa game_s */
+	game_s *tail; /**< The last game in the list. \sa game_s */
+	int count; /**< Number of games in the list. */
+	/*@}*/
+};
+
+/*!
+ * \brief A structure to represent a board as bitsets. Field (x, y) is bit
+ * x * stride + y, where stride is the board size plus one guard bit per row.
+ * The structure and its bitsets form a single cache-line-aligned block.
+ */
+struct board_s {
+	/*@{*/
+	int size; /**< Size of the board. */
+	int stride; /**< Distance in bits between vertically adjacent fields. */
+	int win_length; /**< Number of consecutive pawns needed to win. */
+	int words; /**< Number of words in each bitset. */
+	int windows; /**< Number of lines of win_length fields on the board. */
+	int live[2]; /**< Number of lines still free of the opponent's pawns, per player. */
+	uint64_t hash; /**< Zobrist hash of the position. */
+	move_kernel_f check_move; /**< Win check specialized for the size and the win length. */
+	uint64_t bits[]; /**< BOARD_BITS_NO bitsets followed by per player pawn counters of windows. \sa board_bits_e */
+	/*@}*/
+};
+
+/*!
+ * \brief A structure to represent a large or unbounded board storing only
+ * occupied fields. The fields are kept in the order they were taken and
+ * found through an open addressing hash table of indices.
+ */
+struct sparse_board_s {
+	/*@{*/
+	int size; /**< Size of the board or 0 for an unbounded board. */
+	int win_length; /**< Number of consecutive pawns needed to win. */
+	int no_cells; /**< Number of occupied fields. */
+	int capacity; /**< Number of fields the cells array has room for. */
+	unsigned mask; /**< Number of hash table slots minus one. */
+	uint64_t hash; /**< Zobrist hash of the position. */
+	int *slots; /**< Hash table holding indices of cells or -1 for free slots. */
+	move_s *cells; /**< Occupied fields in the order they were taken. \sa move_s */
 	/*@}*/
 };
 
@@ -112,6 +234,8 @@ struct thread_s {
 	/*@{*/
 	int game_id; /**< The game ID which is being served by current thread. */
 	pthread_t pthread; /**< The thread ID. */
+	thread_s *prev; /**< The previous thread in the threads list. */
+	thread_s *next; /**< The next thread in the threads list. */
 	/*@}*/
 };
 
@@ -120,8 +244,55 @@ struct thread_s {
  */
 struct threads_list_s {
 	/*@{*/
-	thread_s *value; /**< Thread structure. \sa thread_s */
-	struct threads_list_s *next; /**< The pointer to the next list value. */
+	thread_s *head; /**< The first thread in the list. \sa thread_s */
+	thread_s *tail; /**< The last thread in the list. \sa thread_s */
+	int count; /**< Number of threads in the list. */
+	/*@}*/
+};
+
+/*!
+ * \brief A structure to represent a timer armed in a timing wheel. Timers are
+ * embedded in the structures they time, so arming and cancelling a timer
+ * allocates nothing.
+ */
+struct timer_s {
+	/*@{*/
+	timer_e kind; /**< What the timer times. \sa timer_e */
+	int key; /**< File descriptor, game ID or seat the timer belongs to. */
+	long long tick; /**< Tick the timer expires at. */
+	int level; /**< Level of the wheel the timer is held in or -1 when it is not armed. */
+	timer_s *prev; /**< The previous timer in the slot. */
+	timer_s *next; /**< The next timer in the slot or in the list of expired timers. */
+	/*@}*/
+};
+
+/*!
+ * \brief A structure to represent a hierarchical timing wheel. Level 0 has a
+ * slot for every tick of the current TIMER_WHEEL_SLOTS ticks, each next level
+ * a slot for every block of the level below it. A timer is held at the level
+ * of the highest digit its tick differs from the current tick in, and moves
+ * down when the wheel reaches its slot.
+ */
+struct timer_wheel_s {
+	/*@{*/
+	long long now; /**< The current tick. */
+	long count; /**< Number of armed timers. */
+	uint64_t occupied[TIMER_WHEEL_LEVELS]; /**< Bitmaps of the slots holding timers. */
+	timer_s *slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS]; /**< Lists of timers. */
+	/*@}*/
+};
+
+/*!
+ * \brief A structure to represent the timers of the main thread: the idle and
+ * keepalive timers of every client descriptor and the expiry of every game
+ * waiting for players.
+ */
+struct lobby_timers_s {
+	/*@{*/
+	timer_wheel_s wheel; /**< The wheel of the main thread. \sa timer_wheel_s */
+	timer_s idle[FD_SETSIZE]; /**< Timers disconnecting clients idle in the lobby. */
+	timer_s keepalive[FD_SETSIZE]; /**< Timers pinging silent clients and disconnecting the ones not answering. */
+	timer_s waiting[MAX_GAME_ID + 1]; /**< Timers removing games nobody joins, indexed by the game ID. */
 	/*@}*/
 };
 
@@ -131,6 +302,9 @@ struct threads_list_s {
 struct thread_data_s {
 	/*@{*/
 	int players_fd[2]; /**< Array of size 2 containing players file descriptors. */
+	long long away_until[2]; /**< Monotonic time in milliseconds until which the seat of a disconnected player is kept, 0 for a connected player. */
+	timer_s seat_timers[2]; /**< Timers ending the game when a disconnected player does not come back. */
+	timer_s move_timer; /**< Clock of the player to move. */
 	int spectators_fd[SPECTATORS_NO]; /**< Array containing file descriptors of connected spectators. */
 	pid_t parent_pid; /**< The PID of the main server process. */
 	pthread_mutex_t *players_list_mutex; /**< Pointer to the players list mutex. */
@@ -138,9 +312,566 @@ struct thread_data_s {
 	pthread_mutex_t *threads_list_mutex; /**< Pointer to the threads list mutex. */
 	fd_set *rd_fds; /**< Pointer to the base server file descriptor set. */
 	game_s *game; /**< Pointer to the game structure. \sa game_s */
-	games_list_s **games_list; /**< Pointer to the games list. \sa games_list_s */
-	players_list_s **players_list; /**< Pointer to the players list. \sa players_list_s */
-	threads_list_s **threads_list; /**< Pointer to the threads list. \sa threads_list_s */
+	games_list_s *games_list; /**< Pointer to the games list. \sa games_list_s */
+	players_list_s *players_list; /**< Pointer to the players list. \sa players_list_s */
+	threads_list_s *threads_list; /**< Pointer to the threads list. \sa threads_list_s */
+	lobby_s *lobby; /**< Pointer to the lobby. \sa lobby_s */
+	hint_channel_s *hints; /**< Channel hint results for the game's clients arrive through or NULL. \sa hint_channel_s */
+	/*@}*/
+};
+
+/*!
+ * \brief A structure to represent a game as seen in the lobby.
+ */
+struct lobby_game_s {
+	/*@{*/
+	int id; /**< Game ID. */
+	int size; /**< Size of the board or 0 for an unbounded board. */
+	int win_length; /**< Number of consecutive pawns needed to win. */
+	game_mode_e mode; /**< Rule deciding where pawns may be put. \sa game_mode_e */
+	int free_spectators; /**< Number of spectator places left. */
+	int no_players; /**< Number of players in the game. */
+	char nicks[2][MAX_NICK_LEN]; /**< Nick names of the players. */
+	/*@}*/
+};
+
+/*!
+ * \brief A structure to represent an immutable snapshot of the games list.
+ */
+struct lobby_snapshot_s {
+	/*@{*/
+	unsigned long version; /**< Version of the snapshot, incremented on every change. */
+	int no_games; /**< Number of games in the snapshot. */
+	int no_players; /**< Number of players in the snapshot. */
+	lobby_game_s *games; /**< Contiguous array of games. \sa lobby_game_s */
+	char (*players)[MAX_NICK_LEN]; /**< Contiguous array of players' nick names. */
+	int encoded[LOBBY_FILTERS_NO]; /**< State of every cached payload. \sa lobby_payload_e */
+	char payloads[LOBBY_FILTERS_NO][MAX_RSP_SIZE]; /**< Cached list responses. \sa lobby_filter_e */
+	lobby_snapshot_s *next; /**< The next retired snapshot waiting to be freed. */
+	/*@}*/
+};
+
+/*!
+ * \brief A structure to represent the lobby i.e. the currently published snapshot of the games list.
+ */
+struct lobby_s {
+	/*@{*/
+	lobby_snapshot_s *current; /**< The currently published snapshot. \sa lobby_snapshot_s */
+	lobby_snapshot_s *retired; /**< Replaced snapshots which may still be read. */
+	lobby_snapshot_s *hazards[LOBBY_READERS]; /**< Snapshots being read by readers. */
+	unsigned long version; /**< Version of the current snapshot. */
+	int next_reader_slot; /**< The next free hazard slot. */
+	pthread_mutex_t mutex; /**< Mutex serializing writers. */
+	games_list_s *games_list; /**< Pointer to the games list. \sa games_list_s */
+	pthread_mutex_t *games_list_mutex; /**< Pointer to the games list mutex. */
+	players_list_s *players_list; /**< Pointer to the players list. \sa players_list_s */
+	pthread_mutex_t *players_list_mutex; /**< Pointer to the players list mutex. */
+	/*@}*/
+};
+
+/*!
+ * \brief A structure to represent quick match queues, one FIFO queue per board size.
+ */
+struct matchmaker_s {
+	/*@{*/
+	player_s *heads[MAX_BOARD_SIZE + 1]; /**< The players waiting longest, indexed by board size. */
+	player_s *tails[MAX_BOARD_SIZE + 1]; /**< The players waiting shortest, indexed by board size. */
+	/*@}*/
+};
+
+/*!
+ * \brief A structure to represent the columns of a gravity game as known to a
+ * client. Heights only grow, so a column full here is full on the server.
+ */
+struct columns_s {
+	/*@{*/
+	int size; /**< Size of the board or 0 when pawns are not dropped. */
+	int heights[MAX_SPARSE_BOARD_SIZE]; /**< Lowest known number of pawns in every column. */
+	/*@}*/
+};
+
+/*!
+ * \brief A structure to represent a job run by a compute pool. It is embedded
+ * in a structure holding the data of the job.
+ */
+struct compute_job_s {
+	/*@{*/
+	void (*run)(compute_job_s *job); /**< Function doing the job, it owns the job once called. */
+	compute_job_s *next; /**< The next job in the queue. */
+	/*@}*/
+};
+
+/*!
+ * \brief A structure to represent a pool of worker threads running jobs from a bounded queue.
+ */
+struct compute_pool_s {
+	/*@{*/
+	pthread_t *workers; /**< Array of worker threads. */
+	int no_workers; /**< Number of worker threads. */
+	int capacity; /**< Maximum number of queued jobs. */
+	int queued; /**< Number of queued jobs. */
+	int stop; /**< Whether the pool is being destroyed. */
+	pthread_mutex_t mutex; /**< Mutex guarding the queue. */
+	pthread_cond_t ready; /**< Condition signalled when a job is queued or the pool stops. */
+	compute_job_s *head; /**< The job waiting longest. \sa compute_job_s */
+	compute_job_s *tail; /**< The job waiting shortest. \sa compute_job_s */
+	/*@}*/
+};
+
+/*!
+ * \brief A structure to represent a bot playing as the second player. The game
+ * thread sees the bot as a client behind one end of a socket pair and the
+ * searches write the bot's moves into the other end.
+ */
+struct bot_s {
+	/*@{*/
+	player_s player; /**< The bot as a player, its descriptor is the game end of the pair. \sa player_s */
+	int fds[2]; /**< The game end and the search end of the socket pair. */
+	int budget_ms; /**< Time the bot thinks over a move, in milliseconds. */
+	bot_engine_e engine; /**< The engine searching the bot's moves. \sa bot_engine_e */
+	int thinking; /**< Whether a search of the current position is queued or running. */
+	int cancelled; /**< Whether the game is over and searches should stop. */
+	int refs; /**< Number of holders: the game and every search in flight. */
+	pthread_mutex_t mutex; /**< Mutex guarding the number of holders. */
+	compute_pool_s *pool; /**< The pool running the searches. \sa compute_pool_s */
+	/*@}*/
+};
+
+/*!
+ * \brief A structure to represent a position searched by a bot. Fields hold 0
+ * when empty, 1 for 'x' and 2 for 'o'.
+ */
+struct search_s {
+	/*@{*/
+	int size; /**< Size of the board. */
+	int win_length; /**< Number of consecutive pawns needed to win. */
+	game_mode_e mode; /**< Rule deciding where pawns may be put. \sa game_mode_e */
+	int side; /**< The player to move, 1 or 2. */
+	int no_empty; /**< Number of empty fields. */
+	unsigned char cells[MAX_BOARD_SIZE * MAX_BOARD_SIZE]; /**< Fields of the board, row by row. */
+	int heights[MAX_BOARD_SIZE]; /**< Number of pawns in every column of a gravity game. */
+	uint64_t hash; /**< Zobrist hash of the position. */
+	uint64_t salt; /**< Key telling apart equal positions of different rules in the table. */
+	long nodes; /**< Number of positions visited. */
+	long long deadline; /**< Monotonic time the search has to stop at, in milliseconds. */
+	long max_playouts; /**< Number of playouts a Monte Carlo search stops after or 0 for no limit. */
+	int stopped; /**< Whether the search ran out of time or was cancelled. */
+	int best; /**< The best move found at the root. */
+	int *cancelled; /**< Pointer to the flag cancelling the search. */
+	/*@}*/
+};
+
+/*!
+ * \brief A structure to represent a search of a bot's move run by a compute pool.
+ */
+struct bot_job_s {
+	/*@{*/
+	compute_job_s job; /**< The job queued in the pool, kept first. \sa compute_job_s */
+	bot_s *bot; /**< The bot the move is searched for. \sa bot_s */
+	search_s search; /**< Copy of the position. \sa search_s */
+	mcts_share_s *share; /**< Results shared by Monte Carlo trees of the move or NULL. \sa mcts_share_s */
+	/*@}*/
+};
+
+/*!
+ * \brief A structure to represent an entry of the transposition table. The
+ * check word is the key xored with the data, so an entry torn by concurrent
+ * writers never matches a key and no lock is needed.
+ */
+struct tt_entry_s {
+	/*@{*/
+	uint64_t check; /**< The key xored with the data. */
+	uint64_t data; /**< Packed score, move, depth and bound of a position. */
+	/*@}*/
+};
+
+/*!
+ * \brief A structure to represent a node of a Monte Carlo tree. The node
+ * stands for the position after its move; wins are counted for the player
+ * who made the move, a draw counting as half a win.
+ */
+struct mcts_node_s {
+	/*@{*/
+	int move; /**< The field of the move, x * size + y. */
+	int first_child; /**< Index of the first child or -1 when not expanded. */
+	int no_children; /**< Number of children, stored one after another. */
+	int terminal; /**< 1 when the move wins, 2 when it fills the board, 0 otherwise. */
+	long visits; /**< Number of playouts through the node. */
+	double wins; /**< Wins of the player who made the move in those playouts. */
+	/*@}*/
+};
+
+/*!
+ * \brief A structure to represent results of Monte Carlo searches of one
+ * position, per move of the player to move.
+ */
+struct mcts_stats_s {
+	/*@{*/
+	long playouts; /**< Number of playouts run. */
+	long visits[MAX_BOARD_SIZE * MAX_BOARD_SIZE]; /**< Playouts through every move. */
+	double wins[MAX_BOARD_SIZE * MAX_BOARD_SIZE]; /**< Wins of the player to move after every move. */
+	/*@}*/
+};
+
+/*!
+ * \brief A structure to represent results gathered from the Monte Carlo
+ * trees searched in parallel for one move of a bot. The last tree to finish
+ * chooses the move.
+ */
+struct mcts_share_s {
+	/*@{*/
+	mcts_stats_s stats; /**< Sums of the results of finished trees. \sa mcts_stats_s */
+	int remaining; /**< Number of trees still searched. */
+	long long start; /**< Monotonic time the search started at, in milliseconds. */
+	pthread_mutex_t mutex; /**< Mutex guarding the sums and the counter. */
+	/*@}*/
+};
+
+/*!
+ * \brief A structure to represent a batch of random playouts played in
+ * lockstep from one position. Lanes are stored side by side: a word of the
+ * bitboards, an entry of the lists of empty fields or a random generator is
+ * kept for all lanes next to each other, so one vector holds several lanes.
+ * A step plays one move in every lane still running.
+ */
+struct playout_batch_s {
+	/*@{*/
+	uint64_t bits[2][BOARD_WORDS][MCTS_BATCH]; /**< Bitboards of x and o, word by word, with the lanes of a word side by side. */
+	int empty[MAX_BOARD_SIZE * MAX_BOARD_SIZE][MCTS_BATCH]; /**< Empty fields, or open columns of a gravity game, entry by entry, with the lanes side by side. */
+	uint64_t no_empty[MCTS_BATCH]; /**< Number of entries in the list of empty fields of every lane. */
+	uint64_t seeds[MCTS_BATCH]; /**< States of the random generators of the lanes. */
+	uint64_t picks[MCTS_BATCH]; /**< Entry of the list of empty fields drawn in every lane. */
+	int cells[MCTS_BATCH]; /**< Field, or column of a gravity game, drawn in every lane. */
+	int heights[MCTS_BATCH][MAX_BOARD_SIZE]; /**< Number of pawns in every column of a gravity game, per lane. */
+	int winners[MCTS_BATCH]; /**< Winner of every lane: 1 or 2, 0 for a draw, -1 while running. */
+	board_s *board; /**< Empty board of the size and win length giving the layout of the bitboards. \sa board_s */
+	/*@}*/
+};
+
+/*!
+ * \brief A structure to represent a position of a recorded game estimated by
+ * the analyzer on a compute pool.
+ */
+struct analysis_job_s {
+	/*@{*/
+	compute_job_s job; /**< The job queued in the pool, kept first. \sa compute_job_s */
+	search_s search; /**< The position and the number of playouts. \sa search_s */
+	int game; /**< Number of the game in the input, from 1. */
+	int ply; /**< Number of moves played before the position. */
+	double value; /**< Estimated chance of 'x' to win, a draw counting as half. */
+	long playouts; /**< Number of playouts run. */
+	/*@}*/
+};
+
+/*!
+ * \brief A structure to represent the header of a solved table file. It is
+ * followed by no_entries sorted keys and then by no_entries packed results.
+ */
+struct solved_header_s {
+	/*@{*/
+	char magic[8]; /**< SOLVED_TABLE_MAGIC. */
+	int32_t size; /**< Size of the board. */
+	int32_t win_length; /**< Number of consecutive pawns needed to win. */
+	int32_t mode; /**< The game mode. \sa game_mode_e */
+	int32_t plies; /**< Number of moves from the empty board every position within is stored. */
+	uint64_t no_entries; /**< Number of positions. */
+	/*@}*/
+};
+
+/*!
+ * \brief A structure to represent a solved table mapped into memory. A result
+ * holds the outcome for the player to move plus one in its two lowest bits
+ * and the best move, in the orientation of the key, above them.
+ */
+struct solved_table_s {
+	/*@{*/
+	void *map; /**< The mapped file. */
+	size_t length; /**< Length of the mapping. */
+	const solved_header_s *header; /**< The header of the table. \sa solved_header_s */
+	const uint64_t *keys; /**< Sorted canonical keys of positions. */
+	const uint16_t *results; /**< Packed results of positions, in the order of keys. */
+	/*@}*/
+};
+
+/*!
+ * \brief A structure to represent a share of stored positions solved by one
+ * worker of the solver.
+ */
+struct solver_job_s {
+	/*@{*/
+	compute_job_s job; /**< The job queued in the pool, kept first. \sa compute_job_s */
+	const search_s *rules; /**< The empty board of the solved size, win length and mode. \sa search_s */
+	const uint64_t *positions; /**< Pairs of masks of 'x' and 'o' fields of canonical positions. */
+	uint16_t *results; /**< Packed results written for the positions. */
+	int first; /**< Index of the first position of the share. */
+	int count; /**< Number of positions of the share. */
+	/*@}*/
+};
+
+/*!
+ * \brief A structure to represent a cached result of a hint search. Moves
+ * are kept for the canonical copy of the position.
+ */
+struct hint_result_s {
+	/*@{*/
+	uint64_t key; /**< Canonical key of the position. */
+	int size; /**< Size of the board. */
+	int win_length; /**< Number of consecutive pawns needed to win. */
+	game_mode_e mode; /**< Rule deciding where pawns may be put. \sa game_mode_e */
+	int move; /**< The best move in the canonical copy or -1 when the entry is empty. */
+	double value; /**< Chance of the player to move to win. */
+	/*@}*/
+};
+
+/*!
+ * \brief A structure to represent a request waiting for a hint search.
+ */
+struct hint_waiter_s {
+	/*@{*/
+	hint_channel_s *channel; /**< Channel of the thread serving the client. \sa hint_channel_s */
+	int client_fd; /**< File descriptor of the client. */
+	message_type_e type; /**< Type of the response. \sa message_type_e */
+	int transform; /**< Symmetry turning the client's position into the canonical copy. */
+	/*@}*/
+};
+
+/*!
+ * \brief A structure to represent a hint search run by the hint pool. Later
+ * requests for the same position wait for it instead of searching again.
+ */
+struct hint_job_s {
+	/*@{*/
+	compute_job_s job; /**< The job queued in the pool, kept first. \sa compute_job_s */
+	search_s search; /**< The position searched. \sa search_s */
+	uint64_t key; /**< Canonical key of the position. */
+	int transform; /**< Symmetry turning the searched position into the canonical copy. */
+	long long deadline; /**< Monotonic time the first request has to be answered by, in milliseconds. */
+	hint_waiter_s waiters[HINT_WAITERS]; /**< Requests waiting for the search. \sa hint_waiter_s */
+	int no_waiters; /**< Number of waiting requests. */
+	hint_job_s *next; /**< The next running search. */
+	/*@}*/
+};
+
+/*!
+ * \brief A structure to represent a finished hint sent to the thread
+ * serving the client that asked for it.
+ */
+struct hint_notice_s {
+	/*@{*/
+	int client_fd; /**< File descriptor of the client. */
+	message_type_e type; /**< Type of the response. \sa message_type_e */
+	message_error_e error; /**< Error of the response. \sa message_error_e */
+	int size; /**< Size of the board. */
+	int move; /**< The best move, x * size + y. */
+	double value; /**< Chance of the player to move to win. */
+	/*@}*/
+};
+
+/*!
+ * \brief A structure to represent a pipe finished hints are written to by
+ * the hint pool and read from by a thread serving clients.
+ */
+struct hint_channel_s {
+	/*@{*/
+	int fds[2]; /**< The reading and the writing end of the pipe. */
+	/*@}*/
+};
+
+/*!
+ * \brief A structure to represent recorded games verified by the verifier.
+ */
+struct verifier_s {
+	/*@{*/
+	const char *data; /**< The mapped file of recorded games. */
+	size_t length; /**< Length of the file. */
+	int no_workers; /**< Number of worker threads. */
+	verifier_worker_s **workers; /**< The workers. \sa verifier_worker_s */
+	/*@}*/
+};
+
+/*!
+ * \brief A structure to represent a worker thread of the verifier. Its
+ * chunks are a range taken from the front by the worker and from the back by
+ * thieves, so both ends are packed into one word changed atomically.
+ */
+struct verifier_worker_s {
+	/*@{*/
+	uint64_t range; /**< The first chunk left in the upper half and the end of the chunks in the lower one. */
+	int id; /**< Number of the worker. */
+	pthread_t thread; /**< The thread of the worker. */
+	verifier_s *verifier; /**< The verified games. \sa verifier_s */
+	arena_s *arena; /**< Arena boards of replayed games are allocated from, reset for every game. \sa arena_s */
+	long games; /**< Number of records verified. */
+	long moves; /**< Number of moves replayed. */
+	long illegal; /**< Number of games with an illegal move or a move after the end. */
+	long wrong_outcome; /**< Number of games ending otherwise than recorded. */
+	long malformed; /**< Number of records that cannot be read. */
+	long steals; /**< Number of successful steals. */
+	/*@}*/
+};
+
+/*!
+ * \brief A structure to represent a record of the game journal. All records
+ * have the same size, 64 bytes, whatever they hold.
+ */
+struct journal_record_s {
+	/*@{*/
+	uint32_t checksum; /**< FNV-1a hash of the rest of the record. */
+	uint8_t type; /**< Kind of the record. \sa journal_record_e */
+	uint8_t pawn; /**< Pawn of a move. */
+	uint8_t mode; /**< Game mode of a created game. \sa game_mode_e */
+	uint8_t win_length; /**< Win length of a created game. */
+	int32_t game_id; /**< ID of the game. */
+	int32_t size; /**< Board size of a created game, 0 for an unbounded board. */
+	int32_t x; /**< Row of a move, or the thinking time of the bot of a started game. */
+	int32_t y; /**< Column of a move, or the engine of the bot of a started game. */
+	int32_t value; /**< Seat of the player to move first in a started game, or the outcome of an ended game. */
+	uint32_t ply; /**< Number of the move, counted from 1. */
+	char nick[MAX_NICK_LEN]; /**< Nick of the creator of a created game or of the second player of a started one. */
+	/*@}*/
+};
+
+/*!
+ * \brief A structure to represent the game journal. Game threads append
+ * records to the active buffer under the mutex, while a flusher thread
+ * writes out the other buffer and syncs the file, so all records gathered
+ * during one sync share it.
+ */
+struct journal_s {
+	/*@{*/
+	char name[256]; /**< Name the segments are named after. */
+	journal_durability_e durability; /**< Durability level. \sa journal_durability_e */
+	int interval_ms; /**< Interval between syncs, in milliseconds. */
+	int fd; /**< The open segment. */
+	int segment; /**< Number of the open segment. */
+	size_t segment_size; /**< Bytes written to the open segment. */
+	char *buffers[2]; /**< Buffers records are gathered in. */
+	size_t used; /**< Bytes used in the active buffer. */
+	int active; /**< Index of the buffer records are appended to. */
+	uint64_t appended; /**< Number of records appended. */
+	uint64_t durable; /**< Number of records written out, and synced unless the level is JOURNAL_DURABILITY_WRITE. */
+	long flushes; /**< Number of buffers written out. */
+	int failed; /**< Whether a write failed and journaling stopped. */
+	int stop; /**< Whether the journal is being closed. */
+	pthread_t flusher; /**< The flusher thread. */
+	pthread_mutex_t mutex; /**< Mutex guarding the buffers and counters. */
+	pthread_cond_t wake; /**< Condition signalled when records wait for the flusher. */
+	pthread_cond_t flushed; /**< Condition signalled when a buffer is written out. */
+	/*@}*/
+};
+
+/*!
+ * \brief A structure to represent a journal segment mapped into memory.
+ */
+struct journal_segment_s {
+	/*@{*/
+	const journal_record_s *records; /**< The mapped records. */
+	size_t length; /**< Length of the mapping in bytes. */
+	long no_records; /**< Number of whole records in the segment. */
+	long valid; /**< Number of records before the first one with a wrong checksum. */
+	long base; /**< Index of the first record of the segment in the whole journal. */
+	/*@}*/
+};
+
+/*!
+ * \brief A structure to represent a game found unfinished in the journal.
+ */
+struct recovered_game_s {
+	/*@{*/
+	long created; /**< Index of the record of the creation of the game. */
+	long started; /**< Index of the record of the start of the game. */
+	game_s *game; /**< The rebuilt game or NULL when it cannot be rebuilt. \sa game_s */
+	char outcome; /**< Pawn of the winner or '-' when the replayed moves end the game, 0 otherwise. */
+	/*@}*/
+};
+
+/*!
+ * \brief A structure to represent games being recovered from the journal.
+ * Workers first check the checksums of chunks of records taken in turn, then
+ * replay unfinished games taken in turn; records of one game are linked so
+ * a game is replayed without looking at the records of other games.
+ */
+struct recovery_s {
+	/*@{*/
+	journal_segment_s *segments; /**< The mapped segments. \sa journal_segment_s */
+	int no_segments; /**< Number of segments. */
+	long no_records; /**< Number of records in all segments. */
+	long *links; /**< Index of the next record of the same game for every record, -1 for the last one. */
+	long next_chunk; /**< The next chunk of records to check. */
+	long no_chunks; /**< Number of chunks of records. */
+	recovered_game_s *games; /**< Games to replay. \sa recovered_game_s */
+	int no_games; /**< Number of games to replay. */
+	int next_game; /**< The next game to replay. */
+	long checked; /**< Number of records checked so far. */
+	long replayed; /**< Number of games replayed so far. */
+	long moves; /**< Number of moves replayed so far. */
+	/*@}*/
+};
+
+/*!
+ * \brief A structure to represent a log-linear histogram: every power of two
+ * is split into equal sub-buckets, so a value is placed within a fixed
+ * relative error at any magnitude.
+ */
+struct metrics_histogram_s {
+	/*@{*/
+	uint64_t count; /**< Number of recorded values. */
+	uint64_t sum; /**< Sum of recorded values. */
+	uint64_t buckets[METRICS_HISTOGRAM_BUCKETS]; /**< Number of values recorded in every bucket. */
+	/*@}*/
+};
+
+/*!
+ * \brief A structure to represent the metrics recorded by one thread. Only
+ * the owning thread writes a shard, readers merge all shards. A shard of an
+ * ended thread is handed to the next thread, so its counts are kept.
+ */
+struct metrics_shard_s {
+	/*@{*/
+	uint64_t counters[METRIC_COUNTERS_NO]; /**< Server-wide counters. \sa metrics_counter_e */
+	uint64_t requests[MSG_TYPES_NO]; /**< Number of requests served, by message type. */
+	uint64_t errors[MSG_TYPES_NO]; /**< Number of responses carrying an error, by message type. */
+	metrics_histogram_s latency[MSG_TYPES_NO]; /**< Handler latency in nanoseconds, by message type. */
+	metrics_histogram_s fanout; /**< Number of recipients of broadcast messages. */
+	int owned; /**< Whether a running thread owns the shard. */
+	metrics_shard_s *next; /**< The next shard of the registry. */
+	/*@}*/
+};
+
+/*!
+ * \brief A structure to represent an entry of a log ring. An entry logged
+ * with integer arguments keeps its format and arguments and is formatted by
+ * the flusher, other entries keep their text.
+ */
+struct log_entry_s {
+	/*@{*/
+	long long time; /**< Wall-clock time of the entry in nanoseconds. */
+	log_level_e level; /**< Level of the entry. \sa log_level_e */
+	const char *format; /**< Format taking the arguments or NULL when the text is formatted. */
+	int args[LOG_ARGS_NO]; /**< Arguments of the format. */
+	char text[LOG_TEXT_SIZE]; /**< Text of the entry when it has no format. */
+	/*@}*/
+};
+
+/*!
+ * \brief A structure to represent the log ring of a thread. The thread is
+ * the only writer and the flusher the only reader, so neither locks: the
+ * writer publishes an entry by moving the head, the flusher releases it by
+ * moving the tail. The two are kept in separate cache lines.
+ */
+struct log_ring_s {
+	/*@{*/
+	uint64_t head; /**< Number of entries written, only moved by the writer. */
+	uint64_t dropped; /**< Number of entries dropped as the ring was full. */
+	char head_pad[CACHE_LINE_SIZE - 2 * sizeof(uint64_t)]; /**< Keeps the tail out of the cache line of the head. */
+	uint64_t tail; /**< Number of entries flushed, only moved by the flusher. */
+	uint64_t limit; /**< The head seen by the flush in progress. */
+	uint64_t reported; /**< Number of dropped entries the flusher reported. */
+	log_ring_s *next; /**< The next ring of the registry. */
+	int owned; /**< Whether a running thread owns the ring. */
+	char tail_pad[CACHE_LINE_SIZE - 3 * sizeof(uint64_t) - sizeof(log_ring_s*)
+			- sizeof(int)]; /**< Keeps the entries out of the cache line of the tail. */
+	log_entry_s entries[LOG_RING_SIZE]; /**< The entries, indexed modulo LOG_RING_SIZE. */
 	/*@}*/
 };
 
@@ -17,13 +17,23 @@
 #include <signal.h>
 #include <unistd.h>
 #include <errno.h>
+#include <inttypes.h>
 
 #include "board_handler.h"
+#include "bot.h"
 #include "config.h"
 #include "common.h"
+#include "hint_service.h"
+#include "journal.h"
 #include "lists.h"
+#include "lobby.h"
+#include "logger.h"
 #include "messenger.h"
+#include "metrics.h"
+#include "solved_table.h"
+#include "sparse_board.h"
 #include "structs.h"
+#include "timer_wheel.h"
 
 /**
  * A variable responsible for setting the value determining the main program loop termination.
@@ -35,6 +45,12 @@ __thread volatile sig_atomic_t thwork = 1;
  */
 __thread volatile sig_atomic_t play = 1;
 
+/**
+ * Outcome of the game journaled when the thread ends: pawn of the winner,
+ * '-' for a draw or 0 when the game is abandoned.
+ */
+__thread char outcome = 0;
+
 /**
  * A structure holding data/arguments used by the current thread.
  */
@@ -50,6 +66,11 @@ __thread fd_set *global_thread_rdfs = NULL;
  */
 __thread int *global_thrad_fdmax = NULL;
 
+/**
+ * A pointer to the timing wheel of the current thread.
+ */
+__thread timer_wheel_s *global_thread_wheel = NULL;
+
 /**
  * Updates array of connected spectators when new spectator is connected.
  */
@@ -57,16 +78,16 @@ void
 update_connected_spectators(void) {
 	int i;
 	pthread_t tid;
-	games_list_s *list = *tdata.games_list;
+	games_list_s *list = tdata.games_list;
 	game_s *game = NULL;
 	tid = pthread_self();
 	if (list == NULL) {
-		fprintf(stderr, "(Thread %d) Error while updating data\n", (int) tid);
+		LOG_ERROR("(Thread %d) Error while updating data", (int) tid);
 		return;
 	}
 	get_game_by_id(list, &game, tdata.game->id);
 	if (game == NULL) {
-		fprintf(stderr, "(Thread %d) Error game list is null\n", (int) tid);
+		LOG_ERROR("(Thread %d) Error game list is null", (int) tid);
 		return;
 	}
 	memcpy(tdata.spectators_fd, game->spectators, SPECTATORS_NO * sizeof(int));
@@ -98,19 +119,180 @@ update_connected_players(int client_fd) {
 }
 
 /**
- * Serves SIGRTMIN + 1 by calling update_connected_spectators.
+ * Encodes all the fields of a board into the game scratch buffer. The buffer
+ * is reused as long as the hash of the board does not change, so repeated
+ * requests for the same position are served without encoding it again.
+ * @param[in] game Pointer to a game structure which board is encoded.
+ * @return Pointer to the null-terminated string held in the scratch buffer.
+ * \sa game_s
+ */
+char*
+encode_board(game_s *game) {
+	if (!game->scratch_ready || game->scratch_hash != game->board->hash) {
+		board_to_string(game->board, game->scratch);
+		game->scratch_hash = game->board->hash;
+		game->scratch_ready = 1;
+	}
+	return game->scratch;
+}
+
+/**
+ * Sends a player who resumed the game the game ID, the game mode, the pawn
+ * of the player and a snapshot of the board. Sparse boards do not fit into a
+ * message, so only their size is sent.
+ * @param[in] seat Seat of the player.
+ */
+void
+send_resume_snapshot(int seat) {
+	response_s response;
+	game_s *game = tdata.game;
+	response.type = MSG_RESUME_RSP;
+	response.error = MSG_RSP_ERROR_NONE;
+	if (game->sparse != NULL) {
+		snprintf(response.payload, MAX_RSP_SIZE, "%d%s%d%s%c%s%d%s", game->id,
+				PAYLOAD_DELIM, game->mode, PAYLOAD_DELIM, seat == 0 ? 'x' : 'o',
+				PAYLOAD_DELIM, game->size, PAYLOAD_DELIM);
+	} else {
+		snprintf(response.payload, MAX_RSP_SIZE,
+				"%d%s%d%s%c%s%d%s%s%s%016" PRIx64 "%s", game->id, PAYLOAD_DELIM,
+				game->mode, PAYLOAD_DELIM, seat == 0 ? 'x' : 'o', PAYLOAD_DELIM,
+				game->board->size, PAYLOAD_DELIM, encode_board(game),
+				PAYLOAD_DELIM, game->board->hash, PAYLOAD_DELIM);
+	}
+	send_response_message(tdata.players_fd[seat], &response);
+}
+
+/**
+ * Starts the clock of the player to move. Nobody's clock runs while the
+ * player to move is away or the bot thinks.
+ */
+void
+start_move_clock(void) {
+	game_s *game = tdata.game;
+	if (game->current_player == -1 || (game->bot != NULL
+			&& game->current_player == game->bot->player.player_fd)) {
+		cancel_timer(global_thread_wheel, &tdata.move_timer);
+		return;
+	}
+	arm_timer(global_thread_wheel, &tdata.move_timer,
+			get_monotonic_ms() + MOVE_CLOCK_MS);
+}
+
+/**
+ * Takes in the new connections of players who resumed the game while their
+ * seats were kept. The main thread hands a connection over by setting the
+ * player's descriptor under the games list mutex.
+ * @param[in] snapshot Whether players are sent a snapshot of the board.
+ */
+void
+update_resumed_players(int snapshot) {
+	int seat, fd;
+	for (seat = 0; seat < 2; seat++) {
+		if (tdata.away_until[seat] == 0
+				|| (fd = tdata.game->players[seat]->player_fd) == -1) {
+			continue;
+		}
+		LOG_INFO_TEXT("(Thread %d) Player %s resumed the game",
+				(int) pthread_self(), tdata.game->players[seat]->player_nick);
+		tdata.players_fd[seat] = fd;
+		tdata.away_until[seat] = 0;
+		cancel_timer(global_thread_wheel, &tdata.seat_timers[seat]);
+		if ((tdata.game->first_seat + tdata.game->no_moves) % 2 == seat) {
+			tdata.game->current_player = fd;
+			start_move_clock();
+		}
+		if (global_thread_rdfs != NULL) {
+			FD_SET(fd, global_thread_rdfs);
+			*global_thrad_fdmax = max(*global_thrad_fdmax, fd);
+		}
+		if (snapshot) {
+			send_resume_snapshot(seat);
+		}
+	}
+}
+
+/**
+ * Serves SIGRTMIN + 1, sent when a spectator connects or a player resumes
+ * the game. The signal is only let in while the thread waits in pselect,
+ * so it never breaks into an entry the thread is writing to its log ring.
  * @param[in] sig A signal number that will be served.
- * \sa update_connected_players
+ * \sa update_connected_spectators update_resumed_players
  */
 void
 sig_handler(int sig) {
-	sigset_t mask, oldmask;
-	sigemptyset(&mask);
-	sigaddset(&mask, SIGRTMIN + 1);
-	sigprocmask(SIG_BLOCK, &mask, &oldmask);
-	printf("(Thread %d) New spectator connected\n", (int) pthread_self());
 	update_connected_spectators();
-	sigprocmask(SIG_UNBLOCK, &mask, NULL);
+	pthread_mutex_lock(tdata.games_list_mutex);
+	update_resumed_players(1);
+	pthread_mutex_unlock(tdata.games_list_mutex);
+}
+
+/**
+ * Gets the seat of a human player given a file descriptor.
+ * @param[in] client_fd File descriptor of a client that is currently served.
+ * @return The seat or -1 when the client is a spectator or the bot.
+ */
+int
+get_player_seat(int client_fd) {
+	int seat;
+	if (tdata.game->bot != NULL
+			&& client_fd == tdata.game->bot->player.player_fd) {
+		return -1;
+	}
+	for (seat = 0; seat < 2; seat++) {
+		if (tdata.players_fd[seat] == client_fd) {
+			return seat;
+		}
+	}
+	return -1;
+}
+
+/**
+ * Keeps the seat of a player who lost the connection for SESSION_GRACE_MS,
+ * so the player can resume the game from a new connection with the session
+ * token. The player stays in the players list meanwhile.
+ * @param[in] seat      Seat of the player.
+ * @param[in] base_rdfs Bit array holding file descriptors being served by the current thread.
+ */
+void
+keep_player_seat(int seat, fd_set *base_rdfs) {
+	int fd = tdata.players_fd[seat];
+	pthread_mutex_lock(tdata.games_list_mutex);
+	tdata.game->players[seat]->player_fd = -1;
+	pthread_mutex_unlock(tdata.games_list_mutex);
+	LOG_INFO_TEXT(
+			"(Thread %d) Player %s lost the connection, seat kept for %d ms",
+			(int) pthread_self(), tdata.game->players[seat]->player_nick,
+			SESSION_GRACE_MS);
+	tdata.players_fd[seat] = -1;
+	tdata.away_until[seat] = get_monotonic_ms() + SESSION_GRACE_MS;
+	arm_timer(global_thread_wheel, &tdata.seat_timers[seat],
+			tdata.away_until[seat]);
+	if (tdata.game->current_player == fd) {
+		tdata.game->current_player = -1;
+		start_move_clock();
+	}
+	FD_CLR(fd, base_rdfs);
+	count_metric(METRIC_CONNECTIONS_CLOSED, 1);
+	if (TEMP_FAILURE_RETRY(close(fd)) < 0) {
+		ERR("close");
+	}
+}
+
+/**
+ * Ends the game when a disconnected player has not resumed it in time.
+ * @param[in] seat Seat of the player.
+ */
+void
+expire_kept_seat(int seat) {
+	pthread_mutex_lock(tdata.games_list_mutex);
+	if (tdata.game->players[seat]->player_fd == -1) {
+		/* resumes are refused from now on */
+		tdata.game->state = GAME_STATE_RESOLVED;
+		thwork = 0;
+		LOG_INFO_TEXT("(Thread %d) Player %s did not resume the game",
+				(int) pthread_self(), tdata.game->players[seat]->player_nick);
+	}
+	pthread_mutex_unlock(tdata.games_list_mutex);
 }
 
 /**
@@ -120,12 +302,24 @@ void
 cleanup_handler(void *arg) {
 	int i, j;
 	response_s response;
-	games_list_s **list = tdata.games_list;
+	player_s *away[2] = { NULL, NULL };
+	games_list_s *list = tdata.games_list;
 	thread_s *thread = NULL;
-	threads_list_s **tlist = tdata.threads_list;
+	threads_list_s *tlist = tdata.threads_list;
 	response.type = MSG_CLEANUP_RSP;
 	response.error = MSG_RSP_ERROR_NONE;
-	printf("Thread %d cleanup handler goes\n", (int) pthread_self());
+	LOG_INFO("Thread %d cleanup handler goes", (int) pthread_self());
+	/* a connection handed over meanwhile goes back to the lobby */
+	pthread_mutex_lock(tdata.games_list_mutex);
+	tdata.game->state = GAME_STATE_RESOLVED;
+	update_resumed_players(0);
+	pthread_mutex_unlock(tdata.games_list_mutex);
+	/* players who lost the connection, the seat kept or not */
+	for (j = 0; j < 2; j++) {
+		if (tdata.players_fd[j] == -1) {
+			away[j] = tdata.game->players[j];
+		}
+	}
 	for (i = 0; i < SPECTATORS_NO; i++) {
 		if (tdata.spectators_fd[i] != -1) {
 			FD_SET(tdata.spectators_fd[i], tdata.rd_fds);
@@ -136,22 +330,36 @@ cleanup_handler(void *arg) {
 	}
 	for (j = 0; j < 2; j++) {
 		if (tdata.players_fd[j] != -1) {
+			if (tdata.game->bot != NULL
+					&& tdata.players_fd[j] == tdata.game->bot->player.player_fd) {
+				/* the bot has no place in the lobby */
+				continue;
+			}
 			FD_SET(tdata.players_fd[j], tdata.rd_fds);
 			if (play == 1) {
 				send_response_message(tdata.players_fd[j], &response);
 			}
 		}
 	}
-	get_thread_by_id(*tlist, &thread, tdata.game->id);
+	get_thread_by_id(tlist, &thread, tdata.game->id);
 	if (thread != NULL) {
 		pthread_mutex_lock(tdata.threads_list_mutex);
 		remove_thread_from_list(tlist, thread);
 		pthread_mutex_unlock(tdata.threads_list_mutex);
 	}
-	destroy_board(tdata.game->board);
+	journal_game_ended(tdata.game, outcome);
 	pthread_mutex_lock(tdata.games_list_mutex);
 	remove_game_from_list(list, tdata.game);
 	pthread_mutex_unlock(tdata.games_list_mutex);
+	/* players who never came back leave the players list with the game */
+	pthread_mutex_lock(tdata.players_list_mutex);
+	for (j = 0; j < 2; j++) {
+		remove_player_from_list(tdata.players_list, away[j]);
+	}
+	pthread_mutex_unlock(tdata.players_list_mutex);
+	close_hint_channel(tdata.hints);
+	tdata.hints = NULL;
+	publish_lobby(tdata.lobby);
 	kill(tdata.parent_pid, SIGRTMIN + 11);
 }
 
@@ -188,42 +396,87 @@ get_pawn(int client_fd, game_s *game, char *pawn) {
 
 /**
  * Sends a message with current state of the board to all connected spectators.
+ * Sparse boards do not fit into a message, so spectators only receive the
+ * last move then.
+ * @param[in] move Structure containing the last move.
+ * \sa move_s
  */
 void
-send_broadcast_message(void) {
-	int i, j, k, size, index = 0;
-	char temp[NROWS * NCOLS];
+send_broadcast_message(move_s *move) {
+	int k, recipients = 0;
 	response_s response;
-	response.type = MSG_PRINT_BOARD_SPC_RSP;
-	size = get_board_size(tdata.game->board);
-	if (size == -1) {
-		response.error = MSG_RSP_INTERNAL_SERVER_ERROR;
-		for (k = 0; k < SPECTATORS_NO; k++) {
-			if (tdata.spectators_fd[k] == -1) {
-				continue;
-			}
-			send_response_message(tdata.spectators_fd[k], &response);
-		}
-		return;
+	if (tdata.game->sparse != NULL) {
+		response.type = MSG_PRINT_MOVE_SPC_RSP;
+		snprintf(response.payload, MAX_RSP_SIZE, "%d%s%d%s%c%s", move->x + 1,
+				PAYLOAD_DELIM, move->y + 1, PAYLOAD_DELIM, move->pawn,
+				PAYLOAD_DELIM);
+	} else {
+		response.type = MSG_PRINT_BOARD_SPC_RSP;
+		snprintf(response.payload, MAX_RSP_SIZE, "%d%s%s%s%016" PRIx64 "%s",
+				tdata.game->board->size, PAYLOAD_DELIM,
+				encode_board(tdata.game), PAYLOAD_DELIM,
+				tdata.game->board->hash, PAYLOAD_DELIM);
 	}
+	response.error = MSG_RSP_ERROR_NONE;
 
-	for (i = 0; i < NROWS; i++) {
-		for (j = 0; j < NCOLS; j++) {
-			temp[index] = tdata.game->board[i][j];
-			index++;
+	for (k = 0; k < SPECTATORS_NO; k++) {
+		if (tdata.spectators_fd[k] == -1) {
+			continue;
 		}
+		send_response_message(tdata.spectators_fd[k], &response);
+		recipients++;
 	}
+	record_fanout_metrics(recipients);
+}
 
-	snprintf(response.payload, MAX_RSP_SIZE, "%d%s%s%s", size, PAYLOAD_DELIM,
-			temp, PAYLOAD_DELIM);
+/**
+ * Looks the current position up in a solved table and tells all connected
+ * spectators who wins it with perfect play, when that changed since the last
+ * announcement. Players are not told, as they only read responses to their
+ * own requests.
+ * @param[in] move Structure containing the last move.
+ * \sa move_s
+ */
+void
+send_broadcast_forced_message(move_s *move) {
+	int k, x, y, outcome, best, recipients = 0;
+	char field, forced;
+	unsigned char cells[MAX_SOLVED_SIZE * MAX_SOLVED_SIZE];
+	response_s response;
+	game_s *game = tdata.game;
+	if (game->sparse != NULL || game->size > MAX_SOLVED_SIZE) {
+		return;
+	}
+	for (x = 0; x < game->size; x++) {
+		for (y = 0; y < game->size; y++) {
+			field = get_field(game->board, x, y);
+			cells[x * game->size + y] = field == 'x' ? 1 : field == 'o' ? 2 : 0;
+		}
+	}
+	if (lookup_solved_position(game->size, game->win_length, game->mode, cells,
+			&outcome, &best) == -1) {
+		return;
+	}
+	/* the outcome is seen by the player to move, the opponent of the last one */
+	forced = outcome == 0 ? '-'
+			: (outcome == -1) == (move->pawn == 'x') ? 'x' : 'o';
+	if (forced == game->forced) {
+		return;
+	}
+	game->forced = forced;
+	LOG_INFO("(Thread %d) Perfect play outcome: %c", (int) pthread_self(),
+			forced);
+	response.type = MSG_FORCED_OUTCOME_SPC_RSP;
 	response.error = MSG_RSP_ERROR_NONE;
-
+	snprintf(response.payload, MAX_RSP_SIZE, "%c%s", forced, PAYLOAD_DELIM);
 	for (k = 0; k < SPECTATORS_NO; k++) {
 		if (tdata.spectators_fd[k] == -1) {
 			continue;
 		}
 		send_response_message(tdata.spectators_fd[k], &response);
+		recipients++;
 	}
+	record_fanout_metrics(recipients);
 }
 
 /**
@@ -231,7 +484,7 @@ send_broadcast_message(void) {
  * is a draw. Then the game is ended.
  */
 void send_broadcast_draw_message(void) {
-	int k;
+	int k, recipients = 2;
 	response_s response;
 	response.type = MSG_PRINT_DRAW_RSP;
 	response.error = MSG_RSP_ERROR_NONE;
@@ -240,9 +493,11 @@ void send_broadcast_draw_message(void) {
 			continue;
 		}
 		send_response_message(tdata.spectators_fd[k], &response);
+		recipients++;
 	}
 	send_response_message(tdata.game->players[0]->player_fd, &response);
 	send_response_message(tdata.game->players[1]->player_fd, &response);
+	record_fanout_metrics(recipients);
 }
 
 /**
@@ -251,7 +506,7 @@ void send_broadcast_draw_message(void) {
  */
 void
 send_broadcast_win_message(int client_fd) {
-	int k, i = -1;
+	int k, i = -1, recipients = 0;
 	response_s response;
 	response.type = MSG_PRINT_RESULT_SPC_RSP;
 
@@ -269,38 +524,66 @@ send_broadcast_win_message(int client_fd) {
 				continue;
 			}
 			send_response_message(tdata.spectators_fd[k], &response);
+			recipients++;
 		}
+		record_fanout_metrics(recipients);
 	}
 }
 
 /**
- * Handles a request to print out current state of the board.
+ * Handles a request to print out current state of the board. The response
+ * holds the size of the board, its fields and the hash of the position.
  * @param[in] client_fd File descriptor of a client that is currently served.
  * @param[in] game      Pointer to a game structure that is currently played.
  * \sa game_s
  */
 void
 thread_handle_print_board_request(int client_fd, game_s *game) {
-	int i, j, size, index = 0;
-	char temp[NROWS * NCOLS];
 	response_s response;
 	response.type = MSG_PRINT_BOARD_RSP;
-	size = get_board_size(game->board);
-	if (size == -1) {
-		response.error = MSG_RSP_INTERNAL_SERVER_ERROR;
+	if (game->sparse != NULL) {
+		response.error = MSG_RSP_ERROR_BOARD_TOO_LARGE;
 		send_response_message(client_fd, &response);
 		return;
 	}
+	snprintf(response.payload, MAX_RSP_SIZE, "%d%s%s%s%016" PRIx64 "%s",
+			game->board->size, PAYLOAD_DELIM, encode_board(game), PAYLOAD_DELIM,
+			game->board->hash, PAYLOAD_DELIM);
 
-	for (i = 0; i < NROWS; i++) {
-		for (j = 0; j < NCOLS; j++) {
-			temp[index] = game->board[i][j];
-			index++;
-		}
-	}
+	response.error = MSG_RSP_ERROR_NONE;
+	send_response_message(client_fd, &response);
+}
 
-	snprintf(response.payload, MAX_RSP_SIZE, "%d%s%s%s", size, PAYLOAD_DELIM,
-			temp, PAYLOAD_DELIM);
+/**
+ * Handles a request to print out a page of occupied fields of a sparse board.
+ * The response holds the size of the board, the win length, the number of
+ * occupied fields and the page number followed by up to CELLS_PER_PAGE fields.
+ * @param[in] client_fd File descriptor of a client that is currently served.
+ * @param[in] request   Pointer to a structure containing the page number.
+ * @param[in] game      Pointer to a game structure that is currently played.
+ * \sa request_s game_s sparse_board_s
+ */
+void
+thread_handle_print_cells_request(int client_fd, request_s *request,
+		game_s *game) {
+	int page, used;
+	response_s response;
+	response.type = MSG_PRINT_CELLS_RSP;
+	if (game->sparse == NULL) {
+		response.error = MSG_RSP_ERROR_WRONG_MOVE;
+		send_response_message(client_fd, &response);
+		return;
+	}
+	page = atoi(request->payload);
+	if (page < 0) {
+		page = 0;
+	}
+	used = snprintf(response.payload, MAX_RSP_SIZE, "%d%s%d%s%d%s%d%s",
+			game->sparse->size, PAYLOAD_DELIM, game->sparse->win_length,
+			PAYLOAD_DELIM, game->sparse->no_cells, PAYLOAD_DELIM, page,
+			PAYLOAD_DELIM);
+	encode_sparse_cells(game->sparse, page * CELLS_PER_PAGE,
+			response.payload + used, MAX_RSP_SIZE - used);
 
 	response.error = MSG_RSP_ERROR_NONE;
 	send_response_message(client_fd, &response);
@@ -327,9 +610,62 @@ thread_handle_check_turn_request(int client_fd, game_s *game) {
 	send_response_message(client_fd, &response);
 }
 
+/**
+ * Ends the game when the player to move runs out of time: the opponent wins.
+ */
+void
+expire_move_clock(void) {
+	int loser = tdata.game->current_player, winner;
+	char pawn = 0;
+	response_s response;
+	if (play != 1 || loser == -1) {
+		return;
+	}
+	winner = check_current_player(loser);
+	get_pawn(loser, tdata.game, &pawn);
+	outcome = pawn == 'x' ? 'o' : 'x';
+	LOG_INFO("(Thread %d) Player with fd %d ran out of time",
+			(int) pthread_self(), loser);
+	send_broadcast_win_message(winner);
+	response.error = MSG_RSP_ERROR_TIMED_OUT;
+	memset(response.payload, 0, MAX_RSP_SIZE);
+	response.type = MSG_PRINT_LOST_RSP;
+	send_response_message(loser, &response);
+	if (winner != -1) {
+		response.type = MSG_PRINT_WIN_RSP;
+		send_response_message(winner, &response);
+	}
+	play = 0;
+	thwork = 0;
+}
+
+/**
+ * Serves the expired timers of the current thread.
+ * \sa timer_e
+ */
+void
+thread_handle_expired_timers(void) {
+	timer_s *timer, *next;
+	for (timer = expire_timers(global_thread_wheel, get_monotonic_ms());
+			timer != NULL; timer = next) {
+		next = timer->next;
+		switch (timer->kind) {
+		case TIMER_MOVE_CLOCK:
+			expire_move_clock();
+			break;
+		case TIMER_KEPT_SEAT:
+			expire_kept_seat(timer->key);
+			break;
+		default:
+			break;
+		}
+	}
+}
+
 /**
  * Handles a request to perform given move on the board. It also checks whether
- * the game has ended and then terminates the thread.
+ * the game has ended and then terminates the thread. In a gravity game the
+ * request holds only a column and the pawn falls onto the column's top.
  * @param[in] client_fd File descriptor of a client that is currently served.
  * @param[in] request   Pointer to a structure containing move coordinates details.
  * @param[in] game      Pointer to a game structure that is currently played.
@@ -337,12 +673,15 @@ thread_handle_check_turn_request(int client_fd, game_s *game) {
  */
 void thread_handle_make_move_request(int client_fd, request_s *request,
 		game_s *game) {
-	int lost, turn, validate_game = 0;
+	int lost, validate_game = 0;
 	char *result = NULL;
 	response_s response;
 	move_s move;
 	response.type = MSG_MAKE_MOVE_RSP;
 
+	if (game->bot != NULL && client_fd == game->bot->player.player_fd) {
+		game->bot->thinking = 0;
+	}
 	if (game->current_player != client_fd) {
 		response.error = MSG_RSP_ERROR_WRONG_TURN;
 		send_response_message(client_fd, &response);
@@ -350,21 +689,44 @@ void thread_handle_make_move_request(int client_fd, request_s *request,
 	}
 
 	result = strtok(request->payload, PAYLOAD_DELIM);
-	move.x = atoi(result) - 1;
-	result = strtok(NULL, PAYLOAD_DELIM);
-	move.y = atoi(result) - 1;
+	if (game->mode == GAME_MODE_GRAVITY) {
+		move.y = atoi(result) - 1;
+		if ((move.x = get_drop_row(game->heights, game->size, move.y)) == -1) {
+			response.error = MSG_RSP_ERROR_WRONG_MOVE;
+			send_response_message(client_fd, &response);
+			return;
+		}
+	} else {
+		move.x = atoi(result) - 1;
+		result = strtok(NULL, PAYLOAD_DELIM);
+		move.y = atoi(result) - 1;
+	}
 	get_pawn(client_fd, game, &move.pawn);
-	validate_game = make_move(game->board, &move, &game->free);
+	if (game->sparse != NULL) {
+		validate_game = make_sparse_move(game->sparse, &move, &game->free);
+	} else {
+		validate_game = make_move(game->board, &move, &game->free);
+	}
 	if (validate_game == -1) {
 		response.error = MSG_RSP_ERROR_WRONG_MOVE;
 		send_response_message(client_fd, &response);
 		return;
-	} else if (validate_game == 1) {
+	}
+	if (game->moves != NULL) {
+		game->moves[game->no_moves] = move;
+	}
+	game->no_moves++;
+	if (game->heights != NULL) {
+		game->heights[move.y]++;
+	}
+	journal_move(game, &move);
+	if (validate_game == 1) {
 		response_s response_lst;
 		response_lst.type = MSG_PRINT_LOST_RSP;
 		response_lst.error = MSG_RSP_ERROR_NONE;
 		response.type = MSG_PRINT_WIN_RSP;
 		response.error = MSG_RSP_ERROR_NONE;
+		outcome = move.pawn;
 		send_broadcast_win_message(client_fd);
 		send_response_message(client_fd, &response);
 
@@ -375,18 +737,22 @@ void thread_handle_make_move_request(int client_fd, request_s *request,
 		thwork = 0;
 		return;
 	} else if (validate_game == 2) {
+		outcome = '-';
 		send_broadcast_draw_message();
 		play = 0;
 		thwork = 0;
 		return;
 	}
-	if ((turn = check_current_player(client_fd)) != -1) {
-		game->current_player = turn;
-	}
+	/* nobody moves while the opponent is away */
+	game->current_player = check_current_player(client_fd);
+	start_move_clock();
 
+	/* the row tells a client of a gravity game where its pawn fell */
+	snprintf(response.payload, MAX_RSP_SIZE, "%d%s", move.x + 1, PAYLOAD_DELIM);
 	response.error = MSG_RSP_ERROR_NONE;
 	send_response_message(client_fd, &response);
-	send_broadcast_message();
+	send_broadcast_message(&move);
+	send_broadcast_forced_message(&move);
 }
 
 /**
@@ -428,6 +794,69 @@ thread_handle_giveup_request(int client_fd, fd_set *tbase_rdfs) {
 	send_response_message(client_fd, &response);
 }
 
+/**
+ * Handles a request for a hint: a suggested move and the chance to win of the
+ * player to move in the current position. It can be sent by a player or a
+ * spectator. The search runs on the hint pool; when the answer is not known
+ * at once it is sent later by thread_handle_hint_notices.
+ * @param[in] client_fd File descriptor of a client that is currently served.
+ * @param[in] game      Pointer to a game structure that is currently played.
+ * \sa game_s hint_notice_s
+ */
+void
+thread_handle_hint_request(int client_fd, game_s *game) {
+	char pawn = 'x';
+	search_s *search;
+	hint_notice_s notice;
+	response_s response;
+	if (game->sparse != NULL) {
+		response.type = MSG_HINT_RSP;
+		response.error = MSG_RSP_ERROR_BOARD_TOO_LARGE;
+		send_response_message(client_fd, &response);
+		return;
+	}
+	if ((search = malloc(sizeof(search_s))) == NULL) {
+		response.type = MSG_HINT_RSP;
+		response.error = MSG_RSP_INTERNAL_SERVER_ERROR;
+		send_response_message(client_fd, &response);
+		return;
+	}
+	get_pawn(game->current_player, game, &pawn);
+	load_search_position(search, game, pawn == 'x' ? 1 : 2);
+	if (request_hint(tdata.hints, client_fd, MSG_HINT_RSP, search, &notice)
+			== 1) {
+		get_hint_response(&notice, &response);
+		send_response_message(client_fd, &response);
+	}
+	free(search);
+}
+
+/**
+ * Sends finished hints to the clients that asked for them, as long as they
+ * are still players or spectators of the game.
+ * \sa hint_notice_s
+ */
+void
+thread_handle_hint_notices(void) {
+	int i, served;
+	hint_notice_s notice;
+	response_s response;
+	while (read_hint_notice(tdata.hints, &notice) == 0) {
+		served = (notice.client_fd == tdata.players_fd[0]
+				|| notice.client_fd == tdata.players_fd[1])
+				&& (tdata.game->bot == NULL
+						|| notice.client_fd
+								!= tdata.game->bot->player.player_fd);
+		for (i = 0; i < SPECTATORS_NO; i++) {
+			served |= notice.client_fd == tdata.spectators_fd[i];
+		}
+		if (served) {
+			get_hint_response(&notice, &response);
+			send_response_message(notice.client_fd, &response);
+		}
+	}
+}
+
 /**
  * Handles a request to return to main menu. It can be sent by a spectator connected to a game.
  * @param[in] client_fd  File descriptor of a client that is currently served.
@@ -443,12 +872,14 @@ thread_handle_back_to_menu_request(int client_fd, fd_set *tbase_rdfs) {
 		if (tdata.spectators_fd[i] == client_fd) {
 			tdata.spectators_fd[i] = -1;
 			tdata.game->no_connected_spectators--;
+			count_metric(METRIC_SPECTATORS_LEFT, 1);
+			publish_lobby(tdata.lobby);
 			FD_CLR(client_fd, tbase_rdfs);
 			FD_SET(client_fd, tdata.rd_fds);
 			send_response_message(client_fd, &response);
 		}
 	}
-	printf("(Thread %d) Spectator disconnected\n", (int) pthread_self());
+	LOG_INFO("(Thread %d) Spectator disconnected", (int) pthread_self());
 	kill(tdata.parent_pid, SIGRTMIN + 11);
 }
 
@@ -467,6 +898,9 @@ thread_request_handler(int client_fd, request_s *request, game_s *game,
 	case MSG_PRINT_BOARD_REQ:
 		thread_handle_print_board_request(client_fd, game);
 		break;
+	case MSG_PRINT_CELLS_REQ:
+		thread_handle_print_cells_request(client_fd, request, game);
+		break;
 	case MSG_CHECK_TURN_REQ:
 		thread_handle_check_turn_request(client_fd, game);
 		break;
@@ -476,6 +910,9 @@ thread_request_handler(int client_fd, request_s *request, game_s *game,
 	case MSG_LEAVE_MESSAGE_REQ:
 		thread_handle_leave_message_request(client_fd, request, game);
 		break;
+	case MSG_HINT_REQ:
+		thread_handle_hint_request(client_fd, game);
+		break;
 	case MSG_LEAVE_REQ:
 		thread_handle_giveup_request(client_fd, tbase_rdfs);
 		break;
@@ -497,26 +934,45 @@ thread_request_handler(int client_fd, request_s *request, game_s *game,
 void
 thread_communicate(int client_fd, fd_set *base_rdfs, thread_data_s *tdata) {
 	char buffer[MAX_MSG_SIZE];
+	int seat;
 	ssize_t size;
+	long long started;
 	request_s request;
 	pthread_t tid;
 	memset(&request, 0, sizeof(request_s));
 	tid = pthread_self();
 	size = bulk_read(client_fd, buffer, MAX_MSG_SIZE);
 	if (size == MAX_MSG_SIZE) {
-		fprintf(stderr, "(Thread %d) Message received from client fd: %d\n",
+		LOG_DEBUG("(Thread %d) Message received from client fd: %d",
 				(int) tid, client_fd);
+		count_metric(METRIC_BYTES_IN, size);
 		string_to_request(buffer, &request);
+		started = get_monotonic_ns();
 		thread_request_handler(client_fd, &request, tdata->game, base_rdfs);
+		record_request_metrics(request.type, get_monotonic_ns() - started);
+	}
+	if (size <= 0 && play == 1 && (seat = get_player_seat(client_fd)) != -1) {
+		keep_player_seat(seat, base_rdfs);
+		return;
 	}
 	if (size == 0) {
-		fprintf(stderr,
-				"(Thread %d) End of file. Removing player. Closing descriptor: %d\n",
+		LOG_INFO(
+				"(Thread %d) End of file. Removing player. Closing descriptor: %d",
 				(int) tid, client_fd);
+		/* the game points to a player, who is removed with the game */
+		if ((seat = get_player_seat(client_fd)) != -1) {
+			pthread_mutex_lock(tdata->games_list_mutex);
+			tdata->game->players[seat]->player_fd = -1;
+			pthread_mutex_unlock(tdata->games_list_mutex);
+		}
 		pthread_mutex_lock(tdata->players_list_mutex);
-		remove_player_from_list2(tdata->players_list, client_fd);
+		if (seat == -1) {
+			remove_player_from_list2(tdata->players_list, client_fd);
+		}
 		update_connected_players(client_fd);
 		pthread_mutex_unlock(tdata->players_list_mutex);
+		publish_lobby(tdata->lobby);
+		count_metric(METRIC_CONNECTIONS_CLOSED, 1);
 		if (TEMP_FAILURE_RETRY(close(client_fd)) < 0) {
 			ERR("close");
 		}
@@ -524,13 +980,23 @@ thread_communicate(int client_fd, fd_set *base_rdfs, thread_data_s *tdata) {
 
 	}
 	if (size < 0) {
-		fprintf(stderr,
-				"(Thread %d) Error. Removing player. Closing descriptor: %d\n",
+		LOG_WARNING(
+				"(Thread %d) Error. Removing player. Closing descriptor: %d",
 				(int) tid, client_fd);
+		/* the game points to a player, who is removed with the game */
+		if ((seat = get_player_seat(client_fd)) != -1) {
+			pthread_mutex_lock(tdata->games_list_mutex);
+			tdata->game->players[seat]->player_fd = -1;
+			pthread_mutex_unlock(tdata->games_list_mutex);
+		}
 		pthread_mutex_lock(tdata->players_list_mutex);
-		remove_player_from_list2(tdata->players_list, client_fd);
+		if (seat == -1) {
+			remove_player_from_list2(tdata->players_list, client_fd);
+		}
 		update_connected_players(client_fd);
 		pthread_mutex_unlock(tdata->players_list_mutex);
+		publish_lobby(tdata->lobby);
+		count_metric(METRIC_CONNECTIONS_CLOSED, 1);
 		if (TEMP_FAILURE_RETRY(close(client_fd)) < 0) {
 			ERR("close");
 		}
@@ -557,6 +1023,10 @@ prepare_descriptor_set(fd_set *base_rdfs) {
 			fdmax = max(fdmax, tdata.spectators_fd[i]);
 		}
 	}
+	if (tdata.hints != NULL) {
+		FD_SET(tdata.hints->fds[0], base_rdfs);
+		fdmax = max(fdmax, tdata.hints->fds[0]);
+	}
 	return fdmax;
 }
 
@@ -566,29 +1036,76 @@ prepare_descriptor_set(fd_set *base_rdfs) {
  */
 void
 *thread_work(void *thread_args) {
-	int i, fdmax;
+	int i, fdmax, ready;
+	long long left;
 	fd_set base_rdfs, rdfs;
 	pthread_t tid;
+	sigset_t mask, oldmask;
+	struct timespec retry, *timeout;
+	timer_wheel_s wheel;
 	memcpy(&tdata, (thread_data_s*) thread_args, sizeof(thread_data_s));
 	global_thread_rdfs = &base_rdfs;
 	global_thrad_fdmax = &fdmax;
+	global_thread_wheel = &wheel;
+	init_timer_wheel(&wheel, get_monotonic_ms());
+	for (i = 0; i < 2; i++) {
+		init_timer(&tdata.seat_timers[i], TIMER_KEPT_SEAT, i);
+	}
+	init_timer(&tdata.move_timer, TIMER_MOVE_CLOCK, 0);
 	tid = pthread_self();
-	printf("Thread %d started\n", (int) tid);
+	LOG_INFO("Thread %d started", (int) tid);
+	tdata.hints = create_hint_channel();
 	if ((fdmax = prepare_descriptor_set(&base_rdfs)) == -1) {
-		fprintf(stderr, "(Thread %d) Unable to prepare descriptor set\n", (int) tid);
+		LOG_ERROR("(Thread %d) Unable to prepare descriptor set", (int) tid);
 		exit(EXIT_FAILURE);
 	}
 	if (sethandler(sig_handler, SIGRTMIN + 1)) {
 		ERR("Setting SIGRTMIN + 1:");
 	}
+	/* new spectators and resumed players are taken in only inside pselect */
+	sigemptyset(&mask);
+	sigaddset(&mask, SIGRTMIN + 1);
+	pthread_sigmask(SIG_BLOCK, &mask, &oldmask);
+	start_move_clock();
 	while (thwork) {
+		count_metric(METRIC_GAME_LOOP_ITERATIONS, 1);
+		thread_handle_expired_timers();
+		if (!thwork) {
+			break;
+		}
 		rdfs = base_rdfs;
-		if (pselect(fdmax + 1, &rdfs, NULL, NULL, NULL, NULL) > 0) {
+		timeout = NULL;
+		if ((left = get_timer_wheel_timeout(&wheel, get_monotonic_ms()))
+				!= -1) {
+			retry.tv_sec = left / 1000;
+			retry.tv_nsec = (left % 1000) * 1000000;
+			timeout = &retry;
+		}
+		if (play == 1 && tdata.game->bot != NULL && !tdata.game->bot->thinking
+				&& tdata.game->current_player
+						== tdata.game->bot->player.player_fd
+				&& start_bot_search(tdata.game->bot, tdata.game) == -1) {
+			/* the pool is busy, try again a little later */
+			if (timeout == NULL || left * 1000000 > BOT_RETRY_NS) {
+				retry.tv_sec = BOT_RETRY_NS / 1000000000;
+				retry.tv_nsec = BOT_RETRY_NS % 1000000000;
+				timeout = &retry;
+			}
+		}
+		if ((ready = pselect(fdmax + 1, &rdfs, NULL, NULL, timeout, &oldmask))
+				> 0) {
 			for (i = 0; i <= fdmax; i++) {
-				if (FD_ISSET(i, &rdfs)) {
+				if (!FD_ISSET(i, &rdfs)) {
+					continue;
+				}
+				if (tdata.hints != NULL && i == tdata.hints->fds[0]) {
+					thread_handle_hint_notices();
+				} else {
 					thread_communicate(i, &base_rdfs, &tdata);
 				}
 			}
+		} else if (ready == 0) {
+			continue;
 		} else {
 			if (EINTR == errno)
 				continue;
@@ -597,7 +1114,7 @@ void
 	}
 	pthread_cleanup_push(cleanup_handler, NULL);
 	pthread_cleanup_pop(1);
-	printf("Thread %d ended\n", (int) tid);
+	LOG_INFO("Thread %d ended", (int) tid);
 	pthread_exit(NULL);
 	return NULL;
 }
@@ -616,7 +1133,7 @@ int
 create_new_thread(thread_s **new_thread, pthread_t thread, int id) {
 	(*new_thread) = malloc(sizeof(thread_s));
 	if ((*new_thread) == NULL) {
-		fprintf(stderr, "Failed to allocate memory for new thread\n");
+		LOG_ERROR("Failed to allocate memory for new thread");
 		return -1;
 	}
 	(*new_thread)->game_id = id;
@@ -0,0 +1,253 @@
+/**
+ * @file timer_wheel.c
+ * @ingroup timer_wheel
+ *
+ * @author Piotr Janaszek <janas03@yahoo.pl>
+ * @date Created on: Oct 18, 2026
+ *
+ * @brief File containing methods for timing wheels.
+ *
+ * A timing wheel keeps timers in slots of TIMER_TICK_MS ticks. Level 0 holds
+ * the timers expiring within the current run of TIMER_WHEEL_SLOTS ticks, level
+ * 1 the timers of the following runs within the current run of runs, and so
+ * on. A timer is held at the level of the highest base-TIMER_WHEEL_SLOTS
+ * digit its tick differs from the current tick in, so it never lands in the
+ * slot the wheel is at. When the wheel reaches a slot of a higher level the
+ * timers held there are moved down a level or more. Arming and cancelling a
+ * timer is a few pointer writes, and a bitmap of occupied slots per level
+ * gives the next tick something happens at without scanning slots, so the
+ * wheel jumps over idle ticks and its owner sleeps until then. Every event
+ * loop owns its wheel and nothing is locked.
+ */
+
+#include <stdlib.h>
+
+#include "config.h"
+#include "structs.h"
+
+/**
+ * Number of bits of a tick each level of a wheel covers.
+ */
+#define TIMER_WHEEL_BITS 6
+
+/**
+ * Initializes a wheel to start at the current time.
+ * @param[in] wheel  Pointer to the wheel.
+ * @param[in] now_ms The current monotonic time in milliseconds.
+ * \sa timer_wheel_s
+ */
+void
+init_timer_wheel(timer_wheel_s *wheel, long long now_ms) {
+	int i, j;
+	wheel->now = now_ms / TIMER_TICK_MS;
+	wheel->count = 0;
+	for (i = 0; i < TIMER_WHEEL_LEVELS; i++) {
+		wheel->occupied[i] = 0;
+		for (j = 0; j < TIMER_WHEEL_SLOTS; j++) {
+			wheel->slots[i][j] = NULL;
+		}
+	}
+}
+
+/**
+ * Initializes a timer that is not armed.
+ * @param[in] timer Pointer to the timer.
+ * @param[in] kind  What the timer times.
+ * @param[in] key   File descriptor, game ID or seat the timer belongs to.
+ * \sa timer_s timer_e
+ */
+void
+init_timer(timer_s *timer, timer_e kind, int key) {
+	timer->kind = kind;
+	timer->key = key;
+	timer->tick = 0;
+	timer->level = -1;
+	timer->prev = NULL;
+	timer->next = NULL;
+}
+
+/**
+ * Checks whether a timer is armed.
+ * @param[in] timer Pointer to the timer.
+ * @return 1 if the timer is armed, 0 otherwise.
+ */
+int
+is_timer_armed(const timer_s *timer) {
+	return timer->level != -1;
+}
+
+/**
+ * Gets the slot of the level a timer is held at.
+ * @param[in] timer Pointer to the timer.
+ * @return The slot.
+ */
+int
+get_timer_slot(const timer_s *timer) {
+	return (timer->tick >> (TIMER_WHEEL_BITS * timer->level))
+			& (TIMER_WHEEL_SLOTS - 1);
+}
+
+/**
+ * Puts a timer into its slot or, when its tick is the current one, onto the
+ * list of expired timers.
+ * @param[in]     wheel   Pointer to the wheel.
+ * @param[in]     timer   Pointer to the timer.
+ * @param[in,out] expired Pointer to the list of expired timers.
+ */
+void
+insert_timer(timer_wheel_s *wheel, timer_s *timer, timer_s **expired) {
+	int slot;
+	unsigned long long diff = timer->tick ^ wheel->now;
+	if (diff == 0) {
+		timer->level = -1;
+		timer->next = *expired;
+		*expired = timer;
+		return;
+	}
+	timer->level = (63 - __builtin_clzll(diff)) / TIMER_WHEEL_BITS;
+	if (timer->level >= TIMER_WHEEL_LEVELS) {
+		/* ticks that far ahead are never reached */
+		timer->level = TIMER_WHEEL_LEVELS - 1;
+	}
+	slot = get_timer_slot(timer);
+	timer->prev = NULL;
+	timer->next = wheel->slots[timer->level][slot];
+	if (timer->next != NULL) {
+		timer->next->prev = timer;
+	}
+	wheel->slots[timer->level][slot] = timer;
+	wheel->occupied[timer->level] |= (uint64_t) 1 << slot;
+	wheel->count++;
+}
+
+/**
+ * Cancels a timer. Cancelling a timer that is not armed does nothing.
+ * @param[in] wheel Pointer to the wheel.
+ * @param[in] timer Pointer to the timer.
+ * \sa timer_wheel_s timer_s
+ */
+void
+cancel_timer(timer_wheel_s *wheel, timer_s *timer) {
+	int slot;
+	if (timer->level == -1) {
+		return;
+	}
+	slot = get_timer_slot(timer);
+	if (timer->prev != NULL) {
+		timer->prev->next = timer->next;
+	} else {
+		wheel->slots[timer->level][slot] = timer->next;
+	}
+	if (timer->next != NULL) {
+		timer->next->prev = timer->prev;
+	}
+	if (wheel->slots[timer->level][slot] == NULL) {
+		wheel->occupied[timer->level] &= ~((uint64_t) 1 << slot);
+	}
+	timer->level = -1;
+	timer->prev = NULL;
+	timer->next = NULL;
+	wheel->count--;
+}
+
+/**
+ * Arms a timer, cancelling it first if it is armed. A timer expiring in the
+ * past expires at the next tick.
+ * @param[in] wheel      Pointer to the wheel.
+ * @param[in] timer      Pointer to the timer.
+ * @param[in] expires_ms Monotonic time in milliseconds the timer expires at.
+ * \sa timer_wheel_s timer_s
+ */
+void
+arm_timer(timer_wheel_s *wheel, timer_s *timer, long long expires_ms) {
+	cancel_timer(wheel, timer);
+	timer->tick = (expires_ms + TIMER_TICK_MS - 1) / TIMER_TICK_MS;
+	if (timer->tick <= wheel->now) {
+		timer->tick = wheel->now + 1;
+	}
+	insert_timer(wheel, timer, NULL);
+}
+
+/**
+ * Finds the next tick the wheel has something to do at: a slot of level 0 to
+ * expire or a slot of a higher level to move down.
+ * @param[in] wheel Pointer to the wheel.
+ * @return The tick or -1 when no timer is armed.
+ */
+long long
+get_next_tick(timer_wheel_s *wheel) {
+	int level, shift, slot;
+	uint64_t later;
+	if (wheel->count == 0) {
+		return -1;
+	}
+	for (level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+		shift = TIMER_WHEEL_BITS * level;
+		slot = (wheel->now >> shift) & (TIMER_WHEEL_SLOTS - 1);
+		later = wheel->occupied[level] & ~((2ULL << slot) - 1);
+		if (later != 0) {
+			return (wheel->now >> (shift + TIMER_WHEEL_BITS)
+					<< (shift + TIMER_WHEEL_BITS))
+					| ((long long) __builtin_ctzll(later) << shift);
+		}
+	}
+	return -1;
+}
+
+/**
+ * Gets the time the owner of a wheel may sleep for.
+ * @param[in] wheel  Pointer to the wheel.
+ * @param[in] now_ms The current monotonic time in milliseconds.
+ * @return Time in milliseconds until the next tick the wheel has something to
+ * do at or -1 when no timer is armed.
+ */
+long long
+get_timer_wheel_timeout(timer_wheel_s *wheel, long long now_ms) {
+	long long next = get_next_tick(wheel);
+	if (next == -1) {
+		return -1;
+	}
+	return next * TIMER_TICK_MS > now_ms ? next * TIMER_TICK_MS - now_ms : 0;
+}
+
+/**
+ * Turns a wheel to the current time and takes out the expired timers. The
+ * wheel jumps straight to the ticks it has something to do at. The expired
+ * timers are no longer armed, so they may be armed again while the list is
+ * walked once the next timer is remembered.
+ * @param[in] wheel  Pointer to the wheel.
+ * @param[in] now_ms The current monotonic time in milliseconds.
+ * @return List of the expired timers linked by next, NULL if none expired.
+ * \sa timer_wheel_s timer_s
+ */
+timer_s*
+expire_timers(timer_wheel_s *wheel, long long now_ms) {
+	int level, slot;
+	long long next, target = now_ms / TIMER_TICK_MS;
+	timer_s *timer, *moved, *expired = NULL;
+	while (wheel->now < target) {
+		if ((next = get_next_tick(wheel)) == -1 || next > target) {
+			wheel->now = target;
+			break;
+		}
+		wheel->now = next;
+		/* the slots reached at higher levels move down, the top first */
+		for (level = TIMER_WHEEL_LEVELS - 1; level >= 0; level--) {
+			if (level > 0 && (wheel->now
+					& ((1LL << (TIMER_WHEEL_BITS * level)) - 1)) != 0) {
+				continue;
+			}
+			slot = (wheel->now >> (TIMER_WHEEL_BITS * level))
+					& (TIMER_WHEEL_SLOTS - 1);
+			moved = wheel->slots[level][slot];
+			wheel->slots[level][slot] = NULL;
+			wheel->occupied[level] &= ~((uint64_t) 1 << slot);
+			while ((timer = moved) != NULL) {
+				moved = timer->next;
+				wheel->count--;
+				insert_timer(wheel, timer, &expired);
+			}
+		}
+	}
+	return expired;
+}
@@ -0,0 +1,24 @@
+/**
+ * @file timer_wheel.h
+ * @ingroup timer_wheel
+ *
+ * @author Piotr Janaszek <janas03@yahoo.pl>
+ * @date Created on: Oct 18, 2026
+ *
+ * @brief File containing methods for timing wheels.
+ */
+
+#ifndef TIMER_WHEEL_H_
+#define TIMER_WHEEL_H_
+
+#include "structs.h"
+
+void init_timer_wheel(timer_wheel_s *wheel, long long now_ms);
+void init_timer(timer_s *timer, timer_e kind, int key);
+int is_timer_armed(const timer_s *timer);
+void cancel_timer(timer_wheel_s *wheel, timer_s *timer);
+void arm_timer(timer_wheel_s *wheel, timer_s *timer, long long expires_ms);
+long long get_timer_wheel_timeout(timer_wheel_s *wheel, long long now_ms);
+timer_s* expire_timers(timer_wheel_s *wheel, long long now_ms);
+
+#endif /* TIMER_WHEEL_H_ */
@@ -0,0 +1,394 @@
+/**
+ * @file verifier.c
+ * @ingroup verifier
+ *
+ * @author Piotr Janaszek <janas03@yahoo.pl>
+ * @date Created on: Oct 18, 2026
+ *
+ * @brief File containing the verifier replaying recorded games by the rules of the server.
+ *
+ * The verifier reads recorded games, one per line in the form
+ * size#K#mode#x;y#x;y#...#r# with coordinates counted from 1 and an optional
+ * outcome r: 'x' or 'o' for the winner, '-' for a draw or '*' for a game not
+ * finished. Every game is replayed with the board of the server, checking
+ * that each move is legal, that no move follows the end and that the game
+ * ends as recorded. The file is mapped into memory and cut into chunks of
+ * VERIFIER_CHUNK_SIZE bytes, a line belonging to the chunk it starts in.
+ * Every worker thread starts with an equal range of chunks and steals half
+ * of the range of another worker when its own is used up. Records are read
+ * in place and boards are allocated from an arena of the worker reset for
+ * every game, so no memory is allocated per game. Faulty records are printed
+ * with their offsets in the file, and the number of games per second is
+ * reported at the end.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "arena.h"
+#include "board_handler.h"
+#include "common.h"
+#include "config.h"
+#include "structs.h"
+
+/**
+ * Prints out parameters required to start the application
+ * @param[in] name Name of the verifier application file.
+ */
+void
+usage(char *name) {
+	fprintf(stderr, "Usage: %s [-t threads] file\n", name);
+	fprintf(stderr, "threads - number of worker threads, default one per core\n");
+	fprintf(stderr, "file    - recorded games, one per line: size#K#mode#x;y#...#outcome#\n");
+}
+
+/**
+ * Reads a number of a record followed by a delimiter.
+ * @param[in,out] text      Pointer to the position in the record, moved past the delimiter.
+ * @param[in]     end       End of the record.
+ * @param[in]     delimiter The character expected after the number.
+ * @param[out]    value     The number.
+ * @retval  0 When the number is read.
+ * @retval -1 When there is no number or delimiter.
+ */
+int
+read_record_number(const char **text, const char *end, char delimiter,
+		int *value) {
+	const char *p = *text;
+	*value = 0;
+	while (p < end && *p >= '0' && *p <= '9' && *value < 1000000) {
+		*value = *value * 10 + *p++ - '0';
+	}
+	if (p == *text || p == end || *p != delimiter) {
+		return -1;
+	}
+	*text = p + 1;
+	return 0;
+}
+
+/**
+ * Replays a recorded game and checks it.
+ * @param[in] worker Pointer to the worker.
+ * @param[in] text   The beginning of the record.
+ * @param[in] end    The end of the record, without the line break.
+ * @return NULL when the game is valid or the reason it is not.
+ * \sa verifier_worker_s
+ */
+const char*
+verify_game(verifier_worker_s *worker, const char *text, const char *end) {
+	int size, win_length, mode, x, y, empty, result = 0, ply = 0;
+	int heights[MAX_BOARD_SIZE] = { 0 };
+	char outcome = 0;
+	board_s *board;
+	move_s move;
+	if (read_record_number(&text, end, PAYLOAD_DELIM[0], &size) == -1
+			|| read_record_number(&text, end, PAYLOAD_DELIM[0], &win_length)
+					== -1
+			|| read_record_number(&text, end, PAYLOAD_DELIM[0], &mode) == -1) {
+		worker->malformed++;
+		return "malformed header";
+	}
+	if (size < MIN_BOARD_SIZE || size > MAX_BOARD_SIZE
+			|| win_length < MIN_WIN_LENGTH || win_length > MAX_WIN_LENGTH
+			|| win_length > size || mode >= GAME_MODES_NO) {
+		worker->malformed++;
+		return "unsupported rules";
+	}
+	reset_arena(worker->arena);
+	if ((board = create_new_board(worker->arena, size, win_length)) == NULL) {
+		worker->malformed++;
+		return "unsupported rules";
+	}
+	empty = size * size;
+	while (text < end) {
+		if (end - text >= 2 && text[1] == PAYLOAD_DELIM[0]
+				&& strchr("xo-*", text[0]) != NULL) {
+			outcome = text[0];
+			text += 2;
+			break;
+		}
+		if (read_record_number(&text, end, INNER_DELIM[0], &x) == -1
+				|| read_record_number(&text, end, PAYLOAD_DELIM[0], &y) == -1) {
+			worker->malformed++;
+			return "malformed move";
+		}
+		if (result != 0) {
+			worker->illegal++;
+			return "move after the end";
+		}
+		move.x = x - 1;
+		move.y = y - 1;
+		move.pawn = ply % 2 == 0 ? 'x' : 'o';
+		if (mode == GAME_MODE_GRAVITY
+				&& get_drop_row(heights, size, move.y) != move.x) {
+			worker->illegal++;
+			return "illegal move";
+		}
+		if ((result = make_move(board, &move, &empty)) == -1) {
+			worker->illegal++;
+			return "illegal move";
+		}
+		if (mode == GAME_MODE_GRAVITY) {
+			heights[move.y]++;
+		}
+		worker->moves++;
+		ply++;
+	}
+	if (text != end) {
+		worker->malformed++;
+		return "data after the outcome";
+	}
+	if (outcome != 0 && outcome != (result == 1 ? move.pawn
+			: result == 2 ? '-' : '*')) {
+		worker->wrong_outcome++;
+		return "wrong outcome";
+	}
+	return NULL;
+}
+
+/**
+ * Verifies the records starting in a chunk of the file.
+ * @param[in] worker Pointer to the worker.
+ * @param[in] chunk  Number of the chunk.
+ * \sa verifier_worker_s
+ */
+void
+verify_chunk(verifier_worker_s *worker, long chunk) {
+	const char *data = worker->verifier->data, *line, *end, *next, *reason;
+	size_t length = worker->verifier->length;
+	size_t first = chunk * (size_t) VERIFIER_CHUNK_SIZE, last;
+	last = first + VERIFIER_CHUNK_SIZE < length ?
+			first + VERIFIER_CHUNK_SIZE : length;
+	line = data + first;
+	/* a line started in the previous chunk belongs to that chunk */
+	if (first > 0 && data[first - 1] != '\n') {
+		if ((line = memchr(line, '\n', length - first)) == NULL) {
+			return;
+		}
+		line++;
+	}
+	while (line < data + last) {
+		if ((next = memchr(line, '\n', data + length - line)) == NULL) {
+			next = data + length;
+		}
+		end = next;
+		if (end > line && end[-1] == '\r') {
+			end--;
+		}
+		if (end > line) {
+			worker->games++;
+			if ((reason = verify_game(worker, line, end)) != NULL) {
+				printf("%zu %s\n", (size_t) (line - data), reason);
+			}
+		}
+		line = next + 1;
+	}
+}
+
+/**
+ * Takes the first chunk left in the worker's own range.
+ * @param[in] worker Pointer to the worker.
+ * @return Number of the chunk or -1 when the range is empty.
+ */
+long
+pop_chunk(verifier_worker_s *worker) {
+	uint64_t range = __atomic_load_n(&worker->range, __ATOMIC_ACQUIRE);
+	while ((range >> 32) < (range & 0xffffffff)) {
+		if (__atomic_compare_exchange_n(&worker->range, &range,
+				range + ((uint64_t) 1 << 32), 0, __ATOMIC_ACQ_REL,
+				__ATOMIC_ACQUIRE)) {
+			return range >> 32;
+		}
+	}
+	return -1;
+}
+
+/**
+ * Steals the upper half of the range of another worker. The first stolen
+ * chunk is returned and the rest becomes the worker's own range, which is
+ * empty before, so no other thread changes it meanwhile.
+ * @param[in] worker Pointer to the worker.
+ * @return Number of the chunk or -1 when no worker has chunks left.
+ */
+long
+steal_chunks(verifier_worker_s *worker) {
+	int i;
+	uint64_t range, first, end, half;
+	verifier_s *verifier = worker->verifier;
+	verifier_worker_s *victim;
+	for (i = 1; i < verifier->no_workers; i++) {
+		victim = verifier->workers[(worker->id + i) % verifier->no_workers];
+		range = __atomic_load_n(&victim->range, __ATOMIC_ACQUIRE);
+		while ((first = range >> 32) < (end = range & 0xffffffff)) {
+			half = (end - first + 1) / 2;
+			if (__atomic_compare_exchange_n(&victim->range, &range,
+					first << 32 | (end - half), 0, __ATOMIC_ACQ_REL,
+					__ATOMIC_ACQUIRE)) {
+				__atomic_store_n(&worker->range, (end - half + 1) << 32 | end,
+						__ATOMIC_RELEASE);
+				worker->steals++;
+				return end - half;
+			}
+		}
+	}
+	return -1;
+}
+
+/**
+ * Main function of a worker thread.
+ * @param[in] arg Pointer to the worker.
+ * \sa verifier_worker_s
+ */
+void*
+verifier_work(void *arg) {
+	long chunk;
+	verifier_worker_s *worker = (verifier_worker_s*) arg;
+	while ((chunk = pop_chunk(worker)) != -1
+			|| (chunk = steal_chunks(worker)) != -1) {
+		verify_chunk(worker, chunk);
+	}
+	return NULL;
+}
+
+/**
+ * Creates a worker with an arena holding a board of any supported rules.
+ * @param[in] verifier Pointer to the verified games.
+ * @param[in] id       Number of the worker.
+ * @param[in] first    The first chunk of the worker.
+ * @param[in] end      The end of the chunks of the worker.
+ * @return Pointer to the worker or NULL upon error.
+ * \sa verifier_worker_s
+ */
+verifier_worker_s*
+create_verifier_worker(verifier_s *verifier, int id, uint64_t first,
+		uint64_t end) {
+	int size, win_length;
+	size_t bytes = 0;
+	verifier_worker_s *worker;
+	/* workers are cache-line-aligned, so their counters are not shared */
+	if (posix_memalign((void**) &worker, CACHE_LINE_SIZE,
+			sizeof(verifier_worker_s)) != 0) {
+		return NULL;
+	}
+	memset(worker, 0, sizeof(verifier_worker_s));
+	for (size = MIN_BOARD_SIZE; size <= MAX_BOARD_SIZE; size++) {
+		for (win_length = MIN_WIN_LENGTH;
+				win_length <= MAX_WIN_LENGTH && win_length <= size;
+				win_length++) {
+			if (get_board_arena_size(size, win_length) > bytes) {
+				bytes = get_board_arena_size(size, win_length);
+			}
+		}
+	}
+	if ((worker->arena = create_arena(bytes)) == NULL) {
+		free(worker);
+		return NULL;
+	}
+	worker->id = id;
+	worker->verifier = verifier;
+	worker->range = first << 32 | end;
+	return worker;
+}
+
+/**
+ * The main procedure.
+ * @param argc The command line.
+ * @param argv The number of options in the command line.
+ * @retval EXIT_SUCCESS When all games are valid.
+ * @retval EXIT_FAILURE When a game is not valid or an error occurs.
+ */
+int
+main(int argc, char **argv) {
+	int i, c, fd, threads = sysconf(_SC_NPROCESSORS_ONLN);
+	long no_chunks, games = 0, moves = 0, illegal = 0, wrong = 0;
+	long malformed = 0, steals = 0;
+	long long elapsed;
+	struct stat st;
+	verifier_s verifier;
+	while ((c = getopt(argc, argv, "t:")) != -1) {
+		switch (c) {
+		case 't':
+			threads = atoi(optarg);
+			break;
+		default:
+			usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+	if (optind != argc - 1 || threads <= 0) {
+		usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+	if ((fd = open(argv[optind], O_RDONLY)) == -1 || fstat(fd, &st) == -1) {
+		perror("Open games:");
+		return EXIT_FAILURE;
+	}
+	verifier.length = st.st_size;
+	verifier.data = verifier.length == 0 ? NULL : mmap(NULL,
+			verifier.length, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (verifier.data == MAP_FAILED) {
+		perror("mmap");
+		return EXIT_FAILURE;
+	}
+	if (verifier.length > 0) {
+		madvise((void*) verifier.data, verifier.length, MADV_SEQUENTIAL);
+	}
+	no_chunks = (verifier.length + VERIFIER_CHUNK_SIZE - 1)
+			/ VERIFIER_CHUNK_SIZE;
+	verifier.no_workers = threads;
+	if ((verifier.workers = calloc(threads, sizeof(verifier_worker_s*)))
+			== NULL) {
+		fprintf(stderr, "Cannot allocate memory for workers\n");
+		return EXIT_FAILURE;
+	}
+	for (i = 0; i < threads; i++) {
+		if ((verifier.workers[i] = create_verifier_worker(&verifier, i,
+				no_chunks * i / threads, no_chunks * (i + 1) / threads))
+				== NULL) {
+			fprintf(stderr, "Cannot allocate memory for workers\n");
+			return EXIT_FAILURE;
+		}
+	}
+	elapsed = get_monotonic_ms();
+	for (i = 0; i < threads; i++) {
+		if (pthread_create(&verifier.workers[i]->thread, NULL, verifier_work,
+				verifier.workers[i]) != 0) {
+			fprintf(stderr, "Cannot start a worker\n");
+			return EXIT_FAILURE;
+		}
+	}
+	/* workers steal from each other, so none is freed before all end */
+	for (i = 0; i < threads; i++) {
+		pthread_join(verifier.workers[i]->thread, NULL);
+	}
+	elapsed = get_monotonic_ms() - elapsed;
+	for (i = 0; i < threads; i++) {
+		games += verifier.workers[i]->games;
+		moves += verifier.workers[i]->moves;
+		illegal += verifier.workers[i]->illegal;
+		wrong += verifier.workers[i]->wrong_outcome;
+		malformed += verifier.workers[i]->malformed;
+		steals += verifier.workers[i]->steals;
+		destroy_arena(verifier.workers[i]->arena);
+		free(verifier.workers[i]);
+	}
+	free(verifier.workers);
+	if (verifier.length > 0) {
+		munmap((void*) verifier.data, verifier.length);
+	}
+	fprintf(stderr,
+			"%ld games, %ld moves: %ld illegal, %ld wrong outcome, %ld malformed\n",
+			games, moves, illegal, wrong, malformed);
+	fprintf(stderr, "%lld ms, %lld games/s on %d threads, %ld steals\n",
+			elapsed, games * 1000LL / (elapsed > 0 ? elapsed : 1), threads,
+			steals);
+	return illegal + wrong + malformed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,103 @@
+/**
+ * @file zobrist.c
+ * @ingroup zobrist
+ *
+ * @author Piotr Janaszek <janas03@yahoo.pl>
+ * @date Created on: Oct 18, 2026
+ *
+ * @brief File containing Zobrist keys used to hash positions.
+ *
+ * Every pawn on every field has a random 64-bit key and the hash of a position
+ * is the xor of the keys of all its pawns, so a move updates the hash with a
+ * single xor. The keys of boards of every size up to MAX_BOARD_SIZE are drawn
+ * from a splitmix64 generator seeded with ZOBRIST_SEED and the board size, so
+ * the same position hashes to the same value in every process, the client
+ * included. Sparse boards are too large for tables and derive the key of a
+ * field by mixing its coordinates instead.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+#include "config.h"
+#include "zobrist.h"
+
+/**
+ * Keys indexed by board size, player and field.
+ */
+static uint64_t zobrist_keys[MAX_BOARD_SIZE - MIN_BOARD_SIZE + 1][2][MAX_BOARD_SIZE
+		* MAX_BOARD_SIZE];
+
+/**
+ * Guard making the tables filled exactly once.
+ */
+static pthread_once_t zobrist_once = PTHREAD_ONCE_INIT;
+
+/**
+ * Advances a splitmix64 generator.
+ * @param[in] state Pointer to the state of the generator.
+ * @return Next pseudo-random number.
+ */
+uint64_t
+splitmix64(uint64_t *state) {
+	uint64_t z = (*state += 0x9e3779b97f4a7c15ULL);
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+	return z ^ (z >> 31);
+}
+
+/**
+ * Fills the key tables of all board sizes.
+ */
+void
+fill_zobrist_keys(void) {
+	int size, pawn, i;
+	uint64_t state;
+	for (size = MIN_BOARD_SIZE; size <= MAX_BOARD_SIZE; size++) {
+		state = ZOBRIST_SEED ^ (uint64_t) size;
+		for (pawn = 0; pawn < 2; pawn++) {
+			for (i = 0; i < size * size; i++) {
+				zobrist_keys[size - MIN_BOARD_SIZE][pawn][i] = splitmix64(&state);
+			}
+		}
+	}
+}
+
+/**
+ * Fills the key tables unless it is already done. It has to be called before
+ * the first call to get_zobrist_key.
+ */
+void
+init_zobrist_keys(void) {
+	pthread_once(&zobrist_once, fill_zobrist_keys);
+}
+
+/**
+ * Gets the key of a pawn on a field of a board.
+ * @param[in] size The size of the board.
+ * @param[in] x    The x coordinate of the field.
+ * @param[in] y    The y coordinate of the field.
+ * @param[in] pawn The pawn, 'x' or 'o'.
+ * @return The key.
+ * \sa init_zobrist_keys
+ */
+uint64_t
+get_zobrist_key(int size, int x, int y, char pawn) {
+	return zobrist_keys[size - MIN_BOARD_SIZE][pawn == 'o'][x * size + y];
+}
+
+/**
+ * Gets the key of a pawn on a field of a sparse board.
+ * @param[in] x    The x coordinate of the field.
+ * @param[in] y    The y coordinate of the field.
+ * @param[in] pawn The pawn, 'x' or 'o'.
+ * @return The key.
+ */
+uint64_t
+get_sparse_zobrist_key(int x, int y, char pawn) {
+	uint64_t state = ZOBRIST_SEED ^ ((uint64_t) (uint32_t) x << 32)
+			^ (uint32_t) y ^ ((uint64_t) (pawn == 'o') << 63);
+	return splitmix64(&state);
+}
@@ -0,0 +1,20 @@
+/**
+ * @file zobrist.h
+ * @ingroup zobrist
+ *
+ * @author Piotr Janaszek <janas03@yahoo.pl>
+ * @date Created on: Oct 18, 2026
+ *
+ * @brief File containing Zobrist keys used to hash positions.
+ */
+
+#ifndef ZOBRIST_H_
+#define ZOBRIST_H_
+
+#include <stdint.h>
+
+void init_zobrist_keys(void);
+uint64_t get_zobrist_key(int size, int x, int y, char pawn);
+uint64_t get_sparse_zobrist_key(int x, int y, char pawn);
+
+#endif /* ZOBRIST_H_ */